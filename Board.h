@@ -41,6 +41,9 @@ extern "C" {
 /* If you want to use UART, comment out this define */
 #define BOARD_DISPLAY_EXCLUDE_UART
 
+/* The LCD is driven by libs/lcd.c, not by the Display driver */
+#define BOARD_DISPLAY_EXCLUDE_LCD
+
 #include <ti/drivers/Power.h>
 
 #include "CC2650STK.h"
@@ -0,0 +1,85 @@
+ /**************************************************************
+  * 
+  *   _   _           _        _        ____    ___  
+  *  | | | |_ __  ___| |_ __ _(_)_ __  |___ \  / _ \ 
+  *  | | | | '_ \/ __| __/ _` | | '__|   __) || | | |
+  *  | |_| | |_) \__ \ || (_| | | |     / __/ | |_| |
+  *   \___/| .__/|___/\__\__,_|_|_|    |_____(_)___/ 
+  *        |_| Miika Sikala, Oulun Yliopisto, 2018
+  * 
+  * 
+  * ************************************************************
+  * THE BEER-WARE LICENSE
+  * This file is part of Upstair 2.0 software. As long as you retain this notice you
+  * can do whatever you want with this stuff. If we meet some day, and you think
+  * this stuff is worth it, you can buy me a beer in return.
+  * 
+  * Miika Sikala
+  * ************************************************************
+  */
+
+// GENERATED by tools/mkanim.py from bitmaps/gui.c, do not edit.
+
+#include <stddef.h>
+
+#include "bitmaps/anim.h"
+#include "bitmaps/gui.h"
+
+
+/* ANIM_STAND_TO_STAIRS: img_standing -> img_stairs_up, 8 frames */
+// lines sent over the whole animation: 65 (910 B), a plain image swap: 53 (742 B)
+static const uint8_t anim_stand_to_stairs_xor1[] = {
+    0x2a, 0xa0, 0x00, 0x2a, 0x54, 0x40, 0x04, 0x40, 0xf8, 0x40, 0x07, 0x80, 0xf0, 0x00, 0x07, 0x00,
+    0xe0, 0x00, 0x07, 0x00, 0x00, 0x03, 0xff, 0x00, 0x00, 0x03, 0xff, 0x00, 0x00, 0x03, 0xff, 0x00,
+};
+static const uint8_t anim_stand_to_stairs_xor2[] = {
+    0x02, 0xa8, 0x2a, 0x2a, 0xa0, 0x01, 0x50, 0x55, 0x15, 0x50, 0x03, 0xf0, 0x3f, 0x38, 0x00, 0x07,
+    0xf0, 0x3b, 0x38, 0x00, 0x0f, 0x60, 0x1c, 0x38, 0x00, 0x1f, 0xe0, 0x1c, 0x38, 0x00, 0x3f, 0xc0,
+    0x11, 0xf8, 0x00, 0x7d, 0xc0, 0x11, 0xf8, 0x00, 0x51, 0x40, 0x10, 0x50, 0x00, 0xa2, 0x80, 0x0a,
+    0x00, 0x00,
+};
+static const uint8_t anim_stand_to_stairs_xor3[] = {
+    0xaa, 0x00, 0x00, 0x0a, 0x54, 0x15, 0x00, 0x15, 0xe4, 0x0f, 0x00, 0x1f, 0xe3, 0xef, 0x00, 0x1c,
+    0xe3, 0xf7, 0x00, 0x1c, 0xe7, 0x3b, 0x80, 0x1c, 0xe7, 0x3b, 0x80, 0x1c, 0xef, 0x3f, 0x8f, 0xfc,
+    0x44, 0x15, 0x45, 0x54, 0xaa, 0x0a, 0x8a, 0xa8,
+};
+static const uint8_t anim_stand_to_stairs_xor4[] = {
+    0x2a, 0x82, 0x2a, 0x2a, 0x00, 0x00, 0x51, 0x41, 0x54, 0x41, 0x00, 0x00, 0x73, 0xe7, 0xff, 0x83,
+    0x80, 0x00, 0x71, 0xff, 0xf6, 0x04, 0x00, 0x00, 0xf0, 0x71, 0xf4, 0x60, 0x00, 0x00, 0xe0, 0x11,
+    0xff, 0x80, 0x00, 0x00, 0x60, 0x19, 0xfe, 0x00, 0x00, 0x00, 0x00, 0x1d, 0xf8, 0x00, 0x00, 0x00,
+    0x00, 0x3c, 0xf0, 0x00, 0x00, 0x00, 0x00, 0x2a, 0x00, 0x00, 0x0a, 0x80, 0x00, 0x55, 0x05, 0x00,
+    0x05, 0x00,
+};
+static const uint8_t anim_stand_to_stairs_xor5[] = {
+    0x00, 0x0a, 0x82, 0xa0, 0x15, 0x50, 0x05, 0x40, 0x3f, 0xf0, 0x3f, 0x80, 0x3f, 0xe0, 0x18, 0x00,
+    0x70, 0x7c, 0x1e, 0x00, 0x71, 0xfc, 0x3f, 0x80, 0xf3, 0xe4, 0xb7, 0xc0, 0xe7, 0xc4, 0xb3, 0xe0,
+    0x45, 0x05, 0x50, 0x44, 0xaa, 0x08, 0xa8, 0x0a,
+};
+static const uint8_t anim_stand_to_stairs_xor6[] = {
+    0x00, 0xa2, 0x20, 0xa0, 0x00, 0x45, 0x50, 0x50, 0x01, 0xc7, 0x38, 0x70, 0x01, 0xc7, 0x38, 0x70,
+    0x01, 0xc7, 0x38, 0x70, 0x01, 0xc7, 0xb8, 0xf0, 0x00, 0xe3, 0xf8, 0xe0, 0x00, 0xf3, 0x13, 0xe0,
+    0x00, 0x54, 0x15, 0x40, 0xaa, 0x80, 0x2a, 0x80,
+};
+static const uint8_t anim_stand_to_stairs_xor7[] = {
+    0x00, 0x3e, 0x00, 0x0f, 0xff, 0x80, 0x3e, 0x3f, 0xc0, 0x7c, 0x03, 0xe0, 0x51, 0x50, 0x40, 0xa2,
+    0xa8, 0xa0,
+};
+
+static const AnimFrame anim_stand_to_stairs_frames[] = {
+    { 1, 0, 0, 0, 0, NULL },
+    { 1, 5, 47, 31, 8, anim_stand_to_stairs_xor1 },
+    { 1, 7, 39, 36, 10, anim_stand_to_stairs_xor2 },
+    { 1, 13, 31, 32, 10, anim_stand_to_stairs_xor3 },
+    { 1, 4, 22, 41, 11, anim_stand_to_stairs_xor4 },
+    { 1, 6, 14, 31, 10, anim_stand_to_stairs_xor5 },
+    { 1, 8, 6, 28, 10, anim_stand_to_stairs_xor6 },
+    { 1, 16, 2, 19, 6, anim_stand_to_stairs_xor7 },
+};
+
+const Animation anim_stand_to_stairs = {
+    &img_standing,
+    &img_stairs_up,
+    8,
+    anim_stand_to_stairs_frames,
+    ANIM_ONCE
+};
@@ -0,0 +1,60 @@
+ /**************************************************************
+  * 
+  *   _   _           _        _        ____    ___  
+  *  | | | |_ __  ___| |_ __ _(_)_ __  |___ \  / _ \ 
+  *  | | | | '_ \/ __| __/ _` | | '__|   __) || | | |
+  *  | |_| | |_) \__ \ || (_| | | |     / __/ | |_| |
+  *   \___/| .__/|___/\__\__,_|_|_|    |_____(_)___/ 
+  *        |_| Miika Sikala, Oulun Yliopisto, 2018
+  * 
+  * 
+  * ************************************************************
+  * THE BEER-WARE LICENSE
+  * This file is part of Upstair 2.0 software. As long as you retain this notice you
+  * can do whatever you want with this stuff. If we meet some day, and you think
+  * this stuff is worth it, you can buy me a beer in return.
+  * 
+  * Miika Sikala
+  * ************************************************************
+  */
+  
+#ifndef __ANIM_H__
+#define __ANIM_H__
+
+#include <inttypes.h>
+
+#include <ti/mw/grlib/grlib.h>
+
+// Animations are stored as the first and last image plus, for every frame,
+// the pixels that change from the previous frame (XOR, cropped to the
+// changed rectangle). The tables are generated by tools/mkanim.py.
+
+/* What happens after the last frame */
+typedef enum {
+    ANIM_ONCE,          // stop
+    ANIM_LOOP,          // continue from the first frame
+    ANIM_PINGPONG       // play backwards to the first frame and again
+} AnimLoop;
+
+typedef struct {
+    uint8_t ticks;      // how long the frame is shown (main loop rounds)
+    uint8_t x;          // changed rectangle, relative to the animation
+    uint8_t y;
+    uint8_t w;          // 0 if nothing changes
+    uint8_t h;
+    const uint8_t *bits;    // h rows of (w + 7) / 8 bytes, MSB is the leftmost pixel
+} AnimFrame;
+
+typedef struct {
+    const tImage *first;        // frame 0
+    const tImage *last;         // frame count - 1
+    uint8_t count;              // number of frames
+    const AnimFrame *frames;    // frames[i] turns frame i - 1 into frame i
+                                // (frames[0]: last frame into the first one)
+    AnimLoop loop;
+} Animation;
+
+/* Animations */
+extern const Animation anim_stand_to_stairs;
+
+#endif // __ANIM_H__
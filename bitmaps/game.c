@@ -0,0 +1,118 @@
+ /**************************************************************
+  * 
+  *   _   _           _        _        ____    ___  
+  *  | | | |_ __  ___| |_ __ _(_)_ __  |___ \  / _ \ 
+  *  | | | | '_ \/ __| __/ _` | | '__|   __) || | | |
+  *  | |_| | |_) \__ \ || (_| | | |     / __/ | |_| |
+  *   \___/| .__/|___/\__\__,_|_|_|    |_____(_)___/ 
+  *        |_| Miika Sikala, Oulun Yliopisto, 2018
+  * 
+  * 
+  * ************************************************************
+  * THE BEER-WARE LICENSE
+  * This file is part of Upstair 2.0 software. As long as you retain this notice you
+  * can do whatever you want with this stuff. If we meet some day, and you think
+  * this stuff is worth it, you can buy me a beer in return.
+  * 
+  * Miika Sikala
+  * ************************************************************
+  */
+  
+#include "bitmaps/game.h"
+
+
+/* PLAYER */
+/*
+..***...  ..***...  ..***...
+..***...  ..***...  ..***...
+..***...  ..***...  *.***.*.
+...*....  ...*....  .*.*.*..
+.*****..  .*****..  ..***...
+*.***.*.  *.***.*.  ..***...
+..***...  ..***...  ..***...
+..*.*...  ...*....  ..*.*...
+.*...*..  ...*....  .*...*..
+.*...*..  ..**....  .*...*..
+*.....*.  ..*.*...  ........
+*.....*.  ..*.*...  ........
+*/
+
+static const uint8_t game_player_run0_data[] = {
+    0x38, 0x38, 0x38, 0x10, 0x7C, 0xBA, 0x38, 0x28, 0x44, 0x44, 0x82, 0x82
+};
+
+static const uint8_t game_player_run1_data[] = {
+    0x38, 0x38, 0x38, 0x10, 0x7C, 0xBA, 0x38, 0x10, 0x10, 0x30, 0x28, 0x28
+};
+
+static const uint8_t game_player_jump_data[] = {
+    0x38, 0x38, 0xBA, 0x54, 0x38, 0x38, 0x38, 0x28, 0x44, 0x44, 0x00, 0x00
+};
+
+// only the body collides, flailing arms and legs are forgiven
+static const uint8_t game_player_mask[] = {
+    0x38, 0x38, 0x38, 0x10, 0x38, 0x38, 0x38, 0x38, 0x38, 0x38, 0x00, 0x00
+};
+
+const GameSprite game_player_run0 = { 8, 12, game_player_run0_data, game_player_mask };
+const GameSprite game_player_run1 = { 8, 12, game_player_run1_data, game_player_mask };
+const GameSprite game_player_jump = { 8, 12, game_player_jump_data, game_player_mask };
+
+
+/* GAME OBSTACLE */
+/*
+   *
+   *
+  ***
+  ***
+ *****
+ *****
+*******
+*******
+*/
+
+static const uint8_t game_obstacle01_data[] = {
+    0x10, 0x10, 0x38, 0x38, 0x7C, 0x7C, 0xFE, 0xFE
+};
+
+const GameSprite game_obstacle01 = { 7, 8, game_obstacle01_data, game_obstacle01_data };
+
+/* GAME OBSTACLE (STAIRS) */
+/*
+........****
+........****
+....********
+....********
+************
+************
+*/
+
+static const uint8_t game_obstacle02_data[] = {
+    0x00, 0xF0,
+    0x00, 0xF0,
+    0x0F, 0xF0,
+    0x0F, 0xF0,
+    0xFF, 0xF0,
+    0xFF, 0xF0
+};
+
+const GameSprite game_obstacle02 = { 12, 6, game_obstacle02_data, game_obstacle02_data };
+
+
+/* GAME GROUND */
+/*
+........
+........
+........
+........
+........
+........
+********
+********
+*/
+
+static const uint8_t game_ground_data[] = {
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xFF, 0xFF
+};
+
+const GameSprite game_ground = { 8, 8, game_ground_data, game_ground_data };
@@ -0,0 +1,49 @@
+ /**************************************************************
+  * 
+  *   _   _           _        _        ____    ___  
+  *  | | | |_ __  ___| |_ __ _(_)_ __  |___ \  / _ \ 
+  *  | | | | '_ \/ __| __/ _` | | '__|   __) || | | |
+  *  | |_| | |_) \__ \ || (_| | | |     / __/ | |_| |
+  *   \___/| .__/|___/\__\__,_|_|_|    |_____(_)___/ 
+  *        |_| Miika Sikala, Oulun Yliopisto, 2018
+  * 
+  * 
+  * ************************************************************
+  * THE BEER-WARE LICENSE
+  * This file is part of Upstair 2.0 software. As long as you retain this notice you
+  * can do whatever you want with this stuff. If we meet some day, and you think
+  * this stuff is worth it, you can buy me a beer in return.
+  * 
+  * Miika Sikala
+  * ************************************************************
+  */
+  
+#ifndef __GAME_H__
+#define __GAME_H__
+
+#include <inttypes.h>
+
+// Sprites of the game. These are drawn with LCD_blit() instead of grlib, so
+// they are stored pre-decoded: one row after another, (w + 7) / 8 bytes per
+// row, MSB is the leftmost pixel and 1 is black.
+
+typedef struct {
+    uint8_t w;                  // width (max 16)
+    uint8_t h;                  // height
+    const uint8_t *pixels;      // what is drawn
+    const uint8_t *mask;        // what collides (same layout as pixels)
+} GameSprite;
+
+/* Player */
+extern const GameSprite game_player_run0;
+extern const GameSprite game_player_run1;
+extern const GameSprite game_player_jump;
+
+/* Obstacles */
+extern const GameSprite game_obstacle01;
+extern const GameSprite game_obstacle02;
+
+/* Scenery */
+extern const GameSprite game_ground;
+
+#endif // __GAME_H__
@@ -297,70 +297,3 @@ const tImage img_standing = {
 	img_standing_data,
 };
 
-/* GAME GROUND */
-/*
-........
-........
-........
-........
-........
-........
-********
-********
-*/
-/*
-static const unsigned char game_ground_data[] = {
-    0x00,
-    0x00,
-    0x00,
-    0x00,
-    0x00,
-    0x00,
-    0xFF,
-    0xFF
-};
-
-const tImage game_ground = {
-	IMAGE_FMT_1BPP_UNCOMP,
-	1,
-	8,
-	2,
-	default_palette,
-	game_ground_data,
-};
-*/
-
-/* GAME OBSTACLE */
-/*
-   * 
-   *
-  ***
-  ***
- *****
- *****
-*******
-*******
-*/
-
-/*
-static const unsigned char game_obstacle01_data[] = {
-    0x10,
-    0x10,
-    0x38,
-    0x38,
-    0x7C,
-    0x7C,
-    0xFE,
-    0xFE
-};
-
-const tImage game_obstacle01 = {
-	IMAGE_FMT_1BPP_UNCOMP,
-	1,
-	8,
-	2,
-	default_palette,
-	game_obstacle01_data,
-};
-
-*/
@@ -0,0 +1,228 @@
+/*
+ * Speed and accuracy of the BMP280 compensation variants (sensors/bmp280.c):
+ *
+ *   double      bmp280_get_data(): the 64 bit formula, then hPa and C as
+ *               double (soft float on the M3)
+ *   64 bit      bmp280_get_data_fixed(): Pa * 256 and 0.01 C
+ *   32 bit      the same with bmp280_config.fast: 1 Pa resolution, no 64
+ *               bit multiplications or division
+ *
+ * First checks the fixed point results against the datasheet's example,
+ * then the error of each variant against the datasheet's floating point
+ * formulas over the whole range of the sensor, then the time per
+ * conversion (temperature and pressure).
+ *
+ * The host has a floating point unit and 64 bit arithmetic, so the
+ * differences are much smaller here than on the M3, where both are library
+ * calls. Measure there with PROFILING (libs/prof.h, readPressure).
+ *
+ * usage: bench_bmp280 [conversions]
+ */
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define HAVE_TSC
+#endif
+
+#include <inttypes.h>
+
+#include "sensors/bmp280.h"
+
+/* Trimming of the datasheet's example (section 3.12) */
+static const int32_t trim[12] = {
+    27504, 26435, -1000,                                // T1 - T3
+    36477, -10685, 3024, 2855, 140, -7, 15500, -14600, 6000   // P1 - P9
+};
+
+#define EXAMPLE_ADC_T   519888
+#define EXAMPLE_ADC_P   415148
+#define EXAMPLE_T       2508                // 0.01 C
+#define EXAMPLE_P       25767236            // Pa * 256, 100653.27 Pa
+
+typedef enum { VAR_DOUBLE, VAR_64, VAR_32, VARIANTS } Variant;
+
+static const char *names[VARIANTS] = { "double", "64 bit", "32 bit" };
+
+static volatile double sink;
+
+static void setTrimming() {
+    char v[24];
+    int i;
+
+    for (i = 0; i < 12; i++) {
+        v[2 * i] = trim[i] & 0xFF;
+        v[2 * i + 1] = (trim[i] >> 8) & 0xFF;
+    }
+    bmp280_set_trimming(v);
+}
+
+/* The datasheet's floating point formulas (section 8.1), Pa */
+static double reference(int32_t adcT, int32_t adcP) {
+    double var1, var2, p, tFine;
+
+    var1 = (adcT / 16384.0 - trim[0] / 1024.0) * trim[1];
+    var2 = (adcT / 131072.0 - trim[0] / 8192.0) * (adcT / 131072.0 - trim[0] / 8192.0) * trim[2];
+    tFine = var1 + var2;
+
+    var1 = tFine / 2.0 - 64000.0;
+    var2 = var1 * var1 * trim[8] / 32768.0;
+    var2 = var2 + var1 * trim[7] * 2.0;
+    var2 = var2 / 4.0 + trim[6] * 65536.0;
+    var1 = (trim[5] * var1 * var1 / 524288.0 + trim[4] * var1) / 524288.0;
+    var1 = (1.0 + var1 / 32768.0) * trim[3];
+    p = 1048576.0 - adcP;
+    p = (p - var2 / 4096.0) * 6250.0 / var1;
+    var1 = trim[11] * p * p / 2147483648.0;
+    var2 = p * trim[10] / 32768.0;
+
+    return p + (var1 + var2 + trim[9]) / 16.0;
+}
+
+/* Pressure (Pa) of one variant, temperature first like the driver */
+static double pressure(Variant v, int32_t adcT, int32_t adcP) {
+    switch (v) {
+        case VAR_DOUBLE:
+            bmp280_convert_temp(adcT);
+            return bmp280_convert_pres(adcP);
+        case VAR_64:
+            bmp280_compensate_temp(adcT);
+            return bmp280_compensate_pres(adcP) / 256.0;
+        default:
+            bmp280_compensate_temp(adcT);
+            return bmp280_compensate_pres32(adcP);
+    }
+}
+
+static int checkExample() {
+    int32_t t = bmp280_compensate_temp(EXAMPLE_ADC_T);
+    uint32_t p = bmp280_compensate_pres(EXAMPLE_ADC_P);
+    uint32_t p32 = bmp280_compensate_pres32(EXAMPLE_ADC_P);
+
+    printf("datasheet example: %" PRId32 " (0.01 C), %" PRIu32 " (Pa * 256), %" PRIu32 " Pa\n", t, p, p32);
+
+    // 100653.27 Pa with the floating point formulas; the 32 bit one is a few Pa off
+    if (t != EXAMPLE_T || abs((int32_t)(p - EXAMPLE_P)) > 4 || abs((int32_t)p32 - 100653) > 4) {
+        printf("FAIL: datasheet example: expected %d, %d, 100653\n", EXAMPLE_T, EXAMPLE_P);
+        return 0;
+    }
+    return 1;
+}
+
+/* Worst error against the floating point formulas, -40..85 C, 300..1100 hPa */
+static void accuracy() {
+    double maxError[VARIANTS] = { 0 };
+    double temp, ref, error;
+    int32_t adcT, adcP;
+    uint32_t points = 0;
+    int v;
+
+    for (adcT = 300000; adcT <= 700000; adcT += 4000) {
+        temp = bmp280_convert_temp(adcT);
+        if (temp < -40 || temp > 85) {
+            continue;
+        }
+
+        for (adcP = 150000; adcP <= 750000; adcP += 997) {
+            ref = reference(adcT, adcP);
+            if (ref < 30000 || ref > 110000) {
+                continue;
+            }
+            points++;
+
+            for (v = 0; v < VARIANTS; v++) {
+                error = fabs(pressure(v, adcT, adcP) - ref);
+                if (error > maxError[v]) {
+                    maxError[v] = error;
+                }
+            }
+        }
+    }
+
+    printf("error against the floating point formulas (%" PRIu32 " points):\n", points);
+    for (v = 0; v < VARIANTS; v++) {
+        printf("  %-8s max %.3f Pa (%.1f cm)\n", names[v], maxError[v], maxError[v] * 8.4);
+    }
+}
+
+/* Time per conversion of @n noisy raw samples around the example, each
+ * variant giving what its driver function gives */
+static void speed(uint32_t n) {
+    int32_t *adcT = malloc(n * sizeof(int32_t));
+    int32_t *adcP = malloc(n * sizeof(int32_t));
+    struct timespec t0, t1;
+    uint64_t cycles = 0;
+    double sum;
+    int64_t isum;
+    uint32_t i;
+    int v;
+
+    srand(1);
+    for (i = 0; i < n; i++) {
+        adcT[i] = EXAMPLE_ADC_T + rand() % 2001 - 1000;
+        adcP[i] = EXAMPLE_ADC_P + rand() % 20001 - 10000;
+    }
+
+    printf("time per conversion (temperature and pressure):\n");
+    for (v = 0; v < VARIANTS; v++) {
+        sum = 0;
+        isum = 0;
+
+        clock_gettime(CLOCK_MONOTONIC, &t0);
+#ifdef HAVE_TSC
+        cycles = __rdtsc();
+#endif
+        switch (v) {
+            case VAR_DOUBLE:
+                for (i = 0; i < n; i++) {
+                    sum += bmp280_convert_temp(adcT[i]);
+                    sum += bmp280_convert_pres(adcP[i]) * 0.01;
+                }
+                break;
+            case VAR_64:
+                for (i = 0; i < n; i++) {
+                    isum += bmp280_compensate_temp(adcT[i]);
+                    isum += bmp280_compensate_pres(adcP[i]);
+                }
+                break;
+            default:
+                for (i = 0; i < n; i++) {
+                    isum += bmp280_compensate_temp(adcT[i]);
+                    isum += bmp280_compensate_pres32(adcP[i]) << 8;
+                }
+                break;
+        }
+#ifdef HAVE_TSC
+        cycles = __rdtsc() - cycles;
+#endif
+        clock_gettime(CLOCK_MONOTONIC, &t1);
+        sink = sum + isum;
+
+        printf("  %-8s %6.1f ns", names[v],
+            ((t1.tv_sec - t0.tv_sec) * 1e9 + (t1.tv_nsec - t0.tv_nsec)) / n);
+#ifdef HAVE_TSC
+        printf(" (%.0f cycles)", (double)cycles / n);
+#endif
+        printf("\n");
+    }
+
+    free(adcT);
+    free(adcP);
+}
+
+int main(int argc, char **argv) {
+    uint32_t n = argc > 1 ? atoi(argv[1]) : 1000000;
+
+    setTrimming();
+
+    if (!checkExample()) {
+        return 1;
+    }
+    accuracy();
+    speed(n);
+
+    return 0;
+}
@@ -0,0 +1,192 @@
+/*
+ * Write throughput and wear benchmark for the activity log (libs/flashlog.c)
+ * on the simulated flash (flashsim.c).
+ *
+ * Feeds the log what the firmware writes during simulated days of use: the
+ * score every second while climbing, activity changes and received
+ * messages, syncing when a climb ends like main.c does. Runs it once with the
+ * page buffer and once syncing after every record, and reports the flash
+ * operations, the erase counts of the log sectors and the time the flash is
+ * busy. Then remounts the log and checks that all the records still in it
+ * read back in order.
+ *
+ * usage: bench_flashlog [days] [image file]
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <inttypes.h>
+
+#include "upstair.h"
+#include "libs/flashlog.h"
+#include "flashsim.h"
+
+typedef struct {
+    uint32_t records;
+    uint32_t bytes;             // record data
+    uint16_t score;
+} Workload;
+
+static double elapsedUs(const struct timespec *a, const struct timespec *b) {
+    return (b->tv_sec - a->tv_sec) * 1e6 + (b->tv_nsec - a->tv_nsec) / 1e3;
+}
+
+static void append(Workload *w, uint8_t type, const void *data, uint8_t len) {
+    if (!FLOG_append(type, data, len)) {
+        printf("FAIL: append\n");
+        exit(1);
+    }
+    w->records++;
+    w->bytes += len;
+}
+
+/* A second of use. Climbs last 30-120 s, with 1-10 min between them. */
+static void second(Workload *w, uint32_t t, int syncAll) {
+    static uint32_t next = 0;
+    static uint8_t climbing = 0;
+    LogActivity act;
+    char msg[MAX_TEXT_LEN];
+
+    if (t == 0) {
+        next = 0;
+        climbing = 0;
+    }
+
+    if (t == next) {
+        climbing = !climbing;
+        next = t + (climbing ? 30 + rand() % 90 : 60 + rand() % 540);
+
+        act.uptime = t;
+        act.score = w->score;
+        act.activity = climbing ? ACT_STAIRS : ACT_IDLE;
+        append(w, LOG_ACTIVITY, &act, sizeof(act));
+
+        if (!climbing) {
+            FLOG_sync();
+        }
+    }
+
+    if (climbing) {
+        w->score++;
+        append(w, LOG_SCORE, &w->score, sizeof(w->score));
+    }
+
+    if (rand() % 120 == 0) {
+        memset(msg, 0, sizeof(msg));
+        snprintf(msg, sizeof(msg), "msg %u", (unsigned)w->records);
+        append(w, LOG_MSG, msg, sizeof(msg));
+    }
+
+    if (syncAll) {
+        FLOG_sync();
+    }
+}
+
+/* Read the whole log back, the scores must be increasing and end at the last one */
+static int verify(uint16_t lastScore) {
+    FlogCursor cursor;
+    FlogRecord record;
+    uint32_t records = 0;
+    uint16_t score = 0;
+    uint16_t prev = 0;
+    int ok = 1;
+
+    FLOG_first(&cursor, FLOG_SECTORS);
+    while (FLOG_next(&cursor, &record)) {
+        records++;
+        if (record.type != LOG_SCORE) {
+            continue;
+        }
+
+        memcpy(&score, record.data, sizeof(score));
+        if (prev != 0 && score != prev + 1) {
+            printf("FAIL: score %u after %u\n", score, prev);
+            ok = 0;
+        }
+        prev = score;
+    }
+
+    if (score != lastScore) {
+        printf("FAIL: last score %u, expected %u\n", score, lastScore);
+        ok = 0;
+    }
+
+    printf("  readback   %u records, last score %u: %s\n", records, score, ok ? "ok" : "FAILED");
+    return ok;
+}
+
+static int run(const char *name, uint32_t days, const char *path, int syncAll) {
+    uint32_t seconds = days * 24 * 3600;
+    FLASHSIM_Stats *stats;
+    Workload w = { 0, 0, 0 };
+    struct timespec t0, t1;
+    uint32_t minErases = ~0u;
+    uint32_t maxErases = 0;
+    uint32_t t;
+    int s;
+    int ok;
+
+    srand(1);
+    FLASHSIM_init(path, 1);
+    stats = FLASHSIM_getStats();
+
+    if (!FLOG_open()) {
+        printf("FAIL: open\n");
+        return 0;
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    for (t = 0; t < seconds; t++) {
+        second(&w, t, syncAll);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+
+    FLOG_close();
+
+    for (s = FLOG_BASE / EXTFLASH_SECTOR_SIZE; s < FLOG_BASE / EXTFLASH_SECTOR_SIZE + FLOG_SECTORS; s++) {
+        if (stats->sectorErases[s] < minErases) {
+            minErases = stats->sectorErases[s];
+        }
+        if (stats->sectorErases[s] > maxErases) {
+            maxErases = stats->sectorErases[s];
+        }
+    }
+
+    printf("%s, %u days:\n", name, days);
+    printf("  records    %u (%u B data), %.2f us CPU each\n", w.records, w.bytes,
+        elapsedUs(&t0, &t1) / w.records);
+    printf("  programs   %u (%u B, %.1f B each)\n", stats->programs, stats->programBytes,
+        (double)stats->programBytes / stats->programs);
+    printf("  erases     %u, per log sector %u..%u\n", stats->erases, minErases, maxErases);
+    printf("  flash busy %.1f s/day, %u wakeups/day\n", stats->busyUs / 1e6 / days,
+        stats->wakeups / days);
+
+    ok = stats->errors == 0;
+    if (!ok) {
+        printf("FAIL: %u flash errors\n", stats->errors);
+    }
+
+    // remount from the image, like after a reboot
+    FLASHSIM_init(path, 0);
+    if (!FLOG_open()) {
+        printf("FAIL: remount\n");
+        return 0;
+    }
+    ok = verify(w.score) && ok;
+    FLOG_close();
+
+    return ok;
+}
+
+int main(int argc, char **argv) {
+    uint32_t days = (argc > 1) ? (uint32_t)atoi(argv[1]) : 7;
+    const char *path = (argc > 2) ? argv[2] : "build/flashlog.img";
+    int ok = 1;
+
+    ok = run("page buffer", days, path, 0) && ok;
+    ok = run("sync every record", days, path, 1) && ok;
+
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,103 @@
+/*
+ * Frame time benchmark for the game (libs/game.c) on the host.
+ *
+ * Runs the game with the real LCD driver on simulated time: the main loop
+ * period of the firmware between frames and a bot pressing the button at
+ * random. Reports percentiles of the CPU time of GAME_frame() on this
+ * machine, and of the SPI bytes and bus time each frame costs on the LCD.
+ *
+ * usage: bench_game [frames] [frame period in us]
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include <ti/drivers/SPI.h>
+
+#include "libs/lcd.h"
+#include "libs/game.h"
+#include "libs/spibus.h"
+
+static int cmpDouble(const void *a, const void *b) {
+    double x = *(const double *)a;
+    double y = *(const double *)b;
+
+    return (x > y) - (x < y);
+}
+
+static double percentile(double *sorted, int n, int p) {
+    return sorted[(long)(n - 1) * p / 100];
+}
+
+static void report(const char *name, const char *unit, double *values, int n) {
+    qsort(values, n, sizeof(double), cmpDouble);
+    printf("%-12s p50 %8.1f  p90 %8.1f  p99 %8.1f  max %8.1f %s\n", name,
+        percentile(values, n, 50), percentile(values, n, 90),
+        percentile(values, n, 99), values[n - 1], unit);
+}
+
+static double elapsedUs(const struct timespec *a, const struct timespec *b) {
+    return (b->tv_sec - a->tv_sec) * 1e6 + (b->tv_nsec - a->tv_nsec) / 1e3;
+}
+
+int main(int argc, char **argv) {
+    int frames = (argc > 1) ? atoi(argv[1]) : 20000;
+    uint32_t period = (argc > 2) ? (uint32_t)atoi(argv[2]) : 50000;
+    double *cpu = malloc(frames * sizeof(double));
+    double *bytes = malloc(frames * sizeof(double));
+    double *bus = malloc(frames * sizeof(double));
+    const LCD_Stats *lcd;
+    const GAME_Stats *game;
+    struct timespec t0, t1;
+    uint32_t now = 0;
+    uint32_t flushes;
+    uint16_t games = 1;
+    int i;
+
+    srand(1);
+    LCD_open();
+    lcd = LCD_getStats();
+    game = GAME_getStats();
+
+    GAME_reset(now);
+    GAME_invalidate();
+
+    for(i=0; i < frames; i++) {
+        now += period;
+
+        // the bot jumps every now and then and starts over after losing
+        if (rand() % 8 == 0) {
+            if (GAME_isOver()) {
+                ++games;
+            }
+            GAME_press();
+        }
+
+        flushes = lcd->flushes;
+
+        clock_gettime(CLOCK_MONOTONIC, &t0);
+        GAME_frame(now);
+        clock_gettime(CLOCK_MONOTONIC, &t1);
+
+        cpu[i] = elapsedUs(&t0, &t1);
+        bytes[i] = (lcd->flushes != flushes) ? lcd->lastBytes : 0;
+        bus[i] = bytes[i] * 8 * 1e6 / SPIBUS_BITRATE;
+    }
+
+    printf("%d frames, %u us apart, %u games, best score %u\n", frames, period, games, GAME_best());
+    printf("steps %u, frames drawn %u, dropped %u, empty flushes %u\n",
+        game->steps, game->frames, game->dropped, lcd->skipped);
+
+    report("cpu (host)", "us", cpu, frames);
+    report("spi bytes", "B", bytes, frames);
+    report("spi time", "us", bus, frames);
+
+    printf("full frame would be %d B, %.1f us\n", 2 + SCREEN_H * (2 + SCREEN_W / 8),
+        (2 + SCREEN_H * (2 + SCREEN_W / 8)) * 8 * 1e6 / SPIBUS_BITRATE);
+
+    free(cpu);
+    free(bytes);
+    free(bus);
+
+    return 0;
+}
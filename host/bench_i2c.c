@@ -0,0 +1,440 @@
+/*
+ * I2C bus time benchmark for the sensors, on the register level models
+ * (sensorsim.c) at 400 kHz.
+ *
+ * First runs the finished drivers in sensors/ and checks that what they read
+ * matches the simulated environment. Then compares ways of reading each
+ * sensor: register by register, in groups and in bursts, and for the
+ * MPU9250 from the FIFO. For each, the transfers and bytes per reading, the
+ * bus time per reading and the share of the bus at a typical rate.
+ *
+ * Waiting for conversions is simulated (SENSORSIM_advance()), only the
+ * driver setups sleep.
+ *
+ * usage: bench_i2c [readings]
+ */
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <inttypes.h>
+
+#include <ti/drivers/I2C.h>
+
+#include "Board.h"
+#include "sensors/mpu9250.h"
+#include "sensors/bmp280.h"
+#include "sensors/hdc1000.h"
+#include "sensors/opt3001.h"
+#include "sensorsim.h"
+
+static I2C_Handle i2c;
+
+static void transfer(uint8_t addr, const uint8_t *writeBuf, size_t writeCount, uint8_t *readBuf, size_t readCount) {
+    I2C_Transaction t;
+
+    t.slaveAddress = addr;
+    t.writeBuf = (void *)writeBuf;
+    t.writeCount = writeCount;
+    t.readBuf = readBuf;
+    t.readCount = readCount;
+
+    if (!I2C_transfer(i2c, &t)) {
+        printf("FAIL: transfer to 0x%02X not acknowledged\n", addr);
+        exit(1);
+    }
+}
+
+static void readReg(uint8_t addr, uint8_t reg, uint8_t *data, size_t count) {
+    transfer(addr, &reg, 1, data, count);
+}
+
+static void writeReg(uint8_t addr, uint8_t reg, uint8_t value) {
+    uint8_t buf[2] = { reg, value };
+
+    transfer(addr, buf, 2, NULL, 0);
+}
+
+static void writeReg16(uint8_t addr, uint8_t reg, uint16_t value) {
+    uint8_t buf[3] = { reg, value >> 8, value & 0xFF };
+
+    transfer(addr, buf, 3, NULL, 0);
+}
+
+static void check(const char *what, double value, double expected, double tolerance) {
+    if (fabs(value - expected) > tolerance) {
+        printf("FAIL: %s %.3f, expected %.3f\n", what, value, expected);
+        exit(1);
+    }
+}
+
+/* Bus use of @addr since @before, per reading */
+static void report(uint8_t addr, const I2C_HostStats *before, const char *name, uint32_t readings, double rate) {
+    I2C_HostStats *after = I2C_hostDeviceStats(addr);
+    double us = (after->busTimeUs - before->busTimeUs) / readings;
+
+    printf("  %-34s %6.1f transfers %7.1f B %8.1f us", name,
+        (double)(after->transfers - before->transfers) / readings,
+        (double)(after->bytes - before->bytes) / readings, us);
+    if (rate > 0) {
+        printf("  %5.2f%% at %g Hz", us * rate / 1e4, rate);
+    }
+    printf("\n");
+}
+
+
+/* The drivers */
+
+static void drivers(uint32_t readings) {
+    I2C_HostStats before;
+    float a[3], g[3];
+    double pres, temp;
+    uint32_t presFixed;
+    int32_t tempFixed;
+    int16_t climateTemp;
+    uint16_t climateHum;
+    uint32_t lux;
+    uint16_t status;
+    const bmp280_config baroConfig = {
+        BMP280_OSRS_X4, BMP280_OSRS_X1, BMP280_FILTER_OFF, BMP280_STANDBY_125_MS, 0
+    };
+    uint32_t i;
+
+    printf("drivers\n");
+
+    before = *I2C_hostDeviceStats(Board_MPU9250_ADDR);
+    mpu9250_setup(&i2c);
+    report(Board_MPU9250_ADDR, &before, "mpu9250_setup", 1, 0);
+
+    before = *I2C_hostDeviceStats(Board_MPU9250_ADDR);
+    for (i = 0; i < readings; i++) {
+        SENSORSIM_advance(5000);
+        mpu9250_get_data(&i2c, &a[0], &a[1], &a[2], &g[0], &g[1], &g[2]);
+    }
+    report(Board_MPU9250_ADDR, &before, "mpu9250_get_data", readings, 10);
+    check("MPU9250 az", a[2], 1.0, 0.03);
+    check("MPU9250 gx", g[0], 0.0, 0.5);
+
+    before = *I2C_hostDeviceStats(Board_BMP280_ADDR);
+    bmp280_setup(&i2c, &baroConfig);
+    report(Board_BMP280_ADDR, &before, "bmp280_setup", 1, 0);
+
+    before = *I2C_hostDeviceStats(Board_BMP280_ADDR);
+    for (i = 0; i < readings; i++) {
+        SENSORSIM_advance(150000);
+        bmp280_get_data(&i2c, &pres, &temp);
+    }
+    report(Board_BMP280_ADDR, &before, "bmp280_get_data", readings, 10);
+    check("BMP280 pressure", pres, SENSORSIM_getEnv()->pressure, 0.2);
+    check("BMP280 temperature", temp, SENSORSIM_getEnv()->temperature, 0.1);
+
+    bmp280_get_data_fixed(&i2c, &presFixed, &tempFixed);
+    check("BMP280 pressure (fixed point)", presFixed / 25600.0, SENSORSIM_getEnv()->pressure, 0.2);
+    check("BMP280 temperature (fixed point)", tempFixed / 100.0, SENSORSIM_getEnv()->temperature, 0.1);
+
+    hdc1000_setup(&i2c);
+
+    // not ready before the conversion is done
+    hdc1000_start(&i2c);
+    if (hdc1000_get_data_fixed(&i2c, &climateTemp, &climateHum)) {
+        printf("FAIL: HDC1000 read before the conversion was done\n");
+        exit(1);
+    }
+
+    before = *I2C_hostDeviceStats(Board_HDC1000_ADDR);
+    for (i = 0; i < readings; i++) {
+        hdc1000_start(&i2c);
+        SENSORSIM_advance(HDC1000_CONVERSION_MS * 1000);
+        hdc1000_get_data_fixed(&i2c, &climateTemp, &climateHum);
+    }
+    report(Board_HDC1000_ADDR, &before, "hdc1000_start, _get_data_fixed", readings, 1);
+    check("HDC1000 temperature (fixed point)", climateTemp / 100.0, SENSORSIM_getEnv()->temperature, 0.3);
+    check("HDC1000 humidity (fixed point)", climateHum / 100.0, SENSORSIM_getEnv()->humidity, 1.5);
+
+    opt3001_setup(&i2c);
+    SENSORSIM_advance(100000);
+    opt3001_get_data_fixed(&i2c, &lux);
+    check("OPT3001 lux (fixed point)", lux / 100.0, SENSORSIM_getEnv()->lux, 0.05 * SENSORSIM_getEnv()->lux);
+
+    // a window around the light: no flags until it changes, for two conversions
+    opt3001_set_window(&i2c, lux * 3 / 4, lux * 5 / 4);
+    opt3001_get_status(&i2c, &status);
+    before = *I2C_hostDeviceStats(Board_OPT3001_ADDR);
+    for (i = 0; i < readings; i++) {
+        SENSORSIM_advance(100000);
+        opt3001_get_status(&i2c, &status);
+        if (status & (OPT3001_FLAG_HIGH | OPT3001_FLAG_LOW)) {
+            printf("FAIL: OPT3001 window flag without a change\n");
+            exit(1);
+        }
+    }
+    report(Board_OPT3001_ADDR, &before, "opt3001_get_status", readings, 2.5);
+    SENSORSIM_getEnv()->lux /= 2;
+    SENSORSIM_advance(200000);
+    opt3001_get_status(&i2c, &status);
+    SENSORSIM_getEnv()->lux *= 2;
+    check("OPT3001 low flag after the light halved", (status & OPT3001_FLAG_LOW) != 0, 1, 0);
+}
+
+
+/* MPU9250: accel, temperature and gyro */
+
+static void mpu9250(uint32_t readings) {
+    I2C_HostStats before;
+    uint8_t data[512];
+    uint16_t count;
+    uint32_t samples = 0;
+    uint32_t i;
+    uint8_t j;
+
+    printf("MPU9250 (200 Hz, 14 B of data)\n");
+
+    writeReg(Board_MPU9250_ADDR, 0x1A, 0x03);       // CONFIG: 41 Hz DLPF, 1 kHz
+    writeReg(Board_MPU9250_ADDR, 0x19, 0x04);       // SMPLRT_DIV: 200 Hz
+
+    before = *I2C_hostDeviceStats(Board_MPU9250_ADDR);
+    for (i = 0; i < readings; i++) {
+        SENSORSIM_advance(5000);
+        for (j = 0; j < 7; j++) {
+            readReg(Board_MPU9250_ADDR, 0x3B + 2 * j, &data[2 * j], 2);
+        }
+    }
+    report(Board_MPU9250_ADDR, &before, "7 registers", readings, 200);
+
+    before = *I2C_hostDeviceStats(Board_MPU9250_ADDR);
+    for (i = 0; i < readings; i++) {
+        SENSORSIM_advance(5000);
+        readReg(Board_MPU9250_ADDR, 0x3B, &data[0], 6);
+        readReg(Board_MPU9250_ADDR, 0x41, &data[6], 2);
+        readReg(Board_MPU9250_ADDR, 0x43, &data[8], 6);
+    }
+    report(Board_MPU9250_ADDR, &before, "accel, temp, gyro", readings, 200);
+
+    before = *I2C_hostDeviceStats(Board_MPU9250_ADDR);
+    for (i = 0; i < readings; i++) {
+        SENSORSIM_advance(5000);
+        readReg(Board_MPU9250_ADDR, 0x3B, data, 14);
+    }
+    report(Board_MPU9250_ADDR, &before, "burst", readings, 200);
+
+    before = *I2C_hostDeviceStats(Board_MPU9250_ADDR);
+    for (i = 0; i < readings; i++) {
+        SENSORSIM_advance(5000);
+        readReg(Board_MPU9250_ADDR, 0x3A, data, 1);
+        if (data[0] & 0x01) {
+            readReg(Board_MPU9250_ADDR, 0x3B, data, 14);
+        }
+    }
+    report(Board_MPU9250_ADDR, &before, "status, burst when ready", readings, 200);
+
+    // accel and gyro (12 B) to the FIFO, emptied at 10 Hz
+    writeReg(Board_MPU9250_ADDR, 0x6A, 0x44);       // USER_CTRL: FIFO on and reset
+    writeReg(Board_MPU9250_ADDR, 0x23, 0x78);       // FIFO_EN: gyro xyz, accel
+
+    for (i = 0; i < readings / 20; i++) {
+        SENSORSIM_advance(100000);
+        readReg(Board_MPU9250_ADDR, 0x72, data, 2);
+        count = (data[0] << 8) | data[1];
+        count -= count % 12;
+        readReg(Board_MPU9250_ADDR, 0x74, data, count);
+        samples += count / 12;
+
+        if (i == 0) {
+            before = *I2C_hostDeviceStats(Board_MPU9250_ADDR);
+            samples = 0;
+        }
+    }
+    report(Board_MPU9250_ADDR, &before, "FIFO at 10 Hz (no temperature)", samples, 200);
+
+    writeReg(Board_MPU9250_ADDR, 0x23, 0x00);
+    writeReg(Board_MPU9250_ADDR, 0x6A, 0x04);
+}
+
+
+/* BMP280: pressure and temperature */
+
+static void bmp280(uint32_t readings) {
+    I2C_HostStats before;
+    uint8_t data[6];
+    uint32_t i;
+    uint8_t j;
+
+    printf("BMP280 (normal mode, 6 B of data)\n");
+
+    before = *I2C_hostDeviceStats(Board_BMP280_ADDR);
+    for (i = 0; i < readings; i++) {
+        SENSORSIM_advance(150000);
+        for (j = 0; j < 6; j++) {
+            readReg(Board_BMP280_ADDR, 0xF7 + j, &data[j], 1);
+        }
+    }
+    report(Board_BMP280_ADDR, &before, "6 registers", readings, 10);
+
+    before = *I2C_hostDeviceStats(Board_BMP280_ADDR);
+    for (i = 0; i < readings; i++) {
+        SENSORSIM_advance(150000);
+        readReg(Board_BMP280_ADDR, 0xF7, &data[0], 3);
+        readReg(Board_BMP280_ADDR, 0xFA, &data[3], 3);
+    }
+    report(Board_BMP280_ADDR, &before, "pressure, temperature", readings, 10);
+
+    before = *I2C_hostDeviceStats(Board_BMP280_ADDR);
+    for (i = 0; i < readings; i++) {
+        SENSORSIM_advance(150000);
+        readReg(Board_BMP280_ADDR, 0xF7, data, 6);
+    }
+    report(Board_BMP280_ADDR, &before, "burst", readings, 10);
+
+    // forced mode: start, poll until done, read
+    before = *I2C_hostDeviceStats(Board_BMP280_ADDR);
+    for (i = 0; i < readings; i++) {
+        writeReg(Board_BMP280_ADDR, 0xF4, 0x2D);
+        do {
+            SENSORSIM_advance(2000);
+            readReg(Board_BMP280_ADDR, 0xF3, data, 1);
+        } while (data[0] & 0x08);
+        readReg(Board_BMP280_ADDR, 0xF7, data, 6);
+    }
+    report(Board_BMP280_ADDR, &before, "forced, polled every 2 ms", readings, 10);
+
+    writeReg(Board_BMP280_ADDR, 0xF4, 0x2F);
+}
+
+
+/* OPT3001: light */
+
+static void opt3001(uint32_t readings) {
+    I2C_HostStats before;
+    uint8_t data[2];
+    uint32_t i;
+
+    printf("OPT3001 (continuous, 100 ms)\n");
+
+    writeReg16(Board_OPT3001_ADDR, 0x01, 0xC610);   // auto range, 100 ms, continuous
+
+    before = *I2C_hostDeviceStats(Board_OPT3001_ADDR);
+    for (i = 0; i < readings; i++) {
+        SENSORSIM_advance(100000);
+        readReg(Board_OPT3001_ADDR, 0x01, data, 2);
+        if (data[1] & 0x80) {
+            readReg(Board_OPT3001_ADDR, 0x00, data, 2);
+        }
+    }
+    report(Board_OPT3001_ADDR, &before, "config, result when ready", readings, 10);
+    check("OPT3001 lux", 0.01 * (1 << (data[0] >> 4)) * (((data[0] & 0x0F) << 8) | data[1]),
+        SENSORSIM_getEnv()->lux, 0.05 * SENSORSIM_getEnv()->lux);
+
+    // the pointer stays at the result, so it needs no write
+    readReg(Board_OPT3001_ADDR, 0x00, data, 2);
+    before = *I2C_hostDeviceStats(Board_OPT3001_ADDR);
+    for (i = 0; i < readings; i++) {
+        SENSORSIM_advance(100000);
+        transfer(Board_OPT3001_ADDR, NULL, 0, data, 2);
+    }
+    report(Board_OPT3001_ADDR, &before, "result, pointer kept", readings, 10);
+}
+
+
+/* HDC1000: temperature and humidity */
+
+static void hdc1000(uint32_t readings) {
+    I2C_HostStats before;
+    uint8_t reg;
+    uint8_t data[4];
+    uint32_t i;
+
+    printf("HDC1000 (14 bit)\n");
+
+    writeReg16(Board_HDC1000_ADDR, 0x02, 0x0000);   // one at a time
+    before = *I2C_hostDeviceStats(Board_HDC1000_ADDR);
+    for (i = 0; i < readings; i++) {
+        reg = 0x00;
+        transfer(Board_HDC1000_ADDR, &reg, 1, NULL, 0);
+        SENSORSIM_advance(6500);
+        transfer(Board_HDC1000_ADDR, NULL, 0, &data[0], 2);
+        reg = 0x01;
+        transfer(Board_HDC1000_ADDR, &reg, 1, NULL, 0);
+        SENSORSIM_advance(6500);
+        transfer(Board_HDC1000_ADDR, NULL, 0, &data[2], 2);
+    }
+    report(Board_HDC1000_ADDR, &before, "temperature, humidity", readings, 1);
+
+    writeReg16(Board_HDC1000_ADDR, 0x02, 0x1000);   // in sequence
+    before = *I2C_hostDeviceStats(Board_HDC1000_ADDR);
+    for (i = 0; i < readings; i++) {
+        reg = 0x00;
+        transfer(Board_HDC1000_ADDR, &reg, 1, NULL, 0);
+        SENSORSIM_advance(13000);
+        transfer(Board_HDC1000_ADDR, NULL, 0, data, 4);
+    }
+    report(Board_HDC1000_ADDR, &before, "both in sequence", readings, 1);
+    check("HDC1000 temperature", ((data[0] << 8) | data[1]) / 65536.0 * 165 - 40,
+        SENSORSIM_getEnv()->temperature, 0.3);
+    check("HDC1000 humidity", ((data[2] << 8) | data[3]) / 65536.0 * 100,
+        SENSORSIM_getEnv()->humidity, 1.5);
+}
+
+
+/* TMP007: object temperature */
+
+static void tmp007(uint32_t readings) {
+    I2C_HostStats before;
+    uint8_t data[2];
+    uint32_t i;
+
+    printf("TMP007 (1 conversion per 260 ms)\n");
+
+    writeReg16(Board_TMP007_ADDR, 0x02, 0x1000);    // CR 0
+
+    before = *I2C_hostDeviceStats(Board_TMP007_ADDR);
+    for (i = 0; i < readings; i++) {
+        SENSORSIM_advance(260000);
+        readReg(Board_TMP007_ADDR, 0x04, data, 2);
+        if (data[0] & 0x40) {
+            readReg(Board_TMP007_ADDR, 0x03, data, 2);
+        }
+    }
+    report(Board_TMP007_ADDR, &before, "status, object when ready", readings, 4);
+    check("TMP007 object temperature", (int16_t)((data[0] << 8) | data[1]) / 4 * 0.03125,
+        SENSORSIM_getEnv()->objectTemp, 0.5);
+
+    before = *I2C_hostDeviceStats(Board_TMP007_ADDR);
+    for (i = 0; i < readings; i++) {
+        SENSORSIM_advance(260000);
+        readReg(Board_TMP007_ADDR, 0x03, data, 2);
+    }
+    report(Board_TMP007_ADDR, &before, "object", readings, 4);
+}
+
+int main(int argc, char **argv) {
+    I2C_Params params;
+    uint32_t readings = 1000;
+
+    if (argc > 1) {
+        readings = atoi(argv[1]);
+    }
+    if (readings < 20) {
+        readings = 20;
+    }
+
+    SENSORSIM_init();
+
+    I2C_init();
+    I2C_Params_init(&params);
+    params.bitRate = I2C_400kHz;
+    i2c = I2C_open(Board_I2C, &params);
+
+    printf("bus time per reading at 400 kHz, share of the bus at the rate\n");
+    drivers(readings);
+    mpu9250(readings);
+    bmp280(readings);
+    opt3001(readings);
+    hdc1000(readings);
+    tmp007(readings);
+
+    printf("bus total: %u transfers, %" PRIu64 " B, %.1f ms\n",
+        I2C_hostStats.transfers, I2C_hostStats.bytes, I2C_hostStats.busTimeUs / 1000);
+
+    return 0;
+}
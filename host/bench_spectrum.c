@@ -0,0 +1,165 @@
+/*
+ * Accuracy and speed of the step band features (libs/spectrum.c).
+ *
+ * Feeds 200 Hz vertical accelerations like ATT_vertical() gives: a steady
+ * rhythm at cadences from slow walking to running (with a harmonic and
+ * noise), then irregular movement and lying still. For each, the mean of
+ * the features over a minute against what they should be: the dominant
+ * frequency and the RMS of the rhythm, and a high regularity only for the
+ * rhythm. The step band is SPEC_BAND_LOW..SPEC_BAND_HIGH: 1.2 and 3 Hz are
+ * outside of it and read low there, though the dominant is still found.
+ *
+ * Then the time per SPEC_sample(): on average, and for the samples that end
+ * a window, which do the floating point part. The host has a floating point
+ * unit, the M3 does not; measure there with PROFILING (libs/prof.h,
+ * SPEC_sample).
+ *
+ * usage: bench_spectrum [samples]
+ */
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define HAVE_TSC
+#endif
+
+#include <inttypes.h>
+
+#include "libs/spectrum.h"
+
+#define RATE        200                 // Hz
+#define SECONDS     60
+#define AMPLITUDE   300.0               // mg, of the step rhythm
+#define NOISE       30.0                // mg
+
+static volatile uint32_t sink;
+
+static double gauss() {
+    double u = (rand() + 1.0) / (RAND_MAX + 2.0);
+    double v = (rand() + 1.0) / (RAND_MAX + 2.0);
+
+    return sqrt(-2.0 * log(u)) * cos(2.0 * M_PI * v);
+}
+
+static int16_t toMg(double v) {
+    return v > 32767 ? 32767 : (v < -32768 ? -32768 : (int16_t)lround(v));
+}
+
+/* Sample @n of a rhythm at @hz, or irregular movement when @hz is negative,
+ * or stillness at 0 */
+static int16_t sample(double hz, uint32_t n) {
+    static double drift = 0;
+    double t = (double)n / RATE;
+    double phase = 2.0 * M_PI * hz * t;
+
+    if (hz > 0) {
+        return toMg(AMPLITUDE * sin(phase) + 0.3 * AMPLITUDE * sin(2 * phase + 0.5) + NOISE * gauss());
+    }
+    if (hz < 0) {
+        // a random walk, low passed: fidgeting, no rhythm
+        drift = 0.98 * drift + 40.0 * gauss();
+        return toMg(drift + NOISE * gauss());
+    }
+    return toMg(2.0 * gauss());
+}
+
+static void accuracy() {
+    const double cadences[] = { 1.2, 1.5, 1.8, 2.1, 2.5, 3.0, -1, 0 };
+    const SpecFeatures *f = SPEC_features();
+    double dominant, band, regularity, error;
+    uint32_t n, windows;
+    unsigned i;
+
+    printf("features, mean over %d s (rhythm %.0f mg, harmonic %.0f mg, noise %.0f mg):\n",
+        SECONDS, AMPLITUDE, 0.3 * AMPLITUDE, NOISE);
+
+    for (i = 0; i < sizeof(cadences) / sizeof(cadences[0]); i++) {
+        srand(1);
+        SPEC_init(RATE);
+        dominant = band = regularity = error = 0;
+        windows = 0;
+
+        for (n = 0; n < SECONDS * RATE; n++) {
+            if (SPEC_sample(sample(cadences[i], n))) {
+                dominant += f->dominant / 100.0;
+                band += f->bandAmplitude;
+                regularity += f->regularity;
+                if (cadences[i] > 0) {
+                    error = fmax(error, fabs(f->dominant / 100.0 - cadences[i]));
+                }
+                windows++;
+            }
+        }
+
+        if (cadences[i] > 0) {
+            printf("  %.1f Hz     dominant %.2f Hz (max error %.2f)  step band %3.0f mg  regularity %3.0f%%\n",
+                cadences[i], dominant / windows, error, band / windows, regularity / windows);
+        } else {
+            printf("  %-10s dominant %.2f Hz                   step band %3.0f mg  regularity %3.0f%%\n",
+                cadences[i] < 0 ? "irregular" : "still", dominant / windows, band / windows,
+                regularity / windows);
+        }
+    }
+    printf("  (a rhythm in the band should read %.0f mg)\n", AMPLITUDE / sqrt(2.0));
+}
+
+static void speed(uint32_t n) {
+    int16_t *input = malloc(n * sizeof(int16_t));
+    struct timespec t0, t1;
+    uint64_t cycles = 0;
+    uint64_t windowCycles = 0;
+    uint64_t c;
+    uint32_t windows = 0;
+    uint32_t i;
+
+    srand(1);
+    for (i = 0; i < n; i++) {
+        input[i] = sample(1.8, i);
+    }
+    SPEC_init(RATE);
+
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+#ifdef HAVE_TSC
+    cycles = __rdtsc();
+#endif
+    for (i = 0; i < n; i++) {
+        sink += SPEC_sample(input[i]);
+    }
+#ifdef HAVE_TSC
+    cycles = __rdtsc() - cycles;
+#endif
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+
+    printf("time per sample: %.1f ns", ((t1.tv_sec - t0.tv_sec) * 1e9 + (t1.tv_nsec - t0.tv_nsec)) / n);
+#ifdef HAVE_TSC
+    printf(" (%.0f cycles)", (double)cycles / n);
+
+    // again, timing each sample to find the ones that end a window
+    SPEC_init(RATE);
+    for (i = 0; i < n; i++) {
+        c = __rdtsc();
+        if (SPEC_sample(input[i])) {
+            windowCycles += __rdtsc() - c;
+            windows++;
+        }
+    }
+    if (windows) {
+        printf(", end of a window %.0f cycles", (double)windowCycles / windows);
+    }
+#endif
+    printf("\n");
+
+    free(input);
+}
+
+int main(int argc, char **argv) {
+    uint32_t n = argc > 1 ? atoi(argv[1]) : 2000000;
+
+    accuracy();
+    speed(n);
+
+    return 0;
+}
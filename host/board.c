@@ -0,0 +1,191 @@
+/*
+ * The simulated SensorTag for running the whole firmware (main.c) on the
+ * host: the flash image, the sensors, the battery and a console on stdin.
+ *
+ *   1, 2        press button 1 or 2
+ *   d           press button 1 with button 2 held down (diagnostics from
+ *               the stats view)
+ *   m <text>    receive a message from the server
+ *   s           start or stop climbing stairs (the device in a pocket)
+ *   e [floors]  ride the elevator up (or down, negative) 3 or @floors floors
+ *   l <lux>     change the ambient light (into a pocket: l 1)
+ *   q           quit
+ *
+ * The flash image is $UPSTAIR_FLASH (kept in memory only if not set). The
+ * energy estimate (libs/energy.h) is printed at exit.
+ */
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <xdc/std.h>
+#include <xdc/runtime/System.h>
+#include <ti/sysbios/BIOS.h>
+#include <ti/sysbios/knl/Task.h>
+#include <ti/sysbios/knl/Clock.h>
+#include <ti/drivers/PIN.h>
+#include <inc/hw_types.h>
+#include <inc/hw_memmap.h>
+
+#include "Board.h"
+#include "upstair.h"
+#include "wireless/comm_lib.h"
+#include "libs/energy.h"
+#include "flashsim.h"
+#include "radiosim.h"
+#include "sensorsim.h"
+
+#define BATMON_BAT      0x28            // AON_BATMON BAT register
+#define BUTTON_MS       100             // how long a button is held down
+#define POLL_MS         5               // the sensors' interrupts are this late at most
+
+#define FLOOR_HEIGHT    3.0             // m
+#define CLIMB_SPEED     0.3             // m/s up the stairs
+#define ELEVATOR_SPEED  1.5             // m/s
+#define ELEVATOR_ACCEL  0.08            // g, when the elevator starts and stops
+#define SCALE_HEIGHT    8434.0          // m, pressure falls by e every this much
+
+static volatile uint8_t climbing = 0;
+static volatile double rideFrom = 0;    // elevator start and target altitude (m)
+static volatile double rideTo = 0;
+static double altitude = 0;             // m above where the board started
+
+/* Move up the stairs or in the elevator and set the pressure to match */
+static void move(uint64_t us, float *accel) {
+    static double groundPressure = 0;
+    static uint64_t lastUs = 0;
+    double dt = lastUs ? (us - lastUs) / 1e6 : 0;
+    double left = rideTo - altitude;
+
+    if (groundPressure == 0) {
+        groundPressure = SENSORSIM_getEnv()->pressure;
+    }
+    lastUs = us;
+
+    if (climbing) {
+        altitude += CLIMB_SPEED * dt;
+        rideTo = altitude;
+    } else if (fabs(left) > ELEVATOR_SPEED * dt) {
+        altitude += copysign(ELEVATOR_SPEED * dt, left);
+
+        // speeding up for the first second, slowing down for the last
+        if (fabs(altitude - rideFrom) < ELEVATOR_SPEED) {
+            accel[2] += copysign(ELEVATOR_ACCEL, left);
+        } else if (fabs(left) < ELEVATOR_SPEED) {
+            accel[2] -= copysign(ELEVATOR_ACCEL, left);
+        }
+    } else {
+        altitude = rideTo;
+    }
+
+    SENSORSIM_getEnv()->pressure = groundPressure * exp(-altitude / SCALE_HEIGHT);
+}
+
+/* Lying flat, or climbing with steps at ~1.8 Hz like host/mktrace */
+static void motion(uint64_t us, float *accel, float *gyro) {
+    double step = 2.0 * M_PI * 1.8 * us / 1e6;
+
+    accel[0] = accel[1] = 0;
+    accel[2] = 1.0;
+    gyro[0] = gyro[1] = gyro[2] = 0;
+
+    move(us, accel);
+
+    if (climbing) {
+        accel[0] = 0.15 * sin(step / 2);
+        accel[1] = 0.10 * sin(step + 1.0);
+        accel[2] = 1.0 + 0.35 * sin(step) + 0.10 * sin(2 * step);
+        gyro[0] = 40.0 * sin(step / 2 + 0.5);
+        gyro[1] = 25.0 * sin(step);
+        gyro[2] = 15.0 * sin(step / 2);
+    }
+}
+
+static void press(PIN_Id pin) {
+    PIN_hostSetInput(pin, 0);
+    Task_sleep(BUTTON_MS * 1000 / Clock_tickPeriod);
+    PIN_hostSetInput(pin, 1);
+}
+
+static void printTx(uint16_t dest, const uint8_t *payload, uint8_t len) {
+    System_printf("Radio: %u bytes to 0x%04X\n", len, dest);
+    System_flush();
+}
+
+/* The sensors keep time and raise interrupts also when nothing reads them */
+static Void sensorTask(UArg arg0, UArg arg1) {
+    while (1) {
+        SENSORSIM_poll();
+        Task_sleep(POLL_MS * 1000 / Clock_tickPeriod);
+    }
+}
+
+static Void consoleTask(UArg arg0, UArg arg1) {
+    char line[64];
+    char *text;
+    int floors;
+
+    while (fgets(line, sizeof(line), stdin) != NULL) {
+        line[strcspn(line, "\r\n")] = '\0';
+
+        switch (line[0]) {
+            case '1':
+                press(Board_BUTTON0);
+                break;
+            case '2':
+                press(Board_BUTTON1);
+                break;
+            case 'd':
+                PIN_hostSetInput(Board_BUTTON1, 0);
+                press(Board_BUTTON0);
+                PIN_hostSetInput(Board_BUTTON1, 1);
+                break;
+            case 'm':
+                text = line[1] == ' ' ? &line[2] : &line[1];
+                RADIOSIM_receive(IEEE80154_SERVER_ADDR, text, strlen(text) + 1, -40);
+                break;
+            case 's':
+                climbing = !climbing;
+                System_printf("Board: %s\n", climbing ? "climbing" : "still");
+                System_flush();
+                break;
+            case 'e':
+                floors = line[1] == ' ' ? atoi(&line[2]) : 3;
+                rideFrom = altitude;
+                rideTo = altitude + floors * FLOOR_HEIGHT;
+                System_printf("Board: elevator %d floors\n", floors);
+                System_flush();
+                break;
+            case 'l':
+                SENSORSIM_getEnv()->lux = atof(line[1] == ' ' ? &line[2] : &line[1]);
+                System_printf("Board: %g lux\n", SENSORSIM_getEnv()->lux);
+                System_flush();
+                break;
+            case 'q':
+                BIOS_exit(0);
+                break;
+        }
+    }
+}
+
+/* Before main(), so the firmware finds the board ready */
+static void __attribute__((constructor)) boardInit() {
+    Task_Params params;
+
+    FLASHSIM_init(getenv("UPSTAIR_FLASH"), 0);
+    BIOS_hostAtExit(FLASHSIM_save);
+    BIOS_hostAtExit(ENERGY_dump);
+
+    // 3.0 V: integer part in bits 10-8, fraction below
+    HWREG_hostSet(AON_BATMON_BASE + BATMON_BAT, 3 << 8);
+
+    RADIOSIM_setTxFxn(printTx);
+
+    SENSORSIM_init();
+    SENSORSIM_setMotionFxn(motion);
+
+    Task_Params_init(&params);
+    Task_create(consoleTask, &params, NULL);
+    Task_create(sensorTask, &params, NULL);
+}
@@ -0,0 +1,161 @@
+/*
+ * Host replacement for the external flash driver, see flashsim.h.
+ */
+#include <stdio.h>
+#include <string.h>
+
+#include <ti/drivers/SPI.h>
+
+#include "libs/spibus.h"
+#include "flashsim.h"
+
+#define T_PROGRAM   850.0       // page program, typ. (us)
+#define T_ERASE     40000.0     // 4 KB sector erase, typ. (us)
+#define T_WAKEUP    35.0        // release from deep power-down (us)
+
+static uint8_t image[EXTFLASH_SIZE];
+static const char *imagePath;
+static FLASHSIM_Stats stats;
+static int asleep = 1;
+
+/* SPI time of a command with a 24-bit address */
+static double busUs(uint32_t len) {
+    return (4 + len) * 8 * 1e6 / SPIBUS_BITRATE;
+}
+
+static int inRange(uint32_t addr, uint32_t len) {
+    if (addr + len > EXTFLASH_SIZE) {
+        stats.errors++;
+        return 0;
+    }
+    return 1;
+}
+
+static void wakeUp() {
+    if (asleep) {
+        asleep = 0;
+        stats.wakeups++;
+        stats.busyUs += T_WAKEUP;
+    }
+}
+
+void FLASHSIM_init(const char *path, int wipe) {
+    FILE *f;
+
+    memset(image, 0xFF, sizeof(image));
+    memset(&stats, 0, sizeof(stats));
+    imagePath = path;
+    asleep = 1;
+
+    if (!wipe && path != NULL && (f = fopen(path, "rb")) != NULL) {
+        if (fread(image, 1, sizeof(image), f) != sizeof(image)) {
+            memset(image, 0xFF, sizeof(image));
+        }
+        fclose(f);
+    }
+}
+
+void FLASHSIM_save() {
+    FILE *f;
+
+    if (imagePath != NULL && (f = fopen(imagePath, "wb")) != NULL) {
+        fwrite(image, 1, sizeof(image), f);
+        fclose(f);
+    }
+}
+
+FLASHSIM_Stats *FLASHSIM_getStats() {
+    return &stats;
+}
+
+
+/* EXTFLASH API */
+
+uint8_t EXTFLASH_open() {
+    asleep = 1;
+    return 1;
+}
+
+void EXTFLASH_close() {
+    asleep = 1;
+    FLASHSIM_save();
+}
+
+uint8_t EXTFLASH_read(uint32_t addr, void *buf, uint16_t len) {
+    if (!inRange(addr, len)) {
+        return 0;
+    }
+
+    wakeUp();
+    memcpy(buf, &image[addr], len);
+
+    stats.reads++;
+    stats.readBytes += len;
+    stats.busyUs += busUs(len);
+    return 1;
+}
+
+uint8_t EXTFLASH_write(uint32_t addr, const void *buf, uint16_t len) {
+    const uint8_t *p = buf;
+    uint16_t i;
+    uint16_t n;
+
+    if (!inRange(addr, len)) {
+        return 0;
+    }
+
+    wakeUp();
+
+    while (len > 0) {
+        n = EXTFLASH_PAGE_SIZE - (addr % EXTFLASH_PAGE_SIZE);
+        if (n > len) {
+            n = len;
+        }
+
+        for (i = 0; i < n; i++) {
+            if (p[i] & ~image[addr + i]) {
+                stats.errors++;
+            }
+            image[addr + i] &= p[i];
+        }
+
+        stats.programs++;
+        stats.programBytes += n;
+        stats.busyUs += busUs(n) + T_PROGRAM;
+
+        addr += n;
+        p += n;
+        len -= n;
+    }
+
+    return 1;
+}
+
+uint8_t EXTFLASH_erase(uint32_t addr) {
+    uint32_t sector = addr / EXTFLASH_SECTOR_SIZE;
+
+    if (!inRange(addr, 0) || sector >= FLASHSIM_SECTORS) {
+        return 0;
+    }
+
+    wakeUp();
+    memset(&image[sector * EXTFLASH_SECTOR_SIZE], 0xFF, EXTFLASH_SECTOR_SIZE);
+
+    stats.erases++;
+    stats.sectorErases[sector]++;
+    stats.busyUs += busUs(0) + T_ERASE;
+    return 1;
+}
+
+uint8_t EXTFLASH_isBusy() {
+    return 0;
+}
+
+uint8_t EXTFLASH_sleep() {
+    asleep = 1;
+    return 1;
+}
+
+uint32_t EXTFLASH_busyTime() {
+    return (uint32_t)(stats.programs * T_PROGRAM + stats.erases * T_ERASE);
+}
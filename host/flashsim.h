@@ -0,0 +1,41 @@
+/*
+ * Host replacement for the external flash driver (libs/extflash.c).
+ *
+ * Implements the EXTFLASH_* API on a RAM image of the chip that is loaded
+ * from and saved to a file. Behaves like NOR flash: programming can only
+ * clear bits (trying to set one is counted as an error) and erasing sets a
+ * whole sector to 0xFF. Writes are split to page programs like the driver
+ * does. Counts the operations and erases per sector, and models
+ * how long the chip is busy (SPI transfers plus typical program and erase
+ * times of the MX25R8035F).
+ */
+#ifndef FLASHSIM_H
+#define FLASHSIM_H
+
+#include <inttypes.h>
+
+#include "libs/extflash.h"
+
+#define FLASHSIM_SECTORS    (EXTFLASH_SIZE / EXTFLASH_SECTOR_SIZE)
+
+typedef struct {
+    uint32_t reads;
+    uint32_t readBytes;
+    uint32_t programs;
+    uint32_t programBytes;
+    uint32_t erases;
+    uint32_t wakeups;
+    uint32_t errors;            // programming 0 to 1, out of range, ...
+    double busyUs;              // time the chip is not in deep power-down
+    uint32_t sectorErases[FLASHSIM_SECTORS];
+} FLASHSIM_Stats;
+
+/* Load the image from @path (blank if missing or @wipe). */
+void FLASHSIM_init(const char *path, int wipe);
+
+/* Save the image to the file. Also done by EXTFLASH_close(). */
+void FLASHSIM_save();
+
+FLASHSIM_Stats *FLASHSIM_getStats();
+
+#endif /* FLASHSIM_H */
@@ -0,0 +1,283 @@
+/*
+ * Writes a synthetic IMU trace (libs/trace.c) for host/replay, until real
+ * ones have been recorded with TRACE_MODE.
+ *
+ * The trace alternates lying still (20-60 s) with climbing stairs up or down
+ * (15-60 s, steps at 1.5-2.2 Hz, a stair each), and now and then walking on
+ * level ground instead (the same steps without the climb), riding an
+ * elevator (8-30 s at 1-2.5 m/s, a push at the start and the end, standing
+ * still or shifting weight) or a short bump (the device picked up or put
+ * down, 1-2 s). It is sampled at the MPU's rate
+ * (IMU_RATE) with sensor noise at its full scales (8 g, 250 dps), and the
+ * BMP280's rate (BARO_RATE) with its noise.
+ *
+ * The segments are printed, so detections can be compared against them (and
+ * tools/train.py trains the activity classifier with them), and at the end
+ * the number of steps.
+ *
+ * With -f, the trace is appended to the activity log on a simulated flash
+ * image (flashsim.c) instead, like TRACE_LOG does on the device. The log
+ * holds about 2.5 minutes of it, older samples are overwritten.
+ *
+ * usage: mktrace [-f] [-m minutes] [-s seed] <output file>
+ */
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <inttypes.h>
+
+#include "upstair.h"
+#include "libs/trace.h"
+#include "libs/flashlog.h"
+#include "flashsim.h"
+
+#define INTERVAL    (1000 / IMU_RATE)                           // ms
+#define BARO_INTERVAL (BARO_RATE * MAIN_TASK_DELAY / 1000)       // ms
+#define STEP_HEIGHT 17.0                                        // cm, of a stair
+#define ELEVATOR_RAMP 1.5                                       // s to full speed
+#define SEA_LEVEL   101325.0                                    // Pa
+#define SCALE_HEIGHT 843400.0                                   // cm
+#define PRESSURE_NOISE 1.3                                      // Pa
+#define ACCEL_RES   (8.0 / 32768.0)
+#define GYRO_RES    (250.0 / 32768.0)
+
+#define SEG_IDLE    0
+#define SEG_STAIRS  1
+#define SEG_BUMP    2
+#define SEG_WALK    3
+#define SEG_ELEVATOR 4
+
+static const char *segNames[] = { "idle", "stairs", "bump", "walk", "elevator" };
+
+/* A segment of the trace, each a bit different */
+typedef struct {
+    int type;                           // SEG_...
+    double length;                      // s
+    int dir;                            // 1 up, -1 down
+    double stepHz;
+    double bounce;                      // g, vertical, of the steps
+    double speed;                       // cm/s, of an elevator
+    double fidget;                      // g, moving about while standing
+} Segment;
+
+static FILE *out;
+static uint32_t records;
+static uint32_t bytes;
+
+static double gauss() {
+    double u = (rand() + 1.0) / (RAND_MAX + 2.0);
+    double v = (rand() + 1.0) / (RAND_MAX + 2.0);
+    return sqrt(-2.0 * log(u)) * cos(2.0 * M_PI * v);
+}
+
+static double uniform(double low, double high) {
+    return low + (high - low) * rand() / RAND_MAX;
+}
+
+static int16_t toRaw(double v, double res) {
+    double r = round(v / res);
+    return r > 32767 ? 32767 : (r < -32768 ? -32768 : (int16_t)r);
+}
+
+static void fileSink(uint8_t type, const void *data, uint8_t len) {
+    fputc(type, out);
+    fputc(len, out);
+    fwrite(data, 1, len, out);
+    records++;
+    bytes += 2 + len;
+}
+
+/* Like logEvent() in main.c */
+static void logSink(uint8_t type, const void *data, uint8_t len) {
+    uint8_t result = FLOG_append(type, data, len);
+
+    if (!result) {
+        fprintf(stderr, "FAIL: append\n");
+        exit(1);
+    }
+    records++;
+    bytes += len;
+
+    if (result == FLOG_NEW_SECTOR) {
+        TRACE_meta();
+    }
+}
+
+/* Vertical speed (cm/s) @t seconds into @seg */
+static double climbSpeed(const Segment *seg, double t) {
+
+    if (seg->type == SEG_STAIRS) {
+        return seg->dir * seg->stepHz * STEP_HEIGHT;
+    }
+    if (seg->type == SEG_ELEVATOR) {
+        return seg->dir * seg->speed * fmin(1.0, fmin(t, seg->length - t) / ELEVATOR_RAMP);
+    }
+    return 0;
+}
+
+/* One sample of @seg, @t seconds into it */
+static void sample(const Segment *seg, double t, const float *bias, int16_t *raw) {
+    static double drift = 0;
+    double a[3] = { 0, 0, 1.0 };        // lying flat
+    double g[3] = { 0, 0, 0 };
+    double accelNoise = 0.004;
+    double gyroNoise = 0.1;
+    double step = 2.0 * M_PI * seg->stepHz * t;
+    double push = seg->speed / ELEVATOR_RAMP / 98100.0;
+    int i;
+
+    if (seg->type == SEG_STAIRS || seg->type == SEG_WALK) {
+        // in a pocket: mostly vertical bounce and some sway
+        a[0] = 0.15 * sin(step / 2);
+        a[1] = 0.10 * sin(step + 1.0);
+        a[2] = 1.0 + seg->bounce * sin(step) + 0.3 * seg->bounce * sin(2 * step);
+        g[0] = 40.0 * sin(step / 2 + 0.5);
+        g[1] = 25.0 * sin(step);
+        g[2] = 15.0 * sin(step / 2);
+        accelNoise = 0.05;
+        gyroNoise = 5.0;
+    } else if (seg->type == SEG_BUMP) {
+        a[2] = 1.0 + 0.4 * sin(M_PI * t);
+        g[0] = 60.0 * sin(M_PI * t);
+        accelNoise = 0.02;
+        gyroNoise = 2.0;
+    } else if (seg->type == SEG_ELEVATOR) {
+        // standing and shifting weight, pushed at the start and the end
+        drift = 0.995 * drift + 0.1 * seg->fidget * gauss();
+        a[2] += drift;
+        if (t < ELEVATOR_RAMP) {
+            a[2] += seg->dir * push;
+        } else if (t > seg->length - ELEVATOR_RAMP) {
+            a[2] -= seg->dir * push;
+        }
+        accelNoise = 0.008;
+        gyroNoise = 0.5 + 20 * seg->fidget;
+    }
+
+    for (i = 0; i < 3; i++) {
+        raw[i] = toRaw(a[i] + accelNoise * gauss() + bias[i], ACCEL_RES);
+        raw[i + 3] = toRaw(g[i] + gyroNoise * gauss(), GYRO_RES);
+    }
+}
+
+int main(int argc, char **argv) {
+    TraceMeta meta = { ACCEL_RES, GYRO_RES, { 0.012, -0.020, 0.031 }, INTERVAL };
+    uint32_t minutes = 30;
+    unsigned seed = 1;
+    int toLog = 0;
+    uint32_t samples;
+    uint32_t n = 0;
+    uint32_t segEnd = 0;
+    uint32_t segStart = 0;
+    uint32_t steps = 0;
+    double altitude = 0;                // cm
+    double t;
+    Segment seg = { SEG_STAIRS };
+    int16_t raw[TRACE_AXES];
+    int opt;
+
+    while ((opt = getopt(argc, argv, "fm:s:")) != -1) {
+        switch (opt) {
+            case 'f': toLog = 1; break;
+            case 'm': minutes = atoi(optarg); break;
+            case 's': seed = atoi(optarg); break;
+            default:
+                fprintf(stderr, "usage: mktrace [-f] [-m minutes] [-s seed] <output file>\n");
+                return 2;
+        }
+    }
+    if (optind >= argc) {
+        fprintf(stderr, "usage: mktrace [-f] [-m minutes] [-s seed] <output file>\n");
+        return 2;
+    }
+
+    srand(seed);
+    samples = minutes * 60 * 1000 / INTERVAL;
+
+    if (toLog) {
+        FLASHSIM_init(argv[optind], 1);
+        if (!FLOG_open()) {
+            fprintf(stderr, "FAIL: open\n");
+            return 1;
+        }
+        TRACE_start(&meta, logSink);
+    } else {
+        out = fopen(argv[optind], "wb");
+        if (out == NULL) {
+            perror(argv[optind]);
+            return 1;
+        }
+        fwrite("UPTR", 1, 4, out);
+        fputc(TRACE_VERSION, out);
+        TRACE_start(&meta, fileSink);
+    }
+
+    for (n = 0; n < samples; n++) {
+        if (n == segEnd) {
+            if (seg.type != SEG_IDLE) {
+                seg.type = SEG_IDLE;
+                segEnd = n + (20 + rand() % 40) * 1000 / INTERVAL;
+            } else {
+                switch (rand() % 8) {
+                    case 0:
+                    case 1:
+                        seg.type = SEG_BUMP;
+                        segEnd = n + (1 + rand() % 2) * 1000 / INTERVAL;
+                        break;
+                    case 2:
+                        seg.type = SEG_WALK;
+                        segEnd = n + (15 + rand() % 45) * 1000 / INTERVAL;
+                        break;
+                    case 3:
+                        seg.type = SEG_ELEVATOR;
+                        segEnd = n + (8 + rand() % 22) * 1000 / INTERVAL;
+                        break;
+                    default:
+                        seg.type = SEG_STAIRS;
+                        segEnd = n + (15 + rand() % 45) * 1000 / INTERVAL;
+                }
+            }
+            segStart = n;
+            seg.length = (segEnd - segStart) * INTERVAL / 1000.0;
+            seg.stepHz = uniform(1.5, 2.2);
+            seg.bounce = uniform(0.2, 0.45);
+            seg.speed = uniform(100, 250);
+            seg.fidget = uniform(0, 0.03);
+            // up or down at random, but not below the ground floor
+            seg.dir = (altitude < 300 || rand() % 2) ? 1 : -1;
+            printf("%8.1f s  %s\n", n * INTERVAL / 1000.0, segNames[seg.type]);
+        }
+
+        t = (n - segStart) * INTERVAL / 1000.0;
+        sample(&seg, t, meta.accelBias, raw);
+        altitude += climbSpeed(&seg, t) * INTERVAL / 1000.0;
+
+        if (n % (BARO_INTERVAL / INTERVAL) == 0) {
+            TRACE_pressure((uint32_t)((SEA_LEVEL * exp(-altitude / SCALE_HEIGHT) + PRESSURE_NOISE * gauss()) * 256),
+                n * INTERVAL);
+        }
+
+        // a step at each top of the bounce
+        if ((seg.type == SEG_STAIRS || seg.type == SEG_WALK)
+                && floor(t * seg.stepHz + 0.75) != floor((t + INTERVAL / 1000.0) * seg.stepHz + 0.75)) {
+            steps++;
+        }
+        TRACE_sample(raw, n * INTERVAL);
+    }
+
+    TRACE_stop();
+
+    if (toLog) {
+        FLOG_close();
+    } else {
+        fclose(out);
+    }
+
+    printf("%u samples in %u records, %u B (%.2f B/sample), %u steps\n", samples, records, bytes,
+        (double)bytes / samples, steps);
+
+    return 0;
+}
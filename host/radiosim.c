@@ -0,0 +1,189 @@
+/*
+ * Host replacement for the radio driver, see radiosim.h.
+ */
+#include <stddef.h>
+#include <pthread.h>
+#include <time.h>
+
+#include <xdc/std.h>
+#include <ti/sysbios/hal/Hwi.h>
+
+#include "wireless/CWC_CC2650_154Drv.h"
+#include "radiosim.h"
+
+#define FRAME_MAX       127
+#define ENTRY_BYTES     (offsetof(rfc_dataEntryGeneral_t, data) + 1 + FRAME_MAX + CC2650_RX_ENTRY_OVERHEAD_BYTES)
+#define PHY_BYTES       6           // preamble, SFD and length
+#define FCS_BYTES       2
+#define US_PER_BYTE     32.0        // 250 kbit/s
+
+volatile uint8_t *rx_read_entry;
+
+static uint8_t entries[RADIOSIM_RX_ENTRIES][ENTRY_BYTES] __attribute__((aligned(8)));
+static uint8_t *writeEntry;
+static CWC_CC2650_154_Init_struct_t config;
+static CWC_CC2650_154_Events_t event;
+static RADIOSIM_TxFxn txFxn = NULL;
+static RADIOSIM_Stats stats;
+static uint8_t seq = 0;
+static CWC_CC2650_154_State_t state = CWC_CC2650_154_STATE_UNINIT;
+static CWC_CC2650_154_State_t background = CWC_CC2650_154_STATE_IDLE;
+static CWC_CC2650_154_StateCallbackfuncPtr_t stateFxn = NULL;
+
+// one frame at a time, like on the air
+static pthread_mutex_t radioLock = PTHREAD_MUTEX_INITIALIZER;
+
+void RADIOSIM_setTxFxn(RADIOSIM_TxFxn fxn) {
+    txFxn = fxn;
+}
+
+RADIOSIM_Stats *RADIOSIM_getStats() {
+    return &stats;
+}
+
+static void setState(CWC_CC2650_154_State_t s) {
+    state = s;
+    if (stateFxn != NULL) {
+        stateFxn(s);
+    }
+}
+
+static void raise(CWC_CC2650_154_Events_t e) {
+    event = e;
+    Hwi_hostPost(INT_RFC_CPE_0);
+}
+
+uint8_t RADIOSIM_receive(uint16_t src, const void *payload, uint8_t len, int8_t rssi) {
+    rfc_dataEntryGeneral_t *entry;
+    CWC_CC2650_IEEE154_simple_header_struct_t header;
+    uint8_t *p;
+
+    if (writeEntry == NULL || len > FRAME_MAX - sizeof(header) - FCS_BYTES) {
+        return 0;
+    }
+    if (state == CWC_CC2650_154_STATE_OFF) {
+        return 0;                   // nobody listening
+    }
+
+    pthread_mutex_lock(&radioLock);
+
+    entry = (rfc_dataEntryGeneral_t *)writeEntry;
+    if (entry->status != DATA_ENTRY_PENDING) {
+        stats.rxDropped++;
+        pthread_mutex_unlock(&radioLock);
+        return 0;
+    }
+
+    header.FCS = 0x8841;            // data frame, PAN ID compression, short addresses
+    header.Seq = seq++;
+    header.DstPAN = config.myPANID;
+    header.DstAddr = config.myAddress;
+    header.SrcAddr = src;
+
+    // element length, PHY header, MAC frame, FCS, RSSI, status, source index, timestamp
+    p = writeEntry + offsetof(rfc_dataEntryGeneral_t, data);
+    *p++ = CC2650_RX_ENTRY_OVERHEAD_BYTES + sizeof(header) + len;
+    *p++ = sizeof(header) + len + FCS_BYTES;
+    memcpy(p, &header, sizeof(header));
+    p += sizeof(header);
+    memcpy(p, payload, len);
+    p += len;
+    memset(p, 0, CC2650_RX_ENTRY_FCS_BYTES);
+    p += CC2650_RX_ENTRY_FCS_BYTES;
+    *p++ = (uint8_t)rssi;
+    *p++ = 0;
+    *p++ = 0;
+    memset(p, 0, CC2650_RX_ENTRY_TIMESTAMP_BYTES);
+
+    entry->status = DATA_ENTRY_FINISHED;
+    writeEntry = entry->pNextEntry;
+
+    stats.rxFrames++;
+    stats.airUs += (PHY_BYTES + sizeof(header) + len + FCS_BYTES) * US_PER_BYTE;
+
+    pthread_mutex_unlock(&radioLock);
+
+    raise(CWC_CC2650_154_EVENT_RXD_OK);
+    return 1;
+}
+
+
+/* Driver API */
+
+uint8_t CWC_CC2650_154_Init(CWC_CC2650_154_Init_struct_t *ptr_Init_Data) {
+    rfc_dataEntryGeneral_t *entry;
+    int i;
+
+    config = *ptr_Init_Data;
+
+    // a ring of entries
+    for (i = 0; i < RADIOSIM_RX_ENTRIES; i++) {
+        entry = (rfc_dataEntryGeneral_t *)entries[i];
+        entry->pNextEntry = entries[(i + 1) % RADIOSIM_RX_ENTRIES];
+        entry->status = DATA_ENTRY_PENDING;
+        entry->length = ENTRY_BYTES - offsetof(rfc_dataEntryGeneral_t, data);
+    }
+
+    rx_read_entry = entries[0];
+    writeEntry = entries[0];
+
+    setState(CWC_CC2650_154_STATE_IDLE);
+    return 1;
+}
+
+uint8_t CWC_CC2650_154_SendDataPacket_Forced(uint16_t DestAddr, uint8_t *ptr_Payload, uint8_t u8_length) {
+    double airUs = (PHY_BYTES + sizeof(CWC_CC2650_IEEE154_simple_header_struct_t) + u8_length + FCS_BYTES) * US_PER_BYTE;
+    struct timespec t = { 0, (long)(airUs * 1000) };
+
+    pthread_mutex_lock(&radioLock);
+
+    stats.txFrames++;
+    stats.txBytes += u8_length;
+    stats.airUs += airUs;
+
+    if (txFxn != NULL) {
+        txFxn(DestAddr, ptr_Payload, u8_length);
+    }
+
+    // on the air for as long as it takes, then back to the background state
+    setState(CWC_CC2650_154_STATE_TX);
+    nanosleep(&t, NULL);
+    setState(background);
+
+    pthread_mutex_unlock(&radioLock);
+
+    raise(CWC_CC2650_154_EVENT_TXD_OK);
+    return 1;
+}
+
+uint8_t CWC_CC2650_154_ReceiveStart(void) {
+    background = CWC_CC2650_154_STATE_RX;
+    setState(background);
+    return 1;
+}
+
+uint8_t CWC_CC2650_154_PowerDown(void) {
+    pthread_mutex_lock(&radioLock);     // not while sending
+
+    background = CWC_CC2650_154_STATE_IDLE;
+    setState(CWC_CC2650_154_STATE_OFF);
+
+    pthread_mutex_unlock(&radioLock);
+    return 1;
+}
+
+void CWC_CC2650_154_SetStateCallback(CWC_CC2650_154_StateCallbackfuncPtr_t Callback) {
+    stateFxn = Callback;
+    if (stateFxn != NULL) {
+        stateFxn(state);
+    }
+}
+
+Void RFCCPE0IntHandler(UArg arg0) {
+    if (config.Event_Callback != NULL) {
+        config.Event_Callback(event);
+    }
+}
+
+Void RFCCPE1IntHandler(UArg arg0) {
+}
@@ -0,0 +1,38 @@
+/*
+ * Host replacement for the IEEE 802.15.4 radio driver
+ * (wireless/CWC_CC2650_154Drv.c), so that wireless/comm_lib.c runs as is.
+ *
+ * Received frames are written to an RX queue of data entries in the format
+ * the radio core uses, and the driver callback is called from the radio
+ * interrupt (Hwi_hostPost()). Sent frames go to a function set with
+ * RADIOSIM_setTxFxn(). Frames and their air time at 250 kbit/s are counted.
+ * The radio state (CWC_CC2650_154_SetStateCallback()) is TX for the air
+ * time of each frame sent, else RX once receiving has been started. After
+ * CWC_CC2650_154_PowerDown() it is OFF and frames are not received until
+ * the driver is initialized again.
+ */
+#ifndef RADIOSIM_H
+#define RADIOSIM_H
+
+#include <inttypes.h>
+
+#define RADIOSIM_RX_ENTRIES 4
+
+typedef void (*RADIOSIM_TxFxn)(uint16_t dest, const uint8_t *payload, uint8_t len);
+
+typedef struct {
+    uint32_t txFrames;
+    uint32_t txBytes;
+    uint32_t rxFrames;
+    uint32_t rxDropped;         // RX queue full
+    double airUs;
+} RADIOSIM_Stats;
+
+void RADIOSIM_setTxFxn(RADIOSIM_TxFxn fxn);
+
+/* A frame from @src to this device. Returns 0 if it was dropped. */
+uint8_t RADIOSIM_receive(uint16_t src, const void *payload, uint8_t len, int8_t rssi);
+
+RADIOSIM_Stats *RADIOSIM_getStats();
+
+#endif /* RADIOSIM_H */
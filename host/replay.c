@@ -0,0 +1,508 @@
+/*
+ * Replays an IMU trace (libs/trace.c) through the attitude filter
+ * (libs/attitude.c), the step detector (libs/detector.c) and the activity
+ * classifier (libs/classifier.c), the same code the firmware runs, as fast
+ * as possible. Like on the device, every sample goes to the attitude filter,
+ * the step counter (libs/steps.c) and the step band features
+ * (libs/spectrum.c), the detector gets their mean linear acceleration once
+ * per MPU read (SAMPLE_RATE), pressure samples go to libs/vertical.c and the
+ * classifier decides the activity once per window of features. Without
+ * pressure samples, the detector decides it alone.
+ *
+ * Prints every activity change with its latency: for STAIRS, from the first
+ * sample that raised shakiness after lying still, for ELEVATOR, from when
+ * the altitude started to change faster than VERT_STOP_SPEED, and for IDLE,
+ * from the last of either, and when runs of steps start and end. Detector
+ * parameters can be overridden to try out other values on the same trace.
+ *
+ * With the segments the trace was made of (what host/mktrace prints, or
+ * "<seconds> s <idle|stairs|walk|bump|elevator>" lines written by hand), the
+ * activity after every window is compared with them. Windows over the start
+ * of a segment are not counted.
+ *
+ * With -a the MPU sampling tiers (libs/tiers.c) are replayed too: while in
+ * the low tier only every TIER_LOW_READ loops' accelerometer sample is used,
+ * to see if the device is moved, and the rest waits until full rate. The
+ * time in each tier gives the MPU charge against always sampling at full
+ * rate. A full rate trace stands in for the low power samples, which are
+ * noisier and come at TIER_LOW_ODR rather than at every read.
+ *
+ * The trace is a trace file, or with -f a flash image (flashsim.c) whose
+ * activity log has a trace recorded with TRACE_LOG.
+ *
+ *   -t treshold   -s stairsLimit   -i idleLimit   -x maxShakiness
+ *   -r shakinessRise   -d shakinessDrop   -q only the summary
+ *   -p print the step band features of every window
+ *   -c print the classifier's feature vectors as CSV (for tools/train.py)
+ *   -l segments   compare the activities with them
+ *   -a replay the sampling tiers and print the MPU charge
+ *
+ * usage: replay [-f] [-q] [-p] [-c] [-a] [-l segments] [-t ..] [-s ..] [-i ..] [-x ..] [-r ..] [-d ..] <trace>
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <inttypes.h>
+
+#include "upstair.h"
+#include "libs/attitude.h"
+#include "libs/detector.h"
+#include "libs/steps.h"
+#include "libs/spectrum.h"
+#include "libs/vertical.h"
+#include "libs/classifier.h"
+#include "libs/tiers.h"
+#include "libs/trace.h"
+#include "libs/flashlog.h"
+#include "flashsim.h"
+
+static const char *actNames[] = { "IDLE", "STAIRS", "ELEVATOR" };
+
+#define MAX_SEGMENTS 4096
+
+/* Segments of the trace, what the activity should be */
+typedef struct {
+    uint32_t start;             // ms
+    Activity activity;
+} Segment;
+
+typedef struct {
+    uint8_t quiet;
+    uint8_t features;           // print them
+    uint8_t csv;                // print the feature vectors
+    uint8_t tiers;              // replay the sampling tiers
+    Activity activity;
+    uint32_t samples;
+    uint16_t interval;          // ms between samples, 0 before the meta
+    uint16_t block;             // samples per detector sample
+    uint16_t inBlock;
+    uint16_t lowBlock;          // samples per low tier read
+    uint16_t lowWindow;         // samples since scored in the low tier
+    uint32_t time;              // of the latest sample, ms
+    uint32_t onset;             // first move after lying still
+    uint32_t lastMove;
+    uint8_t still;
+    uint32_t climbStart;        // altitude started to change
+    uint32_t lastClimb;
+    uint8_t climbing;
+    uint32_t changes[3];        // by Activity
+    double latency[3];          // sum, ms
+    uint32_t maxLatency[3];
+    uint8_t walking;
+    uint32_t walkSamples;       // while walking
+    double cadenceSum;          // per sample while walking
+    uint32_t windows[2];        // features while IDLE, STAIRS
+    double band[2];             // sum, mg
+    double regularity[2];       // sum, %
+    Segment *segments;
+    uint32_t segmentCount;
+    uint32_t segment;           // the one being replayed
+    uint32_t confusion[3][3];   // windows by true and replayed Activity
+} Replay;
+
+static void usage() {
+    fprintf(stderr, "usage: replay [-f] [-q] [-p] [-c] [-a] [-l segments] [-t treshold] [-s stairsLimit]\n"
+        "              [-i idleLimit] [-x maxShakiness] [-r shakinessRise] [-d shakinessDrop] <trace>\n");
+    exit(2);
+}
+
+static double elapsedUs(const struct timespec *a, const struct timespec *b) {
+    return (b->tv_sec - a->tv_sec) * 1e6 + (b->tv_nsec - a->tv_nsec) / 1e3;
+}
+
+/* Read the segments, @return how many */
+static uint32_t readSegments(Replay *r, const char *path) {
+    static const char *names[] = { "idle", "stairs", "elevator", "walk", "bump" };
+    static const Activity activities[] = { ACT_IDLE, ACT_STAIRS, ACT_ELEVATOR, ACT_IDLE, ACT_IDLE };
+    char line[128], name[32];
+    double seconds;
+    unsigned i;
+    FILE *in;
+
+    in = fopen(path, "r");
+    if (in == NULL) {
+        perror(path);
+        exit(1);
+    }
+
+    r->segments = malloc(MAX_SEGMENTS * sizeof(Segment));
+    while (fgets(line, sizeof(line), in) && r->segmentCount < MAX_SEGMENTS) {
+        if (sscanf(line, "%lf s %31s", &seconds, name) != 2) {
+            continue;
+        }
+        for (i = 0; i < sizeof(names) / sizeof(names[0]); i++) {
+            if (strcmp(name, names[i]) == 0) {
+                r->segments[r->segmentCount].start = (uint32_t)(seconds * 1000 + 0.5);
+                r->segments[r->segmentCount].activity = activities[i];
+                r->segmentCount++;
+            }
+        }
+    }
+
+    fclose(in);
+    return r->segmentCount;
+}
+
+/* Compare the activity after the window ending at @time with the segments */
+static void score(Replay *r, uint32_t time) {
+    uint32_t windowMs = SPEC_WINDOW * SPEC_DECIMATION * r->interval;
+
+    while (r->segment + 1 < r->segmentCount && r->segments[r->segment + 1].start <= time) {
+        r->segment++;
+    }
+    if (r->segmentCount == 0 || time < r->segments[r->segment].start + windowMs) {
+        return;
+    }
+    r->confusion[r->segments[r->segment].activity][r->activity]++;
+}
+
+/* A change of the activity, with its latency */
+static void change(Replay *r, Activity activity, uint32_t time) {
+    uint32_t from;
+    uint32_t latency;
+
+    if (activity == ACT_STAIRS) {
+        from = r->onset;
+    } else if (activity == ACT_ELEVATOR) {
+        from = r->climbStart;
+    } else {
+        from = r->lastMove > r->lastClimb ? r->lastMove : r->lastClimb;
+    }
+    latency = time > from ? time - from : 0;
+
+    r->changes[activity]++;
+    r->latency[activity] += latency;
+    if (latency > r->maxLatency[activity]) {
+        r->maxLatency[activity] = latency;
+    }
+
+    if (!r->quiet) {
+        printf("%8.1f s  %-8s latency %u ms\n", time / 1000.0, actNames[activity], latency);
+    }
+
+    r->activity = activity;
+}
+
+/* A sample in the low tier: only the accelerometer, every lowBlock
+ * samples. @return 1 if it woke up to full rate. */
+static uint8_t lowTier(Replay *r, const int16_t *raw, uint32_t time) {
+    uint8_t busy;
+
+    // nothing is decided while low, the activity stays for the windows
+    if (++r->lowWindow >= SPEC_WINDOW * SPEC_DECIMATION / 2) {
+        r->lowWindow = 0;
+        score(r, time);
+    }
+
+    if (++r->inBlock < r->lowBlock) {
+        return 0;
+    }
+    r->inBlock = 0;
+
+    busy = TIER_motion(raw) || abs(VERT_state()->speed) >= VERT_START_SPEED;
+    if (TIER_update(busy, time) == TIER_LOW) {
+        return 0;
+    }
+
+    // like setTier() in the firmware
+    ATT_reset();
+    SPEC_reset();
+    if (r->still) {
+        r->onset = time;
+        r->still = 0;
+    }
+    return 1;
+}
+
+/* A new or repeated meta: the scales, and the bias if it was corrected */
+static void setMeta(Replay *r, const TraceMeta *meta) {
+    uint16_t interval = meta->interval ? meta->interval : 1;
+
+    if (interval != r->interval) {
+        r->interval = interval;
+        r->block = SAMPLE_RATE * MAIN_TASK_DELAY / 1000 / interval;
+        if (r->block == 0) {
+            r->block = 1;
+        }
+        r->inBlock = 0;
+        r->lowBlock = TIER_LOW_READ * MAIN_TASK_DELAY / 1000 / interval;
+        if (r->lowBlock == 0) {
+            r->lowBlock = 1;
+        }
+        ATT_init(1000 / interval, meta->aRes, meta->gRes, meta->accelBias);
+        STEP_init(1000 / interval);
+        SPEC_init(1000 / interval);
+        TIER_init(meta->aRes, r->time);
+    } else {
+        ATT_setBias(meta->accelBias);
+    }
+}
+
+static void feed(Replay *r, TraceReader *reader, uint8_t type, const uint8_t *data, uint8_t len) {
+    const DetParams *params = DET_params();
+    const StepState *steps = STEP_state();
+    const SpecFeatures *spec = SPEC_features();
+    const VertState *vert = VERT_state();
+    int16_t raw[TRACE_AXES];
+    int16_t features[CLS_FEATURES];
+    float accel[3];
+    Activity activity;
+    uint32_t time;
+    uint32_t pressureTime;
+    uint32_t pressure;
+    uint8_t busy;
+    uint8_t to;
+
+    if (!TRACE_readerPut(reader, type, data, len)) {
+        if (type == LOG_TRACE_META && reader->hasMeta) {
+            setMeta(r, &reader->meta);
+        }
+        return;
+    }
+
+    while (TRACE_readerNextRaw(reader, &time, raw)) {
+        while (TRACE_readerPressure(reader, time, &pressureTime, &pressure)) {
+            VERT_sample(pressure, DET_shakiness() >= params->idleLimit);
+
+            if (abs(vert->speed) > VERT_STOP_SPEED) {
+                if (!r->climbing) {
+                    r->climbStart = pressureTime;
+                }
+                r->lastClimb = pressureTime;
+            }
+            r->climbing = (abs(vert->speed) > VERT_STOP_SPEED);
+        }
+
+        r->samples++;
+        r->time = time;
+        if (r->tiers && TIER_state()->tier == TIER_LOW) {
+            lowTier(r, raw, time);
+            continue;
+        }
+
+        ATT_sample(raw);
+        STEP_sample(ATT_vertical());
+
+        if (SPEC_sample(ATT_vertical())) {
+            to = (r->activity == ACT_STAIRS);
+            r->windows[to]++;
+            r->band[to] += spec->bandAmplitude;
+            r->regularity[to] += spec->regularity;
+
+            if (r->features) {
+                printf("%8.1f s  %-8s %4u mg, band %4u mg, %u.%02u Hz, regularity %3u%%\n",
+                    time / 1000.0, actNames[r->activity], spec->amplitude, spec->bandAmplitude,
+                    spec->dominant / 100, spec->dominant % 100, spec->regularity);
+            }
+
+            CLS_gather(features);
+            if (r->csv) {
+                printf("%.1f,%d,%d,%d,%d,%d\n", time / 1000.0, features[CLS_AMPLITUDE], features[CLS_BAND],
+                    features[CLS_REGULARITY], features[CLS_CADENCE], features[CLS_CLIMB]);
+            }
+
+            // like the firmware: the classifier decides when there is pressure
+            activity = CLS_classify(features);
+            if (vert->valid && activity != r->activity
+                    && CLS_result()->confidence[activity] >= CLS_MIN_CONFIDENCE) {
+                change(r, activity, time);
+            }
+            score(r, time);
+        }
+
+        if (steps->walking) {
+            r->walkSamples++;
+            r->cadenceSum += steps->cadence;
+        }
+        if (steps->walking != r->walking) {
+            r->walking = steps->walking;
+            if (!r->quiet) {
+                printf("%8.1f s  %s, %u steps\n", time / 1000.0,
+                    r->walking ? "walking" : "stopped", steps->steps);
+            }
+        }
+
+        if (++r->inBlock < r->block) {
+            continue;
+        }
+        r->inBlock = 0;
+
+        ATT_linear(accel);
+        activity = DET_sample(accel);
+        if (vert->valid) {
+            activity = r->activity;
+        }
+
+        if (DET_moved()) {
+            if (r->still) {
+                r->onset = time;
+                r->still = 0;
+            }
+            r->lastMove = time;
+        } else if (DET_shakiness() < params->minShakiness + params->shakinessDrop) {
+            r->still = 1;             // can't drop any lower
+        }
+
+        if (activity != r->activity) {
+            change(r, activity, time);
+        }
+
+        // like the firmware, after each read
+        if (r->tiers) {
+            busy = DET_shakiness() >= params->idleLimit || r->activity != ACT_IDLE
+                || abs(vert->speed) >= VERT_START_SPEED;
+            if (TIER_update(busy, time) == TIER_LOW) {
+                r->lowWindow = 0;
+            }
+        }
+    }
+}
+
+static int replayFile(Replay *r, const char *path) {
+    TraceReader reader;
+    uint8_t data[256];
+    char magic[5];
+    int type, len;
+    FILE *in;
+
+    in = fopen(path, "rb");
+    if (in == NULL) {
+        perror(path);
+        return 0;
+    }
+
+    if (fread(magic, 1, 5, in) != 5 || memcmp(magic, "UPTR", 4) != 0 || magic[4] != TRACE_VERSION) {
+        fprintf(stderr, "%s: not a trace file (version %u)\n", path, TRACE_VERSION);
+        fclose(in);
+        return 0;
+    }
+
+    TRACE_readerInit(&reader);
+    while ((type = fgetc(in)) != EOF && (len = fgetc(in)) != EOF) {
+        if (fread(data, 1, len, in) != (size_t)len) {
+            fprintf(stderr, "%s: truncated\n", path);
+            break;
+        }
+        feed(r, &reader, type, data, len);
+    }
+
+    fclose(in);
+    return 1;
+}
+
+static int replayLog(Replay *r, const char *path) {
+    TraceReader reader;
+    FlogCursor cursor;
+    FlogRecord record;
+
+    FLASHSIM_init(path, 0);
+    if (!FLOG_open()) {
+        fprintf(stderr, "%s: no activity log\n", path);
+        return 0;
+    }
+
+    TRACE_readerInit(&reader);
+    FLOG_first(&cursor, FLOG_SECTORS);
+    while (FLOG_next(&cursor, &record)) {
+        feed(r, &reader, record.type, record.data, record.len);
+    }
+
+    FLOG_close();
+    return 1;
+}
+
+int main(int argc, char **argv) {
+    DetParams *params = DET_params();
+    const TierState *tiers;
+    double full, low, always;
+    Replay r;
+    struct timespec t0, t1;
+    int fromLog = 0;
+    uint32_t total;
+    int ok;
+    int opt;
+
+    memset(&r, 0, sizeof(r));
+    r.activity = ACT_IDLE;
+    r.still = 1;
+
+    while ((opt = getopt(argc, argv, "fqpcal:t:s:i:x:r:d:")) != -1) {
+        switch (opt) {
+            case 'f': fromLog = 1; break;
+            case 'q': r.quiet = 1; break;
+            case 'p': r.features = 1; break;
+            case 'c': r.csv = 1; r.quiet = 1; break;
+            case 'a': r.tiers = 1; break;
+            case 'l':
+                if (!readSegments(&r, optarg)) {
+                    fprintf(stderr, "%s: no segments\n", optarg);
+                    return 1;
+                }
+                break;
+            case 't': params->treshold = atof(optarg); break;
+            case 's': params->stairsLimit = atoi(optarg); break;
+            case 'i': params->idleLimit = atoi(optarg); break;
+            case 'x': params->maxShakiness = atoi(optarg); break;
+            case 'r': params->shakinessRise = atof(optarg); break;
+            case 'd': params->shakinessDrop = atof(optarg); break;
+            default: usage();
+        }
+    }
+    if (optind >= argc) {
+        usage();
+    }
+
+    DET_reset();
+    VERT_reset();
+    CLS_init(&CLS_model);
+
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    ok = fromLog ? replayLog(&r, argv[optind]) : replayFile(&r, argv[optind]);
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+
+    if (!ok) {
+        return 1;
+    }
+    if (r.csv) {
+        return 0;
+    }
+
+    printf("%u samples (%.1f min), %.2f Msamples/s\n", r.samples,
+        (double)r.samples * r.interval / 60e3, r.samples / elapsedUs(&t0, &t1));
+    for (opt = ACT_IDLE; opt <= ACT_ELEVATOR; opt++) {
+        if (opt == ACT_ELEVATOR && r.changes[opt] == 0) {
+            continue;           // nothing to say without the barometer
+        }
+        printf("  to %-8s %u, latency %.0f ms mean, %u ms max\n", actNames[opt], r.changes[opt],
+            r.changes[opt] ? r.latency[opt] / r.changes[opt] : 0, r.maxLatency[opt]);
+    }
+    printf("  steps      %u, %.1f min walking at %.0f/min mean\n", STEP_state()->steps,
+        (double)r.walkSamples * r.interval / 60e3, r.walkSamples ? r.cadenceSum / r.walkSamples : 0);
+    for (opt = 1; opt >= 0; opt--) {
+        printf("  %-10s step band %.0f mg, regularity %.0f%% mean (%u windows)\n", actNames[opt],
+            r.windows[opt] ? r.band[opt] / r.windows[opt] : 0,
+            r.windows[opt] ? r.regularity[opt] / r.windows[opt] : 0, r.windows[opt]);
+    }
+    if (r.tiers) {
+        tiers = TIER_state();
+        full = (double)tiers->time[TIER_FULL] * CUR_MPU / 3.6e6;
+        low = (double)tiers->time[TIER_LOW] * CUR_MPU_LP / 3.6e6;
+        always = (double)(tiers->time[TIER_FULL] + tiers->time[TIER_LOW]) * CUR_MPU / 3.6e6;
+        printf("  tiers      full %.1f min, low %.1f min, %u wakes\n", tiers->time[TIER_FULL] / 60e3,
+            tiers->time[TIER_LOW] / 60e3, tiers->wakes);
+        printf("  MPU        %.1f uAh, %.1f uAh at full rate only (%.0f%% saved)\n", full + low, always,
+            always > 0 ? 100.0 * (1 - (full + low) / always) : 0);
+    }
+    printf("  classifier %s\n", CLS_model.name);
+    for (opt = ACT_IDLE; r.segmentCount && opt <= ACT_ELEVATOR; opt++) {
+        total = r.confusion[opt][ACT_IDLE] + r.confusion[opt][ACT_STAIRS] + r.confusion[opt][ACT_ELEVATOR];
+        printf("  %-10s %3.0f%% right of %u windows: IDLE %u, STAIRS %u, ELEVATOR %u\n", actNames[opt],
+            total ? 100.0 * r.confusion[opt][opt] / total : 0, total,
+            r.confusion[opt][ACT_IDLE], r.confusion[opt][ACT_STAIRS], r.confusion[opt][ACT_ELEVATOR]);
+    }
+
+    return 0;
+}
@@ -0,0 +1,1167 @@
+/*
+ * Register level models of the SensorTag I2C sensors (see sensorsim.h).
+ *
+ * A model catches up with time when it is accessed: the samples and
+ * conversions that would have completed since the last transfer are done
+ * then. The I2C shim serializes the transfers, so the models need no locks.
+ */
+#include <math.h>
+#include <string.h>
+#include <time.h>
+
+#include <inttypes.h>
+
+#include <ti/drivers/I2C.h>
+#include <ti/drivers/PIN.h>
+
+#include "Board.h"
+#include "sensorsim.h"
+
+#define CLAMP(x, lo, hi)    ((x) < (lo) ? (lo) : ((x) > (hi) ? (hi) : (x)))
+
+static SENSORSIM_Env env;
+static SENSORSIM_MotionFxn motionFxn = NULL;
+static uint64_t bootUs;
+static uint64_t skipUs;
+static uint64_t seed = 0x9E3779B97F4A7C15ULL;
+
+static uint64_t monotonicUs() {
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000 + now.tv_nsec / 1000;
+}
+
+/* Repeatable noise: xorshift64* and Box-Muller */
+static double uniform() {
+    seed ^= seed >> 12;
+    seed ^= seed << 25;
+    seed ^= seed >> 27;
+    return ((seed * 0x2545F4914F6CDD1DULL) >> 11) * (1.0 / 9007199254740992.0);
+}
+
+static double gauss() {
+    double u = uniform() + 1e-12;
+
+    return sqrt(-2.0 * log(u)) * cos(2.0 * M_PI * uniform());
+}
+
+static void put16(uint8_t *dest, int32_t value) {
+    dest[0] = (value >> 8) & 0xFF;
+    dest[1] = value & 0xFF;
+}
+
+
+/* MPU9250 */
+
+#define MPU_SELF_TEST_X_GYRO    0x00
+#define MPU_SELF_TEST_X_ACCEL   0x0D
+#define MPU_XG_OFFSET_H         0x13
+#define MPU_SMPLRT_DIV          0x19
+#define MPU_CONFIG              0x1A
+#define MPU_GYRO_CONFIG         0x1B
+#define MPU_ACCEL_CONFIG        0x1C
+#define MPU_FIFO_EN             0x23
+#define MPU_INT_PIN_CFG         0x37
+#define MPU_INT_ENABLE          0x38
+#define MPU_INT_STATUS          0x3A
+#define MPU_ACCEL_XOUT_H        0x3B
+#define MPU_TEMP_OUT_H          0x41
+#define MPU_GYRO_XOUT_H         0x43
+#define MPU_MOT_DETECT_CTRL     0x69
+#define MPU_USER_CTRL           0x6A
+#define MPU_PWR_MGMT_1          0x6B
+#define MPU_PWR_MGMT_2          0x6C
+#define MPU_LP_ACCEL_ODR        0x1E
+#define MPU_WOM_THR             0x1F
+#define MPU_FIFO_COUNTH         0x72
+#define MPU_FIFO_COUNTL         0x73
+#define MPU_FIFO_R_W            0x74
+#define MPU_WHO_AM_I            0x75
+#define MPU_XA_OFFSET_H         0x77
+
+#define MPU_FIFO_SIZE           512
+#define MPU_STARTUP_US          35000   // gyro start-up time
+#define MPU_CATCH_UP            300     // samples, more would overflow the FIFO anyway
+
+typedef struct {
+    uint8_t reg[128];
+    uint8_t ptr;
+    uint8_t fifo[MPU_FIFO_SIZE];
+    uint16_t fifoHead;
+    uint16_t fifoCount;
+    uint64_t next;              // time of the next sample
+    int16_t womRef[3];          // accel of the previous sample, for wake on motion
+    uint8_t womValid;
+    uint8_t intPending;         // INT to be pulsed at the next SENSORSIM_poll()
+} Mpu;
+
+static Mpu mpu;
+
+/* Of this particular chip */
+static const float mpuBias[6] = { 0.021, -0.034, 0.047, 1.35, -0.82, 0.41 };   // g, dps
+static const uint8_t mpuSelfTestCodes[6] = { 0x6B, 0x6F, 0x78, 0x5C, 0x60, 0x55 };   // accel xyz, gyro xyz
+static const float mpuSelfTestError[6] = { 0.021, -0.013, 0.034, -0.027, 0.008, 0.016 };
+static const int16_t mpuAccelTrim[3] = { 0x0F3E, -0x0A51, 0x1C8B };
+
+static void mpuReset(uint64_t now) {
+    uint8_t i;
+
+    memset(mpu.reg, 0, sizeof(mpu.reg));
+    mpu.reg[MPU_PWR_MGMT_1] = 0x01;
+    mpu.reg[MPU_WHO_AM_I] = 0x71;
+
+    for (i = 0; i < 3; i++) {
+        mpu.reg[MPU_SELF_TEST_X_ACCEL + i] = mpuSelfTestCodes[i];
+        mpu.reg[MPU_SELF_TEST_X_GYRO + i] = mpuSelfTestCodes[i + 3];
+        put16(&mpu.reg[MPU_XA_OFFSET_H + 3 * i], mpuAccelTrim[i]);
+    }
+
+    mpu.ptr = 0;
+    mpu.fifoHead = 0;
+    mpu.fifoCount = 0;
+    mpu.next = now + MPU_STARTUP_US;
+    mpu.womValid = 0;
+    mpu.intPending = 0;
+}
+
+static uint32_t mpuPeriodUs() {
+    uint8_t dlpf = mpu.reg[MPU_CONFIG] & 0x07;
+    uint8_t odr = mpu.reg[MPU_LP_ACCEL_ODR] & 0x0F;
+
+    if (mpu.reg[MPU_PWR_MGMT_1] & 0x20) {
+        return lround(1e6 / (0.24414 * (1 << (odr > 11 ? 11 : odr))));  // low power accel cycle
+    }
+    if (mpu.reg[MPU_GYRO_CONFIG] & 0x03) {
+        return 31;                              // 32 kHz, DLPF bypassed
+    }
+    if (dlpf == 0 || dlpf == 7) {
+        return 125;                             // 8 kHz, divider not used
+    }
+    return 1000 * (1 + mpu.reg[MPU_SMPLRT_DIV]);
+}
+
+/* Self test response of axis @i (accel xyz, gyro xyz), LSB at the lowest full scale */
+static float mpuSelfTestResponse(uint8_t i) {
+    float factoryTrim = 2620.0 * pow(1.01, mpuSelfTestCodes[i] - 1.0);
+
+    return factoryTrim * (1.0 + mpuSelfTestError[i]);
+}
+
+static void mpuFifoPush(const uint8_t *data, uint8_t len) {
+    uint8_t i;
+
+    for (i = 0; i < len; i++) {
+        if (mpu.fifoCount == MPU_FIFO_SIZE) {
+            mpu.reg[MPU_INT_STATUS] |= 0x10;
+
+            // FIFO_MODE: keep the old data, else the oldest byte is replaced
+            if (mpu.reg[MPU_CONFIG] & 0x40) {
+                return;
+            }
+            mpu.fifoHead = (mpu.fifoHead + 1) % MPU_FIFO_SIZE;
+            mpu.fifoCount--;
+        }
+        mpu.fifo[(mpu.fifoHead + mpu.fifoCount) % MPU_FIFO_SIZE] = data[i];
+        mpu.fifoCount++;
+    }
+}
+
+static void mpuSample(uint64_t t) {
+    uint8_t afs = (mpu.reg[MPU_ACCEL_CONFIG] >> 3) & 0x03;
+    uint8_t gfs = (mpu.reg[MPU_GYRO_CONFIG] >> 3) & 0x03;
+    float accel[3];
+    float gyro[3];
+    double value;
+    int16_t offset;
+    uint8_t fifoEn = mpu.reg[MPU_FIFO_EN];
+    uint8_t status = 0x01;
+    int16_t current;
+    uint8_t i;
+
+    if (motionFxn) {
+        motionFxn(t, accel, gyro);
+    } else {
+        memcpy(accel, env.accel, sizeof(accel));
+        memcpy(gyro, env.gyro, sizeof(gyro));
+    }
+
+    for (i = 0; i < 3; i++) {
+
+        // accel: offset register in 0.98 mg steps above bit 0, relative to the factory trim
+        if (!(mpu.reg[MPU_PWR_MGMT_2] & (0x20 >> i))) {
+            offset = (int16_t)((mpu.reg[MPU_XA_OFFSET_H + 3 * i] << 8) | mpu.reg[MPU_XA_OFFSET_H + 3 * i + 1]);
+            value = (accel[i] + mpuBias[i] + 0.004 * gauss()) * (16384 >> afs);
+            value += ((offset >> 1) - (mpuAccelTrim[i] >> 1)) * 16.0 / (1 << afs);
+            if (mpu.reg[MPU_ACCEL_CONFIG] & (0x80 >> i)) {
+                value += mpuSelfTestResponse(i) / (1 << afs);
+            }
+            put16(&mpu.reg[MPU_ACCEL_XOUT_H + 2 * i], CLAMP(lround(value), -32768, 32767));
+        }
+
+        // gyro: offset register in 32.8 LSB/dps (1000 dps), added to the output
+        if (!(mpu.reg[MPU_PWR_MGMT_2] & (0x04 >> i))) {
+            offset = (int16_t)((mpu.reg[MPU_XG_OFFSET_H + 2 * i] << 8) | mpu.reg[MPU_XG_OFFSET_H + 2 * i + 1]);
+            value = (gyro[i] + mpuBias[i + 3] + 0.05 * gauss()) * 131.072 / (1 << gfs);
+            value += offset * 4.0 / (1 << gfs);
+            if (mpu.reg[MPU_GYRO_CONFIG] & (0x80 >> i)) {
+                value += mpuSelfTestResponse(i + 3) / (1 << gfs);
+            }
+            put16(&mpu.reg[MPU_GYRO_XOUT_H + 2 * i], CLAMP(lround(value), -32768, 32767));
+        }
+    }
+
+    value = (env.temperature - 21.0) * 333.87 + 5.0 * gauss();
+    put16(&mpu.reg[MPU_TEMP_OUT_H], CLAMP(lround(value), -32768, 32767));
+
+    // wake on motion: any axis against the previous sample, WOM_THR in 4 mg
+    if ((mpu.reg[MPU_MOT_DETECT_CTRL] & 0x80) && (mpu.reg[MPU_INT_ENABLE] & 0x40)) {
+        for (i = 0; i < 3; i++) {
+            current = (int16_t)((mpu.reg[MPU_ACCEL_XOUT_H + 2 * i] << 8) | mpu.reg[MPU_ACCEL_XOUT_H + 2 * i + 1]);
+            if (mpu.womValid && fabs(current - mpu.womRef[i]) > mpu.reg[MPU_WOM_THR] * 4e-3 * (16384 >> afs)) {
+                status |= 0x40;
+            }
+            mpu.womRef[i] = current;
+        }
+        mpu.womValid = 1;
+    }
+
+    mpu.reg[MPU_INT_STATUS] |= status;
+    if (status & mpu.reg[MPU_INT_ENABLE]) {
+        mpu.intPending = 1;
+    }
+
+    // in register order
+    if (mpu.reg[MPU_USER_CTRL] & 0x40) {
+        if (fifoEn & 0x08) {
+            mpuFifoPush(&mpu.reg[MPU_ACCEL_XOUT_H], 6);
+        }
+        if (fifoEn & 0x80) {
+            mpuFifoPush(&mpu.reg[MPU_TEMP_OUT_H], 2);
+        }
+        for (i = 0; i < 3; i++) {
+            if (fifoEn & (0x40 >> i)) {
+                mpuFifoPush(&mpu.reg[MPU_GYRO_XOUT_H + 2 * i], 2);
+            }
+        }
+    }
+}
+
+static void mpuAdvance(uint64_t now) {
+    uint32_t period;
+
+    if (mpu.reg[MPU_PWR_MGMT_1] & 0x40) {
+        return;
+    }
+
+    period = mpuPeriodUs();
+    if (mpu.next + (uint64_t)MPU_CATCH_UP * period < now) {
+        if ((mpu.reg[MPU_USER_CTRL] & 0x40) && mpu.reg[MPU_FIFO_EN]) {
+            mpu.reg[MPU_INT_STATUS] |= 0x10;
+        }
+        mpu.next = now - (uint64_t)MPU_CATCH_UP * period;
+    }
+
+    while (mpu.next <= now) {
+        mpuSample(mpu.next);
+        mpu.next += period;
+    }
+}
+
+static void mpuWrite(uint8_t reg, uint8_t value, uint64_t now) {
+    switch (reg) {
+        case MPU_PWR_MGMT_1:
+            if (value & 0x80) {
+                mpuReset(now);
+                return;
+            }
+            if ((mpu.reg[reg] & 0x40) && !(value & 0x40)) {
+                mpu.next = now + MPU_STARTUP_US;
+            }
+            if ((mpu.reg[reg] ^ value) & 0x20) {
+                mpu.next = now;                 // into or out of the cycle mode
+            }
+            break;
+
+        case MPU_INT_ENABLE:
+            mpu.womValid = 0;                   // the first sample is the reference
+            mpu.intPending = 0;                 // pulses of the old sources are over
+            break;
+
+        case MPU_USER_CTRL:
+            if (value & 0x04) {
+                mpu.fifoHead = 0;
+                mpu.fifoCount = 0;
+            }
+            value &= ~0x07;                     // reset bits clear themselves
+            break;
+
+        case MPU_WHO_AM_I:
+        case MPU_FIFO_COUNTH:
+        case MPU_FIFO_COUNTL:
+        case MPU_FIFO_R_W:
+            return;
+
+        default:
+            if (reg >= MPU_INT_STATUS && reg <= 0x60) {
+                return;                         // status and sensor data
+            }
+            break;
+    }
+
+    mpu.reg[reg] = value;
+}
+
+static uint8_t mpuRead(uint8_t reg) {
+    uint8_t value;
+
+    switch (reg) {
+        case MPU_INT_STATUS:
+            value = mpu.reg[reg];
+            mpu.reg[reg] = 0;
+            return value;
+
+        case MPU_FIFO_COUNTH:
+            return mpu.fifoCount >> 8;
+
+        case MPU_FIFO_COUNTL:
+            return mpu.fifoCount & 0xFF;
+
+        case MPU_FIFO_R_W:
+            if (mpu.fifoCount == 0) {
+                return 0xFF;
+            }
+            value = mpu.fifo[mpu.fifoHead];
+            mpu.fifoHead = (mpu.fifoHead + 1) % MPU_FIFO_SIZE;
+            mpu.fifoCount--;
+            return value;
+
+        default:
+            return mpu.reg[reg];
+    }
+}
+
+/* Register address and data, with auto increment except on the FIFO */
+static bool mpuTransfer(void *arg, const uint8_t *writeBuf, size_t writeCount, uint8_t *readBuf, size_t readCount) {
+    uint64_t now = SENSORSIM_now();
+    size_t i;
+
+    mpuAdvance(now);
+
+    if (writeCount > 0) {
+        mpu.ptr = writeBuf[0] & 0x7F;
+        for (i = 1; i < writeCount; i++) {
+            mpuWrite(mpu.ptr, writeBuf[i], now);
+            mpu.ptr = (mpu.ptr + 1) & 0x7F;
+        }
+    }
+
+    for (i = 0; i < readCount; i++) {
+        readBuf[i] = mpuRead(mpu.ptr);
+        if (mpu.ptr != MPU_FIFO_R_W) {
+            mpu.ptr = (mpu.ptr + 1) & 0x7F;
+        }
+    }
+
+    // INT_ANYRD_2CLEAR
+    if (readCount > 0 && (mpu.reg[MPU_INT_PIN_CFG] & 0x10)) {
+        mpu.reg[MPU_INT_STATUS] = 0;
+    }
+
+    return true;
+}
+
+
+/* BMP280 */
+
+#define BMP_CALIB               0x88
+#define BMP_ID                  0xD0
+#define BMP_RESET               0xE0
+#define BMP_STATUS              0xF3
+#define BMP_CTRL_MEAS           0xF4
+#define BMP_CONFIG              0xF5
+#define BMP_PRESS_MSB           0xF7
+#define BMP_TEMP_MSB            0xFA
+
+#define BMP_NVM_COPY_US         2000
+#define BMP_CATCH_UP            16      // conversions
+
+typedef struct {
+    uint8_t reg[256];
+    uint8_t ptr;
+    uint8_t scheduled;          // a conversion, now or after the standby time
+    uint64_t start;
+    uint64_t end;
+    uint64_t nvmReady;
+    uint8_t filtered;
+    double filterT;
+    double filterP;
+} Bmp;
+
+static Bmp bmp;
+
+/* The example trimming of the datasheet: T1-T3, P1-P9 */
+static const int32_t bmpTrim[12] = { 27504, 26435, -1000, 36477, -10685, 3024, 2855, 140, -7, 15500, -14600, 6000 };
+static const uint32_t bmpStandbyUs[8] = { 500, 62500, 125000, 250000, 500000, 1000000, 2000000, 4000000 };
+
+/* Compensation formulas of the datasheet: 0.01 C and Pa / 256 */
+static int32_t bmpCompensateT(int32_t adc, int32_t *tFine) {
+    int32_t var1 = ((((adc >> 3) - (bmpTrim[0] << 1))) * bmpTrim[1]) >> 11;
+    int32_t var2 = (((((adc >> 4) - bmpTrim[0]) * ((adc >> 4) - bmpTrim[0])) >> 12) * bmpTrim[2]) >> 14;
+
+    *tFine = var1 + var2;
+    return (*tFine * 5 + 128) >> 8;
+}
+
+static uint32_t bmpCompensateP(int32_t adc, int32_t tFine) {
+    int64_t var1 = (int64_t)tFine - 128000;
+    int64_t var2 = var1 * var1 * bmpTrim[8];
+    int64_t p;
+
+    var2 = var2 + ((var1 * bmpTrim[7]) << 17);
+    var2 = var2 + ((int64_t)bmpTrim[6] << 35);
+    var1 = ((var1 * var1 * bmpTrim[5]) >> 8) + ((var1 * bmpTrim[4]) << 12);
+    var1 = ((((int64_t)1) << 47) + var1) * bmpTrim[3] >> 33;
+    if (var1 == 0) {
+        return 0;
+    }
+    p = 1048576 - adc;
+    p = (((p << 31) - var2) * 3125) / var1;
+    var1 = ((int64_t)bmpTrim[11] * (p >> 13) * (p >> 13)) >> 25;
+    var2 = ((int64_t)bmpTrim[10] * p) >> 19;
+
+    return (uint32_t)(((p + var1 + var2) >> 8) + ((int64_t)bmpTrim[9] << 4));
+}
+
+/* Raw values that compensate to @temp (C) and @pres (Pa), by bisection */
+static int32_t bmpRawT(double temp, int32_t *tFine) {
+    int32_t target = lround(temp * 100);
+    int32_t lo = 0;
+    int32_t hi = (1 << 20) - 1;
+    int32_t mid;
+
+    while (lo < hi) {
+        mid = (lo + hi) / 2;
+        if (bmpCompensateT(mid, tFine) < target) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    bmpCompensateT(lo, tFine);
+    return lo;
+}
+
+static int32_t bmpRawP(double pres, int32_t tFine) {
+    uint32_t target = lround(pres * 256);
+    int32_t lo = 0;
+    int32_t hi = (1 << 20) - 1;
+    int32_t mid;
+
+    // pressure falls as the raw value rises
+    while (lo < hi) {
+        mid = (lo + hi) / 2;
+        if (bmpCompensateP(mid, tFine) > target) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+static uint8_t bmpOversampling(uint8_t osrs) {
+    return osrs == 0 ? 0 : (osrs >= 5 ? 16 : 1 << (osrs - 1));
+}
+
+/* Typical measurement time */
+static uint32_t bmpMeasureUs() {
+    uint8_t osT = bmpOversampling(bmp.reg[BMP_CTRL_MEAS] >> 5);
+    uint8_t osP = bmpOversampling((bmp.reg[BMP_CTRL_MEAS] >> 2) & 0x07);
+
+    return 1000 + 2000 * osT + (osP ? 2000 * osP + 500 : 0);
+}
+
+static void bmpReset(uint64_t now) {
+    uint8_t i;
+
+    memset(bmp.reg, 0, sizeof(bmp.reg));
+    bmp.reg[BMP_ID] = 0x58;
+    for (i = 0; i < 12; i++) {
+        bmp.reg[BMP_CALIB + 2 * i] = bmpTrim[i] & 0xFF;
+        bmp.reg[BMP_CALIB + 2 * i + 1] = (bmpTrim[i] >> 8) & 0xFF;
+    }
+    bmp.reg[BMP_PRESS_MSB] = 0x80;
+    bmp.reg[BMP_TEMP_MSB] = 0x80;
+
+    bmp.ptr = 0;
+    bmp.scheduled = 0;
+    bmp.filtered = 0;
+    bmp.nvmReady = now + BMP_NVM_COPY_US;
+}
+
+/* 20 bit result with the resolution of the oversampling, 0x80000 if skipped */
+static void bmpPutResult(uint8_t *dest, double raw, uint8_t osrs, uint8_t filter) {
+    int32_t value = lround(raw);
+
+    if (osrs == 0) {
+        value = 0x80000;
+    } else if (!filter && osrs < 5) {
+        value &= ~((1 << (5 - osrs)) - 1);
+    }
+
+    dest[0] = (value >> 12) & 0xFF;
+    dest[1] = (value >> 4) & 0xFF;
+    dest[2] = (value << 4) & 0xF0;
+}
+
+static void bmpConvert() {
+    uint8_t osrsT = bmp.reg[BMP_CTRL_MEAS] >> 5;
+    uint8_t osrsP = (bmp.reg[BMP_CTRL_MEAS] >> 2) & 0x07;
+    uint8_t filter = (bmp.reg[BMP_CONFIG] >> 2) & 0x07;
+    double coef = filter == 0 ? 1 : 1 << (filter < 4 ? filter : 4);
+    double temp;
+    double rawT;
+    double rawP;
+    int32_t tFine;
+
+    temp = env.temperature + 0.005 * gauss() / sqrt(bmpOversampling(osrsT) | 1);
+    rawT = bmpRawT(temp, &tFine);
+    rawP = bmpRawP(env.pressure * 100 + 1.3 * gauss() / sqrt(bmpOversampling(osrsP) | 1), tFine);
+
+    if (!bmp.filtered || filter == 0) {
+        bmp.filterT = rawT;
+        bmp.filterP = rawP;
+        bmp.filtered = 1;
+    } else {
+        bmp.filterT += (rawT - bmp.filterT) / coef;
+        bmp.filterP += (rawP - bmp.filterP) / coef;
+    }
+
+    bmpPutResult(&bmp.reg[BMP_PRESS_MSB], bmp.filterP, osrsP, filter);
+    bmpPutResult(&bmp.reg[BMP_TEMP_MSB], bmp.filterT, osrsT, filter);
+}
+
+static void bmpAdvance(uint64_t now) {
+    uint64_t period;
+
+    if (bmp.scheduled && (bmp.reg[BMP_CTRL_MEAS] & 0x03) == 0x03) {
+        period = bmpMeasureUs() + bmpStandbyUs[bmp.reg[BMP_CONFIG] >> 5];
+        if (bmp.end + BMP_CATCH_UP * period < now) {
+            bmp.end += (now - bmp.end) / period * period - BMP_CATCH_UP * period;
+        }
+    }
+
+    while (bmp.scheduled && bmp.end <= now) {
+        bmpConvert();
+
+        if ((bmp.reg[BMP_CTRL_MEAS] & 0x03) == 0x03) {
+            bmp.start = bmp.end + bmpStandbyUs[bmp.reg[BMP_CONFIG] >> 5];
+            bmp.end = bmp.start + bmpMeasureUs();
+        } else {
+            // forced mode: back to sleep
+            bmp.reg[BMP_CTRL_MEAS] &= ~0x03;
+            bmp.scheduled = 0;
+        }
+    }
+
+    bmp.reg[BMP_STATUS] = (bmp.scheduled && bmp.start <= now ? 0x08 : 0) | (now < bmp.nvmReady ? 0x01 : 0);
+}
+
+static void bmpWrite(uint8_t reg, uint8_t value, uint64_t now) {
+    uint8_t normal;
+
+    switch (reg) {
+        case BMP_RESET:
+            if (value == 0xB6) {
+                bmpReset(now);
+            }
+            break;
+
+        case BMP_CTRL_MEAS:
+            normal = bmp.scheduled && (bmp.reg[reg] & 0x03) == 0x03;
+            bmp.reg[reg] = value;
+
+            // forced mode starts a conversion, normal mode the periodic ones
+            if ((value & 0x03) == 0) {
+                bmp.scheduled = 0;
+            } else if ((value & 0x03) != 0x03 || !normal) {
+                bmp.start = now;
+                bmp.end = now + bmpMeasureUs();
+                bmp.scheduled = 1;
+            }
+            break;
+
+        case BMP_CONFIG:
+            bmp.reg[reg] = value;
+            break;
+    }
+}
+
+/* Writes are register and data pairs, reads auto increment */
+static bool bmpTransfer(void *arg, const uint8_t *writeBuf, size_t writeCount, uint8_t *readBuf, size_t readCount) {
+    uint64_t now = SENSORSIM_now();
+    size_t i;
+
+    bmpAdvance(now);
+
+    if (writeCount == 1) {
+        bmp.ptr = writeBuf[0];
+    }
+    for (i = 0; i + 1 < writeCount; i += 2) {
+        bmpWrite(writeBuf[i], writeBuf[i + 1], now);
+    }
+    if (writeCount > 1) {
+        bmpAdvance(now);
+    }
+
+    for (i = 0; i < readCount; i++) {
+        readBuf[i] = bmp.reg[bmp.ptr++];
+    }
+
+    return true;
+}
+
+
+/* OPT3001 */
+
+#define OPT_RESULT              0x00
+#define OPT_CONFIG              0x01
+#define OPT_LOW_LIMIT           0x02
+#define OPT_HIGH_LIMIT          0x03
+
+#define OPT_OVF                 0x0100
+#define OPT_CRF                 0x0080
+#define OPT_FH                  0x0040
+#define OPT_FL                  0x0020
+#define OPT_L                   0x0010
+
+#define OPT_CATCH_UP            8       // conversions
+
+typedef struct {
+    uint16_t reg[4];
+    uint8_t ptr;
+    uint8_t converting;
+    uint64_t end;
+    uint8_t highCount;          // consecutive results past the limits
+    uint8_t lowCount;
+} Opt;
+
+static Opt opt;
+
+static void optReset() {
+    memset(&opt, 0, sizeof(opt));
+    opt.reg[OPT_CONFIG] = 0xC810;
+    opt.reg[OPT_HIGH_LIMIT] = 0xBFFF;
+}
+
+static uint32_t optConversionUs() {
+    return (opt.reg[OPT_CONFIG] & 0x0800) ? 800000 : 100000;
+}
+
+static double optLux(uint16_t value) {
+    return 0.01 * (1 << (value >> 12)) * (value & 0x0FFF);
+}
+
+/* The limit flags after a result, for the configured fault count */
+static void optCompare(double lux) {
+    uint8_t faults = 1 << (opt.reg[OPT_CONFIG] & 0x03);
+    uint16_t *config = &opt.reg[OPT_CONFIG];
+
+    opt.highCount = lux > optLux(opt.reg[OPT_HIGH_LIMIT]) ? opt.highCount + 1 : 0;
+    opt.lowCount = lux < optLux(opt.reg[OPT_LOW_LIMIT]) ? opt.lowCount + 1 : 0;
+
+    if (*config & OPT_L) {
+        // latched window: set until the configuration is read
+        if (opt.highCount >= faults) {
+            *config |= OPT_FH;
+        }
+        if (opt.lowCount >= faults) {
+            *config |= OPT_FL;
+        }
+    } else {
+        // transparent hysteresis: high above the high limit, low below the low one
+        if (opt.highCount >= faults) {
+            *config = (*config | OPT_FH) & ~OPT_FL;
+        }
+        if (opt.lowCount >= faults) {
+            *config = (*config | OPT_FL) & ~OPT_FH;
+        }
+    }
+}
+
+static void optConvert() {
+    uint16_t *config = &opt.reg[OPT_CONFIG];
+    uint8_t range = *config >> 12;
+    double lux = env.lux * (1.0 + 0.005 * gauss());
+    uint8_t exponent;
+    int32_t mantissa;
+
+    if (lux < 0) {
+        lux = 0;
+    }
+
+    // automatic range: the finest that fits 12 bits
+    exponent = range;
+    if (range >= 0x0C) {
+        for (exponent = 0; exponent < 11 && lux / (0.01 * (1 << exponent)) > 4095; exponent++);
+    }
+
+    mantissa = lround(lux / (0.01 * (1 << exponent)));
+    *config &= ~OPT_OVF;
+    if (mantissa > 4095) {
+        mantissa = 4095;
+        *config |= OPT_OVF;
+    }
+
+    opt.reg[OPT_RESULT] = (exponent << 12) | mantissa;
+    *config |= OPT_CRF;
+    optCompare(optLux(opt.reg[OPT_RESULT]));
+}
+
+static void optAdvance(uint64_t now) {
+    uint64_t period = optConversionUs();
+
+    if (opt.converting && opt.end + OPT_CATCH_UP * period < now) {
+        opt.end += (now - opt.end) / period * period - OPT_CATCH_UP * period;
+    }
+
+    while (opt.converting && opt.end <= now) {
+        optConvert();
+
+        if (opt.reg[OPT_CONFIG] & 0x0400) {
+            opt.end += period;
+        } else {
+            // single shot: back to shutdown
+            opt.reg[OPT_CONFIG] &= ~0x0600;
+            opt.converting = 0;
+        }
+    }
+}
+
+static void optWrite(uint8_t reg, uint16_t value, uint64_t now) {
+    uint16_t *config = &opt.reg[OPT_CONFIG];
+
+    switch (reg) {
+        case OPT_CONFIG:
+            // overflow, ready and the flags are read only, writing clears ready
+            *config = (value & ~0x01E0) | (*config & (OPT_OVF | OPT_FH | OPT_FL));
+            if ((value & 0x0600) == 0) {
+                opt.converting = 0;
+            } else if (!opt.converting) {
+                opt.converting = 1;
+                opt.end = now + optConversionUs();
+            }
+            break;
+
+        case OPT_LOW_LIMIT:
+        case OPT_HIGH_LIMIT:
+            opt.reg[reg] = value;
+            break;
+    }
+}
+
+static uint16_t optRead(uint8_t reg) {
+    uint16_t value;
+
+    switch (reg) {
+        case OPT_CONFIG:
+            value = opt.reg[reg];
+            opt.reg[reg] &= ~OPT_CRF;
+            if (value & OPT_L) {
+                opt.reg[reg] &= ~(OPT_FH | OPT_FL);
+            }
+            return value;
+
+        case OPT_RESULT:
+        case OPT_LOW_LIMIT:
+        case OPT_HIGH_LIMIT:
+            return opt.reg[reg];
+
+        case 0x7E:
+            return 0x5449;                      // "TI"
+
+        case 0x7F:
+            return 0x3001;
+
+        default:
+            return 0;
+    }
+}
+
+/* 16 bit registers: pointer and data MSB first, reads repeat the register */
+static bool optTransfer(void *arg, const uint8_t *writeBuf, size_t writeCount, uint8_t *readBuf, size_t readCount) {
+    uint64_t now = SENSORSIM_now();
+    uint16_t value = 0;
+    size_t i;
+
+    optAdvance(now);
+
+    if (writeCount > 0) {
+        opt.ptr = writeBuf[0];
+        if (writeCount >= 3) {
+            optWrite(opt.ptr, (writeBuf[1] << 8) | writeBuf[2], now);
+        }
+    }
+
+    for (i = 0; i < readCount; i++) {
+        if (i % 2 == 0) {
+            value = optRead(opt.ptr);
+        }
+        readBuf[i] = i % 2 == 0 ? value >> 8 : value & 0xFF;
+    }
+
+    return true;
+}
+
+
+/* HDC1000 */
+
+#define HDC_TEMP                0x00
+#define HDC_HUM                 0x01
+#define HDC_CONFIG              0x02
+
+#define HDC_RST                 0x8000
+#define HDC_MODE                0x1000  // temperature and humidity in sequence
+#define HDC_TRES                0x0400
+
+typedef struct {
+    uint16_t config;
+    uint16_t temp;
+    uint16_t hum;
+    uint8_t ptr;
+    uint8_t converting;
+    uint8_t measured;           // HDC_TEMP or HDC_HUM, or both with HDC_MODE
+    uint64_t end;
+} Hdc;
+
+static Hdc hdc;
+
+static void hdcReset() {
+    memset(&hdc, 0, sizeof(hdc));
+    hdc.config = HDC_MODE;
+}
+
+static uint32_t hdcTempUs() {
+    return (hdc.config & HDC_TRES) ? 3650 : 6350;
+}
+
+static uint32_t hdcHumUs() {
+    switch ((hdc.config >> 8) & 0x03) {
+        case 0: return 6500;
+        case 1: return 3850;
+        default: return 2500;
+    }
+}
+
+static uint16_t hdcHumMask() {
+    switch ((hdc.config >> 8) & 0x03) {
+        case 0: return 0xFFFC;
+        case 1: return 0xFFE0;
+        default: return 0xFF00;
+    }
+}
+
+static void hdcStart(uint8_t ptr, uint64_t now) {
+    if (hdc.config & HDC_MODE) {
+        if (ptr != HDC_TEMP) {
+            return;
+        }
+        hdc.end = now + hdcTempUs() + hdcHumUs();
+    } else {
+        hdc.end = now + (ptr == HDC_TEMP ? hdcTempUs() : hdcHumUs());
+    }
+    hdc.measured = ptr;
+    hdc.converting = 1;
+}
+
+static void hdcAdvance(uint64_t now) {
+    double temp;
+    double hum;
+
+    if (!hdc.converting || hdc.end > now) {
+        return;
+    }
+    hdc.converting = 0;
+
+    if ((hdc.config & HDC_MODE) || hdc.measured == HDC_TEMP) {
+        temp = CLAMP(env.temperature + 0.05 * gauss(), -40.0, 125.0);
+        hdc.temp = (uint16_t)CLAMP(lround((temp + 40.0) / 165.0 * 65536), 0, 65535);
+        hdc.temp &= (hdc.config & HDC_TRES) ? 0xFFE0 : 0xFFFC;
+    }
+    if ((hdc.config & HDC_MODE) || hdc.measured == HDC_HUM) {
+        hum = CLAMP(env.humidity + 0.3 * gauss(), 0.0, 100.0);
+        hdc.hum = (uint16_t)CLAMP(lround(hum / 100.0 * 65536), 0, 65535) & hdcHumMask();
+    }
+}
+
+static uint16_t hdcRead(uint8_t reg) {
+    switch (reg) {
+        case HDC_TEMP: return hdc.temp;
+        case HDC_HUM: return hdc.hum;
+        case HDC_CONFIG: return hdc.config;
+        case 0xFB: return 0x0217;               // serial number
+        case 0xFC: return 0x9C40;
+        case 0xFD: return 0x3E80;
+        case 0xFE: return 0x5449;
+        case 0xFF: return 0x1000;
+        default: return 0;
+    }
+}
+
+/*
+ * Writing the temperature or humidity pointer alone starts a conversion,
+ * which is read without a pointer write after it is done.
+ */
+static bool hdcTransfer(void *arg, const uint8_t *writeBuf, size_t writeCount, uint8_t *readBuf, size_t readCount) {
+    uint64_t now = SENSORSIM_now();
+    uint16_t value;
+    uint8_t reg;
+    size_t i;
+
+    hdcAdvance(now);
+
+    if (writeCount > 0) {
+        hdc.ptr = writeBuf[0];
+        if (hdc.ptr == HDC_CONFIG && writeCount >= 3) {
+            value = (writeBuf[1] << 8) | writeBuf[2];
+            if (value & HDC_RST) {
+                hdcReset();
+            } else {
+                hdc.config = value & 0x3700;
+            }
+        } else if (hdc.ptr <= HDC_HUM && writeCount == 1) {
+            hdcStart(hdc.ptr, now);
+        }
+    }
+
+    if (readCount > 0 && hdc.converting) {
+        return false;
+    }
+
+    // in sequence mode the humidity follows the temperature
+    for (i = 0; i < readCount; i++) {
+        reg = hdc.ptr;
+        if (i >= 2 && hdc.ptr == HDC_TEMP && (hdc.config & HDC_MODE)) {
+            reg = HDC_HUM;
+        }
+        value = hdcRead(reg);
+        readBuf[i] = i % 2 == 0 ? value >> 8 : value & 0xFF;
+    }
+
+    return true;
+}
+
+
+/* TMP007 */
+
+#define TMP_VOBJ                0x00
+#define TMP_TDIE                0x01
+#define TMP_CONFIG              0x02
+#define TMP_TOBJ                0x03
+#define TMP_STATUS              0x04
+#define TMP_MASK                0x05
+#define TMP_TOBJ_HIGH           0x06
+#define TMP_TOBJ_LOW            0x07
+#define TMP_TDIE_HIGH           0x08
+#define TMP_TDIE_LOW            0x09
+#define TMP_COEF_LAST           0x11
+
+#define TMP_RST                 0x8000
+#define TMP_MOD                 0x1000
+#define TMP_CRTF                0x4000
+
+#define TMP_CATCH_UP            4       // conversions
+
+typedef struct {
+    uint16_t reg[0x20];
+    uint8_t ptr;
+    uint64_t next;              // end of the conversion in progress
+} Tmp;
+
+static Tmp tmp;
+
+/* Conversion period by CR: 1-16 averages back to back, then 1 s and 4 s periods */
+static const uint32_t tmpPeriodUs[8] = { 260000, 510000, 1010000, 2010000, 4010000, 1000000, 4000000, 4000000 };
+
+static void tmpReset(uint64_t now) {
+    memset(&tmp, 0, sizeof(tmp));
+    tmp.reg[TMP_CONFIG] = 0x1440;
+    tmp.reg[TMP_MASK] = 0xC000;
+    tmp.reg[TMP_TOBJ_HIGH] = 0x7FC0;
+    tmp.reg[TMP_TOBJ_LOW] = 0x8000;
+    tmp.reg[TMP_TDIE_HIGH] = 0x7FC0;
+    tmp.reg[TMP_TDIE_LOW] = 0x8000;
+    tmp.reg[0x0A] = 0x260E;                     // S0
+    tmp.reg[0x1E] = 0x5449;
+    tmp.reg[0x1F] = 0x0078;
+    tmp.next = now + tmpPeriodUs[(tmp.reg[TMP_CONFIG] >> 9) & 0x07];
+}
+
+/* 0.03125 C in bits 15:2 */
+static uint16_t tmpTemperature(double temp) {
+    return (uint16_t)(CLAMP(lround(temp / 0.03125), -8192, 8191) << 2);
+}
+
+static void tmpConvert() {
+    uint16_t *status = &tmp.reg[TMP_STATUS];
+    uint16_t flags;
+    double die = env.temperature + 0.03 * gauss();
+    double obj = env.objectTemp + 0.1 * gauss();
+    double kDie = die + 273.15;
+    double kObj = obj + 273.15;
+
+    // thermopile voltage, 156.25 nV per LSB
+    tmp.reg[TMP_VOBJ] = CLAMP(lround(6.4e-14 * (pow(kObj, 4) - pow(kDie, 4)) / 156.25e-9), -32768, 32767);
+    tmp.reg[TMP_TDIE] = tmpTemperature(die);
+    tmp.reg[TMP_TOBJ] = tmpTemperature(obj);
+
+    flags = TMP_CRTF;
+    if ((int16_t)tmp.reg[TMP_TOBJ] > (int16_t)tmp.reg[TMP_TOBJ_HIGH]) {
+        flags |= 0x2000;
+    }
+    if ((int16_t)tmp.reg[TMP_TOBJ] < (int16_t)tmp.reg[TMP_TOBJ_LOW]) {
+        flags |= 0x1000;
+    }
+    if ((int16_t)tmp.reg[TMP_TDIE] > (int16_t)tmp.reg[TMP_TDIE_HIGH]) {
+        flags |= 0x0800;
+    }
+    if ((int16_t)tmp.reg[TMP_TDIE] < (int16_t)tmp.reg[TMP_TDIE_LOW]) {
+        flags |= 0x0400;
+    }
+    *status |= flags;
+
+    // alert when enabled flags are set
+    if (*status & tmp.reg[TMP_MASK] & 0x7C00) {
+        *status |= 0x8000;
+    }
+}
+
+static void tmpAdvance(uint64_t now) {
+    uint64_t period = tmpPeriodUs[(tmp.reg[TMP_CONFIG] >> 9) & 0x07];
+
+    if (!(tmp.reg[TMP_CONFIG] & TMP_MOD)) {
+        return;
+    }
+
+    if (tmp.next + TMP_CATCH_UP * period < now) {
+        tmp.next += (now - tmp.next) / period * period - TMP_CATCH_UP * period;
+    }
+
+    while (tmp.next <= now) {
+        tmpConvert();
+        tmp.next += period;
+    }
+}
+
+static void tmpWrite(uint8_t reg, uint16_t value, uint64_t now) {
+    if (reg == TMP_CONFIG) {
+        if (value & TMP_RST) {
+            tmpReset(now);
+            return;
+        }
+        if (!(tmp.reg[reg] & TMP_MOD) && (value & TMP_MOD)) {
+            tmp.next = now + tmpPeriodUs[(value >> 9) & 0x07];
+        }
+        tmp.reg[reg] = value;
+    } else if (reg == TMP_MASK || (reg >= TMP_TOBJ_HIGH && reg <= TMP_COEF_LAST)) {
+        tmp.reg[reg] = value;
+    }
+}
+
+static uint16_t tmpRead(uint8_t reg) {
+    uint16_t value;
+
+    if (reg >= 0x20) {
+        return 0;
+    }
+
+    value = tmp.reg[reg];
+    if (reg == TMP_STATUS) {
+        tmp.reg[reg] = 0;
+    }
+    return value;
+}
+
+/* 16 bit registers like the OPT3001 */
+static bool tmpTransfer(void *arg, const uint8_t *writeBuf, size_t writeCount, uint8_t *readBuf, size_t readCount) {
+    uint64_t now = SENSORSIM_now();
+    uint16_t value = 0;
+    size_t i;
+
+    tmpAdvance(now);
+
+    if (writeCount > 0) {
+        tmp.ptr = writeBuf[0];
+        if (writeCount >= 3) {
+            tmpWrite(tmp.ptr, (writeBuf[1] << 8) | writeBuf[2], now);
+        }
+    }
+
+    for (i = 0; i < readCount; i++) {
+        if (i % 2 == 0) {
+            value = tmpRead(tmp.ptr);
+        }
+        readBuf[i] = i % 2 == 0 ? value >> 8 : value & 0xFF;
+    }
+
+    return true;
+}
+
+
+/* Environment and time */
+
+void SENSORSIM_init() {
+    SENSORSIM_Env still = {
+        { 0, 0, 1.0 }, { 0, 0, 0 },             // lying flat
+        21.0, 1013.25, 40.0, 300.0, 21.0
+    };
+
+    env = still;
+    bootUs = monotonicUs();
+    skipUs = 0;
+
+    mpuReset(0);
+    bmpReset(0);
+    optReset();
+    hdcReset();
+    tmpReset(0);
+
+    I2C_hostAttach(Board_MPU9250_ADDR, mpuTransfer, NULL);
+    I2C_hostAttach(Board_BMP280_ADDR, bmpTransfer, NULL);
+    I2C_hostAttach(Board_OPT3001_ADDR, optTransfer, NULL);
+    I2C_hostAttach(Board_HDC1000_ADDR, hdcTransfer, NULL);
+    I2C_hostAttach(Board_TMP007_ADDR, tmpTransfer, NULL);
+}
+
+SENSORSIM_Env *SENSORSIM_getEnv() {
+    return &env;
+}
+
+void SENSORSIM_setMotionFxn(SENSORSIM_MotionFxn fxn) {
+    motionFxn = fxn;
+}
+
+uint64_t SENSORSIM_now() {
+    return monotonicUs() - bootUs + skipUs;
+}
+
+void SENSORSIM_poll() {
+    uint8_t pending;
+
+    I2C_hostLock();
+    mpuAdvance(SENSORSIM_now());
+    pending = mpu.intPending;
+    mpu.intPending = 0;
+    I2C_hostUnlock();
+
+    // a 50 us pulse, as configured by the driver
+    if (pending) {
+        PIN_hostSetInput(Board_MPU_INT, 1);
+        PIN_hostSetInput(Board_MPU_INT, 0);
+    }
+}
+
+void SENSORSIM_advance(uint64_t us) {
+    skipUs += us;
+}
@@ -0,0 +1,67 @@
+/*
+ * Register level models of the sensors on the SensorTag I2C bus, so that the
+ * drivers in sensors/ run as is on the host:
+ *
+ *   MPU9250 (0x68)  output registers updated at the sample rate of CONFIG
+ *                   and SMPLRT_DIV, the 512 byte FIFO, data ready and FIFO
+ *                   overflow status, gyro and accel offset registers, self
+ *                   test with factory codes, sleep and gyro start-up time,
+ *                   the low power accelerometer cycle at LP_ACCEL_ODR,
+ *                   axes in standby (PWR_MGMT_2) and wake on motion, with
+ *                   the interrupts pulsing Board_MPU_INT (SENSORSIM_poll())
+ *   BMP280  (0x77)  trimming parameters, forced and normal mode with the
+ *                   conversion time of the oversampling, standby time, IIR
+ *                   filter and the measuring and NVM copy status bits
+ *   OPT3001 (0x45)  100 or 800 ms conversions, single shot and continuous,
+ *                   automatic or fixed range, conversion ready, overflow
+ *                   and the limit flags (latched window or hysteresis)
+ *   HDC1000 (0x43)  triggered temperature and/or humidity conversions at
+ *                   the configured resolution; reading before the conversion
+ *                   is done is not acknowledged, like on the chip
+ *   TMP007  (0x44)  conversions at the configured rate, conversion ready and
+ *                   limit flags in the status register
+ *
+ * What the sensors measure comes from SENSORSIM_getEnv() (the motion from a
+ * SENSORSIM_MotionFxn if one is set), with noise. Time is the host's
+ * monotonic clock, so the sleeps in the drivers wait for conversions like on
+ * the device; SENSORSIM_advance() skips time without waiting.
+ *
+ * The magnetometer (behind the MPU9250) is not modelled, nothing uses it.
+ * Transfers, bytes and bus time per sensor are counted by the I2C shim, see
+ * I2C_hostDeviceStats().
+ */
+#ifndef SENSORSIM_H
+#define SENSORSIM_H
+
+#include <inttypes.h>
+
+typedef struct {
+    float accel[3];             // g, in the sensor frame
+    float gyro[3];              // dps
+    float temperature;          // C
+    float pressure;             // hPa
+    float humidity;             // %RH
+    float lux;
+    float objectTemp;           // C, what the TMP007 looks at
+} SENSORSIM_Env;
+
+/* Motion at @us, for each MPU9250 sample (instead of the environment) */
+typedef void (*SENSORSIM_MotionFxn)(uint64_t us, float *accel, float *gyro);
+
+/* Power on the sensors and attach them to the bus. Lying still in a room. */
+void SENSORSIM_init();
+
+SENSORSIM_Env *SENSORSIM_getEnv();
+void SENSORSIM_setMotionFxn(SENSORSIM_MotionFxn fxn);
+
+/* Time of the sensors, us since SENSORSIM_init() */
+uint64_t SENSORSIM_now();
+
+/* Catch the MPU9250 up with time and pulse its INT pin for the interrupts
+ * it raised, also when nothing reads it. Call it every few ms. */
+void SENSORSIM_poll();
+
+/* Skip @us forward without waiting */
+void SENSORSIM_advance(uint64_t us);
+
+#endif /* SENSORSIM_H */
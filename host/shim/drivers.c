@@ -0,0 +1,344 @@
+/*
+ * Host shim: PIN, SPI, I2C and Power drivers, registers and the board.
+ */
+#include <stdio.h>
+#include <pthread.h>
+
+#include <xdc/std.h>
+#include <ti/sysbios/BIOS.h>
+#include <ti/drivers/PIN.h>
+#include <ti/drivers/pin/PINCC26XX.h>
+#include <ti/drivers/SPI.h>
+#include <ti/drivers/I2C.h>
+#include <ti/drivers/Power.h>
+#include <inc/hw_types.h>
+#include <driverlib/sys_ctrl.h>
+
+#define MAX_PINS        256
+#define MAX_I2C         2
+#define MAX_REGS        32
+
+
+/* Board (CC2650STK.c is not built on the host) */
+
+const PIN_Config BoardGpioInitTable[] = {
+    PIN_TERMINATE
+};
+
+
+/* PIN */
+
+static uint8_t pinValue[MAX_PINS];
+static PIN_Config pinConfig[MAX_PINS];
+static PIN_Handle pinOwner[MAX_PINS];
+
+static void pinApply(const PIN_Config *table, PIN_Handle owner) {
+    for(; *table != PIN_TERMINATE; table++) {
+        pinConfig[PIN_ID(*table)] = *table;
+        pinOwner[PIN_ID(*table)] = owner;
+
+        if ((*table & PIN_GPIO_OUTPUT_EN) == PIN_GPIO_OUTPUT_EN) {
+            pinValue[PIN_ID(*table)] = (*table & PIN_GPIO_HIGH & ~PIN_GEN) ? 1 : 0;
+        } else if ((*table & PIN_PULLUP & ~PIN_GEN) == (PIN_PULLUP & ~PIN_GEN)) {
+            pinValue[PIN_ID(*table)] = 1;
+        }
+    }
+}
+
+PIN_Status PIN_init(const PIN_Config *table) {
+    pinApply(table, NULL);
+    return PIN_SUCCESS;
+}
+
+PIN_Handle PIN_open(PIN_State *state, const PIN_Config *table) {
+    state->callback = NULL;
+    pinApply(table, state);
+    return state;
+}
+
+void PIN_close(PIN_Handle handle) {
+    int i;
+
+    for (i = 0; i < MAX_PINS; i++) {
+        if (pinOwner[i] == handle) {
+            pinOwner[i] = NULL;
+        }
+    }
+}
+
+PIN_Status PIN_registerIntCb(PIN_Handle handle, PIN_IntCb callback) {
+    handle->callback = callback;
+    return PIN_SUCCESS;
+}
+
+PIN_Status PIN_setInterrupt(PIN_Handle handle, PIN_Config pinCfg) {
+    PIN_Config *cfg = &pinConfig[PIN_ID(pinCfg)];
+
+    *cfg = (*cfg & ~(0x7 << 16)) | (pinCfg & (0x7 << 16));
+    return PIN_SUCCESS;
+}
+
+PIN_Status PIN_setOutputValue(PIN_Handle handle, PIN_Id pin, uint_fast8_t value) {
+    pinValue[pin] = value ? 1 : 0;
+    return PIN_SUCCESS;
+}
+
+uint_fast8_t PIN_getOutputValue(PIN_Id pin) {
+    return pinValue[pin];
+}
+
+uint_fast8_t PIN_getInputValue(PIN_Id pin) {
+    return pinValue[pin];
+}
+
+/* Drive an input, calling the callback on the configured edges (host only) */
+void PIN_hostSetInput(PIN_Id pin, uint_fast8_t value) {
+    uint32_t irq = (pinConfig[pin] >> 16) & 0x7;
+    uint8_t old = pinValue[pin];
+    PIN_Handle owner = pinOwner[pin];
+
+    value = value ? 1 : 0;
+    pinValue[pin] = value;
+
+    if (owner == NULL || owner->callback == NULL || old == value) {
+        return;
+    }
+
+    if ((value == 0 && (irq == 0x4 || irq == 0x7)) || (value == 1 && (irq == 0x5 || irq == 0x7))) {
+        owner->callback(owner, pin);
+    }
+}
+
+PIN_Status PINCC26XX_setWakeup(const PIN_Config *table) {
+    return PIN_SUCCESS;
+}
+
+
+/* SPI */
+
+struct SPI_Config {
+    SPI_Params params;
+};
+
+static struct SPI_Config spiConfig[2];
+
+SPI_HostStats SPI_hostStats;
+
+void SPI_init(void) {
+}
+
+void SPI_Params_init(SPI_Params *params) {
+    memset(params, 0, sizeof(*params));
+    params->transferMode = SPI_MODE_BLOCKING;
+    params->mode = SPI_MASTER;
+    params->bitRate = 1000000;
+    params->dataSize = 8;
+    params->frameFormat = SPI_POL0_PHA0;
+}
+
+SPI_Handle SPI_open(unsigned int index, SPI_Params *params) {
+    SPI_Handle handle = &spiConfig[index];
+
+    if (params) {
+        handle->params = *params;
+    } else {
+        SPI_Params_init(&handle->params);
+    }
+
+    return handle;
+}
+
+void SPI_close(SPI_Handle handle) {
+}
+
+bool SPI_transfer(SPI_Handle handle, SPI_Transaction *transaction) {
+
+    ++SPI_hostStats.transfers;
+    SPI_hostStats.bytes += transaction->count;
+    SPI_hostStats.busTimeUs += (uint64_t)transaction->count * 8 * 1000000 / handle->params.bitRate;
+
+    if (transaction->rxBuf) {
+        memset(transaction->rxBuf, 0xFF, transaction->count);
+    }
+
+    transaction->status = SPI_TRANSFER_COMPLETED;
+
+    if (handle->params.transferMode == SPI_MODE_CALLBACK) {
+        handle->params.transferCallbackFxn(handle, transaction);
+    }
+
+    return true;
+}
+
+
+/* I2C */
+
+struct I2C_Config {
+    I2C_Params params;
+    Bool open;
+};
+
+typedef struct {
+    I2C_HostDevice device;
+    void *arg;
+    I2C_HostStats stats;
+} I2CDevice;
+
+static struct I2C_Config i2cConfig[MAX_I2C];
+static I2CDevice i2cDevices[128];
+static pthread_mutex_t i2cLock = PTHREAD_MUTEX_INITIALIZER;
+
+I2C_HostStats I2C_hostStats;
+
+static void i2cCount(I2C_HostStats *stats, uint32_t bytes, uint32_t bits, uint32_t rate, bool ok) {
+    ++stats->transfers;
+    stats->bytes += bytes;
+    stats->busTimeUs += bits * 1e6 / rate;
+    if (!ok) {
+        ++stats->nacks;
+    }
+}
+
+void I2C_init(void) {
+}
+
+void I2C_Params_init(I2C_Params *params) {
+    memset(params, 0, sizeof(*params));
+    params->transferMode = I2C_MODE_BLOCKING;
+    params->bitRate = I2C_100kHz;
+}
+
+/* Like the driver, an instance can only be open once */
+I2C_Handle I2C_open(unsigned int index, I2C_Params *params) {
+    I2C_Handle handle;
+
+    if (index >= MAX_I2C || i2cConfig[index].open) {
+        return NULL;
+    }
+
+    handle = &i2cConfig[index];
+    if (params) {
+        handle->params = *params;
+    } else {
+        I2C_Params_init(&handle->params);
+    }
+    handle->open = TRUE;
+
+    return handle;
+}
+
+void I2C_close(I2C_Handle handle) {
+    handle->open = FALSE;
+}
+
+bool I2C_transfer(I2C_Handle handle, I2C_Transaction *transaction) {
+    I2CDevice *dev = &i2cDevices[transaction->slaveAddress & 0x7F];
+    uint32_t rate = (handle->params.bitRate == I2C_400kHz) ? 400000 : 100000;
+    uint32_t bytes = transaction->writeCount + transaction->readCount;
+    uint32_t bits;
+    bool ok;
+
+    if (!handle->open) {
+        return false;
+    }
+
+    // one transfer on the bus at a time
+    pthread_mutex_lock(&i2cLock);
+
+    // address bytes, 9 bits each with the acknowledge, plus start and stop
+    // and a repeated start between writing and reading
+    bytes += (transaction->writeCount > 0) + (transaction->readCount > 0);
+    bits = bytes * 9 + 2 + (transaction->writeCount > 0 && transaction->readCount > 0);
+
+    ok = dev->device != NULL && dev->device(dev->arg,
+        transaction->writeBuf, transaction->writeCount,
+        transaction->readBuf, transaction->readCount);
+
+    i2cCount(&I2C_hostStats, bytes, bits, rate, ok);
+    i2cCount(&dev->stats, bytes, bits, rate, ok);
+
+    pthread_mutex_unlock(&i2cLock);
+
+    if (handle->params.transferMode == I2C_MODE_CALLBACK) {
+        handle->params.transferCallbackFxn(handle, transaction, ok);
+    }
+
+    return ok;
+}
+
+void I2C_hostAttach(uint8_t address, I2C_HostDevice device, void *arg) {
+    i2cDevices[address & 0x7F].device = device;
+    i2cDevices[address & 0x7F].arg = arg;
+}
+
+I2C_HostStats *I2C_hostDeviceStats(uint8_t address) {
+    return &i2cDevices[address & 0x7F].stats;
+}
+
+void I2C_hostLock(void) {
+    pthread_mutex_lock(&i2cLock);
+}
+
+void I2C_hostUnlock(void) {
+    pthread_mutex_unlock(&i2cLock);
+}
+
+
+/* Power */
+
+uint32_t SysCtrl_hostResetSource = RSTSRC_PWR_ON;
+
+void Power_init(void) {
+}
+
+int_fast16_t Power_shutdown(uint_fast16_t shutdownState, uint_fast32_t shutdownTime) {
+    printf("Power: shutdown\n");
+    BIOS_exit(0);
+    return Power_SOK;
+}
+
+uint32_t SysCtrlResetSourceGet(void) {
+    return SysCtrl_hostResetSource;
+}
+
+
+/* Registers */
+
+static struct {
+    uint32_t addr;
+    volatile uint32_t value;
+} regs[MAX_REGS];
+static int regCount = 0;
+static pthread_mutex_t regLock = PTHREAD_MUTEX_INITIALIZER;
+
+volatile uint32_t *HWREG_hostReg(uint32_t addr) {
+    volatile uint32_t *reg = NULL;
+    int i;
+
+    pthread_mutex_lock(&regLock);
+
+    for (i = 0; i < regCount; i++) {
+        if (regs[i].addr == addr) {
+            reg = &regs[i].value;
+            break;
+        }
+    }
+
+    if (reg == NULL) {
+        if (regCount == MAX_REGS) {
+            fprintf(stderr, "HWREG: too many registers\n");
+            abort();
+        }
+        regs[regCount].addr = addr;
+        regs[regCount].value = 0;
+        reg = &regs[regCount++].value;
+    }
+
+    pthread_mutex_unlock(&regLock);
+
+    return reg;
+}
+
+void HWREG_hostSet(uint32_t addr, uint32_t value) {
+    *HWREG_hostReg(addr) = value;
+}
@@ -0,0 +1,286 @@
+/*
+ * Host shim: the grlib drawing functions, on top of the display driver
+ * callbacks.
+ */
+#include <ti/mw/grlib/grlib.h>
+
+/* 5x7 characters in 6x8 cells, ' ' to '~' */
+static const unsigned char fixed6x8Glyphs[95 * 5] = {
+    0x00, 0x00, 0x00, 0x00, 0x00,   0x00, 0x00, 0x5F, 0x00, 0x00,   0x00, 0x07, 0x00, 0x07, 0x00,
+    0x14, 0x7F, 0x14, 0x7F, 0x14,   0x24, 0x2A, 0x7F, 0x2A, 0x12,   0x23, 0x13, 0x08, 0x64, 0x62,
+    0x36, 0x49, 0x56, 0x20, 0x50,   0x00, 0x08, 0x07, 0x03, 0x00,   0x00, 0x1C, 0x22, 0x41, 0x00,
+    0x00, 0x41, 0x22, 0x1C, 0x00,   0x2A, 0x1C, 0x7F, 0x1C, 0x2A,   0x08, 0x08, 0x3E, 0x08, 0x08,
+    0x00, 0x80, 0x70, 0x30, 0x00,   0x08, 0x08, 0x08, 0x08, 0x08,   0x00, 0x00, 0x60, 0x60, 0x00,
+    0x20, 0x10, 0x08, 0x04, 0x02,   0x3E, 0x51, 0x49, 0x45, 0x3E,   0x00, 0x42, 0x7F, 0x40, 0x00,
+    0x72, 0x49, 0x49, 0x49, 0x46,   0x21, 0x41, 0x49, 0x4D, 0x33,   0x18, 0x14, 0x12, 0x7F, 0x10,
+    0x27, 0x45, 0x45, 0x45, 0x39,   0x3C, 0x4A, 0x49, 0x49, 0x31,   0x41, 0x21, 0x11, 0x09, 0x07,
+    0x36, 0x49, 0x49, 0x49, 0x36,   0x46, 0x49, 0x49, 0x29, 0x1E,   0x00, 0x00, 0x14, 0x00, 0x00,
+    0x00, 0x40, 0x34, 0x00, 0x00,   0x00, 0x08, 0x14, 0x22, 0x41,   0x14, 0x14, 0x14, 0x14, 0x14,
+    0x00, 0x41, 0x22, 0x14, 0x08,   0x02, 0x01, 0x59, 0x09, 0x06,   0x3E, 0x41, 0x5D, 0x59, 0x4E,
+    0x7C, 0x12, 0x11, 0x12, 0x7C,   0x7F, 0x49, 0x49, 0x49, 0x36,   0x3E, 0x41, 0x41, 0x41, 0x22,
+    0x7F, 0x41, 0x41, 0x41, 0x3E,   0x7F, 0x49, 0x49, 0x49, 0x41,   0x7F, 0x09, 0x09, 0x09, 0x01,
+    0x3E, 0x41, 0x41, 0x51, 0x73,   0x7F, 0x08, 0x08, 0x08, 0x7F,   0x00, 0x41, 0x7F, 0x41, 0x00,
+    0x20, 0x40, 0x41, 0x3F, 0x01,   0x7F, 0x08, 0x14, 0x22, 0x41,   0x7F, 0x40, 0x40, 0x40, 0x40,
+    0x7F, 0x02, 0x1C, 0x02, 0x7F,   0x7F, 0x04, 0x08, 0x10, 0x7F,   0x3E, 0x41, 0x41, 0x41, 0x3E,
+    0x7F, 0x09, 0x09, 0x09, 0x06,   0x3E, 0x41, 0x51, 0x21, 0x5E,   0x7F, 0x09, 0x19, 0x29, 0x46,
+    0x26, 0x49, 0x49, 0x49, 0x32,   0x03, 0x01, 0x7F, 0x01, 0x03,   0x3F, 0x40, 0x40, 0x40, 0x3F,
+    0x1F, 0x20, 0x40, 0x20, 0x1F,   0x3F, 0x40, 0x38, 0x40, 0x3F,   0x63, 0x14, 0x08, 0x14, 0x63,
+    0x03, 0x04, 0x78, 0x04, 0x03,   0x61, 0x59, 0x49, 0x4D, 0x43,   0x00, 0x7F, 0x41, 0x41, 0x41,
+    0x02, 0x04, 0x08, 0x10, 0x20,   0x00, 0x41, 0x41, 0x41, 0x7F,   0x04, 0x02, 0x01, 0x02, 0x04,
+    0x40, 0x40, 0x40, 0x40, 0x40,   0x00, 0x03, 0x07, 0x08, 0x00,   0x20, 0x54, 0x54, 0x78, 0x40,
+    0x7F, 0x28, 0x44, 0x44, 0x38,   0x38, 0x44, 0x44, 0x44, 0x28,   0x38, 0x44, 0x44, 0x28, 0x7F,
+    0x38, 0x54, 0x54, 0x54, 0x18,   0x00, 0x08, 0x7E, 0x09, 0x02,   0x18, 0xA4, 0xA4, 0x9C, 0x78,
+    0x7F, 0x08, 0x04, 0x04, 0x78,   0x00, 0x44, 0x7D, 0x40, 0x00,   0x20, 0x40, 0x40, 0x3D, 0x00,
+    0x7F, 0x10, 0x28, 0x44, 0x00,   0x00, 0x41, 0x7F, 0x40, 0x00,   0x7C, 0x04, 0x78, 0x04, 0x78,
+    0x7C, 0x08, 0x04, 0x04, 0x78,   0x38, 0x44, 0x44, 0x44, 0x38,   0xFC, 0x18, 0x24, 0x24, 0x18,
+    0x18, 0x24, 0x24, 0x18, 0xFC,   0x7C, 0x08, 0x04, 0x04, 0x08,   0x48, 0x54, 0x54, 0x54, 0x24,
+    0x04, 0x04, 0x3F, 0x44, 0x24,   0x3C, 0x40, 0x40, 0x20, 0x7C,   0x1C, 0x20, 0x40, 0x20, 0x1C,
+    0x3C, 0x40, 0x30, 0x40, 0x3C,   0x44, 0x28, 0x10, 0x28, 0x44,   0x4C, 0x90, 0x90, 0x90, 0x7C,
+    0x44, 0x64, 0x54, 0x4C, 0x44,   0x00, 0x08, 0x36, 0x41, 0x00,   0x00, 0x00, 0x77, 0x00, 0x00,
+    0x00, 0x41, 0x36, 0x08, 0x00,   0x02, 0x01, 0x02, 0x04, 0x02
+};
+
+const tFont g_sFontFixed6x8 = { 0, 6, 8, 7, fixed6x8Glyphs };
+
+void GrContextInit(tContext *context, const tDisplay *display) {
+    context->lSize = sizeof(tContext);
+    context->pDisplay = display;
+    context->sClipRegion.sXMin = 0;
+    context->sClipRegion.sYMin = 0;
+    context->sClipRegion.sXMax = display->usWidth - 1;
+    context->sClipRegion.sYMax = display->usHeight - 1;
+    context->ulForeground = 0;
+    context->ulBackground = 0;
+    context->pFont = NULL;
+}
+
+void GrContextForegroundSet(tContext *context, unsigned long value) {
+    context->ulForeground = context->pDisplay->pfnColorTranslate(context->pDisplay->pvDisplayData, value);
+}
+
+void GrContextBackgroundSet(tContext *context, unsigned long value) {
+    context->ulBackground = context->pDisplay->pfnColorTranslate(context->pDisplay->pvDisplayData, value);
+}
+
+void GrContextFontSet(tContext *context, const tFont *font) {
+    context->pFont = font;
+}
+
+
+/* Lines and rectangles */
+
+static void lineH(const tContext *context, long x1, long x2, long y, unsigned long value) {
+    const tRectangle *clip = &context->sClipRegion;
+    long t;
+
+    if (x1 > x2) {
+        t = x1; x1 = x2; x2 = t;
+    }
+    if (y < clip->sYMin || y > clip->sYMax) return;
+    if (x1 < clip->sXMin) x1 = clip->sXMin;
+    if (x2 > clip->sXMax) x2 = clip->sXMax;
+
+    if (x1 <= x2) {
+        context->pDisplay->pfnLineDrawH(context->pDisplay->pvDisplayData, x1, x2, y, value);
+    }
+}
+
+void GrPixelDraw(const tContext *context, long x, long y) {
+    const tRectangle *clip = &context->sClipRegion;
+
+    if (x >= clip->sXMin && x <= clip->sXMax && y >= clip->sYMin && y <= clip->sYMax) {
+        context->pDisplay->pfnPixelDraw(context->pDisplay->pvDisplayData, x, y, context->ulForeground);
+    }
+}
+
+void GrLineDrawH(const tContext *context, long x1, long x2, long y) {
+    lineH(context, x1, x2, y, context->ulForeground);
+}
+
+void GrLineDrawV(const tContext *context, long x, long y1, long y2) {
+    const tRectangle *clip = &context->sClipRegion;
+    long t;
+
+    if (y1 > y2) {
+        t = y1; y1 = y2; y2 = t;
+    }
+    if (x < clip->sXMin || x > clip->sXMax) return;
+    if (y1 < clip->sYMin) y1 = clip->sYMin;
+    if (y2 > clip->sYMax) y2 = clip->sYMax;
+
+    if (y1 <= y2) {
+        context->pDisplay->pfnLineDrawV(context->pDisplay->pvDisplayData, x, y1, y2, context->ulForeground);
+    }
+}
+
+/* Bresenham */
+void GrLineDraw(const tContext *context, long x1, long y1, long x2, long y2) {
+    long dx = x2 > x1 ? x2 - x1 : x1 - x2;
+    long dy = y2 > y1 ? y1 - y2 : y2 - y1;
+    long sx = x1 < x2 ? 1 : -1;
+    long sy = y1 < y2 ? 1 : -1;
+    long err = dx + dy;
+
+    if (y1 == y2) {
+        GrLineDrawH(context, x1, x2, y1);
+        return;
+    }
+    if (x1 == x2) {
+        GrLineDrawV(context, x1, y1, y2);
+        return;
+    }
+
+    while (1) {
+        GrPixelDraw(context, x1, y1);
+        if (x1 == x2 && y1 == y2) {
+            break;
+        }
+        if (2 * err >= dy) {
+            err += dy;
+            x1 += sx;
+        }
+        if (2 * err <= dx) {
+            err += dx;
+            y1 += sy;
+        }
+    }
+}
+
+void GrRectDraw(const tContext *context, const tRectangle *rect) {
+    GrLineDrawH(context, rect->sXMin, rect->sXMax, rect->sYMin);
+    GrLineDrawV(context, rect->sXMax, rect->sYMin, rect->sYMax);
+    GrLineDrawH(context, rect->sXMin, rect->sXMax, rect->sYMax);
+    GrLineDrawV(context, rect->sXMin, rect->sYMin, rect->sYMax);
+}
+
+void GrRectFill(const tContext *context, const tRectangle *rect) {
+    tRectangle r = *rect;
+    const tRectangle *clip = &context->sClipRegion;
+
+    if (r.sXMin < clip->sXMin) r.sXMin = clip->sXMin;
+    if (r.sYMin < clip->sYMin) r.sYMin = clip->sYMin;
+    if (r.sXMax > clip->sXMax) r.sXMax = clip->sXMax;
+    if (r.sYMax > clip->sYMax) r.sYMax = clip->sYMax;
+
+    if (r.sXMin <= r.sXMax && r.sYMin <= r.sYMax) {
+        context->pDisplay->pfnRectFill(context->pDisplay->pvDisplayData, &r, context->ulForeground);
+    }
+}
+
+
+/* Text */
+
+long GrStringWidthGet(const tContext *context, const char *string, long length) {
+    long n = 0;
+
+    while ((length < 0 || n < length) && string[n] != '\0') {
+        n++;
+    }
+
+    return n * context->pFont->ucMaxWidth;
+}
+
+void GrStringDraw(const tContext *context, const char *string, long length, long x, long y, bool opaque) {
+    const tFont *font = context->pFont;
+    const unsigned char *glyph;
+    unsigned char column;
+    long n, col, row;
+
+    for (n = 0; (length < 0 || n < length) && string[n] != '\0'; n++, x += font->ucMaxWidth) {
+        glyph = NULL;
+        if (string[n] >= ' ' && string[n] <= '~') {
+            glyph = &font->pucGlyphs[(string[n] - ' ') * 5];
+        }
+
+        for (col = 0; col < font->ucMaxWidth; col++) {
+            column = (glyph != NULL && col < 5) ? glyph[col] : 0;
+
+            for (row = 0; row < font->ucHeight; row++) {
+                if (column & (1 << row)) {
+                    GrPixelDraw(context, x + col, y + row);
+                } else if (opaque) {
+                    const tRectangle *clip = &context->sClipRegion;
+                    if (x + col >= clip->sXMin && x + col <= clip->sXMax && y + row >= clip->sYMin && y + row <= clip->sYMax) {
+                        context->pDisplay->pfnPixelDraw(context->pDisplay->pvDisplayData, x + col, y + row, context->ulBackground);
+                    }
+                }
+            }
+        }
+    }
+}
+
+void GrStringDrawCentered(const tContext *context, const char *string, long length, long x, long y, bool opaque) {
+    GrStringDraw(context, string, length, x - GrStringWidthGet(context, string, length) / 2,
+        y - context->pFont->ucBaseline / 2, opaque);
+}
+
+
+/* Images */
+
+/* Draw a row of palette indices as runs of the same color */
+static void imageRow(const tContext *context, const unsigned char *index, long width, long x, long y, const unsigned long *colors) {
+    long start = 0;
+    long i;
+
+    for (i = 1; i <= width; i++) {
+        if (i == width || index[i] != index[start]) {
+            lineH(context, x + start, x + i - 1, y, colors[index[start]]);
+            start = i;
+        }
+    }
+}
+
+void GrImageDraw(const tContext *context, const tImage *image, long x, long y) {
+    const tDisplay *display = context->pDisplay;
+    unsigned char row[256];
+    unsigned long colors[2];
+    const unsigned char *data = image->pPixel;
+    long width = image->XSize;
+    long rowBytes = (width + 7) / 8;
+    long run = 0;
+    unsigned char color = 0;
+    long r, i;
+
+    if (image->BPP != IMAGE_FMT_1BPP_UNCOMP && image->BPP != IMAGE_FMT_1BPP_COMP_RLE4) {
+        return;
+    }
+    if (width > (long)sizeof(row)) {
+        width = sizeof(row);
+    }
+
+    colors[0] = display->pfnColorTranslate(display->pvDisplayData, image->pPalette[0]);
+    colors[1] = display->pfnColorTranslate(display->pvDisplayData, image->pPalette[1]);
+
+    for (r = 0; r < image->YSize; r++) {
+
+        if (image->BPP == IMAGE_FMT_1BPP_UNCOMP) {
+            for (i = 0; i < width; i++) {
+                row[i] = (data[r * rowBytes + i / 8] >> (7 - i % 8)) & 1;
+            }
+        } else {
+            // RLE4: high nibble is the run length - 1, low nibble the color
+            for (i = 0; i < width; i++) {
+                if (run == 0) {
+                    run = (*data >> 4) + 1;
+                    color = *data & 0x0F;
+                    data++;
+                }
+                row[i] = color & 1;
+                run--;
+            }
+        }
+
+        imageRow(context, row, width, x, y + r, colors);
+    }
+}
+
+
+/* Display */
+
+void GrClearDisplay(const tContext *context) {
+    context->pDisplay->pfnClearDisplay(context->pDisplay->pvDisplayData, context->ulBackground);
+}
+
+void GrFlush(const tContext *context) {
+    context->pDisplay->pfnFlush(context->pDisplay->pvDisplayData);
+}
@@ -0,0 +1,23 @@
+/*
+ * Host shim: driverlib/interrupt.h. Nothing to enable on the host.
+ */
+#ifndef SHIM_INTERRUPT_H
+#define SHIM_INTERRUPT_H
+
+#include <inc/hw_types.h>
+#include <inc/hw_ints.h>
+
+__STATIC_INLINE void IntEnable(uint32_t interrupt) {
+}
+
+__STATIC_INLINE void IntDisable(uint32_t interrupt) {
+}
+
+__STATIC_INLINE void IntPendClear(uint32_t interrupt) {
+}
+
+__STATIC_INLINE bool IntMasterEnable(void) {
+    return false;
+}
+
+#endif /* SHIM_INTERRUPT_H */
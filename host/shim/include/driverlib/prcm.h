@@ -0,0 +1,23 @@
+/*
+ * Host shim: driverlib/prcm.h. Power domains are always on.
+ */
+#ifndef SHIM_PRCM_H
+#define SHIM_PRCM_H
+
+#include <inc/hw_types.h>
+
+#define PRCM_DOMAIN_RFCORE          0x00000001
+#define PRCM_DOMAIN_SERIAL          0x00000002
+#define PRCM_DOMAIN_PERIPH          0x00000004
+
+#define PRCM_DOMAIN_POWER_OFF       0x00000002
+#define PRCM_DOMAIN_POWER_ON        0x00000001
+
+__STATIC_INLINE void PRCMPowerDomainOn(uint32_t domains) {
+}
+
+__STATIC_INLINE uint32_t PRCMPowerDomainStatus(uint32_t domains) {
+    return PRCM_DOMAIN_POWER_ON;
+}
+
+#endif /* SHIM_PRCM_H */
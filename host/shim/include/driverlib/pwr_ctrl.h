@@ -0,0 +1,10 @@
+/*
+ * Host shim: driverlib/pwr_ctrl.h (and the prcm.h power domains).
+ */
+#ifndef SHIM_PWR_CTRL_H
+#define SHIM_PWR_CTRL_H
+
+#include <inc/hw_types.h>
+#include <driverlib/prcm.h>
+
+#endif /* SHIM_PWR_CTRL_H */
@@ -0,0 +1,29 @@
+/*
+ * Host shim: driverlib/rf_data_entry.h, the general data entry of the radio
+ * queues. pNextEntry is a host pointer, so the header is longer than the 8
+ * bytes on the CC2650; use offsetof(rfc_dataEntryGeneral_t, data).
+ */
+#ifndef SHIM_RF_DATA_ENTRY_H
+#define SHIM_RF_DATA_ENTRY_H
+
+#include <stdint.h>
+
+#define DATA_ENTRY_PENDING      0
+#define DATA_ENTRY_ACTIVE       1
+#define DATA_ENTRY_BUSY         2
+#define DATA_ENTRY_FINISHED     3
+#define DATA_ENTRY_UNFINISHED   4
+
+typedef struct {
+    uint8_t *pNextEntry;
+    uint8_t status;
+    struct {
+        uint8_t type:2;
+        uint8_t lenSz:2;
+        uint8_t irqIntv:4;
+    } config;
+    uint16_t length;
+    uint8_t data;
+} rfc_dataEntryGeneral_t;
+
+#endif /* SHIM_RF_DATA_ENTRY_H */
@@ -0,0 +1,25 @@
+/*
+ * Host shim: driverlib/sys_ctrl.h. The reset source can be set by a
+ * simulation (SysCtrl_hostResetSource), it is a power-on reset by default.
+ */
+#ifndef SHIM_SYS_CTRL_H
+#define SHIM_SYS_CTRL_H
+
+#include <inc/hw_types.h>
+#include <inc/hw_memmap.h>
+
+#define RSTSRC_PWR_ON               0
+#define RSTSRC_PIN_RESET            1
+#define RSTSRC_VDDS_LOSS            2
+#define RSTSRC_VDD_LOSS             3
+#define RSTSRC_VDDR_LOSS            4
+#define RSTSRC_CLK_LOSS             5
+#define RSTSRC_SYSRESET             6
+#define RSTSRC_WARMRESET            7
+#define RSTSRC_WAKEUP_FROM_SHUTDOWN 8
+
+extern uint32_t SysCtrl_hostResetSource;
+
+uint32_t SysCtrlResetSourceGet(void);
+
+#endif /* SHIM_SYS_CTRL_H */
@@ -0,0 +1,10 @@
+/*
+ * Host shim: inc/hw_ints.h.
+ */
+#ifndef SHIM_HW_INTS_H
+#define SHIM_HW_INTS_H
+
+#define INT_RFC_CPE_1       25
+#define INT_RFC_CPE_0       26
+
+#endif /* SHIM_HW_INTS_H */
@@ -0,0 +1,9 @@
+/*
+ * Host shim: inc/hw_memmap.h, the peripherals the application touches.
+ */
+#ifndef SHIM_HW_MEMMAP_H
+#define SHIM_HW_MEMMAP_H
+
+#define AON_BATMON_BASE     0x40095000
+
+#endif /* SHIM_HW_MEMMAP_H */
@@ -0,0 +1,19 @@
+/*
+ * Host shim: inc/hw_types.h. Registers are kept in a table, so HWREG()
+ * reads back what was written or what a simulation set (host only:
+ * HWREG_hostSet()).
+ */
+#ifndef SHIM_HW_TYPES_H
+#define SHIM_HW_TYPES_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define __STATIC_INLINE     static inline
+
+#define HWREG(x)            (*HWREG_hostReg(x))
+
+volatile uint32_t *HWREG_hostReg(uint32_t addr);
+void HWREG_hostSet(uint32_t addr, uint32_t value);
+
+#endif /* SHIM_HW_TYPES_H */
@@ -0,0 +1,71 @@
+/*
+ * Host shim: ti.drivers.I2C. Transfers go to device models attached to a
+ * slave address with I2C_hostAttach(); without one the address is not
+ * acknowledged and the transfer fails, like on the bus. The bytes and the
+ * time they would take on the wire are counted.
+ */
+#ifndef SHIM_I2C_H
+#define SHIM_I2C_H
+
+#include <xdc/std.h>
+
+typedef struct I2C_Config *I2C_Handle;
+
+typedef enum {
+    I2C_100kHz = 0,
+    I2C_400kHz = 1
+} I2C_BitRate;
+
+typedef enum {
+    I2C_MODE_BLOCKING,
+    I2C_MODE_CALLBACK
+} I2C_TransferMode;
+
+typedef struct {
+    void *writeBuf;
+    size_t writeCount;
+    void *readBuf;
+    size_t readCount;
+    uint_least8_t slaveAddress;
+    void *arg;
+} I2C_Transaction;
+
+typedef void (*I2C_CallbackFxn)(I2C_Handle, I2C_Transaction *, bool);
+
+typedef struct {
+    I2C_TransferMode transferMode;
+    I2C_CallbackFxn transferCallbackFxn;
+    I2C_BitRate bitRate;
+    uintptr_t custom;
+} I2C_Params;
+
+/*
+ * A device model: handles one transfer (a write, a read or a write followed
+ * by a repeated start and a read). Returns false to not acknowledge.
+ */
+typedef bool (*I2C_HostDevice)(void *arg, const uint8_t *writeBuf, size_t writeCount, uint8_t *readBuf, size_t readCount);
+
+/* Bus accounting (host only), for the whole bus and per slave address */
+typedef struct {
+    uint32_t transfers;
+    uint32_t nacks;
+    uint64_t bytes;         // with the address bytes
+    double busTimeUs;       // at the bit rate of the handle
+} I2C_HostStats;
+
+extern I2C_HostStats I2C_hostStats;
+
+void I2C_init(void);
+void I2C_Params_init(I2C_Params *params);
+I2C_Handle I2C_open(unsigned int index, I2C_Params *params);
+void I2C_close(I2C_Handle handle);
+bool I2C_transfer(I2C_Handle handle, I2C_Transaction *transaction);
+
+void I2C_hostAttach(uint8_t address, I2C_HostDevice device, void *arg);
+I2C_HostStats *I2C_hostDeviceStats(uint8_t address);
+
+/* Hold the bus, to step the device models between transfers */
+void I2C_hostLock(void);
+void I2C_hostUnlock(void);
+
+#endif /* SHIM_I2C_H */
@@ -0,0 +1,59 @@
+/*
+ * Host shim: ti.drivers.PIN. Pin values are kept in a table so that the
+ * code reading them back sees what it wrote. Inputs are driven by
+ * simulations with PIN_hostSetInput(), which calls the callbacks.
+ */
+#ifndef SHIM_PIN_H
+#define SHIM_PIN_H
+
+#include <xdc/std.h>
+
+typedef uint32_t PIN_Config;
+typedef uint8_t PIN_Id;
+typedef uint32_t PIN_Status;
+
+typedef struct PIN_State_s {
+    void (*callback)(struct PIN_State_s *, PIN_Id);
+} PIN_State;
+
+typedef PIN_State *PIN_Handle;
+typedef void (*PIN_IntCb)(PIN_Handle, PIN_Id);
+
+#define PIN_SUCCESS         0
+#define PIN_TERMINATE       0xFE
+#define PIN_UNASSIGNED      0xFF
+#define PIN_ID(x)           ((x) & 0xFF)
+
+#define PIN_GEN             (((uint32_t)1) << 31)
+#define PIN_INPUT_EN        (PIN_GEN | (0 << 29))
+#define PIN_INPUT_DIS       (PIN_GEN | (1 << 29))
+#define PIN_HYSTERESIS      (PIN_GEN | (1 << 30))
+#define PIN_NOPULL          (PIN_GEN | (0 << 13))
+#define PIN_PULLUP          (PIN_GEN | (1 << 13))
+#define PIN_PULLDOWN        (PIN_GEN | (2 << 13))
+#define PIN_IRQ_DIS         (PIN_GEN | (0x0 << 16))
+#define PIN_IRQ_NEGEDGE     (PIN_GEN | (0x4 << 16))
+#define PIN_IRQ_POSEDGE     (PIN_GEN | (0x5 << 16))
+#define PIN_IRQ_BOTHEDGES   (PIN_GEN | (0x7 << 16))
+#define PIN_GPIO_OUTPUT_DIS (PIN_GEN | (0 << 23))
+#define PIN_GPIO_OUTPUT_EN  (PIN_GEN | (1 << 23))
+#define PIN_GPIO_LOW        (PIN_GEN | (0 << 22))
+#define PIN_GPIO_HIGH       (PIN_GEN | (1 << 22))
+#define PIN_PUSHPULL        (PIN_GEN | (0 << 25))
+#define PIN_OPENDRAIN       (PIN_GEN | (2 << 25))
+#define PIN_DRVSTR_MIN      (PIN_GEN | (0x0 << 8))
+#define PIN_DRVSTR_MED      (PIN_GEN | (0x4 << 8))
+#define PIN_DRVSTR_MAX      (PIN_GEN | (0x8 << 8))
+
+PIN_Status PIN_init(const PIN_Config *table);
+PIN_Handle PIN_open(PIN_State *state, const PIN_Config *table);
+void PIN_close(PIN_Handle handle);
+PIN_Status PIN_registerIntCb(PIN_Handle handle, PIN_IntCb callback);
+PIN_Status PIN_setInterrupt(PIN_Handle handle, PIN_Config pinCfg);
+PIN_Status PIN_setOutputValue(PIN_Handle handle, PIN_Id pin, uint_fast8_t value);
+uint_fast8_t PIN_getOutputValue(PIN_Id pin);
+uint_fast8_t PIN_getInputValue(PIN_Id pin);
+
+void PIN_hostSetInput(PIN_Id pin, uint_fast8_t value);
+
+#endif /* SHIM_PIN_H */
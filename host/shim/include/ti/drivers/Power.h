@@ -0,0 +1,14 @@
+/*
+ * Host shim: ti.drivers.Power. Shutting down ends the program.
+ */
+#ifndef SHIM_POWER_H
+#define SHIM_POWER_H
+
+#include <xdc/std.h>
+
+#define Power_SOK           0
+
+void Power_init(void);
+int_fast16_t Power_shutdown(uint_fast16_t shutdownState, uint_fast32_t shutdownTime);
+
+#endif /* SHIM_POWER_H */
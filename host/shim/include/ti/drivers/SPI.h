@@ -0,0 +1,73 @@
+/*
+ * Host shim: ti.drivers.SPI. Transfers complete immediately; in callback
+ * mode the callback is called before SPI_transfer() returns. The bytes and
+ * the time they would take on the wire are counted.
+ */
+#ifndef SHIM_SPI_H
+#define SHIM_SPI_H
+
+#include <xdc/std.h>
+
+typedef struct SPI_Config *SPI_Handle;
+
+typedef enum {
+    SPI_TRANSFER_COMPLETED = 0,
+    SPI_TRANSFER_STARTED,
+    SPI_TRANSFER_CANCELED,
+    SPI_TRANSFER_FAILED
+} SPI_Status;
+
+typedef struct {
+    size_t count;
+    void *txBuf;
+    void *rxBuf;
+    void *arg;
+    SPI_Status status;
+} SPI_Transaction;
+
+typedef void (*SPI_CallbackFxn)(SPI_Handle, SPI_Transaction *);
+
+typedef enum {
+    SPI_MODE_BLOCKING,
+    SPI_MODE_CALLBACK
+} SPI_TransferMode;
+
+typedef enum {
+    SPI_MASTER = 0,
+    SPI_SLAVE = 1
+} SPI_Mode;
+
+typedef enum {
+    SPI_POL0_PHA0 = 0,
+    SPI_POL0_PHA1,
+    SPI_POL1_PHA0,
+    SPI_POL1_PHA1
+} SPI_FrameFormat;
+
+typedef struct {
+    SPI_TransferMode transferMode;
+    UInt32 transferTimeout;
+    SPI_CallbackFxn transferCallbackFxn;
+    SPI_Mode mode;
+    UInt32 bitRate;
+    UInt32 dataSize;
+    SPI_FrameFormat frameFormat;
+    uintptr_t custom;
+} SPI_Params;
+
+/* Bus accounting (host only) */
+typedef struct {
+    uint32_t transfers;
+    uint64_t bytes;
+    uint64_t busTimeUs;     // at the bit rate of the handle
+} SPI_HostStats;
+
+extern SPI_HostStats SPI_hostStats;
+
+void SPI_init(void);
+void SPI_Params_init(SPI_Params *params);
+SPI_Handle SPI_open(unsigned int index, SPI_Params *params);
+void SPI_close(SPI_Handle handle);
+bool SPI_transfer(SPI_Handle handle, SPI_Transaction *transaction);
+
+#endif /* SHIM_SPI_H */
@@ -0,0 +1,15 @@
+/*
+ * Host shim: ti.drivers.i2c.I2CCC26XX.
+ */
+#ifndef SHIM_I2CCC26XX_H
+#define SHIM_I2CCC26XX_H
+
+#include <ti/drivers/I2C.h>
+#include <ti/drivers/PIN.h>
+
+typedef struct {
+    uint8_t pinSDA;
+    uint8_t pinSCL;
+} I2CCC26XX_I2CPinCfg;
+
+#endif /* SHIM_I2CCC26XX_H */
@@ -0,0 +1,15 @@
+/*
+ * Host shim: ti.drivers.pin.PINCC26XX.
+ */
+#ifndef SHIM_PINCC26XX_H
+#define SHIM_PINCC26XX_H
+
+#include <ti/drivers/PIN.h>
+
+#define PINCC26XX_NO_WAKEUP         (PIN_GEN | (0 << 27))
+#define PINCC26XX_WAKEUP_POSEDGE    (PIN_GEN | (3 << 27))
+#define PINCC26XX_WAKEUP_NEGEDGE    (PIN_GEN | (2 << 27))
+
+PIN_Status PINCC26XX_setWakeup(const PIN_Config *table);
+
+#endif /* SHIM_PINCC26XX_H */
@@ -0,0 +1,9 @@
+/*
+ * Host shim: ti.drivers.power.PowerCC26XX.
+ */
+#ifndef SHIM_POWERCC26XX_H
+#define SHIM_POWERCC26XX_H
+
+#include <ti/drivers/Power.h>
+
+#endif /* SHIM_POWERCC26XX_H */
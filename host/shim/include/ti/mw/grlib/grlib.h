@@ -0,0 +1,85 @@
+/*
+ * Host shim: the subset of TI grlib used by the application. Drawing goes
+ * through the tDisplay driver callbacks, like on the device. Images can be
+ * 1 BPP, uncompressed or RLE4.
+ */
+#ifndef SHIM_GRLIB_H
+#define SHIM_GRLIB_H
+
+#include <xdc/std.h>
+
+typedef struct {
+    short sXMin;
+    short sYMin;
+    short sXMax;
+    short sYMax;
+} tRectangle;
+
+typedef struct {
+    long lSize;
+    void *pvDisplayData;
+    unsigned short usWidth;
+    unsigned short usHeight;
+    void (*pfnPixelDraw)(void *pvDisplayData, long lX, long lY, unsigned long ulValue);
+    void (*pfnPixelDrawMultiple)(void *pvDisplayData, long lX, long lY, long lX0, long lCount, long lBPP, const unsigned char *pucData, const unsigned long *pucPalette);
+    void (*pfnLineDrawH)(void *pvDisplayData, long lX1, long lX2, long lY, unsigned long ulValue);
+    void (*pfnLineDrawV)(void *pvDisplayData, long lX, long lY1, long lY2, unsigned long ulValue);
+    void (*pfnRectFill)(void *pvDisplayData, const tRectangle *pRect, unsigned long ulValue);
+    unsigned long (*pfnColorTranslate)(void *pvDisplayData, unsigned long ulValue);
+    void (*pfnFlush)(void *pvDisplayData);
+    void (*pfnClearDisplay)(void *pvDisplayData, unsigned long ulValue);
+} tDisplay;
+
+/* Fixed width fonts only: 5 column bytes (LSB on top) per character from ' ' to '~' */
+typedef struct {
+    unsigned char ucFormat;
+    unsigned char ucMaxWidth;
+    unsigned char ucHeight;
+    unsigned char ucBaseline;
+    const unsigned char *pucGlyphs;
+} tFont;
+
+typedef struct {
+    long lSize;
+    const tDisplay *pDisplay;
+    tRectangle sClipRegion;
+    unsigned long ulForeground;
+    unsigned long ulBackground;
+    const tFont *pFont;
+} tContext;
+
+typedef struct {
+    unsigned char BPP;
+    unsigned short XSize;
+    unsigned short YSize;
+    unsigned short NumColors;
+    const unsigned long *pPalette;
+    const unsigned char *pPixel;
+} tImage;
+
+#define IMAGE_FMT_1BPP_UNCOMP       0x01
+#define IMAGE_FMT_1BPP_COMP_RLE4    0x41
+
+#define ClrBlack                    0x00000000
+#define ClrWhite                    0x00FFFFFF
+
+extern const tFont g_sFontFixed6x8;
+
+void GrContextInit(tContext *context, const tDisplay *display);
+void GrContextForegroundSet(tContext *context, unsigned long value);
+void GrContextBackgroundSet(tContext *context, unsigned long value);
+void GrContextFontSet(tContext *context, const tFont *font);
+void GrRectFill(const tContext *context, const tRectangle *rect);
+void GrRectDraw(const tContext *context, const tRectangle *rect);
+void GrPixelDraw(const tContext *context, long x, long y);
+void GrLineDraw(const tContext *context, long x1, long y1, long x2, long y2);
+void GrLineDrawH(const tContext *context, long x1, long x2, long y);
+void GrLineDrawV(const tContext *context, long x, long y1, long y2);
+void GrStringDraw(const tContext *context, const char *string, long length, long x, long y, bool opaque);
+void GrStringDrawCentered(const tContext *context, const char *string, long length, long x, long y, bool opaque);
+long GrStringWidthGet(const tContext *context, const char *string, long length);
+void GrImageDraw(const tContext *context, const tImage *image, long x, long y);
+void GrClearDisplay(const tContext *context);
+void GrFlush(const tContext *context);
+
+#endif /* SHIM_GRLIB_H */
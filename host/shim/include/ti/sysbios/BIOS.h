@@ -0,0 +1,21 @@
+/*
+ * Host shim: ti.sysbios.BIOS. BIOS_start() starts the tasks and the clocks
+ * and never returns; the program ends with BIOS_exit() or Power_shutdown().
+ * If SHIM_RUN_MS is set in the environment, it exits after that many
+ * milliseconds.
+ */
+#ifndef SHIM_BIOS_H
+#define SHIM_BIOS_H
+
+#include <xdc/std.h>
+
+#define BIOS_WAIT_FOREVER   (~(0U))
+#define BIOS_NO_WAIT        0
+
+void BIOS_start(void);
+void BIOS_exit(Int stat);
+
+/* Functions to call at BIOS_exit(), e.g. to save simulated state (host only) */
+void BIOS_hostAtExit(void (*fxn)(void));
+
+#endif /* SHIM_BIOS_H */
@@ -0,0 +1,26 @@
+/*
+ * Host shim: ti.sysbios.hal.Hwi. There are no interrupts on the host; the
+ * simulated peripherals call the handlers directly with Hwi_hostPost().
+ */
+#ifndef SHIM_HWI_H
+#define SHIM_HWI_H
+
+#include <xdc/std.h>
+
+typedef struct Hwi_Object *Hwi_Handle;
+typedef void (*Hwi_FuncPtr)(UArg);
+
+typedef struct {
+    UArg arg;
+    Int priority;
+} Hwi_Params;
+
+void Hwi_Params_init(Hwi_Params *params);
+Hwi_Handle Hwi_create(Int intNum, Hwi_FuncPtr fxn, const Hwi_Params *params, void *eb);
+UInt Hwi_disable(void);
+void Hwi_restore(UInt key);
+
+/* Run the handler of @intNum, if one was created (host only) */
+void Hwi_hostPost(Int intNum);
+
+#endif /* SHIM_HWI_H */
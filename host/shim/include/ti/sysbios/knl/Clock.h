@@ -0,0 +1,30 @@
+/*
+ * Host shim: ti.sysbios.knl.Clock. Ticks follow CLOCK_MONOTONIC, with the
+ * same tick period as the firmware (empty.cfg).
+ */
+#ifndef SHIM_CLOCK_H
+#define SHIM_CLOCK_H
+
+#include <xdc/std.h>
+
+extern UInt32 Clock_tickPeriod;     // us
+
+typedef struct Clock_Object *Clock_Handle;
+typedef void (*Clock_FuncPtr)(UArg);
+
+typedef struct {
+    UInt32 period;
+    Bool startFlag;
+    UArg arg;
+} Clock_Params;
+
+void Clock_Params_init(Clock_Params *params);
+Clock_Handle Clock_create(Clock_FuncPtr fxn, UInt32 timeout, const Clock_Params *params, void *eb);
+void Clock_delete(Clock_Handle *handle);
+void Clock_start(Clock_Handle handle);
+void Clock_stop(Clock_Handle handle);
+void Clock_setTimeout(Clock_Handle handle, UInt32 timeout);
+void Clock_setPeriod(Clock_Handle handle, UInt32 period);
+UInt32 Clock_getTicks(void);
+
+#endif /* SHIM_CLOCK_H */
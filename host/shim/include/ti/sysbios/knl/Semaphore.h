@@ -0,0 +1,27 @@
+/*
+ * Host shim: ti.sysbios.knl.Semaphore on top of pthreads.
+ */
+#ifndef SHIM_SEMAPHORE_H
+#define SHIM_SEMAPHORE_H
+
+#include <xdc/std.h>
+
+typedef struct Semaphore_Object *Semaphore_Handle;
+
+typedef enum {
+    Semaphore_Mode_COUNTING,
+    Semaphore_Mode_BINARY
+} Semaphore_Mode;
+
+typedef struct {
+    Semaphore_Mode mode;
+} Semaphore_Params;
+
+void Semaphore_Params_init(Semaphore_Params *params);
+Semaphore_Handle Semaphore_create(Int count, const Semaphore_Params *params, void *eb);
+void Semaphore_delete(Semaphore_Handle *handle);
+Bool Semaphore_pend(Semaphore_Handle handle, UInt32 timeout);
+void Semaphore_post(Semaphore_Handle handle);
+Int Semaphore_getCount(Semaphore_Handle handle);
+
+#endif /* SHIM_SEMAPHORE_H */
@@ -0,0 +1,36 @@
+/*
+ * Host shim: ti.sysbios.knl.Task. Every task is a thread, started by
+ * BIOS_start() (or at once when created after it). The threads run
+ * concurrently: priorities are kept but not enforced, so a task that polls
+ * without blocking only costs a host core instead of starving the lower
+ * priority ones.
+ */
+#ifndef SHIM_TASK_H
+#define SHIM_TASK_H
+
+#include <xdc/std.h>
+
+typedef struct Task_Object *Task_Handle;
+typedef void (*Task_FuncPtr)(UArg, UArg);
+
+typedef struct {
+    UArg arg0;
+    UArg arg1;
+    Int priority;
+    Ptr stack;              // not used, the threads have their own
+    size_t stackSize;
+} Task_Params;
+
+void Task_Params_init(Task_Params *params);
+Task_Handle Task_create(Task_FuncPtr fxn, const Task_Params *params, void *eb);
+Task_Handle Task_self(void);
+void Task_sleep(UInt32 ticks);
+void Task_yield(void);
+
+/* Called by BIOS_start() */
+void Task_hostStartAll(void);
+
+/* CPU time used by the task's thread, in us (0 before it starts) */
+UInt64 Task_hostCpuTime(Task_Handle task);
+
+#endif /* SHIM_TASK_H */
@@ -0,0 +1,14 @@
+/*
+ * Host shim: xdc.runtime.System, printing to stdout.
+ */
+#ifndef SHIM_SYSTEM_H
+#define SHIM_SYSTEM_H
+
+#include <xdc/std.h>
+
+int System_printf(const char *fmt, ...);
+int System_sprintf(char *buf, const char *fmt, ...);
+void System_flush(void);
+void System_abort(const char *msg);
+
+#endif /* SHIM_SYSTEM_H */
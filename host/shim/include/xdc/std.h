@@ -0,0 +1,44 @@
+/*
+ * Host shim: XDCtools standard types.
+ */
+#ifndef SHIM_XDC_STD_H
+#define SHIM_XDC_STD_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+typedef void            Void;
+typedef char            Char;
+typedef unsigned char   UChar;
+typedef short           Short;
+typedef unsigned short  UShort;
+typedef int             Int;
+typedef unsigned int    UInt;
+typedef long            Long;
+typedef unsigned long   ULong;
+typedef int             Bool;
+typedef uintptr_t       UArg;
+typedef void           *Ptr;
+typedef const char     *String;
+
+typedef int8_t          Int8;
+typedef int16_t         Int16;
+typedef int32_t         Int32;
+typedef uint8_t         UInt8;
+typedef uint16_t        UInt16;
+typedef uint32_t        UInt32;
+typedef uint64_t        UInt64;
+typedef uint8_t         Bits8;
+typedef uint16_t        Bits16;
+typedef uint32_t        Bits32;
+
+#ifndef TRUE
+#define TRUE    1
+#define FALSE   0
+#endif
+
+#endif /* SHIM_XDC_STD_H */
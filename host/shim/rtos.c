@@ -0,0 +1,509 @@
+/*
+ * Host shim: System, BIOS, Task, Clock, Semaphore and Hwi.
+ */
+#define _GNU_SOURCE         // recursive mutex initializer
+#include <stdarg.h>
+#include <pthread.h>
+#include <sched.h>
+#include <time.h>
+
+#include <xdc/std.h>
+#include <xdc/runtime/System.h>
+#include <ti/sysbios/BIOS.h>
+#include <ti/sysbios/knl/Task.h>
+#include <ti/sysbios/knl/Clock.h>
+#include <ti/sysbios/knl/Semaphore.h>
+#include <ti/sysbios/hal/Hwi.h>
+
+#define MAX_EXIT_FXNS   8
+#define MAX_HWIS        64
+
+static void clockStartThread(void);
+
+
+/* System */
+
+int System_printf(const char *fmt, ...) {
+    va_list args;
+    int n;
+
+    va_start(args, fmt);
+    n = vprintf(fmt, args);
+    va_end(args);
+
+    return n;
+}
+
+int System_sprintf(char *buf, const char *fmt, ...) {
+    va_list args;
+    int n;
+
+    va_start(args, fmt);
+    n = vsprintf(buf, fmt, args);
+    va_end(args);
+
+    return n;
+}
+
+void System_flush(void) {
+    fflush(stdout);
+}
+
+void System_abort(const char *msg) {
+    fprintf(stderr, "%s", msg);
+    abort();
+}
+
+
+/* BIOS */
+
+static Bool started = FALSE;
+static void (*exitFxns[MAX_EXIT_FXNS])(void);
+static int exitCount = 0;
+
+void BIOS_hostAtExit(void (*fxn)(void)) {
+    if (exitCount < MAX_EXIT_FXNS) {
+        exitFxns[exitCount++] = fxn;
+    }
+}
+
+void BIOS_exit(Int stat) {
+    int i;
+
+    for (i = exitCount - 1; i >= 0; i--) {
+        exitFxns[i]();
+    }
+
+    fflush(stdout);
+    exit(stat);
+}
+
+void BIOS_start(void) {
+    const char *runMs = getenv("SHIM_RUN_MS");
+
+    started = TRUE;
+    Task_hostStartAll();
+    clockStartThread();
+
+    if (runMs != NULL) {
+        Task_sleep((UInt32)(atol(runMs) * 1000 / Clock_tickPeriod));
+        BIOS_exit(0);
+    }
+
+    while (1) {
+        Task_sleep(~0U);
+    }
+}
+
+
+/* Task */
+
+struct Task_Object {
+    Task_FuncPtr fxn;
+    Task_Params params;
+    pthread_t thread;
+    Bool running;
+    struct Task_Object *next;
+};
+
+static pthread_mutex_t taskLock = PTHREAD_MUTEX_INITIALIZER;
+static Task_Handle tasks = NULL;
+static __thread Task_Handle self = NULL;
+
+static void *taskMain(void *arg) {
+    Task_Handle task = arg;
+
+    self = task;
+    task->fxn(task->params.arg0, task->params.arg1);
+
+    return NULL;
+}
+
+static void taskStart(Task_Handle task) {
+    task->running = TRUE;
+    if (pthread_create(&task->thread, NULL, taskMain, task) != 0) {
+        System_abort("Task: thread create failed\n");
+    }
+}
+
+void Task_Params_init(Task_Params *params) {
+    params->arg0 = 0;
+    params->arg1 = 0;
+    params->priority = 1;
+    params->stack = NULL;
+    params->stackSize = 0;
+}
+
+Task_Handle Task_create(Task_FuncPtr fxn, const Task_Params *params, void *eb) {
+    Task_Handle task = calloc(1, sizeof(*task));
+
+    task->fxn = fxn;
+    if (params) {
+        task->params = *params;
+    } else {
+        Task_Params_init(&task->params);
+    }
+
+    pthread_mutex_lock(&taskLock);
+    task->next = tasks;
+    tasks = task;
+    if (started) {
+        taskStart(task);
+    }
+    pthread_mutex_unlock(&taskLock);
+
+    return task;
+}
+
+void Task_hostStartAll(void) {
+    Task_Handle task;
+
+    pthread_mutex_lock(&taskLock);
+    for (task = tasks; task != NULL; task = task->next) {
+        if (!task->running) {
+            taskStart(task);
+        }
+    }
+    pthread_mutex_unlock(&taskLock);
+}
+
+Task_Handle Task_self(void) {
+    return self;
+}
+
+void Task_sleep(UInt32 ticks) {
+    struct timespec t;
+    uint64_t us = (uint64_t)ticks * Clock_tickPeriod;
+
+    t.tv_sec = us / 1000000;
+    t.tv_nsec = (us % 1000000) * 1000;
+    while (nanosleep(&t, &t) != 0) {
+    }
+}
+
+void Task_yield(void) {
+    sched_yield();
+}
+
+UInt64 Task_hostCpuTime(Task_Handle task) {
+    clockid_t clock;
+    struct timespec t;
+
+    if (!task->running || pthread_getcpuclockid(task->thread, &clock) != 0 ||
+            clock_gettime(clock, &t) != 0) {
+        return 0;
+    }
+
+    return (UInt64)t.tv_sec * 1000000 + t.tv_nsec / 1000;
+}
+
+
+/* Clock */
+
+UInt32 Clock_tickPeriod = 10;
+
+/*
+ * Clock functions are called from one thread, like from the Clock Swi on
+ * the device: when they are due, at the earliest.
+ */
+struct Clock_Object {
+    Clock_FuncPtr fxn;
+    UInt32 timeout;
+    UInt32 period;
+    UArg arg;
+    Bool running;
+    UInt32 due;                 // ticks
+    struct Clock_Object *next;
+};
+
+static pthread_mutex_t clockLock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t clockChanged = PTHREAD_COND_INITIALIZER;
+static Clock_Handle clocks = NULL;
+static Bool clockThreadRunning = FALSE;
+
+static void *clockMain(void *arg) {
+    struct timespec deadline;
+    Clock_Handle clock;
+    Clock_Handle next;
+    UInt32 now;
+    uint64_t ns;
+
+    pthread_mutex_lock(&clockLock);
+
+    while (1) {
+        now = Clock_getTicks();
+        next = NULL;
+
+        for (clock = clocks; clock != NULL; clock = clock->next) {
+            if (!clock->running) {
+                continue;
+            }
+
+            if ((Int32)(clock->due - now) <= 0) {
+                if (clock->period > 0) {
+                    clock->due += clock->period;
+                } else {
+                    clock->running = FALSE;
+                }
+
+                pthread_mutex_unlock(&clockLock);
+                clock->fxn(clock->arg);
+                pthread_mutex_lock(&clockLock);
+
+                // the list may have changed
+                next = NULL;
+                break;
+            }
+
+            if (next == NULL || (Int32)(clock->due - next->due) < 0) {
+                next = clock;
+            }
+        }
+
+        if (clock != NULL) {
+            continue;
+        }
+
+        if (next == NULL) {
+            pthread_cond_wait(&clockChanged, &clockLock);
+        } else {
+            clock_gettime(CLOCK_REALTIME, &deadline);
+            ns = (uint64_t)deadline.tv_nsec + (uint64_t)(next->due - now) * Clock_tickPeriod * 1000;
+            deadline.tv_sec += ns / 1000000000;
+            deadline.tv_nsec = ns % 1000000000;
+            pthread_cond_timedwait(&clockChanged, &clockLock, &deadline);
+        }
+    }
+
+    return NULL;
+}
+
+/* Started by BIOS_start(), so programs that never call it stay single threaded */
+static void clockStartThread(void) {
+    pthread_t thread;
+
+    pthread_mutex_lock(&clockLock);
+    if (!clockThreadRunning) {
+        clockThreadRunning = TRUE;
+        pthread_create(&thread, NULL, clockMain, NULL);
+        pthread_detach(thread);
+    }
+    pthread_mutex_unlock(&clockLock);
+}
+
+void Clock_Params_init(Clock_Params *params) {
+    params->period = 0;
+    params->startFlag = FALSE;
+    params->arg = 0;
+}
+
+Clock_Handle Clock_create(Clock_FuncPtr fxn, UInt32 timeout, const Clock_Params *params, void *eb) {
+    Clock_Handle handle = calloc(1, sizeof(*handle));
+    Clock_Params defaults;
+
+    if (params == NULL) {
+        Clock_Params_init(&defaults);
+        params = &defaults;
+    }
+
+    handle->fxn = fxn;
+    handle->timeout = timeout;
+    handle->period = params->period;
+    handle->arg = params->arg;
+
+    pthread_mutex_lock(&clockLock);
+    handle->next = clocks;
+    clocks = handle;
+    pthread_mutex_unlock(&clockLock);
+
+    if (params->startFlag) {
+        Clock_start(handle);
+    }
+
+    return handle;
+}
+
+void Clock_delete(Clock_Handle *handle) {
+    Clock_Handle *p;
+
+    pthread_mutex_lock(&clockLock);
+    for (p = &clocks; *p != NULL; p = &(*p)->next) {
+        if (*p == *handle) {
+            *p = (*handle)->next;
+            break;
+        }
+    }
+    pthread_mutex_unlock(&clockLock);
+
+    free(*handle);
+    *handle = NULL;
+}
+
+void Clock_start(Clock_Handle handle) {
+    pthread_mutex_lock(&clockLock);
+    handle->due = Clock_getTicks() + handle->timeout;
+    handle->running = TRUE;
+    pthread_cond_signal(&clockChanged);
+    pthread_mutex_unlock(&clockLock);
+}
+
+void Clock_stop(Clock_Handle handle) {
+    pthread_mutex_lock(&clockLock);
+    handle->running = FALSE;
+    pthread_mutex_unlock(&clockLock);
+}
+
+void Clock_setTimeout(Clock_Handle handle, UInt32 timeout) {
+    handle->timeout = timeout;
+}
+
+void Clock_setPeriod(Clock_Handle handle, UInt32 period) {
+    handle->period = period;
+}
+
+static uint64_t monotonicUs(void) {
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000 + now.tv_nsec / 1000;
+}
+
+/* Counts from power on (program start), as on the device */
+static uint64_t bootUs;
+
+static void __attribute__((constructor)) clockBoot(void) {
+    bootUs = monotonicUs();
+}
+
+UInt32 Clock_getTicks(void) {
+    return (UInt32)((monotonicUs() - bootUs) / Clock_tickPeriod);
+}
+
+
+/* Semaphore */
+
+struct Semaphore_Object {
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+    Semaphore_Mode mode;
+    Int count;
+};
+
+void Semaphore_Params_init(Semaphore_Params *params) {
+    params->mode = Semaphore_Mode_COUNTING;
+}
+
+Semaphore_Handle Semaphore_create(Int count, const Semaphore_Params *params, void *eb) {
+    Semaphore_Handle handle = calloc(1, sizeof(*handle));
+
+    pthread_mutex_init(&handle->mutex, NULL);
+    pthread_cond_init(&handle->cond, NULL);
+    handle->mode = params ? params->mode : Semaphore_Mode_COUNTING;
+    handle->count = count;
+
+    return handle;
+}
+
+void Semaphore_delete(Semaphore_Handle *handle) {
+    pthread_cond_destroy(&(*handle)->cond);
+    pthread_mutex_destroy(&(*handle)->mutex);
+    free(*handle);
+    *handle = NULL;
+}
+
+Bool Semaphore_pend(Semaphore_Handle handle, UInt32 timeout) {
+    struct timespec deadline;
+    uint64_t ns;
+    Bool ok = TRUE;
+
+    pthread_mutex_lock(&handle->mutex);
+
+    if (timeout != BIOS_WAIT_FOREVER) {
+        clock_gettime(CLOCK_REALTIME, &deadline);
+        ns = (uint64_t)deadline.tv_nsec + (uint64_t)timeout * Clock_tickPeriod * 1000;
+        deadline.tv_sec += ns / 1000000000;
+        deadline.tv_nsec = ns % 1000000000;
+    }
+
+    while (handle->count == 0 && ok) {
+        if (timeout == BIOS_WAIT_FOREVER) {
+            pthread_cond_wait(&handle->cond, &handle->mutex);
+        } else if (timeout == BIOS_NO_WAIT || pthread_cond_timedwait(&handle->cond, &handle->mutex, &deadline) != 0) {
+            ok = (handle->count > 0);
+            break;
+        }
+    }
+
+    if (ok) {
+        --handle->count;
+    }
+
+    pthread_mutex_unlock(&handle->mutex);
+
+    return ok;
+}
+
+void Semaphore_post(Semaphore_Handle handle) {
+    pthread_mutex_lock(&handle->mutex);
+
+    if (handle->mode == Semaphore_Mode_BINARY) {
+        handle->count = 1;
+    } else {
+        ++handle->count;
+    }
+
+    pthread_cond_signal(&handle->cond);
+    pthread_mutex_unlock(&handle->mutex);
+}
+
+Int Semaphore_getCount(Semaphore_Handle handle) {
+    return handle->count;
+}
+
+
+/* Hwi */
+
+struct Hwi_Object {
+    Hwi_FuncPtr fxn;
+    UArg arg;
+};
+
+static struct Hwi_Object hwis[MAX_HWIS];
+static pthread_mutex_t hwiLock = PTHREAD_RECURSIVE_MUTEX_INITIALIZER_NP;
+
+void Hwi_Params_init(Hwi_Params *params) {
+    params->arg = 0;
+    params->priority = -1;
+}
+
+Hwi_Handle Hwi_create(Int intNum, Hwi_FuncPtr fxn, const Hwi_Params *params, void *eb) {
+    if (intNum < 0 || intNum >= MAX_HWIS) {
+        return NULL;
+    }
+
+    hwis[intNum].fxn = fxn;
+    hwis[intNum].arg = params ? params->arg : 0;
+
+    return &hwis[intNum];
+}
+
+/*
+ * Interrupts run one at a time, but tasks are not stopped meanwhile (see
+ * Task.h).
+ */
+UInt Hwi_disable(void) {
+    pthread_mutex_lock(&hwiLock);
+    return 0;
+}
+
+void Hwi_restore(UInt key) {
+    pthread_mutex_unlock(&hwiLock);
+}
+
+void Hwi_hostPost(Int intNum) {
+    if (intNum >= 0 && intNum < MAX_HWIS && hwis[intNum].fxn != NULL) {
+        Hwi_disable();
+        hwis[intNum].fxn(hwis[intNum].arg);
+        Hwi_restore(0);
+    }
+}
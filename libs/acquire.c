@@ -0,0 +1,263 @@
+ /**************************************************************
+  * 
+  *   _   _           _        _        ____    ___  
+  *  | | | |_ __  ___| |_ __ _(_)_ __  |___ \  / _ \ 
+  *  | | | | '_ \/ __| __/ _` | | '__|   __) || | | |
+  *  | |_| | |_) \__ \ || (_| | | |     / __/ | |_| |
+  *   \___/| .__/|___/\__\__,_|_|_|    |_____(_)___/ 
+  *        |_| Miika Sikala, Oulun Yliopisto, 2018
+  * 
+  * 
+  * ************************************************************
+  * THE BEER-WARE LICENSE
+  * This file is part of Upstair 2.0 software. As long as you retain this notice you
+  * can do whatever you want with this stuff. If we meet some day, and you think
+  * this stuff is worth it, you can buy me a beer in return.
+  * 
+  * Miika Sikala
+  * ************************************************************
+  */
+  
+/* Standard libs */
+#include <stdio.h>
+#include <string.h>
+
+#include "libs/acquire.h"
+#include "libs/energy.h"
+#include "libs/diag.h"
+
+#include <xdc/std.h>
+#include <xdc/runtime/System.h>
+
+#include "Board.h"
+
+
+
+/*******************************
+ *        DEFINITIONS          *
+ ******************************/
+
+// time @a is at or after @b (ms), across the wrap of the clock
+#define AT_OR_AFTER(a, b) ((int32_t)((a) - (b)) >= 0)
+
+typedef struct {
+    uint16_t period;            // ms, may differ from the table (ACQ_setPeriod())
+    uint32_t due;               // ms, start of the period being sampled
+    uint32_t ready;             // ms, when the triggered conversion is done
+    uint8_t pending;            // triggered, not collected yet
+    AcqStats stats;
+} Slot;
+
+static const unsigned int busIndex[ACQ_BUSES] = {
+    Board_I2C0,
+    Board_I2C
+};
+
+static const AcqSensor *table;
+static uint8_t sensorCount = 0;
+static Slot slots[ACQ_SENSORS_MAX];
+static I2C_Params *busParams[ACQ_BUSES];
+
+static uint32_t opens = 0;              // times a bus was opened
+static uint32_t transfers = 0;          // triggers and collects
+
+
+
+/*******************************
+ *          FUNCTIONS          *
+ ******************************/
+
+
+/**
+ * Start the schedule.
+ * 
+ * @param   sensors     at most ACQ_SENSORS_MAX; indices of the table are
+ *                      the bits of ACQ_run()
+ * @param   params      of each bus, kept
+ * @param   now         ms
+ */
+void ACQ_init(const AcqSensor *sensors, uint8_t count, I2C_Params *params[ACQ_BUSES], uint32_t now) {
+    uint8_t i;
+    
+    table = sensors;
+    sensorCount = count < ACQ_SENSORS_MAX ? count : ACQ_SENSORS_MAX;
+    memcpy(busParams, params, sizeof(busParams));
+    
+    memset(slots, 0, sizeof(slots));
+    for (i = 0; i < sensorCount; i++) {
+        slots[i].period = table[i].period;
+    }
+    opens = transfers = 0;
+    
+    ACQ_resync(now);
+}
+
+/* Anything to do on @bus */
+static uint8_t hasWork(uint8_t bus, uint32_t now) {
+    uint8_t i;
+    
+    for (i = 0; i < sensorCount; i++) {
+        if (table[i].bus == bus && AT_OR_AFTER(now, slots[i].pending ? slots[i].ready : slots[i].due)) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/* Read the result of sensor @i: how late it was, and on to the next period */
+static void collect(uint8_t i, I2C_Handle *i2c, uint32_t now) {
+    Slot *slot = &slots[i];
+    uint8_t ok = table[i].collect(i2c);
+    uint32_t late = now - (slot->due + (table[i].trigger ? table[i].latency : 0));
+    
+    transfers++;
+    slot->pending = 0;
+    
+    if (ok) {
+        slot->stats.samples++;
+        slot->stats.jitter = late < 0xFFFF ? late : 0xFFFF;
+        slot->stats.jitterSum += slot->stats.jitter;
+        if (slot->stats.jitter > slot->stats.jitterMax) {
+            slot->stats.jitterMax = slot->stats.jitter;
+        }
+    } else {
+        slot->stats.failed++;
+    }
+    
+    // the next one should have started already
+    if (AT_OR_AFTER(now, slot->due + slot->period)) {
+        slot->stats.missed++;
+    }
+    slot->due += slot->period;
+}
+
+/* Sensor @i is due: skip the periods it is too late for, then trigger it.
+ * @return 1 if it was read instead */
+static uint8_t start(uint8_t i, I2C_Handle *i2c, uint32_t now) {
+    Slot *slot = &slots[i];
+    uint32_t behind = (now - slot->due) / slot->period;
+    
+    if (behind > 0) {
+        slot->stats.missed += behind;
+        slot->due += behind * slot->period;
+    }
+    
+    if (table[i].trigger == NULL) {
+        collect(i, i2c, now);
+        return 1;
+    }
+    
+    transfers++;
+    if (table[i].trigger(i2c)) {
+        slot->pending = 1;
+        slot->ready = now + table[i].latency;
+    } else {
+        slot->stats.failed++;
+        slot->due += slot->period;
+    }
+    
+    return 0;
+}
+
+/**
+ * Collect the conversions that are done and trigger the sensors that are
+ * due, a bus at a time. Call on every loop.
+ * 
+ * @param   now     ms
+ * @return  A bit per sensor read on this run; a collect function that
+ *          failed says so in what it read
+ */
+uint16_t ACQ_run(uint32_t now) {
+    uint16_t results = 0;
+    I2C_Handle i2c;
+    uint8_t bus, i;
+    
+    for (bus = 0; bus < ACQ_BUSES; bus++) {
+        if (!hasWork(bus, now)) {
+            continue;
+        }
+        
+        i2c = I2C_open(busIndex[bus], busParams[bus]);
+        if (i2c == NULL) {
+            System_abort("Error Initializing I2C\n");
+        }
+        ENERGY_on(EN_I2C);
+        opens++;
+        
+        // the results first: a sensor is triggered again on the same run
+        for (i = 0; i < sensorCount; i++) {
+            if (table[i].bus == bus && slots[i].pending && AT_OR_AFTER(now, slots[i].ready)) {
+                collect(i, &i2c, now);
+                results |= 1 << i;
+            }
+        }
+        for (i = 0; i < sensorCount; i++) {
+            if (table[i].bus == bus && !slots[i].pending && AT_OR_AFTER(now, slots[i].due)
+                    && start(i, &i2c, now)) {
+                results |= 1 << i;
+            }
+        }
+        
+        I2C_close(i2c);
+        ENERGY_off(EN_I2C);
+    }
+    
+    return results;
+}
+
+/**
+ * Sample @sensor every @period ms from now on. A shorter period starts
+ * within it, in step with the old one.
+ * 
+ * @param   now     ms
+ */
+void ACQ_setPeriod(uint8_t sensor, uint16_t period, uint32_t now) {
+    Slot *slot = &slots[sensor];
+    
+    slot->period = period;
+    while (!slot->pending && AT_OR_AFTER(slot->due - period, now)) {
+        slot->due -= period;
+    }
+}
+
+/**
+ * Start over from @now, after the sensors were not sampled for a while
+ * (standby): conversions in progress are dropped and the time in between is
+ * not counted as missed.
+ */
+void ACQ_resync(uint32_t now) {
+    uint8_t i;
+    
+    for (i = 0; i < sensorCount; i++) {
+        slots[i].pending = 0;
+        slots[i].due = now + table[i].offset;
+    }
+}
+
+const AcqStats *ACQ_stats(uint8_t sensor) {
+    return &slots[sensor].stats;
+}
+
+/**
+ * Print for each sensor the period, results read, mean and maximum jitter
+ * and the periods missed, then how well the transfers were packed on the
+ * buses.
+ */
+void ACQ_dump() {
+    char line[DIAG_LINE_LEN];
+    const AcqStats *stats;
+    uint8_t i;
+    
+    for (i = 0; i < sensorCount; i++) {
+        stats = &slots[i].stats;
+        sprintf(line, "ACQ %.4s %u ms: %lu, jitter %u/%u ms, %u missed %u failed",
+            table[i].name, slots[i].period, (unsigned long)stats->samples,
+            (uint16_t)(stats->samples ? stats->jitterSum / stats->samples : 0), stats->jitterMax,
+            stats->missed, stats->failed);
+        DIAG_print(line);
+    }
+    
+    sprintf(line, "ACQ %lu transfers, buses opened %lu times", (unsigned long)transfers,
+        (unsigned long)opens);
+    DIAG_print(line);
+}
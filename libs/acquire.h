@@ -0,0 +1,89 @@
+ /**************************************************************
+  * 
+  *   _   _           _        _        ____    ___  
+  *  | | | |_ __  ___| |_ __ _(_)_ __  |___ \  / _ \ 
+  *  | | | | '_ \/ __| __/ _` | | '__|   __) || | | |
+  *  | |_| | |_) \__ \ || (_| | | |     / __/ | |_| |
+  *   \___/| .__/|___/\__\__,_|_|_|    |_____(_)___/ 
+  *        |_| Miika Sikala, Oulun Yliopisto, 2018
+  * 
+  * 
+  * ************************************************************
+  * THE BEER-WARE LICENSE
+  * This file is part of Upstair 2.0 software. As long as you retain this notice you
+  * can do whatever you want with this stuff. If we meet some day, and you think
+  * this stuff is worth it, you can buy me a beer in return.
+  * 
+  * Miika Sikala
+  * ************************************************************
+  */
+  
+#ifndef UPSTAIR_ACQUIRE_H
+#define UPSTAIR_ACQUIRE_H
+
+/* Standard libs */
+#include <inttypes.h>
+
+/* TI-RTOS Header files */
+#include <ti/drivers/I2C.h>
+
+#include "upstair.h"
+
+/*
+ * Acquisition scheduler of the I2C sensors. Each sensor declares its
+ * period, how long a conversion takes and the bus it is on; ACQ_run() is
+ * called on every main loop and does what is due:
+ * 
+ *   - the results of conversions that are done are collected, then the
+ *     sensors that are due are triggered (or read, if they convert on their
+ *     own); a conversion is never waited for, it is collected on a later
+ *     run
+ *   - the work is packed per bus: a bus is opened once per run for all of
+ *     its sensors. The buses are pin configurations of the one I2C
+ *     peripheral, only one can be open at a time.
+ * 
+ * A sensor is due on a steady clock: every period from its offset, however
+ * late the previous one was. How late each result is read (jitter) and the
+ * periods that were missed are counted, see ACQ_dump().
+ */
+
+/* Pin configurations of the I2C peripheral */
+typedef enum {
+    ACQ_BUS_SENSORS,            // Board_I2C0: the BMP280, OPT3001, HDC1000, TMP007
+    ACQ_BUS_MPU,                // Board_I2C: the MPU9250 on its own pins
+    ACQ_BUSES
+} AcqBus;
+
+/* A transfer on the open bus, 1 if it went through */
+typedef uint8_t (*AcqFxn)(I2C_Handle *i2c);
+
+typedef struct {
+    const char *name;           // up to 4 characters are shown
+    AcqBus bus;
+    uint16_t period;            // ms
+    uint16_t latency;           // ms, from the trigger to the result
+    uint16_t offset;            // ms, of the first one: spreads sensors of the same period
+    AcqFxn trigger;             // start a conversion, NULL if the sensor converts on its own
+    AcqFxn collect;             // read the result
+} AcqSensor;
+
+typedef struct {
+    uint32_t samples;           // results collected
+    uint16_t missed;            // periods without a result by the next one's start
+    uint16_t failed;            // transfers that did not go through
+    uint16_t jitter;            // ms, the latest result: how late it was read
+    uint16_t jitterMax;         // ms
+    uint32_t jitterSum;         // ms, for the mean
+} AcqStats;
+
+
+/* Public functions */
+
+void ACQ_init(const AcqSensor *sensors, uint8_t count, I2C_Params *params[ACQ_BUSES], uint32_t now);
+uint16_t ACQ_run(uint32_t now);
+void ACQ_setPeriod(uint8_t sensor, uint16_t period, uint32_t now);
+void ACQ_resync(uint32_t now);
+const AcqStats *ACQ_stats(uint8_t sensor);
+void ACQ_dump();
+
+#endif /* UPSTAIR_ACQUIRE_H */
@@ -0,0 +1,96 @@
+ /**************************************************************
+  * 
+  *   _   _           _        _        ____    ___  
+  *  | | | |_ __  ___| |_ __ _(_)_ __  |___ \  / _ \ 
+  *  | | | | '_ \/ __| __/ _` | | '__|   __) || | | |
+  *  | |_| | |_) \__ \ || (_| | | |     / __/ | |_| |
+  *   \___/| .__/|___/\__\__,_|_|_|    |_____(_)___/ 
+  *        |_| Miika Sikala, Oulun Yliopisto, 2018
+  * 
+  * 
+  * ************************************************************
+  * THE BEER-WARE LICENSE
+  * This file is part of Upstair 2.0 software. As long as you retain this notice you
+  * can do whatever you want with this stuff. If we meet some day, and you think
+  * this stuff is worth it, you can buy me a beer in return.
+  * 
+  * Miika Sikala
+  * ************************************************************
+  */
+  
+/* Standard libs */
+#include <stdio.h>
+#include <string.h>
+
+#include "libs/ambient.h"
+#include "libs/diag.h"
+
+
+
+/*******************************
+ *        DEFINITIONS          *
+ ******************************/
+
+static AmbState state;
+
+
+
+/*******************************
+ *          FUNCTIONS          *
+ ******************************/
+
+
+/**
+ * Start light, until the first reading.
+ */
+void AMB_init() {
+    memset(&state, 0, sizeof(state));
+}
+
+/**
+ * A new light reading, when it left the window (or the first one). Moves
+ * the window around it.
+ * 
+ * @param   lux     0.01 lux
+ * @return  1 if it went dark or light
+ */
+uint8_t AMB_sample(uint32_t lux) {
+    uint32_t margin = lux / 100 * AMB_HYSTERESIS;
+    uint8_t dark = state.dark;
+    
+    if (margin < AMB_MIN_CHANGE * 100UL) {
+        margin = AMB_MIN_CHANGE * 100UL;
+    }
+    
+    if (state.valid) {
+        state.changes++;
+    }
+    state.valid = 1;
+    state.lux = lux;
+    state.low = lux > margin ? lux - margin : 0;
+    state.high = lux + margin;
+    
+    if (lux < AMB_DARK_LUX * 100UL) {
+        state.dark = 1;
+    } else if (lux > AMB_LIGHT_LUX * 100UL) {
+        state.dark = 0;
+    }
+    
+    return state.dark != dark;
+}
+
+const AmbState *AMB_state() {
+    return &state;
+}
+
+/**
+ * Print the light, its window and how often it has changed.
+ */
+void AMB_dump() {
+    char line[DIAG_LINE_LEN];
+    
+    sprintf(line, "AMB %lu lux (%lu-%lu)%s, %u changes", (unsigned long)(state.lux / 100),
+        (unsigned long)(state.low / 100), (unsigned long)(state.high / 100),
+        state.dark ? " dark" : "", state.changes);
+    DIAG_print(line);
+}
@@ -0,0 +1,63 @@
+ /**************************************************************
+  * 
+  *   _   _           _        _        ____    ___  
+  *  | | | |_ __  ___| |_ __ _(_)_ __  |___ \  / _ \ 
+  *  | | | | '_ \/ __| __/ _` | | '__|   __) || | | |
+  *  | |_| | |_) \__ \ || (_| | | |     / __/ | |_| |
+  *   \___/| .__/|___/\__\__,_|_|_|    |_____(_)___/ 
+  *        |_| Miika Sikala, Oulun Yliopisto, 2018
+  * 
+  * 
+  * ************************************************************
+  * THE BEER-WARE LICENSE
+  * This file is part of Upstair 2.0 software. As long as you retain this notice you
+  * can do whatever you want with this stuff. If we meet some day, and you think
+  * this stuff is worth it, you can buy me a beer in return.
+  * 
+  * Miika Sikala
+  * ************************************************************
+  */
+  
+#ifndef UPSTAIR_AMBIENT_H
+#define UPSTAIR_AMBIENT_H
+
+/* Standard libs */
+#include <inttypes.h>
+
+#include "upstair.h"
+
+/*
+ * Ambient light from the OPT3001, and what the display makes of it.
+ * 
+ * The sensor compares every conversion with a window around the last light
+ * read and latches a flag when it is outside. Only then is the light read
+ * again and the window moved around it: AMB_HYSTERESIS percent each way,
+ * at least AMB_MIN_CHANGE lux. While the light stays about the same, a
+ * poll is a single status read.
+ * 
+ * Below AMB_DARK_LUX the device is taken to be in a pocket or a bag, and
+ * the screen is not redrawn on its own (buttons still redraw it). Above
+ * AMB_LIGHT_LUX it is redrawn again. The memory LCD has no backlight, so
+ * not drawing is what saves.
+ * 
+ * Integer math only, the light in 0.01 lux.
+ */
+
+typedef struct {
+    uint32_t lux;               // 0.01 lux, the latest light read
+    uint32_t low;               // 0.01 lux, the window around it
+    uint32_t high;
+    uint8_t valid;              // read at least once
+    uint8_t dark;               // in a pocket, no frames
+    uint16_t changes;           // times the light was outside the window
+} AmbState;
+
+
+/* Public functions */
+
+void AMB_init();
+uint8_t AMB_sample(uint32_t lux);
+const AmbState *AMB_state();
+void AMB_dump();
+
+#endif /* UPSTAIR_AMBIENT_H */
@@ -0,0 +1,140 @@
+ /**************************************************************
+  * 
+  *   _   _           _        _        ____    ___  
+  *  | | | |_ __  ___| |_ __ _(_)_ __  |___ \  / _ \ 
+  *  | | | | '_ \/ __| __/ _` | | '__|   __) || | | |
+  *  | |_| | |_) \__ \ || (_| | | |     / __/ | |_| |
+  *   \___/| .__/|___/\__\__,_|_|_|    |_____(_)___/ 
+  *        |_| Miika Sikala, Oulun Yliopisto, 2018
+  * 
+  * 
+  * ************************************************************
+  * THE BEER-WARE LICENSE
+  * This file is part of Upstair 2.0 software. As long as you retain this notice you
+  * can do whatever you want with this stuff. If we meet some day, and you think
+  * this stuff is worth it, you can buy me a beer in return.
+  * 
+  * Miika Sikala
+  * ************************************************************
+  */
+  
+#include "libs/anim.h"
+#include "libs/lcd.h"
+
+
+
+/*******************************
+ *          FUNCTIONS          *
+ ******************************/
+
+
+/**
+ * Start playing an animation. The first frame (forwards) or the last frame
+ * (backwards) must already be drawn at @x, @y.
+ * 
+ * @player  Player state
+ * @anim    Animation to play
+ * @x       Left edge on the screen
+ * @y       Top edge on the screen
+ * @dir     1 to play forwards, -1 backwards
+ */
+void ANIM_start(AnimPlayer *player, const Animation *anim, int16_t x, int16_t y, int8_t dir) {
+    
+    player->anim = anim;
+    player->x = x;
+    player->y = y;
+    player->dir = dir;
+    player->frame = (dir > 0) ? 0 : anim->count - 1;
+    player->ticksLeft = anim->frames[player->frame].ticks;
+    
+}
+
+/**
+ * Turn around in the middle of an animation (e.g. the change it was showing
+ * was cancelled). Does nothing if the animation has stopped.
+ */
+void ANIM_reverse(AnimPlayer *player) {
+    player->dir = -player->dir;
+}
+
+/**
+ * Stop the animation where it is.
+ */
+void ANIM_stop(AnimPlayer *player) {
+    player->dir = 0;
+}
+
+/**
+ * Returns 1 if the animation is still playing.
+ */
+uint8_t ANIM_isRunning(const AnimPlayer *player) {
+    return player->anim != NULL && player->dir != 0;
+}
+
+/**
+ * Invert the pixels of a frame delta on the screen.
+ */
+static void applyDelta(const AnimPlayer *player, const AnimFrame *delta) {
+    
+    if (delta->w == 0) {
+        return;
+    }
+    
+    LCD_blit(player->x + delta->x, player->y + delta->y, delta->w, delta->h, delta->bits, LCD_BLIT_XOR);
+}
+
+/**
+ * Advance the animation by one main loop round. Returns 1 if the frame
+ * buffer changed and needs a flush.
+ */
+uint8_t ANIM_tick(AnimPlayer *player) {
+    const Animation *anim = player->anim;
+    uint8_t last;
+    
+    if (!ANIM_isRunning(player)) {
+        return 0;
+    }
+    
+    if (player->ticksLeft > 1) {
+        --player->ticksLeft;
+        return 0;
+    }
+    
+    last = anim->count - 1;
+    
+    // reached an end
+    if ((player->dir > 0 && player->frame == last) || (player->dir < 0 && player->frame == 0)) {
+        
+        switch(anim->loop) {
+            
+            case ANIM_ONCE:
+                player->dir = 0;
+                return 0;
+                
+            case ANIM_LOOP:
+                
+                // frames[0] wraps around in both directions
+                applyDelta(player, &anim->frames[0]);
+                player->frame = (player->dir > 0) ? 0 : last;
+                player->ticksLeft = anim->frames[player->frame].ticks;
+                return 1;
+                
+            case ANIM_PINGPONG:
+                player->dir = -player->dir;
+                break;
+        }
+    }
+    
+    // frames[i] is the difference between frames i - 1 and i, both ways
+    if (player->dir > 0) {
+        ++player->frame;
+        applyDelta(player, &anim->frames[player->frame]);
+    } else {
+        applyDelta(player, &anim->frames[player->frame]);
+        --player->frame;
+    }
+    
+    player->ticksLeft = anim->frames[player->frame].ticks;
+    
+    return 1;
+}
@@ -0,0 +1,55 @@
+ /**************************************************************
+  * 
+  *   _   _           _        _        ____    ___  
+  *  | | | |_ __  ___| |_ __ _(_)_ __  |___ \  / _ \ 
+  *  | | | | '_ \/ __| __/ _` | | '__|   __) || | | |
+  *  | |_| | |_) \__ \ || (_| | | |     / __/ | |_| |
+  *   \___/| .__/|___/\__\__,_|_|_|    |_____(_)___/ 
+  *        |_| Miika Sikala, Oulun Yliopisto, 2018
+  * 
+  * 
+  * ************************************************************
+  * THE BEER-WARE LICENSE
+  * This file is part of Upstair 2.0 software. As long as you retain this notice you
+  * can do whatever you want with this stuff. If we meet some day, and you think
+  * this stuff is worth it, you can buy me a beer in return.
+  * 
+  * Miika Sikala
+  * ************************************************************
+  */
+  
+#ifndef UPSTAIR_ANIM_H
+#define UPSTAIR_ANIM_H
+
+/* Standard libs */
+#include <inttypes.h>
+
+#include "upstair.h"
+#include "bitmaps/anim.h"
+
+/*
+ * Plays animations made of XOR deltas (see bitmaps/anim.h). The first or
+ * the last frame has to be on the screen already; after that ANIM_tick()
+ * only inverts the pixels that change between frames.
+ */
+
+/* State of one animation on the screen */
+typedef struct {
+    const Animation *anim;
+    int16_t x;              // where the animation is on the screen
+    int16_t y;
+    uint8_t frame;          // frame on the screen now
+    uint8_t ticksLeft;      // until the next frame
+    int8_t dir;             // 1 forwards, -1 backwards, 0 stopped
+} AnimPlayer;
+
+
+/* Public functions */
+
+void ANIM_start(AnimPlayer *player, const Animation *anim, int16_t x, int16_t y, int8_t dir);
+void ANIM_reverse(AnimPlayer *player);
+void ANIM_stop(AnimPlayer *player);
+uint8_t ANIM_isRunning(const AnimPlayer *player);
+uint8_t ANIM_tick(AnimPlayer *player);
+
+#endif /* UPSTAIR_ANIM_H */
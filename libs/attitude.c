@@ -0,0 +1,313 @@
+ /**************************************************************
+  * 
+  *   _   _           _        _        ____    ___  
+  *  | | | |_ __  ___| |_ __ _(_)_ __  |___ \  / _ \ 
+  *  | | | | '_ \/ __| __/ _` | | '__|   __) || | | |
+  *  | |_| | |_) \__ \ || (_| | | |     / __/ | |_| |
+  *   \___/| .__/|___/\__\__,_|_|_|    |_____(_)___/ 
+  *        |_| Miika Sikala, Oulun Yliopisto, 2018
+  * 
+  * 
+  * ************************************************************
+  * THE BEER-WARE LICENSE
+  * This file is part of Upstair 2.0 software. As long as you retain this notice you
+  * can do whatever you want with this stuff. If we meet some day, and you think
+  * this stuff is worth it, you can buy me a beer in return.
+  * 
+  * Miika Sikala
+  * ************************************************************
+  */
+  
+/* Standard libs */
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "libs/attitude.h"
+#include "libs/diag.h"
+
+
+
+/*******************************
+ *        DEFINITIONS          *
+ ******************************/
+
+#define ONE (1L << 30)                  // 1.0 in Q30
+#define G_ONE (1L << 24)                // 1 g in Q24
+#define GYRO_SHIFT 10                   // gyroK is Q40
+#define SUM_SHIFT 8                     // the sums are Q16 g
+#define SUM_MAX 4000
+#define RAD_PER_DEG 0.01745329f
+
+static int32_t q[4] = { ONE, 0, 0, 0 }; // body to earth, Q30
+static uint8_t started = 0;             // 0 until the first sample sets the tilt
+
+static int32_t accelK;                  // Q24 g per LSB
+static int32_t accelBiasQ[3];           // Q24 g
+static int32_t gyroK;                   // half angle per sample per LSB, Q40
+static int32_t corrK;                   // ATT_KP half angle per sample, Q30
+static int32_t gateMin, gateMax;        // |a|^2 where the accelerometer is trusted, Q24 g^2
+
+static int32_t vertical = 0;            // of the latest sample, Q24 g
+static int32_t sum[3];                  // linear acceleration since ATT_linear(), Q16 g
+static uint16_t count = 0;
+
+static uint32_t samples = 0;            // for the diagnostics
+static uint32_t rejected = 0;           // samples not corrected, too much acceleration
+
+
+
+/*******************************
+ *          FUNCTIONS          *
+ ******************************/
+
+
+/**
+ * Q30 multiplication: one SMULL and a shift.
+ */
+static inline int32_t mul(int32_t a, int32_t b) {
+    return (int32_t)(((int64_t)a * b) >> 30);
+}
+
+/**
+ * Set the constants for the sensor. Floats here only.
+ * 
+ * @param   rate        samples per second
+ * @param   aRes        g per accelerometer LSB
+ * @param   gRes        dps per gyro LSB
+ * @param   accelBias   g, removed from the accelerometer
+ */
+void ATT_init(uint16_t rate, float aRes, float gRes, const float *accelBias) {
+    float gate;
+    
+    accelK = lroundf(aRes * G_ONE);
+    gyroK = lroundf(gRes * RAD_PER_DEG / (2.0f * rate) * (float)(1LL << 40));
+    corrK = lroundf(ATT_KP / (2.0f * rate) * (float)ONE * (float)(ONE / G_ONE));
+    
+    gate = (100 - ATT_GATE) / 100.0f;
+    gateMin = lroundf(gate * gate * G_ONE);
+    gate = (100 + ATT_GATE) / 100.0f;
+    gateMax = lroundf(gate * gate * G_ONE);
+    
+    ATT_setBias(accelBias);
+    ATT_reset();
+}
+
+/**
+ * Change the accelerometer bias, e.g. after the drift is corrected.
+ */
+void ATT_setBias(const float *accelBias) {
+    uint8_t i;
+    
+    for (i = 0; i < 3; i++) {
+        accelBiasQ[i] = lroundf(accelBias[i] * G_ONE);
+    }
+}
+
+/**
+ * Forget the attitude, the next sample sets the tilt from gravity.
+ */
+void ATT_reset() {
+    
+    started = 0;
+    vertical = 0;
+    memset(sum, 0, sizeof(sum));
+    count = 0;
+}
+
+/**
+ * Tilt from the first sample: the shortest rotation from the measured
+ * gravity to the earth's z axis. The heading is arbitrary.
+ */
+static void start(const int32_t *a) {
+    float u[3];
+    float n, w;
+    uint8_t i;
+    
+    for (i = 0; i < 3; i++) {
+        u[i] = (float)a[i] / G_ONE;
+    }
+    
+    n = sqrtf(u[0] * u[0] + u[1] * u[1] + u[2] * u[2]);
+    if (n < 0.1f) {
+        return;     // free fall, wait for gravity
+    }
+    
+    // upside down: half a turn about x
+    if (u[2] / n < -0.999f) {
+        q[0] = 0;
+        q[1] = ONE;
+        q[2] = 0;
+        q[3] = 0;
+        started = 1;
+        return;
+    }
+    
+    // (1 + u.z, u x z), normalised
+    w = 1.0f + u[2] / n;
+    n = sqrtf(2.0f * w) * n;
+    q[0] = lroundf(w * (float)ONE / sqrtf(2.0f * w));
+    q[1] = lroundf(u[1] / n * (float)ONE);
+    q[2] = lroundf(-u[0] / n * (float)ONE);
+    q[3] = 0;
+    started = 1;
+}
+
+/**
+ * Update the attitude with a sample.
+ * 
+ * @param   raw     ax, ay, az, gx, gy, gz, unscaled (like in the MPU9250)
+ */
+void ATT_sample(const int16_t *raw) {
+    int32_t a[3];
+    int32_t h[3];
+    int32_t v[3];
+    int32_t lin[3];
+    int32_t q0q1, q0q2, q0q3, q1q1, q1q2, q1q3, q2q2, q2q3, q3q3;
+    int32_t q0, q1, q2, q3;
+    int32_t norm2, n;
+    uint8_t i;
+
+    
+    for (i = 0; i < 3; i++) {
+        a[i] = raw[i] * accelK - accelBiasQ[i];
+    }
+    
+    if (!started) {
+        start(a);
+        if (!started) {
+            return;
+        }
+    }
+    
+    q0 = q[0];
+    q1 = q[1];
+    q2 = q[2];
+    q3 = q[3];
+    
+    q0q1 = mul(q0, q1);
+    q0q2 = mul(q0, q2);
+    q0q3 = mul(q0, q3);
+    q1q1 = mul(q1, q1);
+    q1q2 = mul(q1, q2);
+    q1q3 = mul(q1, q3);
+    q2q2 = mul(q2, q2);
+    q2q3 = mul(q2, q3);
+    q3q3 = mul(q3, q3);
+    
+    // gravity in the body frame: the third row of the rotation
+    v[0] = 2 * (q1q3 - q0q2);
+    v[1] = 2 * (q2q3 + q0q1);
+    v[2] = ONE - 2 * (q1q1 + q2q2);
+    
+    // acceleration in the earth frame (Q24), without gravity
+    lin[0] = mul(ONE - 2 * (q2q2 + q3q3), a[0]) + mul(2 * (q1q2 - q0q3), a[1]) + mul(2 * (q1q3 + q0q2), a[2]);
+    lin[1] = mul(2 * (q1q2 + q0q3), a[0]) + mul(ONE - 2 * (q1q1 + q3q3), a[1]) + mul(2 * (q2q3 - q0q1), a[2]);
+    lin[2] = mul(v[0], a[0]) + mul(v[1], a[1]) + mul(v[2], a[2]) - G_ONE;
+    vertical = lin[2];
+    
+    // the sums hold SUM_MAX samples at 8 g, keep the mean if not read
+    if (count == SUM_MAX) {
+        for (i = 0; i < 3; i++) {
+            sum[i] /= 2;
+        }
+        count /= 2;
+    }
+    for (i = 0; i < 3; i++) {
+        sum[i] += lin[i] >> SUM_SHIFT;
+    }
+    ++count;
+    ++samples;
+    
+    // rotation of this sample from the gyro (half angles, Q30)
+    for (i = 0; i < 3; i++) {
+        h[i] = (int32_t)(((int64_t)raw[3 + i] * gyroK) >> GYRO_SHIFT);
+    }
+    
+    // turned towards gravity when the accelerometer measures mostly it:
+    // the error is the cross product of the measured and the estimated
+    norm2 = (int32_t)(((int64_t)a[0] * a[0] + (int64_t)a[1] * a[1] + (int64_t)a[2] * a[2]) >> 24);
+    if (norm2 >= gateMin && norm2 <= gateMax) {
+        h[0] += mul(mul(a[1], v[2]) - mul(a[2], v[1]), corrK);
+        h[1] += mul(mul(a[2], v[0]) - mul(a[0], v[2]), corrK);
+        h[2] += mul(mul(a[0], v[1]) - mul(a[1], v[0]), corrK);
+    } else {
+        ++rejected;
+    }
+    
+    // q += q * (0, h)
+    q[0] = q0 - mul(q1, h[0]) - mul(q2, h[1]) - mul(q3, h[2]);
+    q[1] = q1 + mul(q0, h[0]) + mul(q2, h[2]) - mul(q3, h[1]);
+    q[2] = q2 + mul(q0, h[1]) - mul(q1, h[2]) + mul(q3, h[0]);
+    q[3] = q3 + mul(q0, h[2]) + mul(q1, h[1]) - mul(q2, h[0]);
+    
+    // back to unit length, it is never far from it: 1/sqrt(x) ~ (3 - x) / 2
+    norm2 = mul(q[0], q[0]) + mul(q[1], q[1]) + mul(q[2], q[2]) + mul(q[3], q[3]);
+    n = (3 * (ONE / 2)) - norm2 / 2;
+    for (i = 0; i < 4; i++) {
+        q[i] = mul(q[i], n);
+    }
+}
+
+/**
+ * Mean acceleration in the earth frame, without gravity, since the previous
+ * call: x and y horizontal (heading arbitrary), z up.
+ * 
+ * @param   accel   g, zeros when there were no samples
+ * @return  Number of samples in the mean
+ */
+uint16_t ATT_linear(float *accel) {
+    uint16_t n = count;
+    uint8_t i;
+    
+    for (i = 0; i < 3; i++) {
+        accel[i] = n ? (float)sum[i] / (n * (float)(G_ONE >> SUM_SHIFT)) : 0.0f;
+        sum[i] = 0;
+    }
+    count = 0;
+    
+    return n;
+}
+
+/**
+ * Vertical acceleration of the latest sample, without gravity.
+ * 
+ * @return  mg, up
+ */
+int16_t ATT_vertical() {
+    
+    // * 1000 / G_ONE without overflowing up to 8 g
+    return (int16_t)(((vertical >> 8) * 125) >> 13);
+}
+
+/**
+ * The attitude as w, x, y, z.
+ */
+void ATT_quaternion(float *quat) {
+    uint8_t i;
+    
+    for (i = 0; i < 4; i++) {
+        quat[i] = (float)q[i] / ONE;
+    }
+}
+
+/**
+ * Print the tilt and how often the accelerometer was not trusted.
+ */
+void ATT_dump() {
+    char line[DIAG_LINE_LEN];
+    int32_t up;
+    
+    if (!started) {
+        DIAG_print("ATT not started");
+        return;
+    }
+    
+    // body z in the earth frame
+    up = ONE - 2 * (mul(q[1], q[1]) + mul(q[2], q[2]));
+    
+    sprintf(line, "ATT tilt %d deg, %lu samples, %lu%% uncorrected",
+        (int)lroundf(acosf((float)up / ONE) / RAD_PER_DEG),
+        (unsigned long)samples, (unsigned long)(samples ? (uint64_t)rejected * 100 / samples : 0));
+    DIAG_print(line);
+}
@@ -0,0 +1,58 @@
+ /**************************************************************
+  * 
+  *   _   _           _        _        ____    ___  
+  *  | | | |_ __  ___| |_ __ _(_)_ __  |___ \  / _ \ 
+  *  | | | | '_ \/ __| __/ _` | | '__|   __) || | | |
+  *  | |_| | |_) \__ \ || (_| | | |     / __/ | |_| |
+  *   \___/| .__/|___/\__\__,_|_|_|    |_____(_)___/ 
+  *        |_| Miika Sikala, Oulun Yliopisto, 2018
+  * 
+  * 
+  * ************************************************************
+  * THE BEER-WARE LICENSE
+  * This file is part of Upstair 2.0 software. As long as you retain this notice you
+  * can do whatever you want with this stuff. If we meet some day, and you think
+  * this stuff is worth it, you can buy me a beer in return.
+  * 
+  * Miika Sikala
+  * ************************************************************
+  */
+  
+#ifndef UPSTAIR_ATTITUDE_H
+#define UPSTAIR_ATTITUDE_H
+
+/* Standard libs */
+#include <inttypes.h>
+
+#include "upstair.h"
+
+/*
+ * Attitude of the device, so that the detector sees the same acceleration
+ * however the tag is worn. A complementary filter in the Mahony form: the
+ * gyro turns the orientation (a quaternion) and the accelerometer pulls it
+ * towards gravity with gain ATT_KP, only while the acceleration is close to
+ * 1 g. There is no magnetometer, so the heading drifts freely; only the
+ * vertical and the length of the horizontal are meaningful.
+ * 
+ * Fed with every raw MPU9250 sample (IMU_RATE from the FIFO). Fixed point:
+ * the quaternion is Q30 and the acceleration Q24 g, with 32x32->64 bit
+ * multiplications, the M3 has them in one instruction. No division or
+ * square root per sample.
+ * 
+ * ATT_linear() gives the acceleration in the earth frame with gravity
+ * removed, averaged since the previous call: x and y horizontal, z up.
+ * ATT_vertical() is the z of the latest sample, for the step counter.
+ */
+
+/* Public functions */
+
+void ATT_init(uint16_t rate, float aRes, float gRes, const float *accelBias);
+void ATT_setBias(const float *accelBias);
+void ATT_reset();
+void ATT_sample(const int16_t *raw);
+uint16_t ATT_linear(float *accel);
+int16_t ATT_vertical();
+void ATT_quaternion(float *quat);
+void ATT_dump();
+
+#endif /* UPSTAIR_ATTITUDE_H */
@@ -0,0 +1,158 @@
+ /**************************************************************
+  * 
+  *   _   _           _        _        ____    ___  
+  *  | | | |_ __  ___| |_ __ _(_)_ __  |___ \  / _ \ 
+  *  | | | | '_ \/ __| __/ _` | | '__|   __) || | | |
+  *  | |_| | |_) \__ \ || (_| | | |     / __/ | |_| |
+  *   \___/| .__/|___/\__\__,_|_|_|    |_____(_)___/ 
+  *        |_| Miika Sikala, Oulun Yliopisto, 2018
+  * 
+  * 
+  * ************************************************************
+  * THE BEER-WARE LICENSE
+  * This file is part of Upstair 2.0 software. As long as you retain this notice you
+  * can do whatever you want with this stuff. If we meet some day, and you think
+  * this stuff is worth it, you can buy me a beer in return.
+  * 
+  * Miika Sikala
+  * ************************************************************
+  */
+  
+/* Standard libs */
+#include <math.h>
+#include <string.h>
+
+#include "libs/calib.h"
+#include "upstair.h"
+#include "libs/snapshot.h"
+
+
+
+/*******************************
+ *        DEFINITIONS          *
+ ******************************/
+
+static mpu9250_calibration calibration;
+
+/* Sums over the current window: ax, ay, az, gx, gy, gz */
+static float sum[6];
+static float sumSq[6];
+static uint8_t count = 0;
+
+
+
+/*******************************
+ *          FUNCTIONS          *
+ ******************************/
+
+
+/**
+ * Load the calibration record from the flash.
+ * 
+ * @return  1 if there was a valid one
+ */
+uint8_t CAL_load() {
+    return SNAP_load(SNAP_CALIBRATION, &calibration, sizeof(calibration), CAL_VERSION);
+}
+
+/**
+ * Save the calibration record to the flash.
+ */
+uint8_t CAL_save() {
+    return SNAP_save(SNAP_CALIBRATION, &calibration, sizeof(calibration), CAL_VERSION);
+}
+
+/**
+ * Replace the calibration (after a full calibration). Not saved.
+ */
+void CAL_set(const mpu9250_calibration *cal) {
+    calibration = *cal;
+    count = 0;
+}
+
+const mpu9250_calibration *CAL_get() {
+    return &calibration;
+}
+
+/**
+ * Feed a sample. Corrects the calibration if it has drifted while the device
+ * is still.
+ * 
+ * @data        ax, ay, az (g), gx, gy, gz (dps), with the current biases applied
+ * @temperature Sensor temperature (C)
+ * @now         Timestamp for the record
+ * 
+ * @return  1 if the calibration changed (apply it to the sensor and save)
+ */
+uint8_t CAL_sample(const float *data, float temperature, uint32_t now) {
+    float mean[6];
+    float var;
+    float gravity;
+    uint8_t drift = 0;
+    uint8_t i;
+    
+    for (i = 0; i < 6; ++i) {
+        sum[i] += data[i];
+        sumSq[i] += data[i] * data[i];
+    }
+    
+    if (++count < CAL_WINDOW) {
+        return 0;
+    }
+    
+    // window full, was it still the whole time?
+    for (i = 0; i < 6; ++i) {
+        mean[i] = sum[i] / CAL_WINDOW;
+        var = sumSq[i] / CAL_WINDOW - mean[i] * mean[i];
+        
+        if (var > (i < 3 ? CAL_STILL_ACCEL * CAL_STILL_ACCEL : CAL_STILL_GYRO * CAL_STILL_GYRO)) {
+            break;
+        }
+    }
+    
+    memset(sum, 0, sizeof(sum));
+    memset(sumSq, 0, sizeof(sumSq));
+    count = 0;
+    
+    if (i < 6) {
+        return 0;
+    }
+    
+    // the gyro should read zero, and a lot of warming up changes everything
+    if (fabsf(temperature - calibration.temperature) > CAL_DRIFT_TEMP) {
+        drift = 1;
+    }
+    for (i = 3; i < 6; ++i) {
+        if (fabsf(mean[i]) > CAL_DRIFT_GYRO) {
+            drift = 1;
+        }
+    }
+    
+    // when lying flat, the accelerometer should read 1 g down the z axis.
+    // Only z is corrected: x and y can't tell a bias from a slight tilt,
+    // and within CAL_FLAT_ACCEL the tilt changes z by less than 0.0001 g.
+    gravity = mean[2] > 0 ? 1.0 : -1.0;
+    if (fabsf(mean[0]) < CAL_FLAT_ACCEL && fabsf(mean[1]) < CAL_FLAT_ACCEL
+            && fabsf(mean[2] - gravity) < 0.1) {
+        
+        if (fabsf(mean[2] - gravity) > CAL_DRIFT_ACCEL) {
+            drift = 1;
+        }
+        
+        if (drift) {
+            calibration.accel_bias[2] += mean[2] - gravity;
+        }
+    }
+    
+    if (!drift) {
+        return 0;
+    }
+    
+    calibration.gyro_bias[0] += mean[3];
+    calibration.gyro_bias[1] += mean[4];
+    calibration.gyro_bias[2] += mean[5];
+    calibration.temperature = temperature;
+    calibration.timestamp = now;
+    
+    return 1;
+}
@@ -0,0 +1,61 @@
+ /**************************************************************
+  * 
+  *   _   _           _        _        ____    ___  
+  *  | | | |_ __  ___| |_ __ _(_)_ __  |___ \  / _ \ 
+  *  | | | | '_ \/ __| __/ _` | | '__|   __) || | | |
+  *  | |_| | |_) \__ \ || (_| | | |     / __/ | |_| |
+  *   \___/| .__/|___/\__\__,_|_|_|    |_____(_)___/ 
+  *        |_| Miika Sikala, Oulun Yliopisto, 2018
+  * 
+  * 
+  * ************************************************************
+  * THE BEER-WARE LICENSE
+  * This file is part of Upstair 2.0 software. As long as you retain this notice you
+  * can do whatever you want with this stuff. If we meet some day, and you think
+  * this stuff is worth it, you can buy me a beer in return.
+  * 
+  * Miika Sikala
+  * ************************************************************
+  */
+  
+#ifndef UPSTAIR_CALIB_H
+#define UPSTAIR_CALIB_H
+
+/* Standard libs */
+#include <inttypes.h>
+
+#include "sensors/mpu9250.h"
+
+/*
+ * MPU9250 calibration record, kept on the flash (libs/snapshot.h) so the
+ * sensor doesn't need to be calibrated at every boot.
+ * 
+ * The biases drift with temperature and time. CAL_sample() watches the
+ * samples, and when the device has been still for a whole window it checks
+ * the gyro (it should read zero) and the accelerometer (it should read 1 g
+ * straight down, when lying flat; only its z bias is corrected, x and y
+ * can't be told from a tilt). If they are off, or the temperature has
+ * changed a lot since the calibration, the biases are corrected from the
+ * window, without the sleeps and resets of a full calibration.
+ */
+
+#define CAL_VERSION         1
+#define CAL_WINDOW          50          // samples (5 s at 10 Hz)
+
+#define CAL_STILL_ACCEL     0.01        // max std. deviation when still (g)
+#define CAL_STILL_GYRO      0.3         // max std. deviation when still (dps)
+#define CAL_DRIFT_ACCEL     0.02        // correct accel bias above this (g)
+#define CAL_FLAT_ACCEL      0.01        // max x and y when lying flat (g), below CAL_DRIFT_ACCEL
+#define CAL_DRIFT_GYRO      0.3         // correct gyro bias above this (dps)
+#define CAL_DRIFT_TEMP      5.0         // correct biases after this change (C)
+
+
+/* Public functions */
+
+uint8_t CAL_load();
+uint8_t CAL_save();
+void CAL_set(const mpu9250_calibration *cal);
+const mpu9250_calibration *CAL_get();
+uint8_t CAL_sample(const float *data, float temperature, uint32_t now);
+
+#endif /* UPSTAIR_CALIB_H */
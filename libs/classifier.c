@@ -0,0 +1,186 @@
+ /**************************************************************
+  * 
+  *   _   _           _        _        ____    ___  
+  *  | | | |_ __  ___| |_ __ _(_)_ __  |___ \  / _ \ 
+  *  | | | | '_ \/ __| __/ _` | | '__|   __) || | | |
+  *  | |_| | |_) \__ \ || (_| | | |     / __/ | |_| |
+  *   \___/| .__/|___/\__\__,_|_|_|    |_____(_)___/ 
+  *        |_| Miika Sikala, Oulun Yliopisto, 2018
+  * 
+  * 
+  * ************************************************************
+  * THE BEER-WARE LICENSE
+  * This file is part of Upstair 2.0 software. As long as you retain this notice you
+  * can do whatever you want with this stuff. If we meet some day, and you think
+  * this stuff is worth it, you can buy me a beer in return.
+  * 
+  * Miika Sikala
+  * ************************************************************
+  */
+  
+/* Standard libs */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "libs/classifier.h"
+#include "libs/spectrum.h"
+#include "libs/steps.h"
+#include "libs/vertical.h"
+#include "libs/diag.h"
+
+
+
+/*******************************
+ *        DEFINITIONS          *
+ ******************************/
+
+#define MAX_DEPTH 32                    // nodes visited at most, a broken tree ends there
+
+// 2^(-i/16), Q15
+static const uint16_t exp2Frac[1 << CLS_LOG_FRAC] = {
+    32767, 31379, 30048, 28774, 27554, 26386, 25268, 24196,
+    23170, 22188, 21247, 20347, 19484, 18658, 17867, 17109
+};
+
+static const ClsModel *model = &CLS_model;
+static ClsResult result = { ACT_IDLE, { 100, 0, 0 } };
+
+
+
+/*******************************
+ *          FUNCTIONS          *
+ ******************************/
+
+
+/**
+ * Use @model from now on.
+ */
+void CLS_init(const ClsModel *newModel) {
+    
+    model = newModel;
+    
+    memset(&result, 0, sizeof(result));
+    result.activity = ACT_IDLE;
+    result.confidence[ACT_IDLE] = 100;
+}
+
+/**
+ * The feature vector of the latest step band features (libs/spectrum.h),
+ * cadence (libs/steps.h) and vertical speed (libs/vertical.h).
+ * 
+ * @features    CLS_FEATURES values, in ClsFeature order
+ */
+void CLS_gather(int16_t *features) {
+    const SpecFeatures *spec = SPEC_features();
+    const StepState *steps = STEP_state();
+    const VertState *vert = VERT_state();
+    
+    features[CLS_AMPLITUDE] = spec->amplitude;
+    features[CLS_BAND] = spec->bandAmplitude;
+    features[CLS_REGULARITY] = spec->regularity;
+    features[CLS_CADENCE] = steps->walking ? steps->cadence : 0;
+    features[CLS_CLIMB] = vert->valid ? abs(vert->speed) : 0;
+}
+
+/**
+ * Walk the tree down to a leaf.
+ */
+static void classifyTree(const int16_t *features) {
+    const ClsNode *node = &model->nodes[0];
+    uint8_t depth;
+    
+    for (depth = 0; depth < MAX_DEPTH && node->feature != CLS_LEAF; depth++) {
+        node = &model->nodes[features[node->feature] <= node->threshold ? node->below : node->above];
+    }
+    
+    memcpy(result.confidence, model->leaves[node->below], CLS_CLASSES);
+}
+
+/**
+ * Class scores in log2 units, then softmax: each class gets 2^(score -
+ * best) of the total.
+ */
+static void classifyLinear(const int16_t *features) {
+    int32_t score[CLS_CLASSES];
+    uint32_t weight[CLS_CLASSES];
+    uint32_t total = 0;
+    int32_t best;
+    int32_t below;
+    uint8_t c, i;
+    
+    for (c = 0; c < CLS_CLASSES; c++) {
+        score[c] = model->bias[c];
+        for (i = 0; i < CLS_FEATURES; i++) {
+            score[c] += (int32_t)model->weights[c][i] * features[i];
+        }
+        score[c] >>= model->shift;
+    }
+    
+    best = score[0];
+    for (c = 1; c < CLS_CLASSES; c++) {
+        if (score[c] > best) {
+            best = score[c];
+        }
+    }
+    
+    for (c = 0; c < CLS_CLASSES; c++) {
+        below = best - score[c];
+        weight[c] = (below >> CLS_LOG_FRAC) >= 16 ? 0 :
+            exp2Frac[below & ((1 << CLS_LOG_FRAC) - 1)] >> (below >> CLS_LOG_FRAC);
+        total += weight[c];
+    }
+    
+    for (c = 0; c < CLS_CLASSES; c++) {
+        result.confidence[c] = (uint8_t)((weight[c] * 100 + total / 2) / total);
+    }
+}
+
+/**
+ * Classify a feature vector.
+ * 
+ * @features    CLS_FEATURES values, see CLS_gather()
+ * 
+ * @return  The most confident activity, the confidences are in CLS_result()
+ */
+Activity CLS_classify(const int16_t *features) {
+    uint8_t c;
+    
+    if (model->nodes != NULL) {
+        classifyTree(features);
+    } else {
+        classifyLinear(features);
+    }
+    
+    result.activity = ACT_IDLE;
+    for (c = 1; c < CLS_CLASSES; c++) {
+        if (result.confidence[c] > result.confidence[result.activity]) {
+            result.activity = (Activity)c;
+        }
+    }
+    
+    return result.activity;
+}
+
+const ClsResult *CLS_result() {
+    return &result;
+}
+
+/**
+ * Dump the latest result: "CLS <activity> <idle> <stairs> <elevator> %
+ * <model>".
+ */
+void CLS_dump() {
+    char line[DIAG_LINE_LEN];
+    
+    const char *names[] = {
+        "idle",
+        "stairs",
+        "elevator"
+    };
+    
+    sprintf(line, "CLS %s %u %u %u %% %.40s", names[result.activity],
+        result.confidence[ACT_IDLE], result.confidence[ACT_STAIRS], result.confidence[ACT_ELEVATOR],
+        model->name);
+    DIAG_print(line);
+}
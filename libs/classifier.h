@@ -0,0 +1,96 @@
+ /**************************************************************
+  * 
+  *   _   _           _        _        ____    ___  
+  *  | | | |_ __  ___| |_ __ _(_)_ __  |___ \  / _ \ 
+  *  | | | | '_ \/ __| __/ _` | | '__|   __) || | | |
+  *  | |_| | |_) \__ \ || (_| | | |     / __/ | |_| |
+  *   \___/| .__/|___/\__\__,_|_|_|    |_____(_)___/ 
+  *        |_| Miika Sikala, Oulun Yliopisto, 2018
+  * 
+  * 
+  * ************************************************************
+  * THE BEER-WARE LICENSE
+  * This file is part of Upstair 2.0 software. As long as you retain this notice you
+  * can do whatever you want with this stuff. If we meet some day, and you think
+  * this stuff is worth it, you can buy me a beer in return.
+  * 
+  * Miika Sikala
+  * ************************************************************
+  */
+  
+#ifndef UPSTAIR_CLASSIFIER_H
+#define UPSTAIR_CLASSIFIER_H
+
+/* Standard libs */
+#include <inttypes.h>
+
+#include "upstair.h"
+
+/*
+ * Activity classifier. Once per window of step band features, a feature
+ * vector of them, the cadence and the vertical speed goes through a model
+ * that gives a confidence for each Activity.
+ * 
+ * The model is data: a decision tree, or a linear model whose class scores
+ * are log2 odds, both in integers. CLS_model in libs/model.c is generated by
+ * tools/train.py from traces with known activities (host/mktrace, or ones
+ * recorded with TRACE_MODE and labelled by hand); training another model
+ * and rebuilding changes the classifier, this code stays as is. Another
+ * model can also be switched to at run time with CLS_init().
+ */
+
+/* The features, in the order of the vector */
+typedef enum {
+    CLS_AMPLITUDE,      // mg, RMS of the vertical acceleration (SpecFeatures)
+    CLS_BAND,           // mg, RMS in the step band
+    CLS_REGULARITY,     // %
+    CLS_CADENCE,        // steps/min while walking, else 0 (StepState)
+    CLS_CLIMB,          // cm/s up or down, 0 without the barometer (VertState)
+    CLS_FEATURES
+} ClsFeature;
+
+#define CLS_CLASSES 3   // ACT_IDLE, ACT_STAIRS, ACT_ELEVATOR
+#define CLS_LEAF (-1)   // ClsNode.feature of a leaf
+#define CLS_LOG_FRAC 4  // fraction bits of the linear model's class scores
+
+/* Tree node: go to @below if the feature is <= @threshold, else @above.
+ * A leaf has its confidences at leaves[@below]. */
+typedef struct {
+    int8_t feature;                             // ClsFeature or CLS_LEAF
+    uint8_t below;
+    uint8_t above;
+    int16_t threshold;
+} ClsNode;
+
+typedef struct {
+    const char *name;                           // what it was trained on, for the diag
+    
+    // decision tree, NULL if linear
+    const ClsNode *nodes;                       // the root first
+    const uint8_t (*leaves)[CLS_CLASSES];       // %
+    
+    // linear: score = (bias + weights . features) >> shift, log2 odds
+    // with CLS_LOG_FRAC fraction bits
+    const int16_t (*weights)[CLS_FEATURES];
+    const int32_t *bias;
+    uint8_t shift;
+} ClsModel;
+
+typedef struct {
+    Activity activity;                          // the most confident class
+    uint8_t confidence[CLS_CLASSES];            // %, by Activity
+} ClsResult;
+
+/* The model of libs/model.c */
+extern const ClsModel CLS_model;
+
+
+/* Public functions */
+
+void CLS_init(const ClsModel *model);
+void CLS_gather(int16_t *features);
+Activity CLS_classify(const int16_t *features);
+const ClsResult *CLS_result();
+void CLS_dump();
+
+#endif /* UPSTAIR_CLASSIFIER_H */
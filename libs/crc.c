@@ -0,0 +1,59 @@
+ /**************************************************************
+  * 
+  *   _   _           _        _        ____    ___  
+  *  | | | |_ __  ___| |_ __ _(_)_ __  |___ \  / _ \ 
+  *  | | | | '_ \/ __| __/ _` | | '__|   __) || | | |
+  *  | |_| | |_) \__ \ || (_| | | |     / __/ | |_| |
+  *   \___/| .__/|___/\__\__,_|_|_|    |_____(_)___/ 
+  *        |_| Miika Sikala, Oulun Yliopisto, 2018
+  * 
+  * 
+  * ************************************************************
+  * THE BEER-WARE LICENSE
+  * This file is part of Upstair 2.0 software. As long as you retain this notice you
+  * can do whatever you want with this stuff. If we meet some day, and you think
+  * this stuff is worth it, you can buy me a beer in return.
+  * 
+  * Miika Sikala
+  * ************************************************************
+  */
+  
+#include "libs/crc.h"
+
+
+
+/*******************************
+ *        DEFINITIONS          *
+ ******************************/
+
+// CRC-16-CCITT (poly 0x1021), one nibble at a time to keep the table small
+static const uint16_t crcTable[16] = {
+    0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50A5, 0x60C6, 0x70E7,
+    0x8108, 0x9129, 0xA14A, 0xB16B, 0xC18C, 0xD1AD, 0xE1CE, 0xF1EF
+};
+
+
+
+/*******************************
+ *          FUNCTIONS          *
+ ******************************/
+
+
+/**
+ * Continue a CRC-16-CCITT over more data. Start with CRC16_INIT.
+ * 
+ * @crc     CRC so far
+ * @data    Data to add
+ * @len     Length of the data
+ */
+uint16_t CRC_16(uint16_t crc, const void *data, uint16_t len) {
+    const uint8_t *p = data;
+    
+    while (len--) {
+        crc = (crc << 4) ^ crcTable[(crc >> 12) ^ (*p >> 4)];
+        crc = (crc << 4) ^ crcTable[(crc >> 12) ^ (*p & 0x0F)];
+        ++p;
+    }
+    
+    return crc;
+}
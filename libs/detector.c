@@ -0,0 +1,207 @@
+ /**************************************************************
+  * 
+  *   _   _           _        _        ____    ___  
+  *  | | | |_ __  ___| |_ __ _(_)_ __  |___ \  / _ \ 
+  *  | | | | '_ \/ __| __/ _` | | '__|   __) || | | |
+  *  | |_| | |_) \__ \ || (_| | | |     / __/ | |_| |
+  *   \___/| .__/|___/\__\__,_|_|_|    |_____(_)___/ 
+  *        |_| Miika Sikala, Oulun Yliopisto, 2018
+  * 
+  * 
+  * ************************************************************
+  * THE BEER-WARE LICENSE
+  * This file is part of Upstair 2.0 software. As long as you retain this notice you
+  * can do whatever you want with this stuff. If we meet some day, and you think
+  * this stuff is worth it, you can buy me a beer in return.
+  * 
+  * Miika Sikala
+  * ************************************************************
+  */
+  
+/* Standard libs */
+#include <math.h>
+#include <string.h>
+
+#include "libs/detector.h"
+
+
+
+/*******************************
+ *        DEFINITIONS          *
+ ******************************/
+
+static DetParams params = {
+    0.19,       // treshold
+    5,          // stairsLimit
+    3,          // idleLimit
+    7,          // maxShakiness
+    0,          // minShakiness
+    0.7,        // shakinessRise
+    0.5         // shakinessDrop
+};
+
+static float shakiness = 0;
+static Activity activity = ACT_IDLE;
+static uint8_t moved = 0;               // last sample exceeded the treshold
+
+static uint32_t sampleCount = 0;
+
+// moving average samples for each axis
+static float ma_samples_x[MA_N];
+static float ma_samples_y[MA_N];
+static float ma_samples_z[MA_N];
+
+// moving average values for each axis
+static float movingAvg_x;
+static float movingAvg_y;
+static float movingAvg_z;
+
+
+
+/*******************************
+ *          FUNCTIONS          *
+ ******************************/
+
+
+/**
+ * Shifts every element in given array to left and adds @el to the end of
+ * the array. The first element is popped out.
+ * 
+ * NOTE: @arr and @el are type of float!
+ * 
+ * @arr     The array we are popping
+ * @el      Element to be added to the end of @arr
+ * @len     Length of @arr
+ */
+static void array_pop(float *arr, float *el, uint16_t len) {
+    
+    // shift every element one element forward
+    uint16_t i;
+    for(i=0; i < len-1; i++) {
+	    arr[i] = arr[i+1];
+	}
+	
+	// add new element to the end of the array
+	arr[len-1] = *el;
+}
+
+
+/**
+ * Sum all elements in given array and return the sum.
+ * 
+ * @arr     Array containing the elements we want to be summed.
+ * @return  (Float) sum of the elements.
+ */
+static float array_sum(float *arr) {
+	float sum = 0;
+	unsigned int i;
+
+	for(i=0; i < MA_N; i++) {
+		sum += arr[i];
+	}
+
+	return sum;
+}
+
+
+/**
+ * Returns 1 if treshold is exceeded on any axis.
+ */
+static uint8_t tresholdExceeded(float ax, float ay, float az) {
+    float treshold = params.treshold;
+    
+    return ((fabs(movingAvg_x - ax) > treshold || fabs(movingAvg_y - ay) > treshold || fabs(movingAvg_z - az) > treshold));
+
+}
+
+
+/**
+ * The parameters, they can be changed at any time.
+ */
+DetParams *DET_params() {
+    return &params;
+}
+
+/**
+ * Forget everything seen so far.
+ */
+void DET_reset() {
+    
+    shakiness = 0;
+    activity = ACT_IDLE;
+    moved = 0;
+    sampleCount = 0;
+    
+    memset(ma_samples_x, 0, sizeof(ma_samples_x));
+    memset(ma_samples_y, 0, sizeof(ma_samples_y));
+    memset(ma_samples_z, 0, sizeof(ma_samples_z));
+}
+
+/**
+ * Detect steps from accelometer data.
+ * 
+ * @accel   x, y horizontal and z up (g), without gravity
+ * 
+ * @return  Current activity
+ */
+Activity DET_sample(const float *accel) {
+    float ax = accel[0];
+    float ay = accel[1];
+    float az = accel[2];
+    
+    // increase sampleCount - how many data pieces we have got in total
+    ++sampleCount;
+    moved = 0;
+    
+    // add new sample to moving average samples, oldest one pops out!
+    array_pop(ma_samples_x, &ax, MA_N);
+    array_pop(ma_samples_y, &ay, MA_N);
+    array_pop(ma_samples_z, &az, MA_N);
+    
+    // if we have gained enough data so the sample list is full
+    if (sampleCount >= MA_N-1) {
+        
+        // TODO: update all of these at once!!
+        // calculate the moving average for each axis individually
+        movingAvg_x = array_sum(ma_samples_x) / MA_N;
+        movingAvg_y = array_sum(ma_samples_y) / MA_N;
+        movingAvg_z = array_sum(ma_samples_z) / MA_N;
+        
+        // Adjust shakiness
+        if(tresholdExceeded(ax, ay, az) && shakiness <= params.maxShakiness - params.shakinessRise) {
+            
+            shakiness += params.shakinessRise;
+            moved = 1;
+            
+        } else {
+            
+            // lower shakiness
+            if(shakiness >= params.minShakiness + params.shakinessDrop) {
+                
+                shakiness -= params.shakinessDrop;
+                
+            }
+        }
+    }
+    
+    /* Handle result */
+    
+    if (shakiness >= params.stairsLimit) {
+	    activity = ACT_STAIRS;
+    } else if(shakiness < params.idleLimit) {
+	    activity = ACT_IDLE;
+	}
+    
+    return activity;
+}
+
+/**
+ * Returns 1 if the last sample raised shakiness (the device is being moved).
+ */
+uint8_t DET_moved() {
+    return moved;
+}
+
+float DET_shakiness() {
+    return shakiness;
+}
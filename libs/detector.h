@@ -0,0 +1,61 @@
+ /**************************************************************
+  * 
+  *   _   _           _        _        ____    ___  
+  *  | | | |_ __  ___| |_ __ _(_)_ __  |___ \  / _ \ 
+  *  | | | | '_ \/ __| __/ _` | | '__|   __) || | | |
+  *  | |_| | |_) \__ \ || (_| | | |     / __/ | |_| |
+  *   \___/| .__/|___/\__\__,_|_|_|    |_____(_)___/ 
+  *        |_| Miika Sikala, Oulun Yliopisto, 2018
+  * 
+  * 
+  * ************************************************************
+  * THE BEER-WARE LICENSE
+  * This file is part of Upstair 2.0 software. As long as you retain this notice you
+  * can do whatever you want with this stuff. If we meet some day, and you think
+  * this stuff is worth it, you can buy me a beer in return.
+  * 
+  * Miika Sikala
+  * ************************************************************
+  */
+  
+#ifndef UPSTAIR_DETECTOR_H
+#define UPSTAIR_DETECTOR_H
+
+/* Standard libs */
+#include <inttypes.h>
+
+#include "upstair.h"
+
+/*
+ * Stair climbing detector. Fed with the acceleration in the earth frame
+ * (libs/attitude.h), so turning the device around is not shaking it. It
+ * keeps up "shakiness" that rises when the acceleration differs from its
+ * moving average and drops back otherwise. High shakiness means stairs,
+ * which decides the activity only without the barometer; otherwise the
+ * classifier (libs/classifier.h) does, and shakiness tells that the device
+ * is being moved.
+ * 
+ * Also built on the host, where host/replay runs recorded traces through it.
+ */
+
+/* Tweak these values to calibrate the detector */
+typedef struct {
+    float treshold;             // how small/big vibrations are counted
+    uint8_t stairsLimit;        // if shakiness rises above this --> STAIRS
+    uint8_t idleLimit;          // if shakiness drops below this --> IDLE
+    uint8_t maxShakiness;       // the greatest possible shakiness
+    uint8_t minShakiness;       // the lowest possible shakiness
+    float shakinessRise;        // how fast shakiness rises
+    float shakinessDrop;        // how fast shakiness drops back
+} DetParams;
+
+
+/* Public functions */
+
+DetParams *DET_params();
+void DET_reset();
+Activity DET_sample(const float *accel);
+uint8_t DET_moved();
+float DET_shakiness();
+
+#endif /* UPSTAIR_DETECTOR_H */
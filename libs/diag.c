@@ -0,0 +1,85 @@
+ /**************************************************************
+  * 
+  *   _   _           _        _        ____    ___  
+  *  | | | |_ __  ___| |_ __ _(_)_ __  |___ \  / _ \ 
+  *  | | | | '_ \/ __| __/ _` | | '__|   __) || | | |
+  *  | |_| | |_) \__ \ || (_| | | |     / __/ | |_| |
+  *   \___/| .__/|___/\__\__,_|_|_|    |_____(_)___/ 
+  *        |_| Miika Sikala, Oulun Yliopisto, 2018
+  * 
+  * 
+  * ************************************************************
+  * THE BEER-WARE LICENSE
+  * This file is part of Upstair 2.0 software. As long as you retain this notice you
+  * can do whatever you want with this stuff. If we meet some day, and you think
+  * this stuff is worth it, you can buy me a beer in return.
+  * 
+  * Miika Sikala
+  * ************************************************************
+  */
+  
+  
+/* Standard libs */
+#include <string.h>
+
+#include "libs/diag.h"
+#include "upstair.h"
+
+#include <xdc/std.h>
+#include <xdc/runtime/System.h>
+
+#include "Board.h"
+
+#if !defined(UPSTAIR_HOST) && !defined(BOARD_DISPLAY_EXCLUDE_UART)
+#include <ti/drivers/UART.h>
+#elif !defined(UPSTAIR_HOST)
+#include "wireless/comm_lib.h"
+#endif
+
+
+
+/*******************************
+ *          FUNCTIONS          *
+ ******************************/
+
+
+/**
+ * Set up the output. Call once, before the tasks start.
+ */
+void DIAG_init() {
+    
+#if !defined(UPSTAIR_HOST) && !defined(BOARD_DISPLAY_EXCLUDE_UART)
+    UART_init();
+#endif
+    
+}
+
+/**
+ * Send a line. The UART is opened for each line so that it doesn't keep the
+ * device out of standby in between.
+ * 
+ * @line        Text without the line feed
+ */
+void DIAG_print(const char *line) {
+    
+#if defined(UPSTAIR_HOST)
+    System_printf("%s\n", line);
+    System_flush();
+#elif !defined(BOARD_DISPLAY_EXCLUDE_UART)
+    UART_Handle uart;
+    UART_Params params;
+    
+    UART_Params_init(&params);
+    params.baudRate = 115200;
+    params.writeDataMode = UART_DATA_TEXT;
+    
+    uart = UART_open(Board_UART0, &params);
+    if (uart != NULL) {
+        UART_write(uart, line, strlen(line));
+        UART_write(uart, "\n", 1);
+        UART_close(uart);
+    }
+#else
+    Send6LoWPAN(IEEE80154_SERVER_ADDR, (uint8_t *)line, strlen(line));
+#endif
+}
@@ -0,0 +1,44 @@
+ /**************************************************************
+  * 
+  *   _   _           _        _        ____    ___  
+  *  | | | |_ __  ___| |_ __ _(_)_ __  |___ \  / _ \ 
+  *  | | | | '_ \/ __| __/ _` | | '__|   __) || | | |
+  *  | |_| | |_) \__ \ || (_| | | |     / __/ | |_| |
+  *   \___/| .__/|___/\__\__,_|_|_|    |_____(_)___/ 
+  *        |_| Miika Sikala, Oulun Yliopisto, 2018
+  * 
+  * 
+  * ************************************************************
+  * THE BEER-WARE LICENSE
+  * This file is part of Upstair 2.0 software. As long as you retain this notice you
+  * can do whatever you want with this stuff. If we meet some day, and you think
+  * this stuff is worth it, you can buy me a beer in return.
+  * 
+  * Miika Sikala
+  * ************************************************************
+  */
+  
+  
+#ifndef UPSTAIR_DIAG_H
+#define UPSTAIR_DIAG_H
+
+/* Standard libs */
+#include <inttypes.h>
+
+#include "upstair.h"
+
+/*
+ * Output for the diagnostics dumps (libs/prof, libs/load), a line at a time:
+ * to the console on the host, over the UART when the display doesn't use it
+ * (BOARD_DISPLAY_EXCLUDE_UART in Board.h), else to the server over 6LoWPAN.
+ */
+
+#define DIAG_LINE_LEN 80
+
+
+/* Public functions */
+
+void DIAG_init();
+void DIAG_print(const char *line);
+
+#endif /* UPSTAIR_DIAG_H */
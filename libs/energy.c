@@ -0,0 +1,289 @@
+ /**************************************************************
+  * 
+  *   _   _           _        _        ____    ___  
+  *  | | | |_ __  ___| |_ __ _(_)_ __  |___ \  / _ \ 
+  *  | | | | '_ \/ __| __/ _` | | '__|   __) || | | |
+  *  | |_| | |_) \__ \ || (_| | | |     / __/ | |_| |
+  *   \___/| .__/|___/\__\__,_|_|_|    |_____(_)___/ 
+  *        |_| Miika Sikala, Oulun Yliopisto, 2018
+  * 
+  * 
+  * ************************************************************
+  * THE BEER-WARE LICENSE
+  * This file is part of Upstair 2.0 software. As long as you retain this notice you
+  * can do whatever you want with this stuff. If we meet some day, and you think
+  * this stuff is worth it, you can buy me a beer in return.
+  * 
+  * Miika Sikala
+  * ************************************************************
+  */
+  
+  
+/* Standard libs */
+#include <stdio.h>
+#include <string.h>
+
+#include "libs/energy.h"
+#include "libs/load.h"
+#include "libs/lcd.h"
+#include "libs/extflash.h"
+#include "libs/diag.h"
+#include "upstair.h"
+
+#include <xdc/std.h>
+#include <ti/sysbios/knl/Clock.h>
+#include <ti/sysbios/hal/Hwi.h>
+
+#include "wireless/CWC_CC2650_154Drv.h"
+
+
+
+/*******************************
+ *        DEFINITIONS          *
+ ******************************/
+
+#define US_PER_HOUR 3600000000ULL
+
+static const uint16_t current[EN_SUBSYSTEMS] = {
+    CUR_CPU_ACTIVE,
+    CUR_CPU_STANDBY,
+    CUR_RADIO_RX,
+    CUR_RADIO_TX,
+    CUR_RADIO_IDLE,
+    CUR_MPU,
+    CUR_MPU_LP,
+    CUR_LCD,
+    CUR_I2C,
+    CUR_FLASH
+};
+
+static const char *names[EN_SUBSYSTEMS] = {
+    "cpu",
+    "standby",
+    "rx",
+    "tx",
+    "rfidle",
+    "mpu",
+    "mpulp",
+    "lcd",
+    "i2c",
+    "flash"
+};
+
+static EnergyStats stats;
+
+static uint16_t on = 0;                     // a bit per subsystem
+static uint32_t since[EN_SUBSYSTEMS];       // Clock ticks when turned on
+
+static uint32_t lcdTime = 0;                // LCD and flash times already added
+static uint32_t flashTime = 0;
+
+
+
+/*******************************
+ *          FUNCTIONS          *
+ ******************************/
+
+
+/**
+ * Radio driver state changes, also from the radio interrupt.
+ */
+static void radioState(CWC_CC2650_154_State_t state) {
+    
+    ENERGY_off(EN_RADIO_RX);
+    ENERGY_off(EN_RADIO_TX);
+    ENERGY_off(EN_RADIO_IDLE);
+    
+    switch (state) {
+        case CWC_CC2650_154_STATE_RX:
+            ENERGY_on(EN_RADIO_RX);
+            break;
+        case CWC_CC2650_154_STATE_TX:
+            ENERGY_on(EN_RADIO_TX);
+            break;
+        case CWC_CC2650_154_STATE_IDLE:
+            ENERGY_on(EN_RADIO_IDLE);
+            break;
+        default:
+            break;
+    }
+}
+
+/**
+ * Add the time of a subsystem that is on up to now, and restart it.
+ */
+static void addOpen(EnergySub sub, uint32_t ticks) {
+    
+    if (on & (1 << sub)) {
+        stats.time[sub] += (uint64_t)(ticks - since[sub]) * Clock_tickPeriod;
+        since[sub] = ticks;
+    }
+}
+
+/**
+ * Start the meter. Call after Init6LoWPAN() (the radio state comes from the
+ * driver) and LOAD_init().
+ */
+void ENERGY_init() {
+    
+    memset(&stats, 0, sizeof(stats));
+    
+    lcdTime = LCD_getStats()->totalTime;
+    flashTime = EXTFLASH_busyTime();
+    
+    CWC_CC2650_154_SetStateCallback(radioState);
+}
+
+/**
+ * A subsystem starts drawing its current. Can be called from a Hwi.
+ */
+void ENERGY_on(EnergySub sub) {
+    UInt key = Hwi_disable();
+    
+    if (!(on & (1 << sub))) {
+        since[sub] = Clock_getTicks();
+        on |= 1 << sub;
+    }
+    
+    Hwi_restore(key);
+}
+
+/**
+ * ...and stops.
+ */
+void ENERGY_off(EnergySub sub) {
+    UInt key = Hwi_disable();
+    
+    addOpen(sub, Clock_getTicks());
+    on &= ~(1 << sub);
+    
+    Hwi_restore(key);
+}
+
+/**
+ * Add time measured elsewhere.
+ * 
+ * @sub     Subsystem
+ * @us      Time it was on
+ */
+void ENERGY_add(EnergySub sub, uint32_t us) {
+    UInt key = Hwi_disable();
+    
+    stats.time[sub] += us;
+    
+    Hwi_restore(key);
+}
+
+/**
+ * Collect the times and recompute the charges. Call once per second, after
+ * LOAD_update().
+ */
+void ENERGY_update() {
+    const LoadStats *load = LOAD_stats();
+    uint32_t ticks;
+    uint32_t t;
+    uint64_t wall;
+    UInt key;
+    uint8_t i;
+    
+    ENERGY_add(EN_CPU, load->busyUs);
+    ENERGY_add(EN_STANDBY, load->windowUs - load->busyUs);
+    
+    t = LCD_getStats()->totalTime;
+    ENERGY_add(EN_LCD, t - lcdTime);
+    lcdTime = t;
+    
+    t = EXTFLASH_busyTime();
+    ENERGY_add(EN_FLASH, t - flashTime);
+    flashTime = t;
+    
+    key = Hwi_disable();
+    
+    ticks = Clock_getTicks();
+    for (i = 0; i < EN_SUBSYSTEMS; i++) {
+        addOpen((EnergySub)i, ticks);
+    }
+    
+    Hwi_restore(key);
+    
+    // the CPU is either active or in standby, all the time
+    wall = stats.time[EN_CPU] + stats.time[EN_STANDBY];
+    stats.uptime = wall / 1000000;
+    stats.total = 0;
+    stats.totalRate = 0;
+    
+    for (i = 0; i < EN_SUBSYSTEMS; i++) {
+        stats.charge[i] = stats.time[i] * current[i] / US_PER_HOUR;
+        stats.rate[i] = wall > 0 ? stats.time[i] * current[i] / wall : 0;
+        
+        stats.total += stats.charge[i];
+        stats.totalRate += stats.rate[i];
+    }
+}
+
+/**
+ * Charges of the last update.
+ */
+const EnergyStats *ENERGY_stats() {
+    return &stats;
+}
+
+/**
+ * Mean current since an earlier copy of the stats, e.g. over a standby.
+ * Both are from after ENERGY_update().
+ * 
+ * @before  The stats then
+ * @return  uA, 0 if no time has passed
+ */
+uint32_t ENERGY_meanSince(const EnergyStats *before) {
+    uint64_t wall;
+    uint64_t charge = 0;            // uA * us
+    uint8_t i;
+    
+    wall = stats.time[EN_CPU] + stats.time[EN_STANDBY] - before->time[EN_CPU] - before->time[EN_STANDBY];
+    if (wall == 0) {
+        return 0;
+    }
+    
+    for (i = 0; i < EN_SUBSYSTEMS; i++) {
+        charge += (stats.time[i] - before->time[i]) * current[i];
+    }
+    
+    return charge / wall;
+}
+
+/**
+ * Battery life at the mean current so far (hours), 0 if not known yet.
+ */
+uint32_t ENERGY_batteryLife() {
+    
+    if (stats.totalRate == 0) {
+        return 0;
+    }
+    
+    return BATTERY_CAPACITY * 1000UL / stats.totalRate;
+}
+
+/**
+ * Dump the charges: "ENERGY <subsystem> <uAh> uAh <uA> uA" for each
+ * subsystem that has been on, then the total and the battery life.
+ */
+void ENERGY_dump() {
+    char line[DIAG_LINE_LEN];
+    uint8_t i;
+    
+    for (i = 0; i < EN_SUBSYSTEMS; i++) {
+        if (stats.time[i] == 0) {
+            continue;
+        }
+        
+        sprintf(line, "ENERGY %s %lu uAh %lu uA", names[i],
+            (unsigned long)stats.charge[i], (unsigned long)stats.rate[i]);
+        DIAG_print(line);
+    }
+    
+    sprintf(line, "ENERGY total %lu uAh %lu uA in %lu s, battery %lu h",
+        (unsigned long)stats.total, (unsigned long)stats.totalRate,
+        (unsigned long)stats.uptime, (unsigned long)ENERGY_batteryLife());
+    DIAG_print(line);
+}
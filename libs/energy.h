@@ -0,0 +1,87 @@
+ /**************************************************************
+  * 
+  *   _   _           _        _        ____    ___  
+  *  | | | |_ __  ___| |_ __ _(_)_ __  |___ \  / _ \ 
+  *  | | | | '_ \/ __| __/ _` | | '__|   __) || | | |
+  *  | |_| | |_) \__ \ || (_| | | |     / __/ | |_| |
+  *   \___/| .__/|___/\__\__,_|_|_|    |_____(_)___/ 
+  *        |_| Miika Sikala, Oulun Yliopisto, 2018
+  * 
+  * 
+  * ************************************************************
+  * THE BEER-WARE LICENSE
+  * This file is part of Upstair 2.0 software. As long as you retain this notice you
+  * can do whatever you want with this stuff. If we meet some day, and you think
+  * this stuff is worth it, you can buy me a beer in return.
+  * 
+  * Miika Sikala
+  * ************************************************************
+  */
+  
+  
+#ifndef UPSTAIR_ENERGY_H
+#define UPSTAIR_ENERGY_H
+
+/* Standard libs */
+#include <inttypes.h>
+
+#include "upstair.h"
+
+/*
+ * Software energy meter. The time each subsystem spends in a state that
+ * draws current is multiplied by a typical current (CUR_* in upstair.h) to
+ * estimate the charge used, in total and per hour.
+ * 
+ *   CPU        active and standby time from libs/load.h
+ *   radio      RX, TX and idle, from the state of the radio driver
+ *   MPU        while Board_MPU_POWER is on, at full rate or in the low power
+ *              accelerometer mode (libs/tiers.h)
+ *   LCD        time spent flushing (libs/lcd.h)
+ *   I2C        while the bus is open
+ *   flash      program and erase time (libs/extflash.h)
+ * 
+ * The static current of the rest of the board (sensors in standby, the LCD
+ * holding an image, regulators) is not included.
+ * 
+ * On the host the same model runs on the simulated board, so firmware
+ * configurations can be compared with "make run". CPU time there is the
+ * CPU time of the host.
+ */
+
+typedef enum {
+    EN_CPU,
+    EN_STANDBY,
+    EN_RADIO_RX,
+    EN_RADIO_TX,
+    EN_RADIO_IDLE,
+    EN_MPU,
+    EN_MPU_LP,
+    EN_LCD,
+    EN_I2C,
+    EN_FLASH,
+    EN_SUBSYSTEMS
+} EnergySub;
+
+typedef struct {
+    uint64_t time[EN_SUBSYSTEMS];       // us in the state so far
+    uint32_t charge[EN_SUBSYSTEMS];     // uAh so far
+    uint32_t rate[EN_SUBSYSTEMS];       // uAh per hour (mean uA)
+    uint32_t total;                     // uAh
+    uint32_t totalRate;                 // uAh per hour
+    uint32_t uptime;                    // s
+} EnergyStats;
+
+
+/* Public functions */
+
+void ENERGY_init();
+void ENERGY_on(EnergySub sub);
+void ENERGY_off(EnergySub sub);
+void ENERGY_add(EnergySub sub, uint32_t us);
+void ENERGY_update();
+const EnergyStats *ENERGY_stats();
+uint32_t ENERGY_meanSince(const EnergyStats *before);
+uint32_t ENERGY_batteryLife();
+void ENERGY_dump();
+
+#endif /* UPSTAIR_ENERGY_H */
@@ -0,0 +1,381 @@
+ /**************************************************************
+  * 
+  *   _   _           _        _        ____    ___  
+  *  | | | |_ __  ___| |_ __ _(_)_ __  |___ \  / _ \ 
+  *  | | | | '_ \/ __| __/ _` | | '__|   __) || | | |
+  *  | |_| | |_) \__ \ || (_| | | |     / __/ | |_| |
+  *   \___/| .__/|___/\__\__,_|_|_|    |_____(_)___/ 
+  *        |_| Miika Sikala, Oulun Yliopisto, 2018
+  * 
+  * 
+  * ************************************************************
+  * THE BEER-WARE LICENSE
+  * This file is part of Upstair 2.0 software. As long as you retain this notice you
+  * can do whatever you want with this stuff. If we meet some day, and you think
+  * this stuff is worth it, you can buy me a beer in return.
+  * 
+  * Miika Sikala
+  * ************************************************************
+  */
+  
+/* XDCtools Header files */
+#include <xdc/std.h>
+#include <xdc/runtime/System.h>
+#include <ti/sysbios/BIOS.h>
+#include <ti/sysbios/knl/Task.h>
+#include <ti/sysbios/knl/Clock.h>
+#include <ti/sysbios/knl/Semaphore.h>
+
+/* TI-RTOS Header files */
+#include <ti/drivers/PIN.h>
+
+#include "Board.h"
+#include "libs/extflash.h"
+#include "libs/spibus.h"
+
+
+
+/*******************************
+ *        DEFINITIONS          *
+ ******************************/
+
+/* Commands */
+#define CMD_READ            0x03
+#define CMD_PAGE_PROGRAM    0x02
+#define CMD_SECTOR_ERASE    0x20
+#define CMD_WRITE_ENABLE    0x06
+#define CMD_READ_STATUS     0x05
+#define CMD_READ_ID         0x9F
+#define CMD_DEEP_POWER_DOWN 0xB9
+#define CMD_RELEASE_DP      0xAB
+
+#define STATUS_WIP          0x01        // write (program/erase) in progress
+
+/* JEDEC ID of the MX25R8035F */
+#define ID_MANUFACTURER     0xC2
+#define ID_DEVICE           0x2814
+
+/* Timing (us) */
+#define WAKEUP_TIME         35          // deep power-down to standby
+#define POLL_PROGRAM        200         // status poll interval while programming
+#define POLL_ERASE          5000        // status poll interval while erasing
+#define TIMEOUT_ERASE       300000      // longer than the max sector erase time
+#define TYP_PROGRAM         850         // page program, typ.
+#define TYP_ERASE           40000       // sector erase, typ.
+
+static PIN_Handle hFlashPin;
+static PIN_State sFlashPin;
+static PIN_Config cFlashPin[] = {
+    Board_SPI_FLASH_CS | PIN_GPIO_OUTPUT_EN | PIN_GPIO_HIGH | PIN_PUSHPULL | PIN_DRVSTR_MIN,
+    PIN_TERMINATE
+};
+
+static Semaphore_Handle hFlashSem;      // one operation at a time
+
+static uint8_t asleep = 0;
+static uint8_t pending = 0;             // program or erase may be in progress
+static uint8_t erasing = 0;             // ...and it is an erase (slow)
+static uint32_t busyTime = 0;           // see EXTFLASH_busyTime()
+
+
+
+/*******************************
+ *          FUNCTIONS          *
+ ******************************/
+
+
+/**
+ * Run one command: send @cmd, then send @tx or read to @rx.
+ */
+static void command(const uint8_t *cmd, uint8_t cmdLen, const void *tx, void *rx, uint16_t len) {
+    
+    SPIBUS_acquire();
+    PIN_setOutputValue(hFlashPin, Board_SPI_FLASH_CS, Board_FLASH_CS_ON);
+    
+    SPIBUS_transfer(cmd, NULL, cmdLen);
+    if (len > 0) {
+        SPIBUS_transfer(tx, rx, len);
+    }
+    
+    PIN_setOutputValue(hFlashPin, Board_SPI_FLASH_CS, Board_FLASH_CS_OFF);
+    SPIBUS_release();
+}
+
+/**
+ * Send a command with a 24-bit address.
+ */
+static void addrCommand(uint8_t op, uint32_t addr, const void *tx, void *rx, uint16_t len) {
+    uint8_t cmd[4] = { op, addr >> 16, addr >> 8, addr };
+    
+    command(cmd, sizeof(cmd), tx, rx, len);
+}
+
+static uint8_t readStatus() {
+    uint8_t cmd = CMD_READ_STATUS;
+    uint8_t status;
+    
+    command(&cmd, 1, NULL, &status, 1);
+    return status;
+}
+
+/**
+ * Wake the chip up if it is in deep power-down.
+ */
+static void wakeUp() {
+    uint8_t cmd = CMD_RELEASE_DP;
+    
+    if (!asleep) {
+        return;
+    }
+    
+    command(&cmd, 1, NULL, NULL, 0);
+    Task_sleep(WAKEUP_TIME / Clock_tickPeriod + 1);
+    asleep = 0;
+}
+
+/**
+ * Wait for a program or erase to finish. The bus is free while waiting.
+ */
+static uint8_t waitReady() {
+    uint32_t poll = erasing ? POLL_ERASE : POLL_PROGRAM;
+    uint32_t waited = 0;
+    
+    // nothing started since the last check, skip the status read
+    if (!pending) {
+        wakeUp();
+        return 1;
+    }
+    
+
+    while (readStatus() & STATUS_WIP) {
+        
+        if (waited > TIMEOUT_ERASE) {
+            System_printf("EXTFLASH: timeout\n");
+            return 0;
+        }
+        
+        Task_sleep(poll / Clock_tickPeriod);
+        waited += poll;
+    }
+    
+    pending = 0;
+    erasing = 0;
+    return 1;
+}
+
+static void writeEnable() {
+    uint8_t cmd = CMD_WRITE_ENABLE;
+    
+    command(&cmd, 1, NULL, NULL, 0);
+}
+
+static uint8_t isBusy() {
+    
+    if (!pending) {
+        return 0;
+    }
+    
+    if (readStatus() & STATUS_WIP) {
+        return 1;
+    }
+    
+    pending = 0;
+    erasing = 0;
+    return 0;
+}
+
+static uint8_t deepSleep() {
+    uint8_t cmd = CMD_DEEP_POWER_DOWN;
+    
+    if (asleep) {
+        return 1;
+    }
+    
+    if (isBusy()) {
+        return 0;
+    }
+    
+    command(&cmd, 1, NULL, NULL, 0);
+    asleep = 1;
+    
+    return 1;
+}
+
+static void lock() {
+    Semaphore_pend(hFlashSem, BIOS_WAIT_FOREVER);
+}
+
+static void unlock() {
+    Semaphore_post(hFlashSem);
+}
+
+/**
+ * Open the flash. Leaves it in deep power-down.
+ * 
+ * @return  1 if the chip answered with the right ID
+ */
+uint8_t EXTFLASH_open() {
+    Semaphore_Params semParams;
+    uint8_t cmd = CMD_READ_ID;
+    uint8_t id[3];
+    
+    if (hFlashSem == NULL) {
+        Semaphore_Params_init(&semParams);
+        semParams.mode = Semaphore_Mode_BINARY;
+        
+        hFlashSem = Semaphore_create(1, &semParams, NULL);
+        if (hFlashSem == NULL) {
+            System_abort("Error creating flash semaphore\n");
+        }
+    }
+    
+    hFlashPin = PIN_open(&sFlashPin, cFlashPin);
+    if (hFlashPin == NULL) {
+        System_abort("Error initializing flash pins\n");
+    }
+    
+    SPIBUS_open();
+    
+    // it may have been left sleeping before a reset
+    asleep = 1;
+    wakeUp();
+    
+    command(&cmd, 1, NULL, id, sizeof(id));
+    
+    if (id[0] != ID_MANUFACTURER || ((id[1] << 8) | id[2]) != ID_DEVICE) {
+        System_printf("EXTFLASH: unknown chip %02x %02x %02x\n", id[0], id[1], id[2]);
+        
+        SPIBUS_close();
+        PIN_close(hFlashPin);
+        return 0;
+    }
+    
+    deepSleep();
+    return 1;
+}
+
+/**
+ * Finish what's going on, put the chip to deep power-down and release it.
+ */
+void EXTFLASH_close() {
+    
+    lock();
+    waitReady();
+    deepSleep();
+    unlock();
+    
+    SPIBUS_close();
+    PIN_close(hFlashPin);
+}
+
+/**
+ * Read any number of bytes from any address.
+ */
+uint8_t EXTFLASH_read(uint32_t addr, void *buf, uint16_t len) {
+    uint8_t ok;
+    
+    lock();
+    
+    ok = waitReady();
+    if (ok) {
+        addrCommand(CMD_READ, addr, NULL, buf, len);
+    }
+    
+    unlock();
+    return ok;
+}
+
+/**
+ * Program bytes (bits can only go from 1 to 0, erase first). Split to page
+ * programs as needed, waits for each to finish.
+ */
+uint8_t EXTFLASH_write(uint32_t addr, const void *buf, uint16_t len) {
+    const uint8_t *p = buf;
+    uint8_t ok = 1;
+    uint16_t n;
+    
+    lock();
+    
+    while (ok && len > 0) {
+        
+        // a page program wraps around at the end of the page
+        n = EXTFLASH_PAGE_SIZE - (addr % EXTFLASH_PAGE_SIZE);
+        if (n > len) {
+            n = len;
+        }
+        
+        ok = waitReady();
+        if (ok) {
+            writeEnable();
+            addrCommand(CMD_PAGE_PROGRAM, addr, p, NULL, n);
+            pending = 1;
+            busyTime += TYP_PROGRAM;
+        }
+        
+        addr += n;
+        p += n;
+        len -= n;
+    }
+    
+    ok = ok && waitReady();
+    
+    unlock();
+    return ok;
+}
+
+/**
+ * Start erasing the sector @addr is in. Doesn't wait for it to finish.
+ */
+uint8_t EXTFLASH_erase(uint32_t addr) {
+    uint8_t ok;
+    
+    lock();
+    
+    ok = waitReady();
+    if (ok) {
+        writeEnable();
+        addrCommand(CMD_SECTOR_ERASE, addr & ~(EXTFLASH_SECTOR_SIZE - 1), NULL, NULL, 0);
+        pending = 1;
+        erasing = 1;
+        busyTime += TYP_ERASE;
+    }
+    
+    unlock();
+    return ok;
+}
+
+/**
+ * Returns 1 if a program or erase is still going on.
+ */
+uint8_t EXTFLASH_isBusy() {
+    uint8_t busy;
+    
+    lock();
+    busy = isBusy();
+    unlock();
+    
+    return busy;
+}
+
+/**
+ * Put the chip to deep power-down (~10 nA). Not possible while it is busy.
+ * 
+ * @return  1 if it went to sleep
+ */
+uint8_t EXTFLASH_sleep() {
+    uint8_t ok;
+    
+    lock();
+    ok = deepSleep();
+    unlock();
+    
+    return ok;
+}
+
+/**
+ * Time spent programming and erasing so far (us), from the typical times of
+ * the chip. For the energy accounting (libs/energy.h).
+ */
+uint32_t EXTFLASH_busyTime() {
+    return busyTime;
+}
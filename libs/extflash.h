@@ -0,0 +1,55 @@
+ /**************************************************************
+  * 
+  *   _   _           _        _        ____    ___  
+  *  | | | |_ __  ___| |_ __ _(_)_ __  |___ \  / _ \ 
+  *  | | | | '_ \/ __| __/ _` | | '__|   __) || | | |
+  *  | |_| | |_) \__ \ || (_| | | |     / __/ | |_| |
+  *   \___/| .__/|___/\__\__,_|_|_|    |_____(_)___/ 
+  *        |_| Miika Sikala, Oulun Yliopisto, 2018
+  * 
+  * 
+  * ************************************************************
+  * THE BEER-WARE LICENSE
+  * This file is part of Upstair 2.0 software. As long as you retain this notice you
+  * can do whatever you want with this stuff. If we meet some day, and you think
+  * this stuff is worth it, you can buy me a beer in return.
+  * 
+  * Miika Sikala
+  * ************************************************************
+  */
+  
+#ifndef UPSTAIR_EXTFLASH_H
+#define UPSTAIR_EXTFLASH_H
+
+/* Standard libs */
+#include <inttypes.h>
+
+/*
+ * Driver for the external SPI flash of the SensorTag (Macronix MX25R8035F,
+ * 1 MB). Shares SPI0 with the LCD (see spibus.h).
+ * 
+ * The chip is woken up from deep power-down automatically by any operation.
+ * Operations wait for a previous program/erase to finish, but an erase is
+ * only started, so it can run while the caller does something else.
+ * Operations from different tasks are serialized.
+ * 
+ * All functions return 1 on success and 0 on failure.
+ */
+
+#define EXTFLASH_SIZE           (1024UL * 1024)
+#define EXTFLASH_SECTOR_SIZE    4096        // smallest erasable unit
+#define EXTFLASH_PAGE_SIZE      256         // largest programmable unit
+
+
+/* Public functions */
+
+uint8_t EXTFLASH_open();
+void EXTFLASH_close();
+uint8_t EXTFLASH_read(uint32_t addr, void *buf, uint16_t len);
+uint8_t EXTFLASH_write(uint32_t addr, const void *buf, uint16_t len);
+uint8_t EXTFLASH_erase(uint32_t addr);
+uint8_t EXTFLASH_isBusy();
+uint8_t EXTFLASH_sleep();
+uint32_t EXTFLASH_busyTime();
+
+#endif /* UPSTAIR_EXTFLASH_H */
@@ -0,0 +1,428 @@
+ /**************************************************************
+  * 
+  *   _   _           _        _        ____    ___  
+  *  | | | |_ __  ___| |_ __ _(_)_ __  |___ \  / _ \ 
+  *  | | | | '_ \/ __| __/ _` | | '__|   __) || | | |
+  *  | |_| | |_) \__ \ || (_| | | |     / __/ | |_| |
+  *   \___/| .__/|___/\__\__,_|_|_|    |_____(_)___/ 
+  *        |_| Miika Sikala, Oulun Yliopisto, 2018
+  * 
+  * 
+  * ************************************************************
+  * THE BEER-WARE LICENSE
+  * This file is part of Upstair 2.0 software. As long as you retain this notice you
+  * can do whatever you want with this stuff. If we meet some day, and you think
+  * this stuff is worth it, you can buy me a beer in return.
+  * 
+  * Miika Sikala
+  * ************************************************************
+  */
+  
+/* Standard libs */
+#include <string.h>
+
+/* XDCtools Header files */
+#include <xdc/std.h>
+#include <xdc/runtime/System.h>
+#include <ti/sysbios/BIOS.h>
+#include <ti/sysbios/knl/Semaphore.h>
+
+#include "libs/flashlog.h"
+#include "libs/extflash.h"
+#include "libs/crc.h"
+
+
+
+/*******************************
+ *        DEFINITIONS          *
+ ******************************/
+
+#define SECTOR_SIZE     EXTFLASH_SECTOR_SIZE
+#define PAGE_SIZE       EXTFLASH_PAGE_SIZE
+
+#define SECTOR_MAGIC    0x5055          // "UP"
+#define RECORD_END      0xFF            // erased flash
+
+#define sectorAddr(s)   (FLOG_BASE + (uint32_t)(s) * SECTOR_SIZE)
+#define nextSector(s)   (((s) + 1) % FLOG_SECTORS)
+
+/* Beginning of every sector */
+typedef struct {
+    uint16_t magic;
+    uint16_t crc;           // of seq
+    uint32_t seq;           // increases by one for every new sector
+} SectorHeader;
+
+/* Beginning of every record */
+typedef struct {
+    uint8_t type;
+    uint8_t len;
+    uint16_t crc;           // of type, len and data
+} RecordHeader;
+
+static Semaphore_Handle hLogSem;
+
+static uint8_t head;                    // sector being written
+static uint32_t headSeq;
+
+/* Page buffer. Bytes [0, flushed) of the page are already on the flash. */
+static uint8_t page[PAGE_SIZE];
+static uint32_t pageAddr;
+static uint16_t fill;
+static uint16_t flushed;
+
+
+
+/*******************************
+ *          FUNCTIONS          *
+ ******************************/
+
+
+/**
+ * Program the buffered bytes that are not on the flash yet.
+ */
+static uint8_t flushPage() {
+    uint8_t ok = 1;
+    
+    if (fill > flushed) {
+        ok = EXTFLASH_write(pageAddr + flushed, &page[flushed], fill - flushed);
+        flushed = fill;
+    }
+    
+    return ok;
+}
+
+/**
+ * Add bytes to the log at the write position.
+ */
+static uint8_t put(const void *data, uint16_t len) {
+    const uint8_t *p = data;
+    uint16_t n;
+    
+    while (len > 0) {
+        
+        n = PAGE_SIZE - fill;
+        if (n > len) {
+            n = len;
+        }
+        
+        memcpy(&page[fill], p, n);
+        fill += n;
+        p += n;
+        len -= n;
+        
+        // page full, program it and start the next one
+        if (fill == PAGE_SIZE) {
+            
+            if (!flushPage()) {
+                return 0;
+            }
+            
+            pageAddr += PAGE_SIZE;
+            fill = 0;
+            flushed = 0;
+            memset(page, RECORD_END, PAGE_SIZE);
+        }
+    }
+    
+    return 1;
+}
+
+/**
+ * Read from the log, including what is still in the page buffer.
+ */
+static void readLog(uint32_t addr, void *buf, uint16_t len) {
+    uint32_t from = pageAddr + flushed;
+    uint32_t to = pageAddr + fill;
+    uint32_t start = addr > from ? addr : from;
+    uint32_t end = addr + len < to ? addr + len : to;
+    
+    EXTFLASH_read(addr, buf, len);
+    
+    if (start < end) {
+        memcpy((uint8_t *)buf + (start - addr), &page[start - pageAddr], end - start);
+    }
+}
+
+static uint16_t seqCrc(uint32_t seq) {
+    return CRC_16(CRC16_INIT, &seq, sizeof(seq));
+}
+
+static uint8_t validHeader(const SectorHeader *hdr) {
+    return hdr->magic == SECTOR_MAGIC && hdr->crc == seqCrc(hdr->seq);
+}
+
+/**
+ * Start writing the next sector (already erased) and erase the one after it.
+ */
+static uint8_t startSector() {
+    SectorHeader hdr;
+    
+    if (!flushPage()) {
+        return 0;
+    }
+    
+    head = nextSector(head);
+    ++headSeq;
+    
+    pageAddr = sectorAddr(head);
+    fill = 0;
+    flushed = 0;
+    memset(page, RECORD_END, PAGE_SIZE);
+    
+    hdr.magic = SECTOR_MAGIC;
+    hdr.seq = headSeq;
+    hdr.crc = seqCrc(headSeq);
+    put(&hdr, sizeof(hdr));
+    
+    // runs in the background while the sector is being filled
+    return EXTFLASH_erase(sectorAddr(nextSector(head)));
+}
+
+/**
+ * Find the end of the records in the head sector.
+ */
+static uint32_t findEnd() {
+    uint32_t addr = sectorAddr(head) + sizeof(SectorHeader);
+    uint32_t end = sectorAddr(head) + SECTOR_SIZE;
+    RecordHeader rec;
+    uint16_t crc;
+    
+    while (addr + sizeof(rec) <= end) {
+        
+        EXTFLASH_read(addr, &rec, sizeof(rec));
+        if (rec.type == RECORD_END) {
+            return addr;
+        }
+        
+        // the page buffer is free for use as long as the log isn't open
+        if (addr + sizeof(rec) + rec.len > end || rec.len > PAGE_SIZE - sizeof(rec)) {
+            break;
+        }
+        
+        memcpy(page, &rec, 2);
+        EXTFLASH_read(addr + sizeof(rec), &page[2], rec.len);
+        crc = CRC_16(CRC16_INIT, page, rec.len + 2);
+        
+        // torn write (power lost mid-record), continue in a new sector
+        if (crc != rec.crc) {
+            break;
+        }
+        
+        addr += sizeof(rec) + rec.len;
+    }
+    
+    return end;
+}
+
+/**
+ * Mount the log: find the newest sector and the end of it. Formats the log
+ * region if there is no log.
+ * 
+ * @return  1 on success
+ */
+uint8_t FLOG_open() {
+    Semaphore_Params semParams;
+    SectorHeader hdr;
+    uint32_t addr;
+    uint8_t found = 0;
+    uint8_t s;
+    
+    if (hLogSem == NULL) {
+        Semaphore_Params_init(&semParams);
+        semParams.mode = Semaphore_Mode_BINARY;
+        
+        hLogSem = Semaphore_create(1, &semParams, NULL);
+        if (hLogSem == NULL) {
+            System_abort("Error creating log semaphore\n");
+        }
+    }
+    
+    if (!EXTFLASH_open()) {
+        return 0;
+    }
+    
+    // the newest sector has the largest sequence number
+    for (s = 0; s < FLOG_SECTORS; ++s) {
+        
+        EXTFLASH_read(sectorAddr(s), &hdr, sizeof(hdr));
+        
+        if (validHeader(&hdr) && (!found || hdr.seq > headSeq)) {
+            head = s;
+            headSeq = hdr.seq;
+            found = 1;
+        }
+    }
+    
+    // nothing there yet: erase the first sector and start from it
+    if (!found) {
+        System_printf("FLOG: formatting\n");
+        
+        head = FLOG_SECTORS - 1;
+        headSeq = 0;
+        pageAddr = sectorAddr(head);
+        fill = flushed = 0;
+        
+        return EXTFLASH_erase(sectorAddr(0)) && startSector();
+    }
+    
+    addr = findEnd();
+    
+    pageAddr = addr & ~(PAGE_SIZE - 1);
+    fill = flushed = addr - pageAddr;
+    memset(page, RECORD_END, PAGE_SIZE);
+    
+    // an erase may have been cut by a reset
+    EXTFLASH_read(sectorAddr(nextSector(head)), &hdr, sizeof(hdr));
+    if (hdr.magic != 0xFFFF || hdr.seq != 0xFFFFFFFF) {
+        EXTFLASH_erase(sectorAddr(nextSector(head)));
+    }
+    
+    return 1;
+}
+
+/**
+ * Write the page buffer and put the flash to sleep.
+ */
+void FLOG_close() {
+    
+    FLOG_sync();
+    EXTFLASH_close();
+}
+
+/**
+ * Append a record to the log. It is on the flash when its page is full or
+ * after FLOG_sync().
+ * 
+ * @type    Record type (not 0xFF)
+ * @data    Record data
+ * @len     Data length (max FLOG_MAX_LEN)
+ * 
+ * @return  1 on success, FLOG_NEW_SECTOR if it started a new sector, 0 on error
+ */
+uint8_t FLOG_append(uint8_t type, const void *data, uint8_t len) {
+    RecordHeader rec;
+    uint8_t ret = 1;
+    
+    if (type == RECORD_END || len > FLOG_MAX_LEN) {
+        return 0;
+    }
+    
+    rec.type = type;
+    rec.len = len;
+    rec.crc = CRC_16(CRC_16(CRC16_INIT, &rec, 2), data, len);
+    
+    Semaphore_pend(hLogSem, BIOS_WAIT_FOREVER);
+    
+    // records never cross a sector
+    if (pageAddr + fill + sizeof(rec) + len > sectorAddr(head) + SECTOR_SIZE) {
+        ret = startSector() ? FLOG_NEW_SECTOR : 0;
+    }
+    
+    if (ret && !(put(&rec, sizeof(rec)) && put(data, len))) {
+        ret = 0;
+    }
+    
+    Semaphore_post(hLogSem);
+    return ret;
+}
+
+/**
+ * Program everything in the page buffer, and put the flash to sleep when
+ * it's done (an erase may still be running).
+ */
+uint8_t FLOG_sync() {
+    uint8_t ok;
+    
+    Semaphore_pend(hLogSem, BIOS_WAIT_FOREVER);
+    ok = flushPage();
+    EXTFLASH_sleep();
+    Semaphore_post(hLogSem);
+    
+    return ok;
+}
+
+/**
+ * Start reading from the beginning of a sector, oldest first.
+ * 
+ * @sectors How many of the newest sectors to read (FLOG_SECTORS for all)
+ */
+void FLOG_first(FlogCursor *cursor, uint8_t sectors) {
+    
+    if (sectors > FLOG_SECTORS - 1) {
+        sectors = FLOG_SECTORS - 1;     // the one after the head is erased
+    }
+    if (sectors == 0) {
+        sectors = 1;
+    }
+    
+    cursor->sector = (head + FLOG_SECTORS - (sectors - 1)) % FLOG_SECTORS;
+    cursor->left = sectors - 1;
+    cursor->addr = 0;
+}
+
+/**
+ * Read the next record.
+ * 
+ * @return  1 if a record was read, 0 at the end of the log
+ */
+uint8_t FLOG_next(FlogCursor *cursor, FlogRecord *record) {
+    SectorHeader hdr;
+    RecordHeader rec;
+    uint32_t back;
+    uint32_t end;
+    
+    Semaphore_pend(hLogSem, BIOS_WAIT_FOREVER);
+    
+    while (1) {
+        
+        end = sectorAddr(cursor->sector) + SECTOR_SIZE;
+        
+        // open the sector, it has to be from this round
+        if (cursor->addr == 0) {
+            back = (head + FLOG_SECTORS - cursor->sector) % FLOG_SECTORS;
+            readLog(sectorAddr(cursor->sector), &hdr, sizeof(hdr));
+            
+            if (validHeader(&hdr) && hdr.seq == headSeq - back) {
+                cursor->addr = sectorAddr(cursor->sector) + sizeof(hdr);
+            } else {
+                cursor->addr = end;
+            }
+        }
+        
+        if (cursor->addr + sizeof(rec) <= end) {
+            
+            readLog(cursor->addr, &rec, sizeof(rec));
+            
+            if (rec.type != RECORD_END && rec.len <= FLOG_MAX_LEN &&
+                    cursor->addr + sizeof(rec) + rec.len <= end) {
+                readLog(cursor->addr + sizeof(rec), record->data, rec.len);
+            } else {
+                rec.type = RECORD_END;
+            }
+            
+            if (rec.type != RECORD_END &&
+                    rec.crc == CRC_16(CRC_16(CRC16_INIT, &rec, 2), record->data, rec.len)) {
+                
+                record->type = rec.type;
+                record->len = rec.len;
+                cursor->addr += sizeof(rec) + rec.len;
+                
+                Semaphore_post(hLogSem);
+                return 1;
+            }
+        }
+        
+        // end of this sector
+        if (cursor->left == 0) {
+            break;
+        }
+        
+        cursor->sector = nextSector(cursor->sector);
+        --cursor->left;
+        cursor->addr = 0;
+    }
+    
+    Semaphore_post(hLogSem);
+    return 0;
+}
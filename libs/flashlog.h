@@ -0,0 +1,73 @@
+ /**************************************************************
+  * 
+  *   _   _           _        _        ____    ___  
+  *  | | | |_ __  ___| |_ __ _(_)_ __  |___ \  / _ \ 
+  *  | | | | '_ \/ __| __/ _` | | '__|   __) || | | |
+  *  | |_| | |_) \__ \ || (_| | | |     / __/ | |_| |
+  *   \___/| .__/|___/\__\__,_|_|_|    |_____(_)___/ 
+  *        |_| Miika Sikala, Oulun Yliopisto, 2018
+  * 
+  * 
+  * ************************************************************
+  * THE BEER-WARE LICENSE
+  * This file is part of Upstair 2.0 software. As long as you retain this notice you
+  * can do whatever you want with this stuff. If we meet some day, and you think
+  * this stuff is worth it, you can buy me a beer in return.
+  * 
+  * Miika Sikala
+  * ************************************************************
+  */
+  
+#ifndef UPSTAIR_FLASHLOG_H
+#define UPSTAIR_FLASHLOG_H
+
+/* Standard libs */
+#include <inttypes.h>
+
+/*
+ * Append-only log on the external flash.
+ * 
+ * The log region is a ring of sectors that are written one after another, so
+ * every sector gets erased equally often. Each sector starts with a header
+ * holding a sequence number, the newest sector is the one with the largest.
+ * Records are {type, length, CRC-16, data} and never cross a sector. Appended
+ * bytes are collected to a page buffer in RAM and programmed a whole page at
+ * a time, or earlier with FLOG_sync().
+ * 
+ * The sector after the one being written is always kept erased, so opening a
+ * new sector never waits for an erase. The oldest records are lost with it.
+ */
+
+#define FLOG_BASE           0xC0000     // last 256 KB of the flash
+#define FLOG_SECTORS        64
+#define FLOG_MAX_LEN        96          // longest record data (fits an IMU block)
+
+#define FLOG_NEW_SECTOR     2           // FLOG_append(): ok, and a new sector was started
+
+
+/* A record read from the log */
+typedef struct {
+    uint8_t type;
+    uint8_t len;
+    uint8_t data[FLOG_MAX_LEN];
+} FlogRecord;
+
+/* Position of a reader in the log */
+typedef struct {
+    uint8_t sector;         // sector being read
+    uint8_t left;           // sectors left after it
+    uint32_t addr;          // next record (0: sector not opened yet)
+} FlogCursor;
+
+
+/* Public functions */
+
+uint8_t FLOG_open();
+void FLOG_close();
+uint8_t FLOG_append(uint8_t type, const void *data, uint8_t len);
+uint8_t FLOG_sync();
+
+void FLOG_first(FlogCursor *cursor, uint8_t sectors);
+uint8_t FLOG_next(FlogCursor *cursor, FlogRecord *record);
+
+#endif /* UPSTAIR_FLASHLOG_H */
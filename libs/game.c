@@ -0,0 +1,433 @@
+ /**************************************************************
+  * 
+  *   _   _           _        _        ____    ___  
+  *  | | | |_ __  ___| |_ __ _(_)_ __  |___ \  / _ \ 
+  *  | | | | '_ \/ __| __/ _` | | '__|   __) || | | |
+  *  | |_| | |_) \__ \ || (_| | | |     / __/ | |_| |
+  *   \___/| .__/|___/\__\__,_|_|_|    |_____(_)___/ 
+  *        |_| Miika Sikala, Oulun Yliopisto, 2018
+  * 
+  * 
+  * ************************************************************
+  * THE BEER-WARE LICENSE
+  * This file is part of Upstair 2.0 software. As long as you retain this notice you
+  * can do whatever you want with this stuff. If we meet some day, and you think
+  * this stuff is worth it, you can buy me a beer in return.
+  * 
+  * Miika Sikala
+  * ************************************************************
+  */
+  
+#include <string.h>
+
+#include "libs/game.h"
+#include "libs/lcd.h"
+
+
+
+/*******************************
+ *        DEFINITIONS          *
+ ******************************/
+
+// Positions and speeds are Q8 fixed point (1/256 px)
+#define FP_SHIFT        8
+#define FP(x)           ((int32_t)(x) << FP_SHIFT)
+
+#define PLAYER_X        8
+#define JUMP_SPEED      878             // initial jump speed (Q8 px/step), ~24 px high
+#define GRAVITY         63              // (Q8 px/step^2)
+#define RUN_ANIM_STEPS  6               // steps per running animation frame
+
+#define START_SPEED     FP(1)           // obstacle speed (Q8 px/step)
+#define MAX_SPEED       FP(3)
+#define SPEED_UP        16              // speed added per passed obstacle
+#define MIN_GAP         40              // min space between obstacles (px)
+#define GAP_RANGE       40              // random extra space (px)
+
+/* Anything that moves on the field */
+typedef struct {
+    const GameSprite *sprite;           // NULL if not in the game
+    int16_t x;
+    int16_t y;
+    const GameSprite *drawnSprite;      // what is on the screen, NULL if nothing
+    int16_t drawnX;
+    int16_t drawnY;
+} Object;
+
+// objects[0] is the player, the rest are obstacles
+static Object objects[1 + GAME_MAX_OBSTACLES];
+#define OBJECT_COUNT (1 + GAME_MAX_OBSTACLES)
+
+static int32_t playerY;                         // top edge
+static int32_t playerVy;
+static int32_t obstacleX[GAME_MAX_OBSTACLES];   // left edges
+static int32_t speed;
+static int32_t spawnDist;                       // distance until the next obstacle
+static uint16_t animStep = 0;
+
+static volatile uint8_t pressed = 0;    // button pressed since the last step
+static uint8_t over = 1;
+static uint8_t groundDrawn = 0;
+static uint16_t score = 0;
+static uint16_t best = 0;
+
+static uint32_t lastTime = 0;           // time of the last frame (us)
+static uint32_t accTime = 0;            // time not yet stepped (us)
+static uint32_t seed = 1;
+static GAME_Stats stats;
+
+static const tRectangle field = { GAME_FIELD_X0, GAME_FIELD_Y0, GAME_FIELD_X1, GAME_FIELD_Y1 };
+
+
+
+/*******************************
+ *          FUNCTIONS          *
+ ******************************/
+
+
+/**
+ * Pseudo random number (LCG), good enough for spacing obstacles.
+ */
+static uint16_t nextRandom() {
+    seed = seed * 1103515245 + 12345;
+    return seed >> 16;
+}
+
+/**
+ * One row of a sprite's collision mask, left aligned to bit 31.
+ */
+static uint32_t maskRow(const GameSprite *sprite, uint8_t row) {
+    const uint8_t *p = sprite->mask + row * ((sprite->w + 7) / 8);
+    uint32_t bits = (uint32_t)p[0] << 24;
+    
+    if (sprite->w > 8) {
+        bits |= (uint32_t)p[1] << 16;
+    }
+    
+    return bits;
+}
+
+/**
+ * Pixel-exact collision test of two objects.
+ */
+static uint8_t collides(const Object *a, const Object *b) {
+    int16_t dx = b->x - a->x;
+    int16_t top = (a->y > b->y) ? a->y : b->y;
+    int16_t bottom = (a->y + a->sprite->h < b->y + b->sprite->h) ? a->y + a->sprite->h : b->y + b->sprite->h;
+    int16_t y;
+    uint32_t rowA, rowB;
+    
+    // bounding boxes first
+    if (dx >= a->sprite->w || -dx >= b->sprite->w || top >= bottom) {
+        return 0;
+    }
+    
+    for(y = top; y < bottom; y++) {
+        rowA = maskRow(a->sprite, y - a->y);
+        rowB = maskRow(b->sprite, y - b->y);
+        
+        if (dx >= 0 ? (rowA & (rowB >> dx)) : ((rowA >> -dx) & rowB)) {
+            return 1;
+        }
+    }
+    
+    return 0;
+}
+
+/**
+ * Start a new game.
+ * 
+ * @now     Current time (us)
+ */
+void GAME_reset(uint32_t now) {
+    uint8_t i;
+    
+    // whatever is drawn stays marked as drawn, so render erases it
+    for(i=0; i < OBJECT_COUNT; i++) {
+        objects[i].sprite = NULL;
+    }
+    
+    objects[0].sprite = &game_player_run0;
+    objects[0].x = PLAYER_X;
+    playerY = FP(GAME_GROUND_Y - game_player_run0.h);
+    playerVy = 0;
+    objects[0].y = playerY >> FP_SHIFT;
+    
+    speed = START_SPEED;
+    spawnDist = FP(MIN_GAP);
+    animStep = 0;
+    
+    seed += now;
+    score = 0;
+    over = 0;
+    pressed = 0;
+    
+    lastTime = now;
+    accTime = 0;
+}
+
+/**
+ * Button press: jump, or start again after game over. Safe to call from a
+ * callback, the press is handled on the next step.
+ */
+void GAME_press() {
+    pressed = 1;
+}
+
+/**
+ * Move the player.
+ */
+static void stepPlayer() {
+    Object *player = &objects[0];
+    int32_t groundY = FP(GAME_GROUND_Y - player->sprite->h);
+    uint8_t onGround = (playerY >= groundY);
+    
+    // jump only from the ground
+    if (pressed) {
+        pressed = 0;
+        if (onGround) {
+            playerVy = -JUMP_SPEED;
+            onGround = 0;
+        }
+    }
+    
+    if (!onGround) {
+        playerVy += GRAVITY;
+        playerY += playerVy;
+        
+        // landed
+        if (playerY >= groundY) {
+            playerY = groundY;
+            playerVy = 0;
+            onGround = 1;
+        }
+    }
+    
+    player->y = playerY >> FP_SHIFT;
+    
+    if (onGround) {
+        ++animStep;
+        player->sprite = ((animStep / RUN_ANIM_STEPS) & 1) ? &game_player_run1 : &game_player_run0;
+    } else {
+        player->sprite = &game_player_jump;
+    }
+}
+
+/**
+ * Move obstacles, remove the ones that have passed and bring in new ones.
+ */
+static void stepObstacles() {
+    Object *obstacle;
+    uint8_t i;
+    
+    for(i=0; i < GAME_MAX_OBSTACLES; i++) {
+        obstacle = &objects[1 + i];
+        
+        if (obstacle->sprite == NULL) {
+            continue;
+        }
+        
+        obstacleX[i] -= speed;
+        obstacle->x = obstacleX[i] >> FP_SHIFT;
+        
+        // made it past one
+        if (obstacle->x + obstacle->sprite->w <= GAME_FIELD_X0) {
+            obstacle->sprite = NULL;
+            ++score;
+            
+            speed += SPEED_UP;
+            if (speed > MAX_SPEED) {
+                speed = MAX_SPEED;
+            }
+        }
+    }
+    
+    spawnDist -= speed;
+    if (spawnDist > 0) {
+        return;
+    }
+    
+    // bring in a new one from the right (if there's room for it)
+    for(i=0; i < GAME_MAX_OBSTACLES; i++) {
+        obstacle = &objects[1 + i];
+        
+        if (obstacle->sprite == NULL) {
+            obstacle->sprite = (nextRandom() & 1) ? &game_obstacle01 : &game_obstacle02;
+            obstacleX[i] = FP(GAME_FIELD_X1 + 1);
+            obstacle->x = GAME_FIELD_X1 + 1;
+            obstacle->y = GAME_GROUND_Y - obstacle->sprite->h;
+            
+            spawnDist = FP(obstacle->sprite->w + MIN_GAP + nextRandom() % GAP_RANGE);
+            break;
+        }
+    }
+}
+
+/**
+ * Advance the game by one time step.
+ */
+static void step() {
+    uint8_t i;
+    
+    stepPlayer();
+    stepObstacles();
+    
+    for(i=1; i < OBJECT_COUNT; i++) {
+        if (objects[i].sprite != NULL && collides(&objects[0], &objects[i])) {
+            over = 1;
+            break;
+        }
+    }
+    
+    if (over && score > best) {
+        best = score;
+    }
+}
+
+/**
+ * Run the game up to the current time and draw a frame if the display is
+ * ready for one. Call this once per main loop while the game is on screen.
+ * 
+ * @now     Current time (us)
+ */
+void GAME_frame(uint32_t now) {
+    
+    accTime += now - lastTime;
+    lastTime = now;
+    
+    // new game
+    if (over) {
+        if (pressed) {
+            GAME_reset(now);
+        }
+        accTime = 0;
+    }
+    
+    // don't try to catch up with a long pause, just continue from here
+    if (accTime > GAME_MAX_STEPS * GAME_STEP_US) {
+        accTime = GAME_MAX_STEPS * GAME_STEP_US;
+        ++stats.lagged;
+    }
+    
+    while (accTime >= GAME_STEP_US && !over) {
+        step();
+        accTime -= GAME_STEP_US;
+        ++stats.steps;
+    }
+    
+    // the last frame is still being sent, skip this one instead of waiting
+    if (LCD_isBusy()) {
+        ++stats.dropped;
+        return;
+    }
+    
+    GAME_render();
+    LCD_flush();
+    ++stats.frames;
+}
+
+/**
+ * The screen has been cleared, so next render has to draw everything.
+ */
+void GAME_invalidate() {
+    uint8_t i;
+    
+    for(i=0; i < OBJECT_COUNT; i++) {
+        objects[i].drawnSprite = NULL;
+    }
+    
+    groundDrawn = 0;
+}
+
+/**
+ * Draw the changes since the last render to the frame buffer. Sprites that
+ * haven't moved are left alone, unless an erased sprite overlapped them.
+ */
+void GAME_render() {
+    tRectangle erased[OBJECT_COUNT];
+    uint8_t moved[OBJECT_COUNT];
+    uint8_t i, j, redraw;
+    int16_t x;
+    Object *o;
+    
+    LCD_setClip(&field);
+    
+    if (!groundDrawn) {
+        for(x = GAME_FIELD_X0; x <= GAME_FIELD_X1; x += game_ground.w) {
+            LCD_blit(x, GAME_GROUND_Y - 6, game_ground.w, game_ground.h, game_ground.pixels, LCD_BLIT_SET);
+        }
+        groundDrawn = 1;
+    }
+    
+    // erase the ones that have moved from where they were drawn
+    for(i=0; i < OBJECT_COUNT; i++) {
+        o = &objects[i];
+        moved[i] = (o->sprite != o->drawnSprite || o->x != o->drawnX || o->y != o->drawnY);
+        
+        if (moved[i] && o->drawnSprite != NULL) {
+            LCD_blit(o->drawnX, o->drawnY, o->drawnSprite->w, o->drawnSprite->h, o->drawnSprite->pixels, LCD_BLIT_CLEAR);
+            
+            erased[i].sXMin = o->drawnX;
+            erased[i].sYMin = o->drawnY;
+            erased[i].sXMax = o->drawnX + o->drawnSprite->w - 1;
+            erased[i].sYMax = o->drawnY + o->drawnSprite->h - 1;
+        } else {
+            erased[i].sXMin = 1;    // empty
+            erased[i].sXMax = 0;
+        }
+    }
+    
+    // draw them to their new places
+    for(i=0; i < OBJECT_COUNT; i++) {
+        o = &objects[i];
+        
+        if (o->sprite == NULL) {
+            o->drawnSprite = NULL;
+            continue;
+        }
+        
+        redraw = moved[i];
+        for(j=0; j < OBJECT_COUNT && !redraw; j++) {
+            redraw = erased[j].sXMin <= erased[j].sXMax
+                && o->x <= erased[j].sXMax && o->x + o->sprite->w - 1 >= erased[j].sXMin
+                && o->y <= erased[j].sYMax && o->y + o->sprite->h - 1 >= erased[j].sYMin;
+        }
+        
+        if (redraw) {
+            LCD_blit(o->x, o->y, o->sprite->w, o->sprite->h, o->sprite->pixels, LCD_BLIT_SET);
+            o->drawnSprite = o->sprite;
+            o->drawnX = o->x;
+            o->drawnY = o->y;
+        }
+    }
+    
+    LCD_setClip(NULL);
+}
+
+/**
+ * Returns 1 if the player has hit an obstacle.
+ */
+uint8_t GAME_isOver() {
+    return over;
+}
+
+/**
+ * Getter for the score of the current game.
+ */
+uint16_t GAME_score() {
+    return score;
+}
+
+/**
+ * Getter for the best score since power on.
+ */
+uint16_t GAME_best() {
+    return best;
+}
+
+/**
+ * Getter for frame statistics.
+ */
+const GAME_Stats *GAME_getStats() {
+    return &stats;
+}
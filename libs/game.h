@@ -0,0 +1,72 @@
+ /**************************************************************
+  * 
+  *   _   _           _        _        ____    ___  
+  *  | | | |_ __  ___| |_ __ _(_)_ __  |___ \  / _ \ 
+  *  | | | | '_ \/ __| __/ _` | | '__|   __) || | | |
+  *  | |_| | |_) \__ \ || (_| | | |     / __/ | |_| |
+  *   \___/| .__/|___/\__\__,_|_|_|    |_____(_)___/ 
+  *        |_| Miika Sikala, Oulun Yliopisto, 2018
+  * 
+  * 
+  * ************************************************************
+  * THE BEER-WARE LICENSE
+  * This file is part of Upstair 2.0 software. As long as you retain this notice you
+  * can do whatever you want with this stuff. If we meet some day, and you think
+  * this stuff is worth it, you can buy me a beer in return.
+  * 
+  * Miika Sikala
+  * ************************************************************
+  */
+  
+#ifndef UPSTAIR_GAME_H
+#define UPSTAIR_GAME_H
+
+/* Standard libs */
+#include <inttypes.h>
+
+#include "upstair.h"
+#include "bitmaps/game.h"
+
+/*
+ * A small side-scrolling runner: jump over the stairs as they come.
+ * 
+ * The game logic runs at a fixed time step no matter how often frames are
+ * drawn. GAME_frame() is called from the main loop, it catches up with the
+ * time that has passed and draws a frame only if the LCD has finished
+ * sending the previous one. Only the sprites that have moved are erased and
+ * redrawn, so a frame usually touches just a few lines of the display.
+ */
+
+#define GAME_STEP_US        25000       // logic time step (us), 40 steps/sec
+#define GAME_MAX_STEPS      4           // max steps to catch up per frame
+#define GAME_MAX_OBSTACLES  3
+
+/* Game field (the right side is reserved for the button icons) */
+#define GAME_FIELD_X0       0
+#define GAME_FIELD_X1       (SCREEN_W - 18)
+#define GAME_FIELD_Y0       28
+#define GAME_FIELD_Y1       (SCREEN_H - 1)
+#define GAME_GROUND_Y       (SCREEN_H - 2)      // the surface everything stands on
+
+/* Frame statistics */
+typedef struct {
+    uint32_t frames;        // frames drawn
+    uint32_t dropped;       // frames skipped because the LCD was busy
+    uint32_t steps;         // logic steps run
+    uint32_t lagged;        // time lost when the caller fell too far behind
+} GAME_Stats;
+
+
+/* Public functions */
+
+void GAME_reset(uint32_t now);
+void GAME_press();
+void GAME_frame(uint32_t now);
+void GAME_invalidate();
+void GAME_render();
+uint8_t GAME_isOver();
+uint16_t GAME_score();
+uint16_t GAME_best();
+const GAME_Stats *GAME_getStats();
+
+#endif /* UPSTAIR_GAME_H */
@@ -19,6 +19,11 @@
   */
   
 #include "libs/gui.h"
+#include "libs/history.h"
+#include "libs/game.h"
+#include "libs/anim.h"
+#include "libs/load.h"
+#include "libs/energy.h"
 
 
 
@@ -26,9 +31,6 @@
  *        DEFINITIONS          *
  ******************************/
 
-/* Display */
-Display_Handle hDisplay;
-
 /* Gfx context */
 tContext *pContext;
 
@@ -47,6 +49,22 @@ enum ButtonIcon {
 uint8_t menuPos = 0;            // holds the menu cursor position
 uint8_t settingsMenuPos = 0;    // holds the settings menu cursor position
 uint8_t forceScrClear = 0;      // if this is set to true, screen is forced to update
+HistRes statsRes = HIST_RES_MINUTE; // resolution of the activity chart in stats view
+ChartKind statsKind = CHART_STAIRS; // what the activity chart shows
+uint8_t statsEnergy = 0;        // stats view shows the energy breakdown instead
+
+/* Activity image in main view */
+#define ACTIVITY_IMG_X  20
+#define ACTIVITY_IMG_Y  17
+
+AnimPlayer activityAnim;        // transition between the activity images
+uint8_t showsStairs = 0;        // which activity image is (or is becoming) visible
+
+/* Activity chart in stats view */
+#define CHART_X         4                   // left edge
+#define CHART_W         72                  // width (divisible by bar counts)
+#define CHART_TOP       (GUI_CONTENT_Y + 26)
+#define CHART_BOTTOM    (SCREEN_H - 16)
 
 
 
@@ -70,21 +88,43 @@ uint8_t GUI_settingsMenuPos() {
 }
 
 /**
- * Initialize display and gfx context.
+ * Whether the buttons changed what is shown (view, cursor or chart) and it
+ * has not been drawn yet.
  */
-void GUI_initDisplay() {
-    
-    Display_Params displayParams;
-	displayParams.lineClearMode = DISPLAY_CLEAR_BOTH;
-    Display_Params_init(&displayParams);
+uint8_t GUI_redrawPending() {
+    return forceScrClear;
+}
 
-    hDisplay = Display_open(Display_Type_LCD, &displayParams);
-    if (hDisplay == NULL) {
-        System_abort("Error initializing Display\n");
+/**
+ * Switch the stats view to the next chart resolution, after the last one to
+ * the next chart (stairs, score, floors) and after the last chart to the
+ * energy breakdown.
+ */
+void GUI_cycleStatsRes() {
+    
+    if (statsEnergy) {
+        statsEnergy = 0;
+        statsKind = CHART_STAIRS;
+        statsRes = HIST_RES_MINUTE;
+    } else if (++statsRes >= HIST_RES_COUNT) {
+        statsRes = HIST_RES_MINUTE;
+        if (++statsKind >= CHART_KINDS) {
+            statsEnergy = 1;
+        }
     }
     
+    // labels change, don't leave ghosts behind
+    forceScrClear = 1;
+    
+}
+
+/**
+ * Initialize display and gfx context.
+ */
+void GUI_initDisplay() {
+    
     // create context for drawing graphic
-    pContext = DisplayExt_getGrlibContext(hDisplay);
+    pContext = LCD_open();
     if (pContext == NULL) {
         System_abort("Could not create a context for display\n");
     }
@@ -97,7 +137,27 @@ void GUI_initDisplay() {
  */
 void GUI_clearDisplay() {
     
-    Display_clear(hDisplay);
+    LCD_clear();
+    
+}
+
+
+/**
+ * Blank the display for standby, what was on it is kept.
+ */
+void GUI_sleepDisplay() {
+    
+    LCD_sleep();
+    
+}
+
+
+/**
+ * Show the display again after GUI_sleepDisplay().
+ */
+void GUI_wakeDisplay() {
+    
+    LCD_wake();
     
 }
 
@@ -107,8 +167,9 @@ void GUI_clearDisplay() {
  */
 void GUI_closeDisplay() {
     
-    Display_clear(hDisplay);
-    Display_close(hDisplay);
+    LCD_clear();
+    GrFlush(pContext);
+    LCD_close();
     
 }
 
@@ -146,6 +207,8 @@ void GUI_moveMenuCursor(uint8_t itemCount) {
  */
 void GUI_updateScreen(Activity *activity, View *view, uint8_t batteryLevel, uint16_t score, char msgs[MSGS_MAX_COUNT][MAX_TEXT_LEN], uint8_t msgCount, uint8_t *newMsg) {
     
+    uint8_t cleared = forceScrClear;
+    
     // clear screen before updating if forced
     if (forceScrClear) {
         GUI_clearDisplay();
@@ -166,7 +229,7 @@ void GUI_updateScreen(Activity *activity, View *view, uint8_t batteryLevel, uint
     switch(*view) {
         
         case VW_MAIN:
-            GUI_mainView(*activity, score);
+            GUI_mainView(*activity, score, cleared);
             break;
             
         case VW_MENU:
@@ -185,9 +248,17 @@ void GUI_updateScreen(Activity *activity, View *view, uint8_t batteryLevel, uint
             GUI_settingsView();
             break;
             
+        case VW_GAME:
+            GUI_gameView(cleared);
+            break;
+            
         case VW_CONFM_SHUTDOWN:
             GUI_confmShutdownView();
             break;
+            
+        case VW_DIAG:
+            GUI_diagView();
+            break;
     }
     
     
@@ -201,6 +272,20 @@ void GUI_updateScreen(Activity *activity, View *view, uint8_t batteryLevel, uint
 }
 
 
+/**
+ * Advance animations. Called on every round of the main loop.
+ * 
+ * @view        Current view
+ */
+void GUI_tick(View view) {
+    
+    if (view == VW_MAIN && ANIM_tick(&activityAnim)) {
+        GrFlush(pContext);
+    }
+    
+}
+
+
 /**
  * Change view.
  * 
@@ -228,17 +313,34 @@ void GUI_changeView(View *view, int newView, State *state) {
  * Draws the main/home screen including activity icon in the middle and
  * the score reading on the bottom.
  * 
+ * When the activity changes, the image is not swapped here but animated
+ * by GUI_tick().
+ * 
  * @activity        Handle to Activity
  * @score           Current score.
+ * @cleared         True if the screen was just cleared
  */
-void GUI_mainView(Activity activity, uint16_t score) {
-
+void GUI_mainView(Activity activity, uint16_t score, uint8_t cleared) {
+    uint8_t stairs = (activity == ACT_STAIRS);
+    
     // Show activity icon on the screen
     
-    if (activity == ACT_STAIRS) {
-        GrImageDraw(pContext, &img_stairs_up, 20, 17);
-    } else {
-        GrImageDraw(pContext, &img_standing, 20, 17);
+    if (cleared) {
+        
+        // nothing to animate from, just draw it
+        ANIM_stop(&activityAnim);
+        GrImageDraw(pContext, stairs ? &img_stairs_up : &img_standing, ACTIVITY_IMG_X, ACTIVITY_IMG_Y);
+        showsStairs = stairs;
+        
+    } else if (stairs != showsStairs) {
+        
+        // turn back if the previous change is still on its way
+        if (ANIM_isRunning(&activityAnim)) {
+            ANIM_reverse(&activityAnim);
+        } else {
+            ANIM_start(&activityAnim, &anim_stand_to_stairs, ACTIVITY_IMG_X, ACTIVITY_IMG_Y, stairs ? 1 : -1);
+        }
+        showsStairs = stairs;
     }
     
     // draw the price and current score
@@ -263,13 +365,15 @@ void GUI_menuView() {
         &icon_home,
         &icon_messages,
         &icon_stats,
+        &icon_game,
     };
     
     char labels[MAIN_MENU_LEN][MAX_TEXT_LEN] = {
         "Settings",
         "Home",
         "Messages",
-        "Stats"
+        "Stats",
+        "Game"
     };
     
     uint8_t i;
@@ -351,23 +455,39 @@ void GUI_messagesView(char messages[MSGS_MAX_COUNT][MAX_TEXT_LEN], uint8_t msgCo
 
 
 /**
- * Draw the statistics view.
- * 
- * This was supposed to show so much more stuff but sadly I ran out of time...
+ * Draw the statistics view: score and a bar chart of the time spent on
+ * stairs, the score gained or the floors climbed. Button 2 switches between
+ * minute, hour and day resolution of each chart in turn.
  * 
  * @score   Current score
  */
 void GUI_statsView(uint16_t score) {
     char score_str[MAX_TEXT_LEN];
     
+    // chart window labels for each resolution
+    char labels[HIST_RES_COUNT][MAX_TEXT_LEN] = {
+        "24min",
+        "24h",
+        "7d"
+    };
+    
     GrStringDraw(pContext, "STATS", -1, 4, GUI_CONTENT_Y, 0);
     
-    sprintf(score_str, "Score: %d", score);
-    GrStringDraw(pContext, score_str, -1, 4, GUI_CONTENT_Y + 16, 1);
+    if (statsEnergy) {
+        GrStringDraw(pContext, "mAh/h", -1, 44, GUI_CONTENT_Y, 0);
+        drawEnergy();
+    } else {
+        GrStringDraw(pContext, labels[statsRes], -1, 44, GUI_CONTENT_Y, 0);
+        
+        sprintf(score_str, "Score: %d", score);
+        GrStringDraw(pContext, score_str, -1, 4, GUI_CONTENT_Y + 12, 1);
+        
+        drawChart(statsRes, statsKind);
+    }
     
     // GUI elements are drawn last so they are always on top
     drawButton(ICON_BACK, 1);
-    drawButton(ICON_EMPTY, 2);
+    drawButton(ICON_DOWN, 2);
 }
 
 
@@ -417,6 +537,43 @@ void GUI_settingsView() {
 }
 
 
+/**
+ * Draw the game view. The game field itself is drawn by the game on every
+ * main loop (see GAME_frame()), this only adds the score line and buttons.
+ * 
+ * @cleared     True if the screen was just cleared
+ */
+void GUI_gameView(uint8_t cleared) {
+    char score_str[MAX_TEXT_LEN];
+    
+    // everything the game had drawn is gone
+    if (cleared) {
+        GAME_invalidate();
+        GAME_render();
+    }
+    
+    if (GAME_isOver()) {
+        // scores past 999 would not fit the line next to each other
+        uint16_t score = GAME_score();
+        uint16_t best = GAME_best();
+        
+        score = (score > 999) ? 999 : score;
+        best = (best > 999) ? 999 : best;
+        
+        snprintf(score_str, sizeof score_str, "OVER %3u/%3u", score, best);
+    } else {
+        sprintf(score_str, "GAME %7u", GAME_score());
+    }
+    
+    GrStringDraw(pContext, score_str, -1, 4, GUI_CONTENT_Y, 1);
+    
+    // GUI elements are drawn last so they are always on top
+    drawButton(ICON_BACK, 1);
+    drawButton(ICON_SELECT, 2);
+    
+}
+
+
 /**
  * Confirm shutdown. This is the view that asks: "Are you sure?"
  */
@@ -432,6 +589,40 @@ void GUI_confmShutdownView() {
 }
 
 
+/**
+ * Draw the diagnostics view: CPU load of the last second and the rolling
+ * average, the load from the idle loop count and the load of each task.
+ * Button 2 dumps the same figures (libs/diag.h).
+ */
+void GUI_diagView() {
+    const LoadStats *load = LOAD_stats();
+    char line[MAX_TEXT_LEN];
+    uint8_t i;
+    
+    GrStringDraw(pContext, "DIAG", -1, 4, GUI_CONTENT_Y, 0);
+    
+    sprintf(line, "CPU %3u/%3u%%", load->cpu, load->cpuAvg);
+    GrStringDraw(pContext, line, -1, 4, GUI_CONTENT_Y + 12, 1);
+    
+    // the count is valid from the second window after opening the view
+    if (load->countLoad >= 0) {
+        sprintf(line, "cnt     %3d%%", load->countLoad);
+    } else {
+        sprintf(line, "cnt        -");
+    }
+    GrStringDraw(pContext, line, -1, 4, GUI_CONTENT_Y + 21, 1);
+    
+    for (i = 0; i < load->taskCount; i++) {
+        sprintf(line, "%-4.4s    %3u%%", load->tasks[i].name, load->tasks[i].load);
+        GrStringDraw(pContext, line, -1, 4, GUI_CONTENT_Y + 33 + 9*i, 1);
+    }
+    
+    // GUI elements are drawn last so they are always on top
+    drawButton(ICON_BACK, 1);
+    drawButton(ICON_SELECT, 2);
+}
+
+
 /* Smaller parts... */
 
 /**
@@ -516,9 +707,7 @@ void drawBatteryIndicator(uint8_t batteryLevel) {
             break;
         }
         
-        // this is my hax to fill those rects since GrRectFill() didn't work :(
-        GrRectDraw(pContext, bars[i]);
-        GrLineDrawV(pContext, 5+i*4, 5, 8);
+        GrRectFill(pContext, bars[i]);
     }
 }
 
@@ -537,3 +726,146 @@ void drawScore(uint16_t score) {
     GrImageDraw(pContext, &icon_price, 0, SCREEN_H-18);
     GrStringDraw(pContext, score_str, -1, 2+12+2, SCREEN_H-2-11, 1);
 }
+
+
+/**
+ * Draw a bar chart of one field of the history for given resolution, newest
+ * bucket on the right, and its total under it. Only the buckets that fit on
+ * the screen are fetched from the history.
+ * 
+ * @res     History resolution to draw
+ * @kind    Which field of the buckets to draw
+ */
+void drawChart(HistRes res, ChartKind kind) {
+    char total_str[MAX_TEXT_LEN];
+    uint16_t values[HIST_MINUTES];  // the longest ring of the history
+    HistBucket bucket;
+    
+    uint8_t count = HIST_length(res);
+    uint8_t slots = (res == HIST_RES_DAY) ? HIST_DAYS : HIST_MINUTES;
+    uint8_t pitch = CHART_W / slots;
+    uint8_t barW = (pitch > 2) ? pitch - 1 : pitch;
+    uint16_t max = 1;
+    uint32_t total = 0;
+    
+    uint8_t i, j;
+    
+    // fetch the visible buckets and find the scale
+    for(i=0; i < count; i++) {
+        HIST_get(res, i, &bucket);
+        
+        switch (kind) {
+            case CHART_SCORE:
+                values[i] = bucket.score;
+                break;
+            case CHART_FLOORS:
+                values[i] = bucket.floors;
+                break;
+            default:
+                values[i] = bucket.stairs;
+                break;
+        }
+        total += values[i];
+        
+        if (values[i] > max) {
+            max = values[i];
+        }
+    }
+    
+    for(i=0; i < slots; i++) {
+        
+        // newest bucket is on the right edge
+        uint8_t age = slots - 1 - i;
+        uint8_t h = (age < count) ? (uint32_t)values[age] * (CHART_BOTTOM - CHART_TOP) / max : 0;
+        long x = CHART_X + i * pitch;
+        
+        for(j=0; j < barW; j++) {
+            drawColumn(x + j, CHART_TOP, CHART_BOTTOM - 1, CHART_BOTTOM - h);
+        }
+    }
+    
+    GrLineDrawH(pContext, CHART_X, CHART_X + CHART_W, CHART_BOTTOM);
+    
+    // day buckets are already in minutes, others in seconds
+    if (kind == CHART_STAIRS && res != HIST_RES_DAY) {
+        total /= 60;
+    }
+    
+    // six digits is all that fits after the label
+    total = (total > 999999) ? 999999 : total;
+    
+    switch (kind) {
+        case CHART_SCORE:
+            snprintf(total_str, sizeof total_str, "Points: %lu", (unsigned long)total);
+            break;
+        case CHART_FLOORS:
+            snprintf(total_str, sizeof total_str, "Floors: %lu", (unsigned long)total);
+            break;
+        default:
+            snprintf(total_str, sizeof total_str, "Stairs: %lum", (unsigned long)total);
+            break;
+    }
+    GrStringDraw(pContext, total_str, -1, 4, CHART_BOTTOM + 3, 1);
+}
+
+
+/**
+ * Energy breakdown: mean current (mAh per hour) in total and of each part
+ * of the device since boot (libs/energy.h).
+ */
+void drawEnergy() {
+    const EnergyStats *energy = ENERGY_stats();
+    char line[MAX_TEXT_LEN];
+    uint32_t rates[6];
+    uint8_t i;
+    
+    const char *labels[6] = {
+        "total",
+        "cpu",
+        "radio",
+        "mpu",
+        "lcd",
+        "other"
+    };
+    
+    rates[0] = energy->totalRate;
+    rates[1] = energy->rate[EN_CPU] + energy->rate[EN_STANDBY];
+    rates[2] = energy->rate[EN_RADIO_RX] + energy->rate[EN_RADIO_TX] + energy->rate[EN_RADIO_IDLE];
+    rates[3] = energy->rate[EN_MPU] + energy->rate[EN_MPU_LP];
+    rates[4] = energy->rate[EN_LCD];
+    rates[5] = energy->rate[EN_I2C] + energy->rate[EN_FLASH];
+    
+    for (i = 0; i < 6; i++) {
+        // 99.99 mA at most, so that the line fits
+        if (rates[i] > 99999) {
+            rates[i] = 99999;
+        }
+        sprintf(line, "%-6s%2lu.%02lu", labels[i],
+            (unsigned long)(rates[i] / 1000), (unsigned long)(rates[i] % 1000 / 10));
+        GrStringDraw(pContext, line, -1, 4, GUI_CONTENT_Y + 12 + 9*i + (i > 0 ? 3 : 0), 1);
+    }
+}
+
+/**
+ * Draw a single filled column and erase whatever was above it, so that the
+ * chart can be redrawn without clearing the whole screen.
+ * 
+ * @x       Column x coordinate
+ * @yTop    Topmost pixel of the column area
+ * @yBottom Bottommost pixel of the column area
+ * @yFill   Topmost filled pixel (the column is empty if @yFill > @yBottom)
+ */
+void drawColumn(long x, long yTop, long yBottom, long yFill) {
+    unsigned long fg = pContext->ulForeground;
+    
+    if (yFill <= yBottom) {
+        GrLineDrawV(pContext, x, yFill, yBottom);
+    }
+    
+    // erase the rest with background color
+    if (yFill > yTop) {
+        pContext->ulForeground = pContext->ulBackground;
+        GrLineDrawV(pContext, x, yTop, yFill - 1);
+        pContext->ulForeground = fg;
+    }
+}
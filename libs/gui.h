@@ -28,11 +28,12 @@
 #include <xdc/std.h>
 #include <xdc/runtime/System.h>
 
-#include <ti/mw/display/Display.h>
-#include <ti/mw/display/DisplayExt.h>
+#include <ti/mw/grlib/grlib.h>
 
 #include "upstair.h"
+#include "libs/lcd.h"
 #include "bitmaps/gui.h"
+#include "libs/history.h"
 
 #define GUI_CONTENT_Y 18    // starting coordinate of the content (y)
 
@@ -46,17 +47,32 @@ typedef enum {
     VW_SETTINGS,        // settings
     VW_GAME,            // the Game (never finished, sadly)
     VW_NEW_MSG,         // view recently received message
-    VW_CONFM_SHUTDOWN   // device shutdown confirmation
+    VW_CONFM_SHUTDOWN,  // device shutdown confirmation
+    VW_DIAG             // CPU load (hidden: button 1 in stats with button 2 held)
 } View;
 
 
+/* What the activity chart in stats view shows */
+typedef enum {
+    CHART_STAIRS,       // time spent on stairs
+    CHART_SCORE,        // score gained
+    CHART_FLOORS,       // floors climbed
+    CHART_KINDS
+} ChartKind;
+
+
 /* Public functions */
 
 uint8_t GUI_menuPos();
+uint8_t GUI_settingsMenuPos();
+uint8_t GUI_redrawPending();
 void GUI_initDisplay();
 void GUI_clearDisplay();
 void GUI_closeDisplay();
+void GUI_sleepDisplay();
+void GUI_wakeDisplay();
 void GUI_moveMenuCursor(uint8_t itemCount);
+void GUI_cycleStatsRes();
 void GUI_drawDynamics(View *view, float shakiness);
 void GUI_updateScreen(
     Activity *activity,
@@ -69,16 +85,19 @@ void GUI_updateScreen(
     uint8_t *newMsg
 );
 void GUI_changeView(View *view, int newView, State *state);
+void GUI_tick(View view);
 
 
 /* View renderers */
 
-void GUI_mainView(Activity activity, uint16_t score);
+void GUI_mainView(Activity activity, uint16_t score, uint8_t cleared);
 void GUI_menuView();
 void GUI_messagesView(char msgs[MSGS_MAX_COUNT][MAX_TEXT_LEN], uint8_t msgCount);
 void GUI_statsView(uint16_t score);
 void GUI_settingsView();
+void GUI_gameView(uint8_t cleared);
 void GUI_confmShutdownView();
+void GUI_diagView();
 
 
 /* Other functions */
@@ -86,5 +105,8 @@ void GUI_confmShutdownView();
 void drawButton(int icon, uint8_t pos);
 void drawBatteryIndicator(uint8_t batteryLevel);
 void drawScore(uint16_t score);
+void drawChart(HistRes res, ChartKind kind);
+void drawEnergy();
+void drawColumn(long x, long yTop, long yBottom, long yFill);
 
 #endif /* UPSTAIR_GUI_H */
@@ -0,0 +1,222 @@
+ /**************************************************************
+  * 
+  *   _   _           _        _        ____    ___  
+  *  | | | |_ __  ___| |_ __ _(_)_ __  |___ \  / _ \ 
+  *  | | | | '_ \/ __| __/ _` | | '__|   __) || | | |
+  *  | |_| | |_) \__ \ || (_| | | |     / __/ | |_| |
+  *   \___/| .__/|___/\__\__,_|_|_|    |_____(_)___/ 
+  *        |_| Miika Sikala, Oulun Yliopisto, 2018
+  * 
+  * 
+  * ************************************************************
+  * THE BEER-WARE LICENSE
+  * This file is part of Upstair 2.0 software. As long as you retain this notice you
+  * can do whatever you want with this stuff. If we meet some day, and you think
+  * this stuff is worth it, you can buy me a beer in return.
+  * 
+  * Miika Sikala
+  * ************************************************************
+  */
+  
+#include <string.h>
+
+#include "libs/history.h"
+
+
+
+/*******************************
+ *        DEFINITIONS          *
+ ******************************/
+
+/* Running totals of the bucket currently being filled */
+typedef struct {
+    uint32_t stairs;        // seconds
+    uint32_t idle;          // seconds
+    uint16_t score;
+    uint16_t floors;
+} HistAcc;
+
+/* One resolution of the history */
+typedef struct {
+    HistBucket *ring;       // completed buckets, oldest gets overwritten
+    uint8_t len;            // capacity of the ring
+    uint8_t head;           // slot the next completed bucket goes to
+    uint8_t count;          // how many completed buckets there are
+    uint8_t span;           // how many lower level buckets make one of these
+    uint8_t elapsed;        // lower level buckets accumulated so far
+    uint8_t unit;           // seconds per stored time unit
+    HistAcc acc;            // the bucket currently being filled
+} HistLevel;
+
+static HistBucket minuteRing[HIST_MINUTES];
+static HistBucket hourRing[HIST_HOURS];
+static HistBucket dayRing[HIST_DAYS];
+
+// the ticks (seconds) themselves act as the "lower level" of minutes
+static HistLevel levels[HIST_RES_COUNT] = {
+    { minuteRing, HIST_MINUTES, 0, 0, 60, 0, 1  },
+    { hourRing,   HIST_HOURS,   0, 0, 60, 0, 1  },
+    { dayRing,    HIST_DAYS,    0, 0, 24, 0, 60 }
+};
+
+
+
+/*******************************
+ *          FUNCTIONS          *
+ ******************************/
+
+
+/**
+ * Convert running totals to a stored bucket.
+ * 
+ * @lvl     Level the bucket belongs to (defines the time unit)
+ * @acc     Running totals
+ * @bucket  Where to store the result
+ */
+static void toBucket(const HistLevel *lvl, const HistAcc *acc, HistBucket *bucket) {
+    uint32_t stairs = acc->stairs / lvl->unit;
+    uint32_t idle = acc->idle / lvl->unit;
+    
+    bucket->stairs = (stairs > 0xFFFF) ? 0xFFFF : stairs;
+    bucket->idle = (idle > 0xFFFF) ? 0xFFFF : idle;
+    bucket->score = acc->score;
+    bucket->floors = acc->floors;
+}
+
+
+/**
+ * Close the current bucket of given level, store it to the ring and carry
+ * the totals up to the next level. Each level is touched at most once per
+ * tick, so this stays constant time.
+ * 
+ * @res     Level whose bucket is complete
+ */
+static void closeBucket(HistRes res) {
+    
+    while (res < HIST_RES_COUNT) {
+        HistLevel *lvl = &levels[res];
+        
+        toBucket(lvl, &lvl->acc, &lvl->ring[lvl->head]);
+        
+        lvl->head = (lvl->head + 1) % lvl->len;
+        if (lvl->count < lvl->len) {
+            ++lvl->count;
+        }
+        
+        // carry the totals to the next level
+        if (res + 1 < HIST_RES_COUNT) {
+            HistLevel *up = &levels[res + 1];
+            
+            up->acc.stairs += lvl->acc.stairs;
+            up->acc.idle += lvl->acc.idle;
+            up->acc.score += lvl->acc.score;
+            up->acc.floors += lvl->acc.floors;
+            
+            ++up->elapsed;
+        }
+        
+        memset(&lvl->acc, 0, sizeof(lvl->acc));
+        lvl->elapsed = 0;
+        
+        // next level isn't full yet, we're done
+        if (res + 1 >= HIST_RES_COUNT || levels[res + 1].elapsed < levels[res + 1].span) {
+            break;
+        }
+        
+        ++res;
+    }
+}
+
+
+/**
+ * Record one second of activity. Call this once per second.
+ * 
+ * @activity    What the user was doing during the last second
+ */
+void HIST_tick(Activity activity) {
+    HistLevel *lvl = &levels[HIST_RES_MINUTE];
+    
+    if (activity == ACT_STAIRS) {
+        ++lvl->acc.stairs;
+    } else {
+        ++lvl->acc.idle;
+    }
+    
+    if (++lvl->elapsed >= lvl->span) {
+        closeBucket(HIST_RES_MINUTE);
+    }
+}
+
+
+/**
+ * Record gained score to the current bucket.
+ * 
+ * @points  How many points were gained
+ */
+void HIST_addScore(uint16_t points) {
+    levels[HIST_RES_MINUTE].acc.score += points;
+}
+
+
+/**
+ * Record climbed floors to the current bucket.
+ * 
+ * @floors  How many floors were climbed
+ */
+void HIST_addFloors(uint16_t floors) {
+    levels[HIST_RES_MINUTE].acc.floors += floors;
+}
+
+
+/**
+ * How many buckets of given resolution there are to show, including the one
+ * still being filled.
+ * 
+ * @res     Resolution
+ * @return  Number of buckets available to HIST_get()
+ */
+uint8_t HIST_length(HistRes res) {
+    const HistLevel *lvl = &levels[res];
+    
+    return (lvl->count < lvl->len) ? lvl->count + 1 : lvl->len;
+}
+
+
+/**
+ * Get one bucket of the history.
+ * 
+ * Only the running totals of the current bucket are converted, older buckets
+ * are read straight from the ring so nothing gets rescanned.
+ * 
+ * @res     Resolution
+ * @age     0 => current (incomplete) bucket, 1 => the one before that...
+ * @bucket  Where to store the bucket
+ * @return  1 if the bucket exists, 0 otherwise
+ */
+uint8_t HIST_get(HistRes res, uint8_t age, HistBucket *bucket) {
+    const HistLevel *lvl = &levels[res];
+    
+    if (age >= HIST_length(res)) {
+        return 0;
+    }
+    
+    if (age == 0) {
+        
+        // lower levels haven't been carried up yet, add them on the fly
+        HistAcc acc = lvl->acc;
+        uint8_t i;
+        for(i=HIST_RES_MINUTE; i < res; i++) {
+            acc.stairs += levels[i].acc.stairs;
+            acc.idle += levels[i].acc.idle;
+            acc.score += levels[i].acc.score;
+            acc.floors += levels[i].acc.floors;
+        }
+        
+        toBucket(lvl, &acc, bucket);
+        
+    } else {
+        *bucket = lvl->ring[(lvl->head + lvl->len - age) % lvl->len];
+    }
+    
+    return 1;
+}
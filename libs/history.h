@@ -0,0 +1,67 @@
+ /**************************************************************
+  * 
+  *   _   _           _        _        ____    ___  
+  *  | | | |_ __  ___| |_ __ _(_)_ __  |___ \  / _ \ 
+  *  | | | | '_ \/ __| __/ _` | | '__|   __) || | | |
+  *  | |_| | |_) \__ \ || (_| | | |     / __/ | |_| |
+  *   \___/| .__/|___/\__\__,_|_|_|    |_____(_)___/ 
+  *        |_| Miika Sikala, Oulun Yliopisto, 2018
+  * 
+  * 
+  * ************************************************************
+  * THE BEER-WARE LICENSE
+  * This file is part of Upstair 2.0 software. As long as you retain this notice you
+  * can do whatever you want with this stuff. If we meet some day, and you think
+  * this stuff is worth it, you can buy me a beer in return.
+  * 
+  * Miika Sikala
+  * ************************************************************
+  */
+  
+#ifndef UPSTAIR_HISTORY_H
+#define UPSTAIR_HISTORY_H
+
+/* Standard libs */
+#include <inttypes.h>
+
+#include "upstair.h"
+
+/* How many buckets are kept for each resolution */
+#define HIST_MINUTES    24      // last 24 minutes
+#define HIST_HOURS      24      // last 24 hours
+#define HIST_DAYS       7       // last 7 days
+
+
+/* Resolutions of the history */
+typedef enum {
+    HIST_RES_MINUTE,
+    HIST_RES_HOUR,
+    HIST_RES_DAY,
+    HIST_RES_COUNT
+} HistRes;
+
+
+/*
+ * One aggregated bucket of activity history.
+ * 
+ * Durations are in seconds for minute and hour buckets and in minutes for
+ * day buckets (a day worth of seconds doesn't fit into 16 bits).
+ */
+typedef struct {
+    uint16_t stairs;        // time spent climbing stairs
+    uint16_t idle;          // time spent doing something else
+    uint16_t score;         // score gained
+    uint16_t floors;        // floors climbed
+} HistBucket;
+
+
+/* Public functions */
+
+void HIST_tick(Activity activity);
+void HIST_addScore(uint16_t points);
+void HIST_addFloors(uint16_t floors);
+
+uint8_t HIST_length(HistRes res);
+uint8_t HIST_get(HistRes res, uint8_t age, HistBucket *bucket);
+
+#endif /* UPSTAIR_HISTORY_H */
@@ -0,0 +1,265 @@
+ /**************************************************************
+  * 
+  *   _   _           _        _        ____    ___  
+  *  | | | |_ __  ___| |_ __ _(_)_ __  |___ \  / _ \ 
+  *  | | | | '_ \/ __| __/ _` | | '__|   __) || | | |
+  *  | |_| | |_) \__ \ || (_| | | |     / __/ | |_| |
+  *   \___/| .__/|___/\__\__,_|_|_|    |_____(_)___/ 
+  *        |_| Miika Sikala, Oulun Yliopisto, 2018
+  * 
+  * 
+  * ************************************************************
+  * THE BEER-WARE LICENSE
+  * This file is part of Upstair 2.0 software. As long as you retain this notice you
+  * can do whatever you want with this stuff. If we meet some day, and you think
+  * this stuff is worth it, you can buy me a beer in return.
+  * 
+  * Miika Sikala
+  * ************************************************************
+  */
+  
+/* Standard libs */
+#include <string.h>
+
+#include "libs/imucodec.h"
+
+
+
+/*******************************
+ *        DEFINITIONS          *
+ ******************************/
+
+#define zigzag(d)   ((uint16_t)(((d) << 1) ^ ((d) >> 15)))
+#define unzigzag(z) ((int16_t)(((z) >> 1) ^ -((z) & 1)))
+
+
+
+/*******************************
+ *          FUNCTIONS          *
+ ******************************/
+
+
+/**
+ * Bits needed for @v.
+ */
+static uint8_t bitWidth(uint16_t v) {
+    uint8_t w = 0;
+    
+    while (v) {
+        v >>= 1;
+        ++w;
+    }
+    
+    return w;
+}
+
+/**
+ * Block size with @n samples and @total bits per sample.
+ */
+static uint16_t blockBytes(uint8_t axes, uint8_t n, uint16_t total) {
+    return IMC_HEADER_BYTES(axes) + (total * (n - 1) + 7) / 8;
+}
+
+/**
+ * Start encoding.
+ * 
+ * @axes        Values per sample (max IMC_MAX_AXES)
+ * @maxBytes    Largest block to make (at least IMC_HEADER_BYTES(axes))
+ */
+void IMC_init(ImcEncoder *enc, uint8_t axes, uint8_t maxBytes) {
+    
+    memset(enc, 0, sizeof(*enc));
+    enc->axes = axes;
+    enc->maxBytes = maxBytes;
+}
+
+/**
+ * Add a sample to the block.
+ * 
+ * @return  1 if added, 0 if the block is full (flush it and add again)
+ */
+uint8_t IMC_put(ImcEncoder *enc, const int16_t *sample) {
+    uint8_t width[IMC_MAX_AXES];
+    uint8_t total = enc->totalWidth;
+    uint16_t *deltas;
+    uint16_t bytes;
+    int16_t d;
+    uint8_t a;
+    
+    if (enc->count == 0) {
+        memcpy(enc->first, sample, enc->axes * sizeof(int16_t));
+        memcpy(enc->prev, sample, enc->axes * sizeof(int16_t));
+        enc->count = 1;
+        enc->bytes = IMC_HEADER_BYTES(enc->axes);
+        return 1;
+    }
+    
+    if (enc->count == IMC_MAX_SAMPLES) {
+        return 0;
+    }
+    
+    deltas = enc->deltas[enc->count - 1];
+    
+    // widths only grow, and mostly stay the same
+    for (a = 0; a < enc->axes; ++a) {
+        d = (int16_t)(sample[a] - enc->prev[a]);
+        deltas[a] = zigzag(d);
+        
+        width[a] = enc->width[a];
+        if (deltas[a] >> width[a]) {
+            width[a] = bitWidth(deltas[a]);
+            total += width[a] - enc->width[a];
+        }
+    }
+    
+    // doesn't fit with the wider deltas, leave it for the next block
+    bytes = blockBytes(enc->axes, enc->count + 1, total);
+    if (bytes > enc->maxBytes) {
+        return 0;
+    }
+    
+    memcpy(enc->width, width, enc->axes);
+    enc->totalWidth = total;
+    memcpy(enc->prev, sample, enc->axes * sizeof(int16_t));
+    enc->bytes = bytes;
+    ++enc->count;
+    
+    return 1;
+}
+
+/**
+ * Write the block and start a new one.
+ * 
+ * @out     Room for the block (maxBytes)
+ * 
+ * @return  Block size, 0 if there were no samples
+ */
+uint8_t IMC_flush(ImcEncoder *enc, uint8_t *out) {
+    uint8_t *p = out;
+    uint32_t acc = 0;               // bits waiting to be written
+    uint8_t accBits = 0;
+    const uint8_t *width = enc->width;
+    uint8_t bytes;
+    uint8_t a, i;
+    
+    if (enc->count == 0) {
+        return 0;
+    }
+    
+    *p++ = enc->count;
+    
+    for (a = 0; a < enc->axes; ++a) {
+        *p++ = (uint16_t)enc->first[a] & 0xFF;
+        *p++ = (uint16_t)enc->first[a] >> 8;
+    }
+    
+    for (a = 0; a < enc->axes; ++a) {
+        *p++ = width[a];
+    }
+    
+    for (a = 0; a < enc->axes; ++a) {
+        for (i = 0; i < enc->count - 1; ++i) {
+            
+            acc |= (uint32_t)enc->deltas[i][a] << accBits;
+            accBits += width[a];
+            
+            while (accBits >= 8) {
+                *p++ = acc & 0xFF;
+                acc >>= 8;
+                accBits -= 8;
+            }
+        }
+    }
+    
+    if (accBits > 0) {
+        *p++ = acc & 0xFF;
+    }
+    
+    bytes = p - out;
+    
+    enc->count = 0;
+    enc->totalWidth = 0;
+    memset(enc->width, 0, sizeof(enc->width));
+    
+    return bytes;
+}
+
+/**
+ * Decode a block.
+ * 
+ * Written as separate simple loops (unpack, zig-zag, prefix sum) so that
+ * compilers can vectorize them on the host.
+ * 
+ * @in      Block
+ * @len     Bytes available at @in
+ * @axes    Values per sample
+ * @out     Room for IMC_MAX_SAMPLES samples
+ * @count   Number of decoded samples
+ * 
+ * @return  Block size, 0 if it is broken
+ */
+uint8_t IMC_decode(const uint8_t *in, uint16_t len, uint8_t axes, int16_t *out, uint8_t *count) {
+    uint8_t buf[IMC_MAX_BYTES + 4];     // room to read 32 bits at any bit
+    uint16_t z[IMC_MAX_SAMPLES];
+    const uint8_t *widths;
+    uint32_t bitPos;
+    uint32_t word;
+    uint16_t total = 0;
+    uint16_t bytes;
+    uint16_t mask;
+    int16_t v;
+    uint8_t n, a, i;
+    
+    if (len < IMC_HEADER_BYTES(axes) || axes > IMC_MAX_AXES) {
+        return 0;
+    }
+    
+    n = in[0];
+    widths = &in[1 + 2 * axes];
+    
+    for (a = 0; a < axes; ++a) {
+        if (widths[a] > 16) {
+            return 0;
+        }
+        total += widths[a];
+    }
+    
+    bytes = IMC_HEADER_BYTES(axes) + (total * (n - 1) + 7) / 8;
+    if (n == 0 || n > IMC_MAX_SAMPLES || bytes > len || bytes > IMC_MAX_BYTES) {
+        return 0;
+    }
+    
+    memcpy(buf, in, bytes);
+    memset(&buf[bytes], 0, 4);
+    
+    bitPos = IMC_HEADER_BYTES(axes) * 8;
+    
+    for (a = 0; a < axes; ++a) {
+        
+        // unpack
+        mask = (1UL << widths[a]) - 1;
+        for (i = 0; i < n - 1; ++i) {
+            uint32_t at = bitPos + (uint32_t)i * widths[a];
+            
+            memcpy(&word, &buf[at >> 3], sizeof(word));
+            z[i] = (word >> (at & 7)) & mask;
+        }
+        bitPos += (uint32_t)(n - 1) * widths[a];
+        
+        // zig-zag back to signed deltas
+        for (i = 0; i < n - 1; ++i) {
+            z[i] = unzigzag(z[i]);
+        }
+        
+        // running sum from the first sample, wrapping like the encoder
+        v = (int16_t)(buf[1 + 2 * a] | (buf[2 + 2 * a] << 8));
+        out[a] = v;
+        for (i = 0; i < n - 1; ++i) {
+            v = (int16_t)(v + z[i]);
+            out[(i + 1) * axes + a] = v;
+        }
+    }
+    
+    *count = n;
+    return bytes;
+}
@@ -0,0 +1,73 @@
+ /**************************************************************
+  * 
+  *   _   _           _        _        ____    ___  
+  *  | | | |_ __  ___| |_ __ _(_)_ __  |___ \  / _ \ 
+  *  | | | | '_ \/ __| __/ _` | | '__|   __) || | | |
+  *  | |_| | |_) \__ \ || (_| | | |     / __/ | |_| |
+  *   \___/| .__/|___/\__\__,_|_|_|    |_____(_)___/ 
+  *        |_| Miika Sikala, Oulun Yliopisto, 2018
+  * 
+  * 
+  * ************************************************************
+  * THE BEER-WARE LICENSE
+  * This file is part of Upstair 2.0 software. As long as you retain this notice you
+  * can do whatever you want with this stuff. If we meet some day, and you think
+  * this stuff is worth it, you can buy me a beer in return.
+  * 
+  * Miika Sikala
+  * ************************************************************
+  */
+  
+#ifndef UPSTAIR_IMUCODEC_H
+#define UPSTAIR_IMUCODEC_H
+
+/* Standard libs */
+#include <inttypes.h>
+
+/*
+ * Block codec for IMU samples (tuples of int16_t, e.g. ax, ay, az, gx, gy, gz).
+ * 
+ * Samples are added one at a time and collected into blocks that decode on
+ * their own, so a lost radio frame or log record only loses its block.
+ * A block is
+ * 
+ *   count       u8, samples in the block
+ *   first       i16 per axis, the first sample (little endian)
+ *   width       u8 per axis, bits per delta
+ *   deltas      per axis, count-1 zig-zag coded deltas of width bits,
+ *               packed LSB first, axis after axis, padded to a byte
+ * 
+ * Deltas wrap around in 16 bits, so they always fit 16 bits and decode
+ * exactly. The width is the smallest one that fits all deltas of the axis
+ * in the block.
+ */
+
+#define IMC_MAX_AXES        6
+#define IMC_MAX_SAMPLES     32          // per block
+#define IMC_MAX_BYTES       255         // per block
+
+#define IMC_HEADER_BYTES(axes)  (1 + 3 * (axes))
+
+
+/* Encoder state */
+typedef struct {
+    uint8_t axes;
+    uint8_t maxBytes;                   // block size limit
+    uint8_t count;                      // samples in the block
+    uint16_t bytes;                     // size of the block so far
+    int16_t first[IMC_MAX_AXES];
+    int16_t prev[IMC_MAX_AXES];
+    uint8_t width[IMC_MAX_AXES];        // bits per delta so far
+    uint8_t totalWidth;                 // sum of widths
+    uint16_t deltas[IMC_MAX_SAMPLES - 1][IMC_MAX_AXES];
+} ImcEncoder;
+
+
+/* Public functions */
+
+void IMC_init(ImcEncoder *enc, uint8_t axes, uint8_t maxBytes);
+uint8_t IMC_put(ImcEncoder *enc, const int16_t *sample);
+uint8_t IMC_flush(ImcEncoder *enc, uint8_t *out);
+uint8_t IMC_decode(const uint8_t *in, uint16_t len, uint8_t axes, int16_t *out, uint8_t *count);
+
+#endif /* UPSTAIR_IMUCODEC_H */
@@ -0,0 +1,621 @@
+ /**************************************************************
+  * 
+  *   _   _           _        _        ____    ___  
+  *  | | | |_ __  ___| |_ __ _(_)_ __  |___ \  / _ \ 
+  *  | | | | '_ \/ __| __/ _` | | '__|   __) || | | |
+  *  | |_| | |_) \__ \ || (_| | | |     / __/ | |_| |
+  *   \___/| .__/|___/\__\__,_|_|_|    |_____(_)___/ 
+  *        |_| Miika Sikala, Oulun Yliopisto, 2018
+  * 
+  * 
+  * ************************************************************
+  * THE BEER-WARE LICENSE
+  * This file is part of Upstair 2.0 software. As long as you retain this notice you
+  * can do whatever you want with this stuff. If we meet some day, and you think
+  * this stuff is worth it, you can buy me a beer in return.
+  * 
+  * Miika Sikala
+  * ************************************************************
+  */
+  
+#include <string.h>
+
+/* XDCtools Header files */
+#include <xdc/std.h>
+#include <xdc/runtime/System.h>
+#include <ti/sysbios/BIOS.h>
+#include <ti/sysbios/knl/Clock.h>
+#include <ti/sysbios/knl/Semaphore.h>
+
+/* TI-RTOS Header files */
+#include <ti/drivers/PIN.h>
+
+#include "Board.h"
+#include "libs/lcd.h"
+#include "libs/spibus.h"
+
+
+
+/*******************************
+ *        DEFINITIONS          *
+ ******************************/
+
+/* Sharp memory LCD commands (M0 is the first bit on the wire) */
+#define LCD_CMD_WRITE       0x80
+#define LCD_CMD_CLEAR       0x20
+
+/*
+ * Frame buffer is stored in wire format:
+ * 
+ *   [cmd] [addr | 12 x data | dummy] x 96 [trailer]
+ * 
+ * The dummy byte of every line holds the write command, so any run of
+ * consecutive lines can be sent straight from the buffer starting one byte
+ * before its first line. The byte after the run (next line address or the
+ * trailer) is clocked out as the trailing dummy byte.
+ */
+#define LCD_LINE_BYTES      (SCREEN_W / 8)
+#define LCD_LINE_SIZE       (1 + LCD_LINE_BYTES + 1)
+#define LCD_BUF_SIZE        (1 + SCREEN_H * LCD_LINE_SIZE + 1)
+#define LCD_LINE(y)         (&lcdBuf[1 + (y) * LCD_LINE_SIZE])
+
+// a DMA transaction can't exceed 1024 bytes
+#define LCD_MAX_RUN         ((1024 - 2) / LCD_LINE_SIZE)
+
+static uint8_t lcdBuf[LCD_BUF_SIZE];
+static uint8_t lineDirty[SCREEN_H / 8];     // changed since last flush
+static uint8_t lineSend[SCREEN_H / 8];      // queued by the ongoing flush
+
+static tRectangle blitClip = { 0, 0, SCREEN_W - 1, SCREEN_H - 1 };
+
+static volatile uint8_t busy = 0;           // flush in progress
+static uint8_t nextLine = 0;                // where the ongoing flush continues
+static uint32_t flushStart = 0;
+static LCD_Stats stats;
+
+/* Drivers */
+static Semaphore_Handle hIdleSem;
+static Clock_Handle hVcomClock;
+static tContext lcdContext;
+
+// LCD pins
+static PIN_Handle hLcdPin;
+static PIN_State sLcdPin;
+static PIN_Config cLcdPin[] = {
+    Board_LCD_CS       | PIN_GPIO_OUTPUT_EN | PIN_GPIO_LOW | PIN_PUSHPULL | PIN_DRVSTR_MIN,
+    Board_LCD_EXTCOMIN | PIN_GPIO_OUTPUT_EN | PIN_GPIO_LOW | PIN_PUSHPULL | PIN_DRVSTR_MIN,
+    Board_LCD_ENABLE   | PIN_GPIO_OUTPUT_EN | PIN_GPIO_HIGH | PIN_PUSHPULL | PIN_DRVSTR_MIN,
+    PIN_TERMINATE
+};
+
+static void runDone();
+
+/* Prototypes of the grlib display driver */
+static void lcdPixelDraw(void *pvDisplayData, long lX, long lY, unsigned long ulValue);
+static void lcdPixelDrawMultiple(void *pvDisplayData, long lX, long lY, long lX0, long lCount, long lBPP, const unsigned char *pucData, const unsigned long *pucPalette);
+static void lcdLineDrawH(void *pvDisplayData, long lX1, long lX2, long lY, unsigned long ulValue);
+static void lcdLineDrawV(void *pvDisplayData, long lX, long lY1, long lY2, unsigned long ulValue);
+static void lcdRectFill(void *pvDisplayData, const tRectangle *pRect, unsigned long ulValue);
+static unsigned long lcdColorTranslate(void *pvDisplayData, unsigned long ulValue);
+static void lcdFlush(void *pvDisplayData);
+static void lcdClearDisplay(void *pvDisplayData, unsigned long ulValue);
+
+static const tDisplay lcdDisplay = {
+    sizeof(tDisplay),
+    lcdBuf,
+    SCREEN_W,
+    SCREEN_H,
+    lcdPixelDraw,
+    lcdPixelDrawMultiple,
+    lcdLineDrawH,
+    lcdLineDrawV,
+    lcdRectFill,
+    lcdColorTranslate,
+    lcdFlush,
+    lcdClearDisplay
+};
+
+
+
+/*******************************
+ *          FUNCTIONS          *
+ ******************************/
+
+
+/**
+ * Reverse bit order of a byte. Line addresses are sent LSB first.
+ */
+static uint8_t reverseBits(uint8_t b) {
+    b = (b & 0xF0) >> 4 | (b & 0x0F) << 4;
+    b = (b & 0xCC) >> 2 | (b & 0x33) << 2;
+    b = (b & 0xAA) >> 1 | (b & 0x55) << 1;
+    return b;
+}
+
+/**
+ * Block until the ongoing flush has been sent. The frame buffer is read by
+ * DMA during a flush, so it must not be drawn to before that.
+ */
+void LCD_waitIdle() {
+    while (busy) {
+        Semaphore_pend(hIdleSem, BIOS_WAIT_FOREVER);
+    }
+}
+
+/**
+ * Returns 1 if a flush is still being sent.
+ */
+uint8_t LCD_isBusy() {
+    return busy;
+}
+
+/**
+ * Getter for flush statistics.
+ */
+const LCD_Stats *LCD_getStats() {
+    return &stats;
+}
+
+/**
+ * Set bits of one byte in the frame buffer and mark the line dirty if the
+ * byte actually changed.
+ * 
+ * @y       Line
+ * @col     Byte index within the line
+ * @mask    Bits to set/clear
+ * @value   Pixel value (1 = white)
+ */
+static void setBits(long y, long col, uint8_t mask, unsigned long value) {
+    uint8_t *byte = LCD_LINE(y) + 1 + col;
+    uint8_t old = *byte;
+    
+    *byte = value ? (old | mask) : (old & ~mask);
+    
+    if (*byte != old) {
+        lineDirty[y >> 3] |= 1 << (y & 7);
+    }
+}
+
+/**
+ * Combine image bits with one byte of the frame buffer.
+ * 
+ * @y       Line
+ * @col     Byte index within the line (may be outside the screen)
+ * @bits    Image bits, 1 = ink
+ * @mode    How to combine
+ */
+static void blitBits(long y, long col, uint8_t bits, LCD_BlitMode mode) {
+    uint8_t *byte;
+    uint8_t old;
+    
+    if (y < blitClip.sYMin || y > blitClip.sYMax) {
+        return;
+    }
+    
+    // cut off the pixels outside the clip region
+    if (col < (blitClip.sXMin >> 3) || col > (blitClip.sXMax >> 3)) {
+        return;
+    }
+    if (col == (blitClip.sXMin >> 3)) {
+        bits &= 0xFF >> (blitClip.sXMin & 7);
+    }
+    if (col == (blitClip.sXMax >> 3)) {
+        bits &= 0xFF << (7 - (blitClip.sXMax & 7));
+    }
+    if (bits == 0) {
+        return;
+    }
+    
+    byte = LCD_LINE(y) + 1 + col;
+    old = *byte;
+    
+    switch(mode) {
+        case LCD_BLIT_SET:
+            *byte &= ~bits;
+            break;
+        case LCD_BLIT_CLEAR:
+            *byte |= bits;
+            break;
+        case LCD_BLIT_XOR:
+            *byte ^= bits;
+            break;
+    }
+    
+    if (*byte != old) {
+        lineDirty[y >> 3] |= 1 << (y & 7);
+    }
+}
+
+static void lcdPixelDraw(void *pvDisplayData, long lX, long lY, unsigned long ulValue) {
+    
+    if (lX < 0 || lX >= SCREEN_W || lY < 0 || lY >= SCREEN_H) {
+        return;
+    }
+    
+    LCD_waitIdle();
+    setBits(lY, lX >> 3, 0x80 >> (lX & 7), ulValue);
+}
+
+static void lcdPixelDrawMultiple(void *pvDisplayData, long lX, long lY, long lX0, long lCount, long lBPP, const unsigned char *pucData, const unsigned long *pucPalette) {
+    unsigned long byte;
+    
+    switch(lBPP) {
+        
+        case 1:
+            
+            // palette holds the two translated colors
+            while (lCount > 0) {
+                byte = *pucData++;
+                for(; lX0 < 8 && lCount > 0; lX0++, lCount--) {
+                    lcdPixelDraw(pvDisplayData, lX++, lY, pucPalette[(byte >> (7 - lX0)) & 1]);
+                }
+                lX0 = 0;
+            }
+            break;
+            
+        case 4:
+            
+            while (lCount > 0) {
+                byte = *pucData++;
+                for(; lX0 < 2 && lCount > 0; lX0++, lCount--) {
+                    lcdPixelDraw(pvDisplayData, lX++, lY, pucPalette[(byte >> (4 - 4 * lX0)) & 0x0F]);
+                }
+                lX0 = 0;
+            }
+            break;
+            
+        case 8:
+            
+            while (lCount-- > 0) {
+                lcdPixelDraw(pvDisplayData, lX++, lY, pucPalette[*pucData++]);
+            }
+            break;
+    }
+}
+
+static void lcdLineDrawH(void *pvDisplayData, long lX1, long lX2, long lY, unsigned long ulValue) {
+    long col;
+    
+    if (lY < 0 || lY >= SCREEN_H) {
+        return;
+    }
+    if (lX1 < 0) {
+        lX1 = 0;
+    }
+    if (lX2 >= SCREEN_W) {
+        lX2 = SCREEN_W - 1;
+    }
+    if (lX1 > lX2) {
+        return;
+    }
+    
+    LCD_waitIdle();
+    
+    // whole bytes in the middle, partial ones at the ends
+    for(col = lX1 >> 3; col <= lX2 >> 3; col++) {
+        uint8_t mask = 0xFF;
+        
+        if (col == lX1 >> 3) {
+            mask &= 0xFF >> (lX1 & 7);
+        }
+        if (col == lX2 >> 3) {
+            mask &= 0xFF << (7 - (lX2 & 7));
+        }
+        
+        setBits(lY, col, mask, ulValue);
+    }
+}
+
+static void lcdLineDrawV(void *pvDisplayData, long lX, long lY1, long lY2, unsigned long ulValue) {
+    long y;
+    
+    for(y = lY1; y <= lY2; y++) {
+        lcdPixelDraw(pvDisplayData, lX, y, ulValue);
+    }
+}
+
+static void lcdRectFill(void *pvDisplayData, const tRectangle *pRect, unsigned long ulValue) {
+    long y;
+    
+    for(y = pRect->sYMin; y <= pRect->sYMax; y++) {
+        lcdLineDrawH(pvDisplayData, pRect->sXMin, pRect->sXMax, y, ulValue);
+    }
+}
+
+/**
+ * Monochrome panel: anything bright enough is white (1).
+ */
+static unsigned long lcdColorTranslate(void *pvDisplayData, unsigned long ulValue) {
+    unsigned long r = (ulValue >> 16) & 0xFF;
+    unsigned long g = (ulValue >> 8) & 0xFF;
+    unsigned long b = ulValue & 0xFF;
+    
+    return ((r * 2 + g * 5 + b) >> 3) >= 0x80;
+}
+
+static void lcdClearDisplay(void *pvDisplayData, unsigned long ulValue) {
+    tRectangle all = { 0, 0, SCREEN_W - 1, SCREEN_H - 1 };
+    
+    lcdRectFill(pvDisplayData, &all, ulValue);
+}
+
+/**
+ * Send the next run of queued lines, or finish the flush if there are none
+ * left. Called from the flush itself and from the SPI callback.
+ */
+static void sendNextRun() {
+    uint8_t y = nextLine;
+    uint8_t n = 0;
+    uint16_t count;
+    
+    // find the first queued line
+    while (y < SCREEN_H && !(lineSend[y >> 3] & (1 << (y & 7)))) {
+        ++y;
+    }
+    
+    if (y >= SCREEN_H) {
+        
+        // all sent
+        stats.lastTime = (Clock_getTicks() - flushStart) * Clock_tickPeriod;
+        if (stats.lastTime > stats.maxTime) {
+            stats.maxTime = stats.lastTime;
+        }
+        stats.totalTime += stats.lastTime;
+        
+        busy = 0;
+        SPIBUS_release();
+        Semaphore_post(hIdleSem);
+        return;
+    }
+    
+    // how many consecutive lines are queued
+    while (y + n < SCREEN_H && n < LCD_MAX_RUN && (lineSend[(y + n) >> 3] & (1 << ((y + n) & 7)))) {
+        ++n;
+    }
+    
+    nextLine = y + n;
+    count = 1 + n * LCD_LINE_SIZE + 1;
+    
+    stats.lastBytes += count;
+    stats.totalBytes += count;
+    
+    PIN_setOutputValue(hLcdPin, Board_LCD_CS, Board_LCD_CS_ON);
+    SPIBUS_transferAsync(LCD_LINE(y) - 1, NULL, count, runDone);
+}
+
+/**
+ * A run of lines has been sent (called from interrupt context).
+ */
+static void runDone() {
+    
+    PIN_setOutputValue(hLcdPin, Board_LCD_CS, Board_LCD_CS_OFF);
+    sendNextRun();
+}
+
+/**
+ * Queue the changed lines and start sending them. Returns immediately (once
+ * the SPI bus is free), the rest is done by the SPI callback.
+ */
+static void lcdFlush(void *pvDisplayData) {
+    uint8_t y;
+    
+    LCD_waitIdle();
+    
+    stats.lastLines = 0;
+    
+    for(y=0; y < SCREEN_H; y++) {
+        if (lineDirty[y >> 3] & (1 << (y & 7))) {
+            ++stats.lastLines;
+        }
+    }
+    
+    memcpy(lineSend, lineDirty, sizeof(lineSend));
+    memset(lineDirty, 0, sizeof(lineDirty));
+    
+    if (stats.lastLines == 0) {
+        ++stats.skipped;
+        return;
+    }
+    
+    SPIBUS_acquire();
+    
+    ++stats.flushes;
+    stats.lastBytes = 0;
+    flushStart = Clock_getTicks();
+    nextLine = 0;
+    busy = 1;
+    
+    sendNextRun();
+}
+
+/**
+ * Clear the panel memory (not the frame buffer), all pixels white.
+ */
+static void panelClear() {
+    uint8_t clearCmd[2] = { LCD_CMD_CLEAR, 0x00 };
+    
+    SPIBUS_acquire();
+    PIN_setOutputValue(hLcdPin, Board_LCD_CS, Board_LCD_CS_ON);
+    SPIBUS_transfer(clearCmd, NULL, sizeof(clearCmd));
+    PIN_setOutputValue(hLcdPin, Board_LCD_CS, Board_LCD_CS_OFF);
+    SPIBUS_release();
+}
+
+/**
+ * Toggle VCOM, the panel needs this to avoid DC bias.
+ */
+static void vcomFxn(UArg arg) {
+    PIN_setOutputValue(hLcdPin, Board_LCD_EXTCOMIN, !PIN_getOutputValue(Board_LCD_EXTCOMIN));
+}
+
+/**
+ * Open the LCD and create a graphics context for it.
+ * 
+ * @return  Context to draw to
+ */
+tContext *LCD_open() {
+    Clock_Params clockParams;
+    Semaphore_Params semParams;
+    uint8_t y;
+    
+    hLcdPin = PIN_open(&sLcdPin, cLcdPin);
+    if (hLcdPin == NULL) {
+        System_abort("Error initializing LCD pins\n");
+    }
+    
+    // at most one post left over from a flush no one waited for
+    Semaphore_Params_init(&semParams);
+    semParams.mode = Semaphore_Mode_BINARY;
+    
+    hIdleSem = Semaphore_create(0, &semParams, NULL);
+    if (hIdleSem == NULL) {
+        System_abort("Error creating LCD semaphore\n");
+    }
+    
+    SPIBUS_open();
+    
+    // clear the panel so that it matches the (white) frame buffer
+    panelClear();
+    
+    // prepare the frame buffer
+    memset(lcdBuf, 0xFF, sizeof(lcdBuf));
+    lcdBuf[0] = LCD_CMD_WRITE;
+    
+    for(y=0; y < SCREEN_H; y++) {
+        LCD_LINE(y)[0] = reverseBits(y + 1);
+        LCD_LINE(y)[LCD_LINE_SIZE - 1] = LCD_CMD_WRITE;
+    }
+    
+    memset(lineDirty, 0, sizeof(lineDirty));
+    memset(&stats, 0, sizeof(stats));
+    
+    // VCOM toggling
+    Clock_Params_init(&clockParams);
+    clockParams.period = LCD_VCOM_PERIOD / Clock_tickPeriod;
+    clockParams.startFlag = TRUE;
+    
+    hVcomClock = Clock_create(vcomFxn, LCD_VCOM_PERIOD / Clock_tickPeriod, &clockParams, NULL);
+    if (hVcomClock == NULL) {
+        System_abort("Error creating LCD clock\n");
+    }
+    
+    GrContextInit(&lcdContext, &lcdDisplay);
+    GrContextForegroundSet(&lcdContext, ClrBlack);
+    GrContextBackgroundSet(&lcdContext, ClrWhite);
+    GrContextFontSet(&lcdContext, &g_sFontFixed6x8);
+    
+    return &lcdContext;
+}
+
+/**
+ * Clear the frame buffer (the panel is updated on next flush).
+ */
+void LCD_clear() {
+    lcdClearDisplay(lcdBuf, 1);
+}
+
+/**
+ * Send the changed lines to the panel (same as GrFlush()).
+ */
+void LCD_flush() {
+    lcdFlush(lcdBuf);
+}
+
+/**
+ * Limit LCD_blit() to a part of the screen.
+ * 
+ * @rect    Clip region, NULL for the whole screen
+ */
+void LCD_setClip(const tRectangle *rect) {
+    tRectangle all = { 0, 0, SCREEN_W - 1, SCREEN_H - 1 };
+    
+    blitClip = rect ? *rect : all;
+    
+    // never outside the frame buffer
+    if (blitClip.sXMin < 0) {
+        blitClip.sXMin = 0;
+    }
+    if (blitClip.sYMin < 0) {
+        blitClip.sYMin = 0;
+    }
+    if (blitClip.sXMax >= SCREEN_W) {
+        blitClip.sXMax = SCREEN_W - 1;
+    }
+    if (blitClip.sYMax >= SCREEN_H) {
+        blitClip.sYMax = SCREEN_H - 1;
+    }
+}
+
+/**
+ * Draw a 1bpp image straight to the frame buffer, a byte at a time. Much
+ * faster than GrImageDraw() for sprites that are redrawn every frame.
+ * 
+ * @x       Left edge (may be partly outside the screen)
+ * @y       Top edge (may be partly outside the screen)
+ * @w       Width in pixels
+ * @h       Height in pixels
+ * @rows    Image rows, (w + 7) / 8 bytes each, MSB is the leftmost pixel
+ * @mode    What to do with the 1 bits
+ */
+void LCD_blit(int16_t x, int16_t y, uint8_t w, uint8_t h, const uint8_t *rows, LCD_BlitMode mode) {
+    uint8_t stride = (w + 7) / 8;
+    uint8_t shift = x & 7;
+    int16_t col0 = (x - shift) / 8;
+    uint8_t lastMask = 0xFF << (stride * 8 - w);
+    uint8_t row, i, bits;
+    
+    LCD_waitIdle();
+    
+    for(row=0; row < h; row++, rows += stride) {
+        for(i=0; i < stride; i++) {
+            bits = (i == stride - 1) ? (rows[i] & lastMask) : rows[i];
+            
+            blitBits(y + row, col0 + i, bits >> shift, mode);
+            if (shift) {
+                blitBits(y + row, col0 + i + 1, bits << (8 - shift), mode);
+            }
+        }
+    }
+}
+
+/**
+ * Blank the panel and stop toggling VCOM, for standby. White pixels hold
+ * no charge, so the panel can go without VCOM while blank. The frame buffer
+ * is kept and can be drawn to, LCD_wake() shows it again.
+ */
+void LCD_sleep() {
+    
+    LCD_waitIdle();
+    
+    Clock_stop(hVcomClock);
+    panelClear();
+    PIN_setOutputValue(hLcdPin, Board_LCD_ENABLE, 0);
+}
+
+/**
+ * Turn the panel back on and send the whole frame buffer to it.
+ */
+void LCD_wake() {
+    
+    PIN_setOutputValue(hLcdPin, Board_LCD_ENABLE, 1);
+    Clock_start(hVcomClock);
+    
+    // the panel was cleared
+    memset(lineDirty, 0xFF, sizeof(lineDirty));
+    lcdFlush(lcdBuf);
+}
+
+/**
+ * Wait for the last flush to finish and release the LCD.
+ */
+void LCD_close() {
+    
+    LCD_waitIdle();
+    
+    Clock_stop(hVcomClock);
+    SPIBUS_close();
+    
+    // panel off
+    PIN_setOutputValue(hLcdPin, Board_LCD_ENABLE, 0);
+    PIN_close(hLcdPin);
+}
@@ -0,0 +1,75 @@
+ /**************************************************************
+  * 
+  *   _   _           _        _        ____    ___  
+  *  | | | |_ __  ___| |_ __ _(_)_ __  |___ \  / _ \ 
+  *  | | | | '_ \/ __| __/ _` | | '__|   __) || | | |
+  *  | |_| | |_) \__ \ || (_| | | |     / __/ | |_| |
+  *   \___/| .__/|___/\__\__,_|_|_|    |_____(_)___/ 
+  *        |_| Miika Sikala, Oulun Yliopisto, 2018
+  * 
+  * 
+  * ************************************************************
+  * THE BEER-WARE LICENSE
+  * This file is part of Upstair 2.0 software. As long as you retain this notice you
+  * can do whatever you want with this stuff. If we meet some day, and you think
+  * this stuff is worth it, you can buy me a beer in return.
+  * 
+  * Miika Sikala
+  * ************************************************************
+  */
+  
+#ifndef UPSTAIR_LCD_H
+#define UPSTAIR_LCD_H
+
+/* Standard libs */
+#include <inttypes.h>
+
+#include <ti/mw/grlib/grlib.h>
+
+#include "upstair.h"
+
+/*
+ * Driver for the Sharp memory LCD on the LCD DevPack.
+ * 
+ * Keeps the frame in RAM in the same format it is sent to the display and
+ * tracks which lines have changed. GrFlush() sends only those lines, using
+ * SPI DMA in callback mode so the flush returns immediately.
+ */
+
+#define LCD_VCOM_PERIOD     500000      // EXTCOMIN toggle period (us), panel needs ~1 Hz
+
+/* How LCD_blit() combines the image with the frame (1 bits of the image) */
+typedef enum {
+    LCD_BLIT_SET,           // draw black
+    LCD_BLIT_CLEAR,         // draw white (erase)
+    LCD_BLIT_XOR            // invert
+} LCD_BlitMode;
+
+/* Flush statistics */
+typedef struct {
+    uint32_t flushes;       // flushes that sent something
+    uint32_t skipped;       // flushes that had nothing to send
+    uint32_t totalBytes;    // bytes sent in total
+    uint16_t lastLines;     // lines sent by the last flush
+    uint16_t lastBytes;     // bytes sent by the last flush
+    uint32_t lastTime;      // duration of the last flush (us)
+    uint32_t maxTime;       // longest flush so far (us)
+    uint32_t totalTime;     // all flushes (us)
+} LCD_Stats;
+
+
+/* Public functions */
+
+tContext *LCD_open();
+void LCD_close();
+void LCD_sleep();
+void LCD_wake();
+void LCD_clear();
+void LCD_flush();
+void LCD_setClip(const tRectangle *rect);
+void LCD_blit(int16_t x, int16_t y, uint8_t w, uint8_t h, const uint8_t *rows, LCD_BlitMode mode);
+uint8_t LCD_isBusy();
+void LCD_waitIdle();
+const LCD_Stats *LCD_getStats();
+
+#endif /* UPSTAIR_LCD_H */
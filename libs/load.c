@@ -0,0 +1,365 @@
+ /**************************************************************
+  * 
+  *   _   _           _        _        ____    ___  
+  *  | | | |_ __  ___| |_ __ _(_)_ __  |___ \  / _ \ 
+  *  | | | | '_ \/ __| __/ _` | | '__|   __) || | | |
+  *  | |_| | |_) \__ \ || (_| | | |     / __/ | |_| |
+  *   \___/| .__/|___/\__\__,_|_|_|    |_____(_)___/ 
+  *        |_| Miika Sikala, Oulun Yliopisto, 2018
+  * 
+  * 
+  * ************************************************************
+  * THE BEER-WARE LICENSE
+  * This file is part of Upstair 2.0 software. As long as you retain this notice you
+  * can do whatever you want with this stuff. If we meet some day, and you think
+  * this stuff is worth it, you can buy me a beer in return.
+  * 
+  * Miika Sikala
+  * ************************************************************
+  */
+  
+  
+/* Standard libs */
+#include <stdio.h>
+#include <string.h>
+
+#include "libs/load.h"
+#include "libs/diag.h"
+#include "upstair.h"
+
+#include <ti/sysbios/knl/Clock.h>
+#include <ti/sysbios/hal/Hwi.h>
+
+#ifdef UPSTAIR_HOST
+#include <time.h>
+#else
+#include <xdc/runtime/Timestamp.h>
+#include <xdc/runtime/Types.h>
+#include <ti/drivers/Power.h>
+#endif
+
+
+
+/*******************************
+ *        DEFINITIONS          *
+ ******************************/
+
+typedef struct {
+    Task_Handle task;
+    uint32_t time;              // run time so far (timestamp ticks)
+    uint32_t windowTime;        // ... at the start of the window
+} TaskTime;
+
+static TaskTime taskTimes[LOAD_MAX_TASKS];
+static LoadStats stats;
+
+static uint32_t freq;                       // timestamp ticks per second
+static uint32_t lastSwitch;                 // timestamp of the last task switch
+static uint32_t windowStart;
+
+static volatile uint32_t idleCount = 0;     // idle loop passes in this window
+static uint8_t counting = 0;                // asked by LOAD_setCounting()
+static uint8_t countingOn = 0;              // policy disabled, the count is valid
+static uint8_t countValid = 0;              // the whole window was counted
+
+static uint8_t history[LOAD_HISTORY];       // cpu of the last windows
+static uint8_t historyLen = 0;
+static uint8_t historyPos = 0;
+
+
+
+/*******************************
+ *          FUNCTIONS          *
+ ******************************/
+
+
+/**
+ * Current timestamp. On the host, microseconds.
+ */
+static uint32_t now() {
+    
+#ifdef UPSTAIR_HOST
+    struct timespec t;
+    
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (uint32_t)((uint64_t)t.tv_sec * 1000000 + t.tv_nsec / 1000);
+#else
+    return Timestamp_get32();
+#endif
+}
+
+/**
+ * @part as a percentage of @whole, at most 100.
+ */
+static uint8_t percent(uint32_t part, uint32_t whole) {
+    
+    if (whole == 0 || part >= whole) {
+        return whole == 0 ? 0 : 100;
+    }
+    
+    return (uint8_t)((uint64_t)part * 100 / whole);
+}
+
+static TaskTime *findTask(Task_Handle task) {
+    uint8_t i;
+    
+    for (i = 0; i < stats.taskCount; i++) {
+        if (taskTimes[i].task == task) {
+            return &taskTimes[i];
+        }
+    }
+    
+    return NULL;
+}
+
+/**
+ * Run time of a task up to @t.
+ */
+static uint32_t runTime(TaskTime *entry, uint32_t t) {
+    
+#ifdef UPSTAIR_HOST
+    return (uint32_t)Task_hostCpuTime(entry->task);
+#else
+    // the running task hasn't been charged since it was switched in
+    if (entry->task == Task_self()) {
+        return entry->time + (t - lastSwitch);
+    }
+    
+    return entry->time;
+#endif
+}
+
+#ifndef UPSTAIR_HOST
+/**
+ * Count the idle loop for LOAD_CALIB_TIME ms while the calling task sleeps.
+ * Nothing else should be running, and the policy must be disabled so that
+ * the idle loop spins.
+ */
+static void calibrate() {
+    
+    idleCount = 0;
+    Task_sleep(LOAD_CALIB_TIME * 1000 / Clock_tickPeriod);
+    stats.baseline = idleCount * (1000 / LOAD_CALIB_TIME);
+}
+#endif
+
+/**
+ * Turn the idle loop counting on or off as asked, in the task calling
+ * LOAD_update().
+ */
+static void applyCounting() {
+    
+#ifndef UPSTAIR_HOST
+    if (counting == countingOn) {
+        return;
+    }
+    
+    if (counting) {
+        Power_disablePolicy();
+        if (stats.baseline == 0) {
+            calibrate();
+        }
+    } else {
+        Power_enablePolicy();
+    }
+    
+    // the window so far was counted with the other policy
+    countingOn = counting;
+    countValid = 0;
+#endif
+}
+
+/**
+ * Start measuring. Call once, before the tasks start.
+ */
+void LOAD_init() {
+    
+#ifdef UPSTAIR_HOST
+    freq = 1000000;
+#else
+    Types_FreqHz tsFreq;
+    
+    Timestamp_getFreq(&tsFreq);
+    freq = tsFreq.lo;
+    
+    LOAD_addTask(Task_getIdleTask(), "idle");
+#endif
+    
+    stats.countLoad = -1;
+    lastSwitch = windowStart = now();
+}
+
+/**
+ * Measure the run time of a task. Tasks that are not added count as busy
+ * time but are not listed.
+ * 
+ * @task        Handle of the task
+ * @name        Short name for the diagnostics
+ */
+void LOAD_addTask(Task_Handle task, const char *name) {
+    TaskTime *entry;
+    
+    if (stats.taskCount >= LOAD_MAX_TASKS) {
+        return;
+    }
+    
+    entry = &taskTimes[stats.taskCount];
+    entry->task = task;
+    entry->time = 0;
+    entry->windowTime = 0;
+    
+    stats.tasks[stats.taskCount].name = name;
+    stats.tasks[stats.taskCount].load = 0;
+    stats.taskCount++;
+}
+
+/**
+ * Count the idle loop against the baseline. This keeps the CPU out of
+ * standby, only for diagnostics. The first time it is turned on, the next
+ * LOAD_update() measures the baseline, which takes LOAD_CALIB_TIME ms.
+ * 
+ * @on          1 to count, 0 to let the CPU sleep again
+ */
+void LOAD_setCounting(uint8_t on) {
+    counting = on;
+}
+
+/**
+ * End a window and start the next one. Call about once per second from the
+ * same task.
+ */
+void LOAD_update() {
+    TaskTime *entry;
+    uint32_t t;
+    uint32_t elapsed;
+    uint32_t run;
+    uint32_t loops;
+    uint32_t delta;
+    uint32_t busy = 0;
+#ifndef UPSTAIR_HOST
+    uint32_t idle = 0;
+#endif
+    uint16_t sum = 0;
+    UInt key;
+    uint8_t i;
+    
+    applyCounting();
+    
+    key = Hwi_disable();
+    
+    t = now();
+    elapsed = t - windowStart;
+    windowStart = t;
+    
+    loops = idleCount;
+    idleCount = 0;
+    
+    for (i = 0; i < stats.taskCount; i++) {
+        entry = &taskTimes[i];
+        
+        run = runTime(entry, t);
+        delta = run - entry->windowTime;
+        entry->windowTime = run;
+        
+        stats.tasks[i].load = percent(delta, elapsed);
+        busy += delta;
+        
+#ifndef UPSTAIR_HOST
+        // the idle task is the first one
+        if (i == 0) {
+            idle = delta;
+        }
+#endif
+    }
+    
+    Hwi_restore(key);
+    
+#ifdef UPSTAIR_HOST
+    // nothing measures idle time, it's what the tasks leave
+    if (busy > elapsed) {
+        busy = elapsed;
+    }
+#else
+    // all but the idle task, also the tasks that are not listed
+    busy = elapsed > idle ? elapsed - idle : 0;
+#endif
+    
+    stats.cpu = percent(busy, elapsed);
+    stats.windowUs = (uint64_t)elapsed * 1000000 / freq;
+    stats.busyUs = (uint64_t)busy * 1000000 / freq;
+    
+    history[historyPos] = stats.cpu;
+    historyPos = (historyPos + 1) % LOAD_HISTORY;
+    if (historyLen < LOAD_HISTORY) {
+        historyLen++;
+    }
+    
+    for (i = 0; i < historyLen; i++) {
+        sum += history[i];
+    }
+    stats.cpuAvg = sum / historyLen;
+    
+    stats.idleLoops = elapsed > 0 ? (uint64_t)loops * freq / elapsed : 0;
+    
+    if (countingOn && countValid && stats.baseline > 0) {
+        stats.countLoad = 100 - percent(stats.idleLoops, stats.baseline);
+    } else {
+        stats.countLoad = -1;
+    }
+    countValid = countingOn;
+}
+
+/**
+ * Figures of the last window.
+ */
+const LoadStats *LOAD_stats() {
+    return &stats;
+}
+
+/**
+ * Dump the figures of the last window:
+ * "LOAD cpu <now>% avg <rolling>%", the idle loop and a line per task.
+ */
+void LOAD_dump() {
+    char line[DIAG_LINE_LEN];
+    uint8_t i;
+    
+    sprintf(line, "LOAD cpu %u%% avg %u%%", stats.cpu, stats.cpuAvg);
+    DIAG_print(line);
+    
+#ifndef UPSTAIR_HOST
+    if (stats.countLoad >= 0) {
+        sprintf(line, "LOAD idle %lu/s baseline %lu/s load %d%%",
+            (unsigned long)stats.idleLoops, (unsigned long)stats.baseline, stats.countLoad);
+    } else {
+        sprintf(line, "LOAD idle %lu/s", (unsigned long)stats.idleLoops);
+    }
+    DIAG_print(line);
+#endif
+    
+    for (i = 0; i < stats.taskCount; i++) {
+        sprintf(line, "LOAD task %s %u%%", stats.tasks[i].name, stats.tasks[i].load);
+        DIAG_print(line);
+    }
+}
+
+/**
+ * Idle hook: a pass of the idle loop.
+ */
+Void LOAD_idleFxn() {
+    idleCount++;
+}
+
+/**
+ * Task switch hook: charge the time since the previous switch to @prev.
+ * Called by the scheduler on every switch, keep it short.
+ */
+Void LOAD_switchFxn(Task_Handle prev, Task_Handle next) {
+    TaskTime *entry = findTask(prev);
+    uint32_t t = now();
+    
+    if (entry != NULL) {
+        entry->time += t - lastSwitch;
+    }
+    lastSwitch = t;
+}
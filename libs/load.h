@@ -0,0 +1,86 @@
+ /**************************************************************
+  * 
+  *   _   _           _        _        ____    ___  
+  *  | | | |_ __  ___| |_ __ _(_)_ __  |___ \  / _ \ 
+  *  | | | | '_ \/ __| __/ _` | | '__|   __) || | | |
+  *  | |_| | |_) \__ \ || (_| | | |     / __/ | |_| |
+  *   \___/| .__/|___/\__\__,_|_|_|    |_____(_)___/ 
+  *        |_| Miika Sikala, Oulun Yliopisto, 2018
+  * 
+  * 
+  * ************************************************************
+  * THE BEER-WARE LICENSE
+  * This file is part of Upstair 2.0 software. As long as you retain this notice you
+  * can do whatever you want with this stuff. If we meet some day, and you think
+  * this stuff is worth it, you can buy me a beer in return.
+  * 
+  * Miika Sikala
+  * ************************************************************
+  */
+  
+  
+#ifndef UPSTAIR_LOAD_H
+#define UPSTAIR_LOAD_H
+
+/* Standard libs */
+#include <inttypes.h>
+
+#include <xdc/std.h>
+#include <ti/sysbios/knl/Task.h>
+
+#include "upstair.h"
+
+/*
+ * CPU load. Two measurements, both updated once per window by LOAD_update():
+ * 
+ * Run time per task: a Task switch hook (empty.cfg) charges the time since
+ * the previous switch to the task that ran, from xdc.runtime.Timestamp. The
+ * CPU is busy whenever the idle task is not running, so this works while
+ * the idle task sleeps in standby. Hwis and Swis count for the task they
+ * interrupt.
+ * 
+ * Idle loop counts: an Idle hook (empty.cfg) counts passes of the idle loop,
+ * and the load is how many fewer there were than in an unloaded window (the
+ * baseline, measured the first time counting is turned on). This needs the
+ * idle loop to spin, so the standby policy is disabled while counting (see
+ * LOAD_setCounting()). The diagnostics view does that while it is shown.
+ * 
+ * On the host the tasks are threads that run concurrently: run time is the
+ * CPU time of each thread, idle is what is left of the window and the idle
+ * loop is not counted.
+ */
+
+#define LOAD_MAX_TASKS 4
+
+typedef struct {
+    const char *name;
+    uint8_t load;               // % of the last window
+} LoadTaskStats;
+
+typedef struct {
+    uint8_t cpu;                // % busy in the last window
+    uint8_t cpuAvg;             // % busy over the last LOAD_HISTORY windows
+    uint32_t windowUs;          // length of the last window
+    uint32_t busyUs;            // ... and the busy time in it
+    int8_t countLoad;           // % from the idle loop count, -1 if not counting
+    uint32_t idleLoops;         // idle loop passes per second
+    uint32_t baseline;          // ... when nothing else runs
+    uint8_t taskCount;
+    LoadTaskStats tasks[LOAD_MAX_TASKS];
+} LoadStats;
+
+
+/* Public functions */
+
+void LOAD_init();
+void LOAD_addTask(Task_Handle task, const char *name);
+void LOAD_setCounting(uint8_t on);
+void LOAD_update();
+const LoadStats *LOAD_stats();
+void LOAD_dump();
+
+/* Hooks (empty.cfg) */
+Void LOAD_idleFxn();
+Void LOAD_switchFxn(Task_Handle prev, Task_Handle next);
+
+#endif /* UPSTAIR_LOAD_H */
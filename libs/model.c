@@ -0,0 +1,52 @@
+ /**************************************************************
+  * 
+  *   _   _           _        _        ____    ___  
+  *  | | | |_ __  ___| |_ __ _(_)_ __  |___ \  / _ \ 
+  *  | | | | '_ \/ __| __/ _` | | '__|   __) || | | |
+  *  | |_| | |_) \__ \ || (_| | | |     / __/ | |_| |
+  *   \___/| .__/|___/\__\__,_|_|_|    |_____(_)___/ 
+  *        |_| Miika Sikala, Oulun Yliopisto, 2018
+  * 
+  * 
+  * ************************************************************
+  * THE BEER-WARE LICENSE
+  * This file is part of Upstair 2.0 software. As long as you retain this notice you
+  * can do whatever you want with this stuff. If we meet some day, and you think
+  * this stuff is worth it, you can buy me a beer in return.
+  * 
+  * Miika Sikala
+  * ************************************************************
+  */
+
+// GENERATED by tools/train.py from build/train.segments, build/train.csv, do not edit.
+// decision tree of 5 nodes, 100.0 % of 8162 training windows right
+
+#include <stddef.h>
+
+#include "libs/classifier.h"
+
+
+// feature, below, above, threshold; a leaf has its confidences at below
+static const ClsNode nodes[] = {
+    { CLS_CLIMB, 1, 2, 10 },                // 0
+    { CLS_LEAF, 0, 0, 0 },                  // 1
+    { CLS_AMPLITUDE, 3, 4, 42 },            // 2
+    { CLS_LEAF, 1, 0, 0 },                  // 3
+    { CLS_LEAF, 2, 0, 0 },                  // 4
+};
+
+// %, IDLE, STAIRS, ELEVATOR
+static const uint8_t leaves[][CLS_CLASSES] = {
+    { 100,   0,   0 },    // 5486 windows
+    {   0,   0, 100 },    // 301 windows
+    {   0, 100,   0 },    // 2375 windows
+};
+
+const ClsModel CLS_model = {
+    "tree, 8162 windows",
+    nodes,
+    leaves,
+    NULL,
+    NULL,
+    0
+};
@@ -0,0 +1,182 @@
+ /**************************************************************
+  * 
+  *   _   _           _        _        ____    ___  
+  *  | | | |_ __  ___| |_ __ _(_)_ __  |___ \  / _ \ 
+  *  | | | | '_ \/ __| __/ _` | | '__|   __) || | | |
+  *  | |_| | |_) \__ \ || (_| | | |     / __/ | |_| |
+  *   \___/| .__/|___/\__\__,_|_|_|    |_____(_)___/ 
+  *        |_| Miika Sikala, Oulun Yliopisto, 2018
+  * 
+  * 
+  * ************************************************************
+  * THE BEER-WARE LICENSE
+  * This file is part of Upstair 2.0 software. As long as you retain this notice you
+  * can do whatever you want with this stuff. If we meet some day, and you think
+  * this stuff is worth it, you can buy me a beer in return.
+  * 
+  * Miika Sikala
+  * ************************************************************
+  */
+  
+/* Standard libs */
+#include <stdio.h>
+#include <string.h>
+
+#include "libs/prof.h"
+#include "upstair.h"
+
+#if PROFILING
+
+#ifdef UPSTAIR_HOST
+#include <time.h>
+#else
+#include <inc/hw_types.h>
+#endif
+
+#include "libs/diag.h"
+
+
+
+/*******************************
+ *        DEFINITIONS          *
+ ******************************/
+
+/* Cortex-M3 debug registers */
+#define DEMCR               0xE000EDFC  // Debug Exception and Monitor Control
+#define DEMCR_TRCENA        0x01000000
+#define DWT_CTRL            0xE0001000
+#define DWT_CTRL_CYCCNTENA  0x00000001
+#define DWT_CYCCNT          0xE0001004
+
+static ProfStats table[PROF_SITES];
+
+static const char *siteNames[PROF_SITES] = {
+    "readSensors",
+    "readPressure",
+    "ATT_sample",
+    "STEP_sample",
+    "SPEC_sample",
+    "DET_sample",
+    "CLS_classify",
+    "GUI_updateScreen",
+    "Receive6LoWPAN"
+};
+
+
+
+/*******************************
+ *          FUNCTIONS          *
+ ******************************/
+
+
+/**
+ * Start the cycle counter and clear the table.
+ */
+void PROF_init() {
+    
+#ifndef UPSTAIR_HOST
+    HWREG(DEMCR) |= DEMCR_TRCENA;
+    HWREG(DWT_CYCCNT) = 0;
+    HWREG(DWT_CTRL) |= DWT_CTRL_CYCCNTENA;
+#endif
+    
+    PROF_reset();
+}
+
+/**
+ * Current cycle count. Wraps around, but differences are right for up to
+ * 89 s at 48 MHz.
+ */
+uint32_t PROF_cycles() {
+    
+#ifdef UPSTAIR_HOST
+    struct timespec now;
+    
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint32_t)((uint64_t)now.tv_sec * 1000000000 + now.tv_nsec);
+#else
+    return HWREG(DWT_CYCCNT);
+#endif
+}
+
+/**
+ * Add a measurement to a site.
+ * 
+ * @site        Where
+ * @cycles      How long it took
+ */
+void PROF_record(ProfSite site, uint32_t cycles) {
+    ProfStats *stats = &table[site];
+    
+    stats->count++;
+    stats->total += cycles;
+    if (cycles < stats->min) {
+        stats->min = cycles;
+    }
+    if (cycles > stats->max) {
+        stats->max = cycles;
+    }
+}
+
+/**
+ * Statistics of a site so far.
+ */
+const ProfStats *PROF_stats(ProfSite site) {
+    return &table[site];
+}
+
+/**
+ * Clear all the sites.
+ */
+void PROF_reset() {
+    uint8_t i;
+    
+    memset(table, 0, sizeof(table));
+    for (i = 0; i < PROF_SITES; i++) {
+        table[i].min = UINT32_MAX;
+    }
+}
+
+/**
+ * Cycles to tenths of microseconds.
+ */
+static unsigned long toUs10(uint64_t cycles) {
+    return (unsigned long)(cycles * 10000000 / PROF_HZ);
+}
+
+/**
+ * Append "<us>.<tenth>" to @dest.
+ */
+static char *putUs(char *dest, const char *sep, uint64_t cycles) {
+    unsigned long us10 = toUs10(cycles);
+    
+    return dest + sprintf(dest, "%s%lu.%lu", sep, us10 / 10, us10 % 10);
+}
+
+/**
+ * Dump the table, a line per site that has been measured:
+ * "PROF <site> <count> <mean>/<min>/<max> us".
+ */
+void PROF_dump() {
+    char line[DIAG_LINE_LEN];
+    char *end;
+    ProfStats *stats;
+    uint8_t i;
+    
+    for (i = 0; i < PROF_SITES; i++) {
+        stats = &table[i];
+        if (stats->count == 0) {
+            continue;
+        }
+        
+        end = line + sprintf(line, "PROF %s %lu", siteNames[i], (unsigned long)stats->count);
+        end = putUs(end, " ", stats->total / stats->count);
+        end = putUs(end, "/", stats->min);
+        end = putUs(end, "/", stats->max);
+        strcpy(end, " us");
+        
+        DIAG_print(line);
+    }
+}
+
+#endif /* PROFILING */
@@ -0,0 +1,87 @@
+ /**************************************************************
+  * 
+  *   _   _           _        _        ____    ___  
+  *  | | | |_ __  ___| |_ __ _(_)_ __  |___ \  / _ \ 
+  *  | | | | '_ \/ __| __/ _` | | '__|   __) || | | |
+  *  | |_| | |_) \__ \ || (_| | | |     / __/ | |_| |
+  *   \___/| .__/|___/\__\__,_|_|_|    |_____(_)___/ 
+  *        |_| Miika Sikala, Oulun Yliopisto, 2018
+  * 
+  * 
+  * ************************************************************
+  * THE BEER-WARE LICENSE
+  * This file is part of Upstair 2.0 software. As long as you retain this notice you
+  * can do whatever you want with this stuff. If we meet some day, and you think
+  * this stuff is worth it, you can buy me a beer in return.
+  * 
+  * Miika Sikala
+  * ************************************************************
+  */
+  
+#ifndef UPSTAIR_PROF_H
+#define UPSTAIR_PROF_H
+
+/* Standard libs */
+#include <inttypes.h>
+
+#include "upstair.h"
+
+/*
+ * Hot path profiling. PROF_BEGIN() and PROF_END() around a piece of code
+ * measure it in CPU cycles with the DWT cycle counter, and the count, min,
+ * max and mean per site are kept in a static table. With PROFILING 0
+ * (upstair.h) the markers compile to nothing.
+ * 
+ * If the task blocks (e.g. on an I2C transfer) or is preempted, the cycles of
+ * the other tasks are included, but not the time the CPU sleeps. A site must
+ * only be used by one task.
+ * 
+ * On the host the same API runs on clock_gettime(), in nanoseconds.
+ */
+
+/* Profiled sites, add new ones before PROF_SITES */
+typedef enum {
+    PROF_READ_SENSORS,
+    PROF_READ_BARO,
+    PROF_ATTITUDE,
+    PROF_STEPS,
+    PROF_SPECTRUM,
+    PROF_DETECT,
+    PROF_CLASSIFY,
+    PROF_UPDATE_SCREEN,
+    PROF_RECEIVE,
+    PROF_SITES
+} ProfSite;
+
+typedef struct {
+    uint32_t count;
+    uint32_t min;               // cycles
+    uint32_t max;
+    uint64_t total;
+} ProfStats;
+
+#ifdef UPSTAIR_HOST
+#define PROF_HZ 1000000000      // nanoseconds
+#else
+#define PROF_HZ 48000000        // CPU clock
+#endif
+
+#if PROFILING
+#define PROF_BEGIN(site)    uint32_t profStart_##site = PROF_cycles()
+#define PROF_END(site)      PROF_record(site, PROF_cycles() - profStart_##site)
+#else
+#define PROF_BEGIN(site)
+#define PROF_END(site)
+#endif
+
+
+/* Public functions */
+
+void PROF_init();
+uint32_t PROF_cycles();
+void PROF_record(ProfSite site, uint32_t cycles);
+const ProfStats *PROF_stats(ProfSite site);
+void PROF_reset();
+void PROF_dump();
+
+#endif /* UPSTAIR_PROF_H */
@@ -0,0 +1,173 @@
+ /**************************************************************
+  * 
+  *   _   _           _        _        ____    ___  
+  *  | | | |_ __  ___| |_ __ _(_)_ __  |___ \  / _ \ 
+  *  | | | | '_ \/ __| __/ _` | | '__|   __) || | | |
+  *  | |_| | |_) \__ \ || (_| | | |     / __/ | |_| |
+  *   \___/| .__/|___/\__\__,_|_|_|    |_____(_)___/ 
+  *        |_| Miika Sikala, Oulun Yliopisto, 2018
+  * 
+  * 
+  * ************************************************************
+  * THE BEER-WARE LICENSE
+  * This file is part of Upstair 2.0 software. As long as you retain this notice you
+  * can do whatever you want with this stuff. If we meet some day, and you think
+  * this stuff is worth it, you can buy me a beer in return.
+  * 
+  * Miika Sikala
+  * ************************************************************
+  */
+  
+#include "libs/snapshot.h"
+#include "libs/crc.h"
+
+
+
+/*******************************
+ *        DEFINITIONS          *
+ ******************************/
+
+#define SLOTS           2
+#define SNAP_MAGIC      0x4E53          // "SN"
+
+#define slotAddr(st, s) (SNAP_BASE + ((uint32_t)(st) * SLOTS + (s)) * EXTFLASH_SECTOR_SIZE)
+
+/* Beginning of a slot, followed by the data */
+typedef struct {
+    uint16_t magic;
+    uint8_t version;
+    uint8_t reserved;
+    uint16_t len;
+    uint16_t crc;           // of seq and data
+    uint32_t seq;           // increases by one for every save
+} SlotHeader;
+
+/* Per store */
+static uint8_t newest[SNAP_STORES];         // slot of the newest snapshot (SLOTS: none)
+static uint32_t newestSeq[SNAP_STORES];
+static uint8_t scanned[SNAP_STORES];
+
+
+
+/*******************************
+ *          FUNCTIONS          *
+ ******************************/
+
+
+/**
+ * Check the snapshot in a slot, reading its data to @data.
+ */
+static uint8_t readSlot(uint8_t store, uint8_t slot, SlotHeader *hdr, void *data, uint16_t len, uint8_t version) {
+    
+    if (!EXTFLASH_read(slotAddr(store, slot), hdr, sizeof(*hdr))) {
+        return 0;
+    }
+    
+    if (hdr->magic != SNAP_MAGIC || hdr->version != version || hdr->len != len) {
+        return 0;
+    }
+    
+    if (!EXTFLASH_read(slotAddr(store, slot) + sizeof(*hdr), data, len)) {
+        return 0;
+    }
+    
+    return hdr->crc == CRC_16(CRC_16(CRC16_INIT, &hdr->seq, sizeof(hdr->seq)), data, len);
+}
+
+/**
+ * Find the slot with the newest snapshot by the headers.
+ */
+static void findNewest(uint8_t store) {
+    SlotHeader hdr;
+    uint8_t slot;
+    
+    scanned[store] = 1;
+    newest[store] = SLOTS;
+    
+    for (slot = 0; slot < SLOTS; ++slot) {
+        
+        EXTFLASH_read(slotAddr(store, slot), &hdr, sizeof(hdr));
+        
+        if (hdr.magic == SNAP_MAGIC && (newest[store] == SLOTS || hdr.seq > newestSeq[store])) {
+            newest[store] = slot;
+            newestSeq[store] = hdr.seq;
+        }
+    }
+}
+
+/**
+ * Load the newest snapshot.
+ * 
+ * @store   Which store (0 ... SNAP_STORES-1)
+ * @data    Where to load
+ * @len     Expected size
+ * @version Expected version
+ * 
+ * @return  1 if a valid snapshot was loaded (@data is undefined otherwise)
+ */
+uint8_t SNAP_load(uint8_t store, void *data, uint16_t len, uint8_t version) {
+    SlotHeader hdr;
+    uint8_t slot;
+    
+    if (store >= SNAP_STORES || len > SNAP_MAX) {
+        return 0;
+    }
+    
+    findNewest(store);
+    if (newest[store] == SLOTS) {
+        return 0;
+    }
+    
+    if (readSlot(store, newest[store], &hdr, data, len, version)) {
+        return 1;
+    }
+    
+    // newest one is broken, try the other and keep it on the next save
+    slot = (newest[store] + 1) % SLOTS;
+    
+    if (readSlot(store, slot, &hdr, data, len, version)) {
+        newest[store] = slot;
+        return 1;
+    }
+    
+    return 0;
+}
+
+/**
+ * Save a snapshot. Takes about 40 ms (a sector erase).
+ * 
+ * @return  1 on success
+ */
+uint8_t SNAP_save(uint8_t store, const void *data, uint16_t len, uint8_t version) {
+    SlotHeader hdr;
+    uint8_t slot;
+    
+    if (store >= SNAP_STORES || len > SNAP_MAX) {
+        return 0;
+    }
+    
+    if (!scanned[store]) {
+        findNewest(store);
+    }
+    
+    slot = (newest[store] + 1) % SLOTS;
+    
+    hdr.magic = SNAP_MAGIC;
+    hdr.version = version;
+    hdr.reserved = 0xFF;
+    hdr.len = len;
+    hdr.seq = newestSeq[store] + 1;
+    hdr.crc = CRC_16(CRC_16(CRC16_INIT, &hdr.seq, sizeof(hdr.seq)), data, len);
+    
+    // the header goes last, the slot isn't valid until it's there
+    if (!EXTFLASH_erase(slotAddr(store, slot)) ||
+            !EXTFLASH_write(slotAddr(store, slot) + sizeof(hdr), data, len) ||
+            !EXTFLASH_write(slotAddr(store, slot), &hdr, sizeof(hdr))) {
+        return 0;
+    }
+    
+    newest[store] = slot;
+    newestSeq[store] = hdr.seq;
+    
+    return 1;
+}
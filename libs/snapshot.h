@@ -0,0 +1,52 @@
+ /**************************************************************
+  * 
+  *   _   _           _        _        ____    ___  
+  *  | | | |_ __  ___| |_ __ _(_)_ __  |___ \  / _ \ 
+  *  | | | | '_ \/ __| __/ _` | | '__|   __) || | | |
+  *  | |_| | |_) \__ \ || (_| | | |     / __/ | |_| |
+  *   \___/| .__/|___/\__\__,_|_|_|    |_____(_)___/ 
+  *        |_| Miika Sikala, Oulun Yliopisto, 2018
+  * 
+  * 
+  * ************************************************************
+  * THE BEER-WARE LICENSE
+  * This file is part of Upstair 2.0 software. As long as you retain this notice you
+  * can do whatever you want with this stuff. If we meet some day, and you think
+  * this stuff is worth it, you can buy me a beer in return.
+  * 
+  * Miika Sikala
+  * ************************************************************
+  */
+  
+#ifndef UPSTAIR_SNAPSHOT_H
+#define UPSTAIR_SNAPSHOT_H
+
+/* Standard libs */
+#include <inttypes.h>
+
+#include "libs/flashlog.h"
+#include "libs/extflash.h"
+
+/*
+ * Snapshots of application state on the external flash, so it can be
+ * restored quickly at boot. There are SNAP_STORES independent stores.
+ * 
+ * Each store has two slots, a save always goes to the one not holding the
+ * newest snapshot. A save cut by a reset leaves the previous snapshot in place.
+ * A snapshot is only loaded if its version and size match what the caller
+ * expects, so changing the layout just makes the old one invalid.
+ * 
+ * The flash must be open (FLOG_open()).
+ */
+
+#define SNAP_STORES 2
+#define SNAP_BASE   (FLOG_BASE - SNAP_STORES * 2 * EXTFLASH_SECTOR_SIZE)   // just below the log
+#define SNAP_MAX    (EXTFLASH_SECTOR_SIZE - 16)                             // largest snapshot
+
+
+/* Public functions */
+
+uint8_t SNAP_load(uint8_t store, void *data, uint16_t len, uint8_t version);
+uint8_t SNAP_save(uint8_t store, const void *data, uint16_t len, uint8_t version);
+
+#endif /* UPSTAIR_SNAPSHOT_H */
@@ -0,0 +1,257 @@
+ /**************************************************************
+  * 
+  *   _   _           _        _        ____    ___  
+  *  | | | |_ __  ___| |_ __ _(_)_ __  |___ \  / _ \ 
+  *  | | | | '_ \/ __| __/ _` | | '__|   __) || | | |
+  *  | |_| | |_) \__ \ || (_| | | |     / __/ | |_| |
+  *   \___/| .__/|___/\__\__,_|_|_|    |_____(_)___/ 
+  *        |_| Miika Sikala, Oulun Yliopisto, 2018
+  * 
+  * 
+  * ************************************************************
+  * THE BEER-WARE LICENSE
+  * This file is part of Upstair 2.0 software. As long as you retain this notice you
+  * can do whatever you want with this stuff. If we meet some day, and you think
+  * this stuff is worth it, you can buy me a beer in return.
+  * 
+  * Miika Sikala
+  * ************************************************************
+  */
+  
+/* Standard libs */
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "libs/spectrum.h"
+#include "libs/diag.h"
+
+
+
+/*******************************
+ *        DEFINITIONS          *
+ ******************************/
+
+#define MAX_BINS 16
+#define BANKS 2                         // half a window apart
+#define COEF_SHIFT 14                   // Goertzel coefficients are Q14
+#define FRAC 4                          // fraction bits of the input (mg << FRAC)
+#define PI_F 3.14159265f
+
+typedef struct {
+    int32_t s1[MAX_BINS];               // Goertzel state
+    int32_t s2[MAX_BINS];
+    int32_t sum;                        // of the inputs
+    int64_t sum2;                       // of their squares
+    int16_t count;                      // inputs so far, negative before the bank starts
+} Bank;
+
+static SpecFeatures features;
+
+static uint16_t binHz;                  // 0.01 Hz between bins
+static uint8_t firstBin;                // bin number of coef[0]
+static uint8_t bins;
+static uint8_t bandFirst, bandLast;     // indexes of the step band
+static int32_t coef[MAX_BINS];          // 2 cos(2 pi k / N), Q14
+
+static Bank banks[BANKS];
+
+static int32_t decimSum;                // of the MPU samples being averaged
+static uint8_t decimCount = 0;
+
+
+
+/*******************************
+ *          FUNCTIONS          *
+ ******************************/
+
+
+/**
+ * Choose the bins for the sample rate. Floats here only.
+ * 
+ * @param   rate    MPU samples per second
+ */
+void SPEC_init(uint16_t rate) {
+    uint8_t i, k;
+    
+    binHz = (uint32_t)rate * 100 / SPEC_DECIMATION / SPEC_WINDOW;
+    firstBin = (SPEC_SEARCH_LOW + binHz - 1) / binHz;
+    if (firstBin < 1) {
+        firstBin = 1;
+    }
+    
+    bins = SPEC_SEARCH_HIGH / binHz - firstBin + 1;
+    if (bins > MAX_BINS) {
+        bins = MAX_BINS;
+    }
+    
+    bandFirst = bins;
+    bandLast = 0;
+    for (i = 0; i < bins; i++) {
+        k = firstBin + i;
+        coef[i] = lroundf(2.0f * cosf(2.0f * PI_F * k / SPEC_WINDOW) * (1 << COEF_SHIFT));
+        
+        if (k * binHz >= SPEC_BAND_LOW && k * binHz <= SPEC_BAND_HIGH) {
+            if (i < bandFirst) {
+                bandFirst = i;
+            }
+            bandLast = i;
+        }
+    }
+    
+    SPEC_reset();
+}
+
+/**
+ * Forget everything seen so far.
+ */
+void SPEC_reset() {
+    uint8_t b;
+    
+    memset(&features, 0, sizeof(features));
+    memset(banks, 0, sizeof(banks));
+    
+    for (b = 0; b < BANKS; b++) {
+        banks[b].count = -(int16_t)(b * SPEC_WINDOW / BANKS);
+    }
+    
+    decimSum = 0;
+    decimCount = 0;
+}
+
+/**
+ * A bank has a whole window: the features from it.
+ */
+static void finish(Bank *bank) {
+    float power[MAX_BINS];
+    float mean, variance, band, total;
+    float m0, m1, m2, delta;
+    uint8_t best = 0;
+    uint8_t i;
+    
+    // |X(k)|^2 of each bin, (mg << FRAC)^2
+    for (i = 0; i < bins; i++) {
+        power[i] = (float)bank->s1[i] * bank->s1[i] + (float)bank->s2[i] * bank->s2[i]
+            - (float)bank->s1[i] * bank->s2[i] * coef[i] / (1 << COEF_SHIFT);
+        if (power[i] < 0) {
+            power[i] = 0;
+        }
+        if (power[i] > power[best]) {
+            best = i;
+        }
+    }
+    
+    mean = (float)bank->sum / SPEC_WINDOW;
+    variance = (float)bank->sum2 / SPEC_WINDOW - mean * mean;
+    if (variance < 0) {
+        variance = 0;
+    }
+    
+    // Parseval: the share of a bin in the variance is 2 |X|^2 / N^2 (it
+    // has a twin at the negative frequency)
+    band = 0;
+    for (i = bandFirst; i <= bandLast && i < bins; i++) {
+        band += power[i];
+    }
+    band = 2.0f * band / ((float)SPEC_WINDOW * SPEC_WINDOW);
+    
+    features.amplitude = lroundf(sqrtf(variance) / (1 << FRAC));
+    features.bandAmplitude = lroundf(sqrtf(band) / (1 << FRAC));
+    features.valid = 1;
+    
+    if (features.amplitude < SPEC_STILL) {
+        features.dominant = 0;
+        features.regularity = 0;
+        return;
+    }
+    
+    // peak between the bins, from the magnitudes around the strongest
+    m1 = sqrtf(power[best]);
+    m0 = best > 0 ? sqrtf(power[best - 1]) : m1;
+    m2 = best < bins - 1 ? sqrtf(power[best + 1]) : m1;
+    delta = m0 - 2.0f * m1 + m2;
+    delta = delta < 0 ? 0.5f * (m0 - m2) / delta : 0;
+    features.dominant = lroundf((firstBin + best + delta) * binHz);
+    
+    // the window leaks a steady rhythm to the neighbours too
+    total = power[best];
+    if (best > 0) {
+        total += power[best - 1];
+    }
+    if (best < bins - 1) {
+        total += power[best + 1];
+    }
+    total = 100.0f * 2.0f * total / ((float)SPEC_WINDOW * SPEC_WINDOW * variance);
+    features.regularity = total > 100.0f ? 100 : lroundf(total);
+}
+
+/**
+ * Process an MPU sample.
+ * 
+ * @param   vertical    mg, up, without gravity
+ * 
+ * @return  1 if there are new features
+ */
+uint8_t SPEC_sample(int16_t vertical) {
+    Bank *bank;
+    int32_t x, s0;
+    uint8_t updated = 0;
+    uint8_t b, i;
+    
+    decimSum += vertical;
+    if (++decimCount < SPEC_DECIMATION) {
+        return 0;
+    }
+    x = (decimSum << FRAC) / SPEC_DECIMATION;
+    decimSum = 0;
+    decimCount = 0;
+    
+    for (b = 0; b < BANKS; b++) {
+        bank = &banks[b];
+        
+        if (bank->count < 0) {
+            ++bank->count;
+            continue;
+        }
+        
+        for (i = 0; i < bins; i++) {
+            s0 = x + (int32_t)(((int64_t)coef[i] * bank->s1[i]) >> COEF_SHIFT) - bank->s2[i];
+            bank->s2[i] = bank->s1[i];
+            bank->s1[i] = s0;
+        }
+        bank->sum += x;
+        bank->sum2 += (int64_t)x * x;
+        
+        if (++bank->count == SPEC_WINDOW) {
+            finish(bank);
+            memset(bank, 0, sizeof(*bank));
+            updated = 1;
+        }
+    }
+    
+    return updated;
+}
+
+/**
+ * The features of the latest window.
+ */
+const SpecFeatures *SPEC_features() {
+    return &features;
+}
+
+/**
+ * Print the features of the latest window.
+ */
+void SPEC_dump() {
+    char line[DIAG_LINE_LEN];
+    
+    if (!features.valid) {
+        DIAG_print("SPEC no window yet");
+        return;
+    }
+    
+    sprintf(line, "SPEC %u mg, step band %u mg, %u.%02u Hz, regularity %u%%",
+        features.amplitude, features.bandAmplitude,
+        features.dominant / 100, features.dominant % 100, features.regularity);
+    DIAG_print(line);
+}
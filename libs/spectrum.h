@@ -0,0 +1,64 @@
+ /**************************************************************
+  * 
+  *   _   _           _        _        ____    ___  
+  *  | | | |_ __  ___| |_ __ _(_)_ __  |___ \  / _ \ 
+  *  | | | | '_ \/ __| __/ _` | | '__|   __) || | | |
+  *  | |_| | |_) \__ \ || (_| | | |     / __/ | |_| |
+  *   \___/| .__/|___/\__\__,_|_|_|    |_____(_)___/ 
+  *        |_| Miika Sikala, Oulun Yliopisto, 2018
+  * 
+  * 
+  * ************************************************************
+  * THE BEER-WARE LICENSE
+  * This file is part of Upstair 2.0 software. As long as you retain this notice you
+  * can do whatever you want with this stuff. If we meet some day, and you think
+  * this stuff is worth it, you can buy me a beer in return.
+  * 
+  * Miika Sikala
+  * ************************************************************
+  */
+  
+#ifndef UPSTAIR_SPECTRUM_H
+#define UPSTAIR_SPECTRUM_H
+
+/* Standard libs */
+#include <inttypes.h>
+
+#include "upstair.h"
+
+/*
+ * Step band features of the vertical acceleration (ATT_vertical()), for
+ * telling rhythmic climbing from other movement.
+ * 
+ * The samples are averaged SPEC_DECIMATION at a time and go through
+ * Goertzel filters at the DFT bins from SPEC_SEARCH_LOW to SPEC_SEARCH_HIGH
+ * over a window of SPEC_WINDOW. Two banks of them are half a window apart,
+ * so there are new features every half window. A Goertzel bin is one
+ * multiplication per sample, the rest is done once per window.
+ * 
+ *   amplitude       RMS of the window, the spread around its mean
+ *   bandAmplitude   RMS of the part between SPEC_BAND_LOW and SPEC_BAND_HIGH
+ *   dominant        the strongest frequency in the search range,
+ *                   interpolated between the bins
+ *   regularity      share of the energy at the dominant frequency, high
+ *                   for steady steps
+ */
+
+typedef struct {
+    uint16_t amplitude;         // mg
+    uint16_t bandAmplitude;     // mg
+    uint16_t dominant;          // 0.01 Hz, 0 when still
+    uint8_t regularity;         // %
+    uint8_t valid;              // a window has been seen
+} SpecFeatures;
+
+
+/* Public functions */
+
+void SPEC_init(uint16_t rate);
+void SPEC_reset();
+uint8_t SPEC_sample(int16_t vertical);
+const SpecFeatures *SPEC_features();
+void SPEC_dump();
+
+#endif /* UPSTAIR_SPECTRUM_H */
@@ -0,0 +1,164 @@
+ /**************************************************************
+  * 
+  *   _   _           _        _        ____    ___  
+  *  | | | |_ __  ___| |_ __ _(_)_ __  |___ \  / _ \ 
+  *  | | | | '_ \/ __| __/ _` | | '__|   __) || | | |
+  *  | |_| | |_) \__ \ || (_| | | |     / __/ | |_| |
+  *   \___/| .__/|___/\__\__,_|_|_|    |_____(_)___/ 
+  *        |_| Miika Sikala, Oulun Yliopisto, 2018
+  * 
+  * 
+  * ************************************************************
+  * THE BEER-WARE LICENSE
+  * This file is part of Upstair 2.0 software. As long as you retain this notice you
+  * can do whatever you want with this stuff. If we meet some day, and you think
+  * this stuff is worth it, you can buy me a beer in return.
+  * 
+  * Miika Sikala
+  * ************************************************************
+  */
+  
+/* XDCtools Header files */
+#include <xdc/std.h>
+#include <xdc/runtime/System.h>
+#include <ti/sysbios/BIOS.h>
+#include <ti/sysbios/knl/Semaphore.h>
+
+/* TI-RTOS Header files */
+#include <ti/drivers/SPI.h>
+
+#include "Board.h"
+#include "libs/spibus.h"
+
+
+
+/*******************************
+ *        DEFINITIONS          *
+ ******************************/
+
+static SPI_Handle hSpi = NULL;
+static SPI_Transaction spiTransaction;
+static uint8_t users = 0;                   // open count
+
+static Semaphore_Handle hBusSem;            // bus owner
+static Semaphore_Handle hDoneSem;           // blocking transfer done
+static SPIBUS_DoneFxn doneFxn = NULL;       // asynchronous transfer done
+
+
+
+/*******************************
+ *          FUNCTIONS          *
+ ******************************/
+
+
+/**
+ * SPI transfer done (called from interrupt context).
+ */
+static void spiCallback(SPI_Handle handle, SPI_Transaction *transaction) {
+    SPIBUS_DoneFxn fxn = doneFxn;
+    
+    if (fxn != NULL) {
+        doneFxn = NULL;
+        fxn();
+    } else {
+        Semaphore_post(hDoneSem);
+    }
+}
+
+/**
+ * Open the bus. Every user opens it, the peripheral is opened only once.
+ */
+void SPIBUS_open() {
+    SPI_Params spiParams;
+    Semaphore_Params semParams;
+    
+    if (users++ > 0) {
+        return;
+    }
+    
+    if (hBusSem == NULL) {
+        Semaphore_Params_init(&semParams);
+        semParams.mode = Semaphore_Mode_BINARY;
+        
+        hBusSem = Semaphore_create(1, &semParams, NULL);
+        hDoneSem = Semaphore_create(0, &semParams, NULL);
+        if (hBusSem == NULL || hDoneSem == NULL) {
+            System_abort("Error creating SPI bus semaphores\n");
+        }
+    }
+    
+    // callback mode, so the LCD can send in the background
+    SPI_Params_init(&spiParams);
+    spiParams.bitRate = SPIBUS_BITRATE;
+    spiParams.transferMode = SPI_MODE_CALLBACK;
+    spiParams.transferCallbackFxn = spiCallback;
+    
+    hSpi = SPI_open(Board_SPI0, &spiParams);
+    if (hSpi == NULL) {
+        System_abort("Error initializing SPI0\n");
+    }
+}
+
+/**
+ * Close the bus. The peripheral is closed when the last user has closed it.
+ */
+void SPIBUS_close() {
+    
+    if (users == 0 || --users > 0) {
+        return;
+    }
+    
+    SPI_close(hSpi);
+    hSpi = NULL;
+}
+
+/**
+ * Wait until the bus is free and take it.
+ */
+void SPIBUS_acquire() {
+    Semaphore_pend(hBusSem, BIOS_WAIT_FOREVER);
+}
+
+/**
+ * Give the bus to the next user. May be called from interrupt context.
+ */
+void SPIBUS_release() {
+    Semaphore_post(hBusSem);
+}
+
+/**
+ * Transfer and wait for it to finish. The bus must be acquired.
+ * 
+ * @tx      Bytes to send (NULL sends zeros)
+ * @rx      Where to read (NULL to ignore)
+ * @count   Bytes
+ */
+void SPIBUS_transfer(const void *tx, void *rx, size_t count) {
+    
+    doneFxn = NULL;
+    spiTransaction.count = count;
+    spiTransaction.txBuf = (void *)tx;
+    spiTransaction.rxBuf = rx;
+    
+    SPI_transfer(hSpi, &spiTransaction);
+    Semaphore_pend(hDoneSem, BIOS_WAIT_FOREVER);
+}
+
+/**
+ * Start a transfer and return. The bus must be acquired, and stays so until
+ * the owner releases it (possibly from @done).
+ * 
+ * @tx      Bytes to send (NULL sends zeros)
+ * @rx      Where to read (NULL to ignore)
+ * @count   Bytes (max 1024, a DMA limit)
+ * @done    Called from interrupt context when the transfer is done
+ */
+void SPIBUS_transferAsync(const void *tx, void *rx, size_t count, SPIBUS_DoneFxn done) {
+    
+    doneFxn = done;
+    spiTransaction.count = count;
+    spiTransaction.txBuf = (void *)tx;
+    spiTransaction.rxBuf = rx;
+    
+    SPI_transfer(hSpi, &spiTransaction);
+}
@@ -0,0 +1,49 @@
+ /**************************************************************
+  * 
+  *   _   _           _        _        ____    ___  
+  *  | | | |_ __  ___| |_ __ _(_)_ __  |___ \  / _ \ 
+  *  | | | | '_ \/ __| __/ _` | | '__|   __) || | | |
+  *  | |_| | |_) \__ \ || (_| | | |     / __/ | |_| |
+  *   \___/| .__/|___/\__\__,_|_|_|    |_____(_)___/ 
+  *        |_| Miika Sikala, Oulun Yliopisto, 2018
+  * 
+  * 
+  * ************************************************************
+  * THE BEER-WARE LICENSE
+  * This file is part of Upstair 2.0 software. As long as you retain this notice you
+  * can do whatever you want with this stuff. If we meet some day, and you think
+  * this stuff is worth it, you can buy me a beer in return.
+  * 
+  * Miika Sikala
+  * ************************************************************
+  */
+  
+#ifndef UPSTAIR_SPIBUS_H
+#define UPSTAIR_SPIBUS_H
+
+/* Standard libs */
+#include <inttypes.h>
+#include <stddef.h>
+
+/*
+ * Shares SPI0 between the LCD and the external flash. The TI SPI driver
+ * allows only one open handle per peripheral, so the bus is opened once
+ * here and the users take turns. Chip selects are driven by the users.
+ */
+
+#define SPIBUS_BITRATE  4000000     // SPI clock (Hz), fine for both the LCD and the flash
+
+/* Called from interrupt context when an asynchronous transfer is done */
+typedef void (*SPIBUS_DoneFxn)();
+
+
+/* Public functions */
+
+void SPIBUS_open();
+void SPIBUS_close();
+void SPIBUS_acquire();
+void SPIBUS_release();
+void SPIBUS_transfer(const void *tx, void *rx, size_t count);
+void SPIBUS_transferAsync(const void *tx, void *rx, size_t count, SPIBUS_DoneFxn done);
+
+#endif /* UPSTAIR_SPIBUS_H */
@@ -0,0 +1,224 @@
+ /**************************************************************
+  * 
+  *   _   _           _        _        ____    ___  
+  *  | | | |_ __  ___| |_ __ _(_)_ __  |___ \  / _ \ 
+  *  | | | | '_ \/ __| __/ _` | | '__|   __) || | | |
+  *  | |_| | |_) \__ \ || (_| | | |     / __/ | |_| |
+  *   \___/| .__/|___/\__\__,_|_|_|    |_____(_)___/ 
+  *        |_| Miika Sikala, Oulun Yliopisto, 2018
+  * 
+  * 
+  * ************************************************************
+  * THE BEER-WARE LICENSE
+  * This file is part of Upstair 2.0 software. As long as you retain this notice you
+  * can do whatever you want with this stuff. If we meet some day, and you think
+  * this stuff is worth it, you can buy me a beer in return.
+  * 
+  * Miika Sikala
+  * ************************************************************
+  */
+  
+/* Standard libs */
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "libs/steps.h"
+#include "libs/diag.h"
+
+
+
+/*******************************
+ *        DEFINITIONS          *
+ ******************************/
+
+#define COEF_SHIFT 14                   // filter coefficients are Q14
+#define FRAC 4                          // fraction bits of the filter's input and output
+#define BAND_Q 0.7f                     // ~1-4 Hz with STEP_BAND_HZ 2
+#define PI_F 3.14159265f
+
+static StepState state;
+
+static uint16_t rate;                   // samples per second
+static uint16_t refractory;             // samples
+static uint16_t timeout;                // samples
+
+// band-pass: y = b0 * (x - x[-2]) + a1 * y[-1] + a2 * y[-2] (a negated)
+static int32_t b0, a1, a2;
+static int32_t in[2];                   // previous inputs, mg << FRAC
+static int32_t out[2];                  // previous outputs, mg << FRAC
+
+static uint8_t armed = 0;               // below zero since the previous step
+static int32_t peakAvg;                 // mg, of the recent steps
+static uint16_t sinceStep;              // samples
+static uint8_t run = 0;                 // steps in a row
+
+static uint16_t intervals[STEP_CADENCE_STEPS];  // samples between the last steps
+static uint8_t intervalPos = 0;
+static uint8_t intervalCount = 0;
+static uint32_t intervalSum = 0;
+
+
+
+/*******************************
+ *          FUNCTIONS          *
+ ******************************/
+
+
+/**
+ * Set the filter for the sample rate. Floats here only.
+ * 
+ * @param   sampleRate  samples per second
+ */
+void STEP_init(uint16_t sampleRate) {
+    float w0 = 2.0f * PI_F * STEP_BAND_HZ / sampleRate;
+    float alpha = sinf(w0) / (2.0f * BAND_Q);
+    float a0 = 1.0f + alpha;
+    
+    rate = sampleRate;
+    refractory = (uint32_t)STEP_REFRACTORY * rate / 1000;
+    timeout = (uint32_t)STEP_TIMEOUT * rate / 1000;
+    
+    // RBJ band-pass, 0 dB at the centre
+    b0 = lroundf(alpha / a0 * (1 << COEF_SHIFT));
+    a1 = lroundf(2.0f * cosf(w0) / a0 * (1 << COEF_SHIFT));
+    a2 = -lroundf((1.0f - alpha) / a0 * (1 << COEF_SHIFT));
+    
+    STEP_reset();
+}
+
+/**
+ * A pause: forget the steps in a row and the cadence.
+ */
+static void endRun() {
+    
+    run = 0;
+    peakAvg = 2 * STEP_MIN_PEAK;
+    intervalPos = 0;
+    intervalCount = 0;
+    intervalSum = 0;
+    
+    state.cadence = 0;
+    state.walking = 0;
+}
+
+/**
+ * Forget everything seen so far, the count starts from zero.
+ */
+void STEP_reset() {
+    
+    memset(&state, 0, sizeof(state));
+    memset(in, 0, sizeof(in));
+    memset(out, 0, sizeof(out));
+    armed = 0;
+    sinceStep = timeout;
+    endRun();
+}
+
+/**
+ * A peak was a step.
+ * 
+ * @return  Number of steps counted
+ */
+static uint8_t step(int32_t peak) {
+    uint8_t counted = 0;
+    
+    armed = 0;
+    peakAvg += (peak - peakAvg) / 4;
+    
+    if (run > 0) {
+        if (intervalCount == STEP_CADENCE_STEPS) {
+            intervalSum -= intervals[intervalPos];
+        } else {
+            ++intervalCount;
+        }
+        intervals[intervalPos] = sinceStep;
+        intervalSum += sinceStep;
+        intervalPos = (intervalPos + 1) % STEP_CADENCE_STEPS;
+    }
+    sinceStep = 0;
+    
+    if (run < UINT8_MAX) {
+        ++run;
+    }
+    
+    // the first ones only when it turns out to be walking
+    if (run == STEP_CONFIRM) {
+        counted = STEP_CONFIRM;
+    } else if (run > STEP_CONFIRM) {
+        counted = 1;
+    }
+    
+    if (counted) {
+        state.steps += counted;
+        state.walking = 1;
+        state.cadence = (uint32_t)60 * rate * intervalCount / intervalSum;
+    }
+    
+    return counted;
+}
+
+/**
+ * Process a sample.
+ * 
+ * @param   vertical    mg, up, without gravity
+ * 
+ * @return  Number of steps counted with this sample (more than one when a
+ *          run of steps is confirmed)
+ */
+uint8_t STEP_sample(int16_t vertical) {
+    int32_t x = (int32_t)vertical << FRAC;
+    int32_t y;
+    int32_t threshold;
+    uint8_t counted = 0;
+    
+    y = (int32_t)(((int64_t)b0 * (x - in[1]) + (int64_t)a1 * out[0] + (int64_t)a2 * out[1]) >> COEF_SHIFT);
+    
+    if (sinceStep < UINT16_MAX) {
+        ++sinceStep;
+    }
+    
+    if (y < 0) {
+        armed = 1;
+    }
+    
+    // the previous sample was a peak
+    if (armed && out[0] > out[1] && out[0] >= y && sinceStep >= refractory) {
+        threshold = peakAvg / 2;
+        if (threshold < STEP_MIN_PEAK) {
+            threshold = STEP_MIN_PEAK;
+        }
+        if ((out[0] >> FRAC) >= threshold) {
+            counted = step(out[0] >> FRAC);
+        }
+    }
+    
+    in[1] = in[0];
+    in[0] = x;
+    out[1] = out[0];
+    out[0] = y;
+    
+    if (sinceStep == timeout && run > 0) {
+        endRun();
+    }
+    
+    return counted;
+}
+
+/**
+ * The count and the cadence.
+ */
+const StepState *STEP_state() {
+    return &state;
+}
+
+/**
+ * Print the count and the cadence.
+ */
+void STEP_dump() {
+    char line[DIAG_LINE_LEN];
+    
+    sprintf(line, "STEP %lu steps, %u/min%s", (unsigned long)state.steps, state.cadence,
+        state.walking ? " walking" : "");
+    DIAG_print(line);
+}
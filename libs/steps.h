@@ -0,0 +1,59 @@
+ /**************************************************************
+  * 
+  *   _   _           _        _        ____    ___  
+  *  | | | |_ __  ___| |_ __ _(_)_ __  |___ \  / _ \ 
+  *  | | | | '_ \/ __| __/ _` | | '__|   __) || | | |
+  *  | |_| | |_) \__ \ || (_| | | |     / __/ | |_| |
+  *   \___/| .__/|___/\__\__,_|_|_|    |_____(_)___/ 
+  *        |_| Miika Sikala, Oulun Yliopisto, 2018
+  * 
+  * 
+  * ************************************************************
+  * THE BEER-WARE LICENSE
+  * This file is part of Upstair 2.0 software. As long as you retain this notice you
+  * can do whatever you want with this stuff. If we meet some day, and you think
+  * this stuff is worth it, you can buy me a beer in return.
+  * 
+  * Miika Sikala
+  * ************************************************************
+  */
+  
+#ifndef UPSTAIR_STEPS_H
+#define UPSTAIR_STEPS_H
+
+/* Standard libs */
+#include <inttypes.h>
+
+#include "upstair.h"
+
+/*
+ * Step counter. Fed with the vertical acceleration of every MPU sample
+ * (ATT_vertical()), band-passed around the step rate (a biquad at
+ * STEP_BAND_HZ). A step is a peak of it above an adaptive threshold, half
+ * of the recent steps' peaks but at least STEP_MIN_PEAK, after the signal
+ * has been below zero and at least STEP_REFRACTORY after the previous step.
+ * 
+ * Steps are counted once STEP_CONFIRM of them have come in a row (less
+ * than STEP_TIMEOUT apart), so a bump or two is not walking. The cadence is
+ * the mean of the last STEP_CADENCE_STEPS intervals.
+ * 
+ * Integer only and O(1) per sample, so the samples of a FIFO read can go
+ * through it one by one.
+ */
+
+typedef struct {
+    uint32_t steps;             // counted since the reset
+    uint16_t cadence;           // steps/min, 0 when not walking
+    uint8_t walking;            // STEP_CONFIRM steps in a row, and no timeout yet
+} StepState;
+
+
+/* Public functions */
+
+void STEP_init(uint16_t rate);
+void STEP_reset();
+uint8_t STEP_sample(int16_t vertical);
+const StepState *STEP_state();
+void STEP_dump();
+
+#endif /* UPSTAIR_STEPS_H */
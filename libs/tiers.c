@@ -0,0 +1,138 @@
+ /**************************************************************
+  * 
+  *   _   _           _        _        ____    ___  
+  *  | | | |_ __  ___| |_ __ _(_)_ __  |___ \  / _ \ 
+  *  | | | | '_ \/ __| __/ _` | | '__|   __) || | | |
+  *  | |_| | |_) \__ \ || (_| | | |     / __/ | |_| |
+  *   \___/| .__/|___/\__\__,_|_|_|    |_____(_)___/ 
+  *        |_| Miika Sikala, Oulun Yliopisto, 2018
+  * 
+  * 
+  * ************************************************************
+  * THE BEER-WARE LICENSE
+  * This file is part of Upstair 2.0 software. As long as you retain this notice you
+  * can do whatever you want with this stuff. If we meet some day, and you think
+  * this stuff is worth it, you can buy me a beer in return.
+  * 
+  * Miika Sikala
+  * ************************************************************
+  */
+  
+/* Standard libs */
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "libs/tiers.h"
+#include "libs/diag.h"
+
+
+
+/*******************************
+ *        DEFINITIONS          *
+ ******************************/
+
+#define RATE_FULL (IMU_RATE * 100)
+#define RATE_LOW ((24414UL << TIER_LOW_ODR) / 1000)    // 0.24414 Hz << odr
+
+static TierState state;
+
+static uint16_t wakeCounts;             // TIER_WAKE_MG in raw accelerometer units
+static int16_t previous[3];             // the last low tier sample
+static uint8_t hasPrevious = 0;
+static uint32_t last;                   // ms, the previous update
+static uint32_t lastBusy;               // ms
+
+
+
+/*******************************
+ *          FUNCTIONS          *
+ ******************************/
+
+
+/**
+ * Start at full rate, like the MPU does after mpu9250_fifo_start().
+ * 
+ * @param   aRes    g per raw accelerometer unit
+ * @param   now     ms
+ */
+void TIER_init(float aRes, uint32_t now) {
+    
+    memset(&state, 0, sizeof(state));
+    state.tier = TIER_FULL;
+    state.rate = RATE_FULL;
+    
+    wakeCounts = lroundf(TIER_WAKE_MG / 1000.0f / aRes);
+    hasPrevious = 0;
+    last = now;
+    lastBusy = now;
+}
+
+/**
+ * A low tier sample. The first one after dropping to the low tier is only
+ * remembered.
+ * 
+ * @param   raw     ax, ay, az (raw)
+ * @return  1 if an axis changed more than TIER_WAKE_MG since the previous
+ */
+uint8_t TIER_motion(const int16_t *raw) {
+    uint8_t moved = 0;
+    uint8_t i;
+    
+    for (i = 0; i < 3; i++) {
+        if (hasPrevious && abs(raw[i] - previous[i]) > wakeCounts) {
+            moved = 1;
+        }
+        previous[i] = raw[i];
+    }
+    hasPrevious = 1;
+    
+    return moved;
+}
+
+/**
+ * Count the time in the current tier and change it if needed.
+ * 
+ * @param   busy    something is going on (or moved, in the low tier)
+ * @param   now     ms
+ * @return  The tier to sample at from now on
+ */
+Tier TIER_update(uint8_t busy, uint32_t now) {
+    
+    state.time[state.tier] += now - last;
+    last = now;
+    
+    if (busy) {
+        lastBusy = now;
+    }
+    
+    if (state.tier == TIER_LOW && busy) {
+        state.tier = TIER_FULL;
+        state.rate = RATE_FULL;
+        state.wakes++;
+    } else if (state.tier == TIER_FULL && now - lastBusy >= TIER_HOLDOFF * 1000UL) {
+        state.tier = TIER_LOW;
+        state.rate = RATE_LOW;
+        hasPrevious = 0;
+    }
+    
+    return state.tier;
+}
+
+const TierState *TIER_state() {
+    return &state;
+}
+
+/**
+ * Print the current tier and the time in each.
+ */
+void TIER_dump() {
+    char line[DIAG_LINE_LEN];
+    
+    sprintf(line, "TIER %s %u.%02u Hz, full %lu s low %lu s, %u wakes",
+        state.tier == TIER_FULL ? "full" : "low", state.rate / 100, state.rate % 100,
+        (unsigned long)(state.time[TIER_FULL] / 1000), (unsigned long)(state.time[TIER_LOW] / 1000),
+        state.wakes);
+    DIAG_print(line);
+}
@@ -0,0 +1,69 @@
+ /**************************************************************
+  * 
+  *   _   _           _        _        ____    ___  
+  *  | | | |_ __  ___| |_ __ _(_)_ __  |___ \  / _ \ 
+  *  | | | | '_ \/ __| __/ _` | | '__|   __) || | | |
+  *  | |_| | |_) \__ \ || (_| | | |     / __/ | |_| |
+  *   \___/| .__/|___/\__\__,_|_|_|    |_____(_)___/ 
+  *        |_| Miika Sikala, Oulun Yliopisto, 2018
+  * 
+  * 
+  * ************************************************************
+  * THE BEER-WARE LICENSE
+  * This file is part of Upstair 2.0 software. As long as you retain this notice you
+  * can do whatever you want with this stuff. If we meet some day, and you think
+  * this stuff is worth it, you can buy me a beer in return.
+  * 
+  * Miika Sikala
+  * ************************************************************
+  */
+  
+#ifndef UPSTAIR_TIERS_H
+#define UPSTAIR_TIERS_H
+
+/* Standard libs */
+#include <inttypes.h>
+
+#include "upstair.h"
+
+/*
+ * Sampling tiers of the MPU9250, by what is going on.
+ * 
+ *   TIER_FULL   accelerometer and gyro into the FIFO at IMU_RATE, for the
+ *               attitude, steps and the classifier
+ *   TIER_LOW    the gyro in standby and the accelerometer alone in its low
+ *               power cycle at TIER_LOW_ODR, one sample every TIER_LOW_READ
+ *               loops; a few uA instead of a few mA
+ * 
+ * The main loop says after each read whether the device is busy (moving,
+ * climbing, going up or down). Idle for TIER_HOLDOFF seconds at full rate
+ * drops to the low tier, and in the low tier a change of more than
+ * TIER_WAKE_MG on any axis between two samples, or being busy, ramps back
+ * up. Switching the sensor is up to the caller.
+ * 
+ * Integer math only, after TIER_init().
+ */
+
+typedef enum {
+    TIER_LOW,
+    TIER_FULL,
+    TIERS
+} Tier;
+
+typedef struct {
+    Tier tier;
+    uint16_t rate;              // 0.01 Hz, MPU samples of the current tier
+    uint32_t time[TIERS];       // ms in each tier so far
+    uint16_t wakes;             // times ramped up from the low tier
+} TierState;
+
+
+/* Public functions */
+
+void TIER_init(float aRes, uint32_t now);
+uint8_t TIER_motion(const int16_t *raw);
+Tier TIER_update(uint8_t busy, uint32_t now);
+const TierState *TIER_state();
+void TIER_dump();
+
+#endif /* UPSTAIR_TIERS_H */
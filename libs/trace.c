@@ -0,0 +1,272 @@
+ /**************************************************************
+  * 
+  *   _   _           _        _        ____    ___  
+  *  | | | |_ __  ___| |_ __ _(_)_ __  |___ \  / _ \ 
+  *  | | | | '_ \/ __| __/ _` | | '__|   __) || | | |
+  *  | |_| | |_) \__ \ || (_| | | |     / __/ | |_| |
+  *   \___/| .__/|___/\__\__,_|_|_|    |_____(_)___/ 
+  *        |_| Miika Sikala, Oulun Yliopisto, 2018
+  * 
+  * 
+  * ************************************************************
+  * THE BEER-WARE LICENSE
+  * This file is part of Upstair 2.0 software. As long as you retain this notice you
+  * can do whatever you want with this stuff. If we meet some day, and you think
+  * this stuff is worth it, you can buy me a beer in return.
+  * 
+  * Miika Sikala
+  * ************************************************************
+  */
+  
+/* Standard libs */
+#include <string.h>
+
+#include "libs/trace.h"
+#include "upstair.h"
+
+
+
+/*******************************
+ *        DEFINITIONS          *
+ ******************************/
+
+static TraceSink sink = NULL;
+static TraceMeta traceMeta;
+static ImcEncoder encoder;
+static uint32_t blockTime;              // time of the first sample in the block
+static uint8_t record[TRACE_MAX_LEN];
+
+
+
+/*******************************
+ *          FUNCTIONS          *
+ ******************************/
+
+
+/**
+ * Send the collected block, if any.
+ */
+static void flushBlock() {
+    uint8_t bytes;
+    
+    record[0] = blockTime & 0xFF;
+    record[1] = (blockTime >> 8) & 0xFF;
+    record[2] = (blockTime >> 16) & 0xFF;
+    record[3] = blockTime >> 24;
+    
+    bytes = IMC_flush(&encoder, &record[4]);
+    if (bytes > 0) {
+        sink(LOG_TRACE, record, 4 + bytes);
+    }
+}
+
+/**
+ * Start recording. When already recording, the samples so far are sent and
+ * the trace goes on with the new meta (e.g. after a recalibration).
+ * 
+ * @meta        Sensor scales and sample interval
+ * @traceSink   Called with each finished record
+ */
+void TRACE_start(const TraceMeta *meta, TraceSink traceSink) {
+    
+    if (sink != NULL) {
+        flushBlock();
+    }
+    
+    sink = traceSink;
+    traceMeta = *meta;
+    IMC_init(&encoder, TRACE_AXES, TRACE_BLOCK_BYTES);
+    
+    sink(LOG_TRACE_META, &traceMeta, sizeof(TraceMeta));
+}
+
+/**
+ * Send the meta again. Readers that start in the middle of the trace (the
+ * log has dropped its beginning) can decode the samples after it.
+ */
+void TRACE_meta() {
+    
+    if (sink != NULL) {
+        sink(LOG_TRACE_META, &traceMeta, sizeof(TraceMeta));
+    }
+}
+
+/**
+ * Record a sample.
+ * 
+ * @raw     ax, ay, az, gx, gy, gz as read from the sensor
+ * @now     Milliseconds since boot
+ */
+void TRACE_sample(const int16_t *raw, uint32_t now) {
+    
+    if (sink == NULL) {
+        return;
+    }
+    
+    if (encoder.count == 0) {
+        blockTime = now;
+    }
+    
+    if (!IMC_put(&encoder, raw)) {
+        flushBlock();
+        blockTime = now;
+        IMC_put(&encoder, raw);
+    }
+}
+
+/**
+ * Record a pressure sample.
+ * 
+ * @pressure    Pa * 256
+ * @now         Milliseconds since boot
+ */
+void TRACE_pressure(uint32_t pressure, uint32_t now) {
+    uint8_t data[8];
+    uint8_t i;
+    
+    if (sink == NULL) {
+        return;
+    }
+    
+    for (i = 0; i < 4; i++) {
+        data[i] = (now >> (8 * i)) & 0xFF;
+        data[4 + i] = (pressure >> (8 * i)) & 0xFF;
+    }
+    sink(LOG_TRACE_PRESSURE, data, sizeof(data));
+}
+
+/**
+ * Send what is left and stop recording.
+ */
+void TRACE_stop() {
+    
+    if (sink == NULL) {
+        return;
+    }
+    
+    flushBlock();
+    sink = NULL;
+}
+
+/**
+ * Start decoding a trace.
+ */
+void TRACE_readerInit(TraceReader *reader) {
+    memset(reader, 0, sizeof(*reader));
+}
+
+/**
+ * Give the next record of the trace to the reader. Pressure samples are
+ * held for TRACE_readerPressure(), records of other types are skipped.
+ * 
+ * @return  1 if it had IMU samples, 0 if not (or it was broken)
+ */
+uint8_t TRACE_readerPut(TraceReader *reader, uint8_t type, const uint8_t *data, uint8_t len) {
+    
+    if (type == LOG_TRACE_META && len == sizeof(TraceMeta)) {
+        memcpy(&reader->meta, data, sizeof(TraceMeta));
+        reader->hasMeta = 1;
+        return 0;
+    }
+    
+    if (type == LOG_TRACE_PRESSURE && len == 8) {
+        // full: the oldest goes
+        if (reader->pressureCount == TRACE_PRESSURE_MAX) {
+            memmove(&reader->pressure[0], &reader->pressure[1], sizeof(reader->pressure[0]) * (TRACE_PRESSURE_MAX - 1));
+            --reader->pressureCount;
+        }
+        reader->pressure[reader->pressureCount][0] = data[0] | (data[1] << 8) | ((uint32_t)data[2] << 16) | ((uint32_t)data[3] << 24);
+        reader->pressure[reader->pressureCount][1] = data[4] | (data[5] << 8) | ((uint32_t)data[6] << 16) | ((uint32_t)data[7] << 24);
+        ++reader->pressureCount;
+        return 0;
+    }
+    
+    if (type != LOG_TRACE || !reader->hasMeta || len < 4) {
+        return 0;
+    }
+    
+    reader->time = data[0] | (data[1] << 8) | ((uint32_t)data[2] << 16) | ((uint32_t)data[3] << 24);
+    reader->next = 0;
+    
+    if (!IMC_decode(&data[4], len - 4, TRACE_AXES, &reader->samples[0][0], &reader->count)) {
+        reader->count = 0;
+    }
+    
+    return reader->count > 0;
+}
+
+/**
+ * Take the next sample of the record, scaled like mpu9250_get_data().
+ * 
+ * @time    Milliseconds since boot
+ * @sample  ax, ay, az (g), gx, gy, gz (dps)
+ * 
+ * @return  1 if there was a sample, 0 if the record is used up
+ */
+uint8_t TRACE_readerNext(TraceReader *reader, uint32_t *time, float *sample) {
+    const TraceMeta *meta = &reader->meta;
+    const int16_t *data;
+    
+    if (reader->next >= reader->count) {
+        return 0;
+    }
+    
+    data = reader->samples[reader->next];
+    *time = reader->time + (uint32_t)reader->next * meta->interval;
+    ++reader->next;
+    
+    sample[0] = (float)data[0]*meta->aRes - meta->accelBias[0];
+    sample[1] = (float)data[1]*meta->aRes - meta->accelBias[1];
+    sample[2] = (float)data[2]*meta->aRes - meta->accelBias[2];
+    
+    sample[3] = (float)data[3]*meta->gRes;
+    sample[4] = (float)data[4]*meta->gRes;
+    sample[5] = (float)data[5]*meta->gRes;
+    
+    return 1;
+}
+
+/**
+ * Take the next sample of the record as it was read from the sensor.
+ * 
+ * @time    Milliseconds since boot
+ * @raw     ax, ay, az, gx, gy, gz (unscaled, see meta)
+ * 
+ * @return  1 if there was a sample, 0 if the record is used up
+ */
+uint8_t TRACE_readerNextRaw(TraceReader *reader, uint32_t *time, int16_t *raw) {
+    
+    if (reader->next >= reader->count) {
+        return 0;
+    }
+    
+    *time = reader->time + (uint32_t)reader->next * reader->meta.interval;
+    memcpy(raw, reader->samples[reader->next], sizeof(reader->samples[0]));
+    ++reader->next;
+    
+    return 1;
+}
+
+/**
+ * Take the oldest pressure sample, if it is from before the IMU sample at
+ * @until. Call before each IMU sample to have them in order.
+ * 
+ * @time        Milliseconds since boot
+ * @pressure    Pa * 256
+ * 
+ * @return  1 if there was a sample, 0 if not
+ */
+uint8_t TRACE_readerPressure(TraceReader *reader, uint32_t until, uint32_t *time, uint32_t *pressure) {
+    
+    if (reader->pressureCount == 0 || (int32_t)(reader->pressure[0][0] - until) > 0) {
+        return 0;
+    }
+    
+    *time = reader->pressure[0][0];
+    *pressure = reader->pressure[0][1];
+    
+    --reader->pressureCount;
+    memmove(&reader->pressure[0], &reader->pressure[1], sizeof(reader->pressure[0]) * reader->pressureCount);
+    
+    return 1;
+}
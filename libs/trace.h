@@ -0,0 +1,106 @@
+ /**************************************************************
+  * 
+  *   _   _           _        _        ____    ___  
+  *  | | | |_ __  ___| |_ __ _(_)_ __  |___ \  / _ \ 
+  *  | | | | '_ \/ __| __/ _` | | '__|   __) || | | |
+  *  | |_| | |_) \__ \ || (_| | | |     / __/ | |_| |
+  *   \___/| .__/|___/\__\__,_|_|_|    |_____(_)___/ 
+  *        |_| Miika Sikala, Oulun Yliopisto, 2018
+  * 
+  * 
+  * ************************************************************
+  * THE BEER-WARE LICENSE
+  * This file is part of Upstair 2.0 software. As long as you retain this notice you
+  * can do whatever you want with this stuff. If we meet some day, and you think
+  * this stuff is worth it, you can buy me a beer in return.
+  * 
+  * Miika Sikala
+  * ************************************************************
+  */
+  
+#ifndef UPSTAIR_TRACE_H
+#define UPSTAIR_TRACE_H
+
+/* Standard libs */
+#include <inttypes.h>
+
+#include "libs/imucodec.h"
+
+/*
+ * Recording of raw IMU samples, for replaying them to the attitude filter and
+ * the step detector on the host (host/replay).
+ * 
+ * A trace is a stream of records {type, length, data}, the same records as in
+ * the activity log, so it can go to the log as is or over the radio. It starts
+ * with a LOG_TRACE_META record (TraceMeta) holding what is needed to turn the
+ * raw samples into g and dps exactly like mpu9250_get_data() does. Then come
+ * LOG_TRACE records of
+ * 
+ *   time        u32, milliseconds since boot of the first sample (LE)
+ *   block       imucodec block of ax, ay, az, gx, gy, gz (raw)
+ * 
+ * Samples in a block are meta.interval milliseconds apart. The meta is
+ * repeated with TRACE_meta(), e.g. at the start of every log sector.
+ * 
+ * Pressure samples go in LOG_TRACE_PRESSURE records of
+ * 
+ *   time        u32, milliseconds since boot (LE)
+ *   pressure    u32, Pa * 256 like bmp280_get_data_fixed() (LE)
+ * 
+ * They are sent right away, so they come before the LOG_TRACE record with
+ * the IMU samples of the same time. The reader holds them until then.
+ * 
+ * Trace files on the host are "UPTR", TRACE_VERSION and the records, each
+ * written as type, length, data.
+ */
+
+#define TRACE_VERSION       1
+#define TRACE_AXES          6
+#define TRACE_MAX_LEN       96          // longest record (FLOG_MAX_LEN)
+#define TRACE_BLOCK_BYTES   (TRACE_MAX_LEN - 4)
+#define TRACE_PRESSURE_MAX  4           // pressure samples the reader holds
+
+/* TRACE_MODE (upstair.h) */
+#define TRACE_OFF           0
+#define TRACE_LOG           1           // to the activity log
+#define TRACE_RADIO         2           // to IEEE80154_SERVER_ADDR
+
+
+typedef struct {
+    float aRes;             // g per LSB
+    float gRes;             // dps per LSB
+    float accelBias[3];     // g
+    uint16_t interval;      // milliseconds between samples
+} TraceMeta;
+
+/* Where the records go */
+typedef void (*TraceSink)(uint8_t type, const void *data, uint8_t len);
+
+/* Decoding state */
+typedef struct {
+    TraceMeta meta;
+    uint8_t hasMeta;
+    uint32_t time;                              // of the first sample
+    int16_t samples[IMC_MAX_SAMPLES][TRACE_AXES];
+    uint8_t count;
+    uint8_t next;
+    uint32_t pressure[TRACE_PRESSURE_MAX][2];   // time, pressure; oldest first
+    uint8_t pressureCount;
+} TraceReader;
+
+
+/* Public functions */
+
+void TRACE_start(const TraceMeta *meta, TraceSink sink);
+void TRACE_meta();
+void TRACE_sample(const int16_t *raw, uint32_t now);
+void TRACE_pressure(uint32_t pressure, uint32_t now);
+void TRACE_stop();
+
+void TRACE_readerInit(TraceReader *reader);
+uint8_t TRACE_readerPut(TraceReader *reader, uint8_t type, const uint8_t *data, uint8_t len);
+uint8_t TRACE_readerNext(TraceReader *reader, uint32_t *time, float *sample);
+uint8_t TRACE_readerNextRaw(TraceReader *reader, uint32_t *time, int16_t *raw);
+uint8_t TRACE_readerPressure(TraceReader *reader, uint32_t until, uint32_t *time, uint32_t *pressure);
+
+#endif /* UPSTAIR_TRACE_H */
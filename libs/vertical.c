@@ -0,0 +1,230 @@
+ /**************************************************************
+  * 
+  *   _   _           _        _        ____    ___  
+  *  | | | |_ __  ___| |_ __ _(_)_ __  |___ \  / _ \ 
+  *  | | | | '_ \/ __| __/ _` | | '__|   __) || | | |
+  *  | |_| | |_) \__ \ || (_| | | |     / __/ | |_| |
+  *   \___/| .__/|___/\__\__,_|_|_|    |_____(_)___/ 
+  *        |_| Miika Sikala, Oulun Yliopisto, 2018
+  * 
+  * 
+  * ************************************************************
+  * THE BEER-WARE LICENSE
+  * This file is part of Upstair 2.0 software. As long as you retain this notice you
+  * can do whatever you want with this stuff. If we meet some day, and you think
+  * this stuff is worth it, you can buy me a beer in return.
+  * 
+  * Miika Sikala
+  * ************************************************************
+  */
+  
+/* Standard libs */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "libs/vertical.h"
+#include "libs/diag.h"
+
+
+
+/*******************************
+ *        DEFINITIONS          *
+ ******************************/
+
+#define VERT_HZ (1000000 / (MAIN_TASK_DELAY * BARO_RATE))       // samples per second
+#define VERT_SETTLE (VERT_SETTLE_TIME * VERT_HZ)
+
+#define SCALE_HEIGHT 843400             // cm, R * T / (g * M) of air at 15 C
+#define PRESSURE_MIN (30000UL * 256)    // the range of the BMP280
+#define PRESSURE_MAX (110000UL * 256)
+#define SMOOTH_SHIFT 2                  // altitude low pass: 1/4 of each sample
+#define FRAC 4                          // fraction bits of the smoothed altitude
+
+static VertState state;
+
+static uint32_t reference = 0;          // pressure at altitude 0, 0 before the first sample
+static int32_t cmPerCount;              // altitude per pressure unit, Q16
+
+static int32_t smoothed;                // altitude (cm << FRAC)
+static int32_t window[VERT_WINDOW];     // smoothed altitude of the last samples
+static uint8_t windowPos = 0;
+
+static uint8_t moving = 0;              // going up or down
+static int32_t anchor;                  // altitude where the trip started (cm << FRAC)
+static int16_t floorIndex;              // floors from the anchor
+static uint16_t levelCount = VERT_SETTLE; // samples since moving
+static int8_t shakeVote = 0;            // + shaking, - not, up to VERT_CONFIRM
+
+
+
+/*******************************
+ *          FUNCTIONS          *
+ ******************************/
+
+
+/**
+ * Forget everything seen so far. The next sample is altitude 0.
+ */
+void VERT_reset() {
+    
+    memset(&state, 0, sizeof(state));
+    state.activity = ACT_IDLE;
+    
+    reference = 0;
+    windowPos = 0;
+    moving = 0;
+    levelCount = VERT_SETTLE;
+    shakeVote = 0;
+}
+
+/**
+ * The first sample: altitude 0 and level for the whole window.
+ */
+static void start(uint32_t pressure) {
+    uint8_t i;
+    
+    reference = pressure;
+    cmPerCount = (int32_t)(((int64_t)SCALE_HEIGHT << 16) / pressure);
+    
+    smoothed = 0;
+    for (i = 0; i < VERT_WINDOW; i++) {
+        window[i] = 0;
+    }
+    anchor = 0;
+    floorIndex = 0;
+}
+
+/**
+ * Count the floors passed since the anchor. A floor counts when three
+ * quarters of it have been climbed, floors are seldom exactly
+ * VERT_FLOOR_HEIGHT apart, and it takes as much back to uncount it.
+ * 
+ * @moving  Going up or down
+ * @oldest  Smoothed altitude VERT_WINDOW samples ago
+ */
+static void countFloors(uint8_t moving, int32_t oldest) {
+    const int32_t floor = (int32_t)VERT_FLOOR_HEIGHT << FRAC;
+    int32_t climbed = smoothed - anchor - floorIndex * floor;
+    
+    if (climbed >= floor * 3 / 4) {
+        ++floorIndex;
+        ++state.floorsUp;
+    } else if (climbed <= -floor * 3 / 4) {
+        --floorIndex;
+        ++state.floorsDown;
+    }
+    
+    if (moving) {
+        levelCount = 0;
+        return;
+    }
+    
+    if (levelCount < VERT_SETTLE) {
+        ++levelCount;
+        return;
+    }
+    
+    // standing still: the next trip starts from where we were a window ago,
+    // because it is noticed that late (this also follows the weather)
+    anchor = oldest;
+    floorIndex = 0;
+}
+
+/**
+ * Feed a pressure sample, VERT_HZ times per second.
+ * 
+ * @pressure    Pa * 256, out of the BMP280 range if the read failed
+ * @shaky       The detector says the device is shaking (steps)
+ * 
+ * @return  Current vertical activity
+ */
+Activity VERT_sample(uint32_t pressure, uint8_t shaky) {
+    int32_t altitude;
+    int32_t oldest;
+    int32_t speed;
+    
+    if (pressure < PRESSURE_MIN || pressure > PRESSURE_MAX) {
+        state.valid = 0;
+        return state.activity;
+    }
+    state.valid = 1;
+    
+    if (reference == 0) {
+        start(pressure);
+    }
+    
+    // dh = -H * dp / p, p taken as constant (the error is 1 % per 80 m)
+    altitude = (int32_t)(((int64_t)((int32_t)reference - (int32_t)pressure) * cmPerCount) >> 16);
+    
+    // low pass, then the speed over the window
+    smoothed += ((altitude << FRAC) - smoothed) >> SMOOTH_SHIFT;
+    
+    oldest = window[windowPos];
+    window[windowPos] = smoothed;
+    windowPos = (windowPos + 1) % VERT_WINDOW;
+    
+    speed = (smoothed - oldest) * VERT_HZ / (VERT_WINDOW << FRAC);
+    
+    // moving up or down: start fast enough, stop when slow enough
+    if (moving) {
+        moving = (abs(speed) > VERT_STOP_SPEED);
+    } else {
+        moving = (abs(speed) >= VERT_START_SPEED);
+    }
+    
+    // steps or not over the last samples, only counting down while moving:
+    // whoever walks up to the stairs is climbing them right away, the
+    // elevator is only certain after VERT_CONFIRM samples without steps
+    if (shaky) {
+        if (shakeVote < VERT_CONFIRM) {
+            ++shakeVote;
+        }
+    } else if (shakeVote > (moving ? -VERT_CONFIRM : 0)) {
+        --shakeVote;
+    }
+    
+    if (!moving) {
+        state.activity = ACT_IDLE;
+    } else if (abs(speed) >= VERT_ELEVATOR_SPEED || shakeVote <= -VERT_CONFIRM) {
+        state.activity = ACT_ELEVATOR;
+    } else if (shakeVote > 0) {
+        state.activity = ACT_STAIRS;
+    }
+    
+    countFloors(moving, oldest);
+    
+    state.altitude = smoothed >> FRAC;
+    state.speed = (int16_t)speed;
+    state.direction = moving ? (speed > 0 ? 1 : -1) : 0;
+    
+    return state.activity;
+}
+
+const VertState *VERT_state() {
+    return &state;
+}
+
+/**
+ * Dump the state: "VERT <cm> cm <cm/s> cm/s <activity>, floors <up> up
+ * <down> down".
+ */
+void VERT_dump() {
+    char line[DIAG_LINE_LEN];
+    
+    const char *names[] = {
+        "idle",
+        "stairs",
+        "elevator"
+    };
+    
+    if (!state.valid) {
+        DIAG_print("VERT no pressure");
+        return;
+    }
+    
+    sprintf(line, "VERT %ld cm %d cm/s %s, floors %u up %u down",
+        (long)state.altitude, state.speed, names[state.activity],
+        state.floorsUp, state.floorsDown);
+    DIAG_print(line);
+}
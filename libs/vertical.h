@@ -0,0 +1,60 @@
+ /**************************************************************
+  * 
+  *   _   _           _        _        ____    ___  
+  *  | | | |_ __  ___| |_ __ _(_)_ __  |___ \  / _ \ 
+  *  | | | | '_ \/ __| __/ _` | | '__|   __) || | | |
+  *  | |_| | |_) \__ \ || (_| | | |     / __/ | |_| |
+  *   \___/| .__/|___/\__\__,_|_|_|    |_____(_)___/ 
+  *        |_| Miika Sikala, Oulun Yliopisto, 2018
+  * 
+  * 
+  * ************************************************************
+  * THE BEER-WARE LICENSE
+  * This file is part of Upstair 2.0 software. As long as you retain this notice you
+  * can do whatever you want with this stuff. If we meet some day, and you think
+  * this stuff is worth it, you can buy me a beer in return.
+  * 
+  * Miika Sikala
+  * ************************************************************
+  */
+  
+#ifndef UPSTAIR_VERTICAL_H
+#define UPSTAIR_VERTICAL_H
+
+/* Standard libs */
+#include <inttypes.h>
+
+#include "upstair.h"
+
+/*
+ * Vertical motion from the BMP280. Fed with a pressure sample every
+ * BARO_RATE loops, it keeps up the altitude and the vertical speed over the
+ * last VERT_WINDOW samples. Going up or down faster than VERT_START_SPEED is
+ * climbing stairs when the detector (libs/detector.h) says the device is
+ * shaking, riding an elevator when it does not. That activity is for the
+ * diag; the one shown comes from the classifier (libs/classifier.h), which
+ * gets the speed as a feature. Floors are counted every VERT_FLOOR_HEIGHT
+ * while moving.
+ * 
+ * Integer math only. Pressure is Pa * 256, altitude cm.
+ */
+
+typedef struct {
+    int32_t altitude;           // cm above the first sample
+    int16_t speed;              // cm/s, up is positive
+    int8_t direction;           // 1 up, -1 down, 0 level
+    Activity activity;          // ACT_STAIRS, ACT_ELEVATOR or ACT_IDLE
+    uint16_t floorsUp;
+    uint16_t floorsDown;
+    uint8_t valid;              // the last sample was good
+} VertState;
+
+
+/* Public functions */
+
+void VERT_reset();
+Activity VERT_sample(uint32_t pressure, uint8_t shaky);
+const VertState *VERT_state();
+void VERT_dump();
+
+#endif /* UPSTAIR_VERTICAL_H */
@@ -20,6 +20,10 @@
   
 /* Standard libs */
 #include <inttypes.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 #include <time.h>
 
 /* XDCtools Header files */
@@ -28,14 +32,17 @@
 #include <ti/sysbios/BIOS.h>
 #include <ti/sysbios/knl/Task.h>
 #include <ti/sysbios/knl/Clock.h>
+#include <ti/sysbios/knl/Semaphore.h>
 
 /* TI-RTOS Header files */
 #include <ti/drivers/I2C.h>
 #include <ti/drivers/PIN.h>
+#include <ti/drivers/SPI.h>
 #include <ti/drivers/i2c/I2CCC26XX.h>
 #include <ti/drivers/pin/PINCC26XX.h>
 #include <ti/drivers/Power.h>
 #include <ti/drivers/power/PowerCC26XX.h>
+#include <driverlib/sys_ctrl.h>
 
 /* Board Header files */
 #include "Board.h"
@@ -45,7 +52,30 @@
 
 /* Libraries */
 #include "wireless/comm_lib.h"
+#include "sensors/mpu9250.h"
+#include "sensors/bmp280.h"
+#include "sensors/hdc1000.h"
+#include "sensors/opt3001.h"
 #include "libs/gui.h"
+#include "libs/history.h"
+#include "libs/game.h"
+#include "libs/flashlog.h"
+#include "libs/snapshot.h"
+#include "libs/calib.h"
+#include "libs/attitude.h"
+#include "libs/steps.h"
+#include "libs/spectrum.h"
+#include "libs/tiers.h"
+#include "libs/acquire.h"
+#include "libs/ambient.h"
+#include "libs/classifier.h"
+#include "libs/detector.h"
+#include "libs/vertical.h"
+#include "libs/trace.h"
+#include "libs/prof.h"
+#include "libs/load.h"
+#include "libs/energy.h"
+#include "libs/diag.h"
 
 /* Task stacks */
 #define STACKSIZE 2048
@@ -73,47 +103,16 @@ uint8_t msgCooldown = 0;                    // this prevents sending too many me
 
 uint32_t sleepCounter = 0;
 uint8_t autoSleep = 0;
+uint8_t powerOff = 0;                       // user asked to shut down
 
+uint8_t logOpen = 0;                        // whether the activity log is usable
+uint8_t diagDump = 0;                       // dump the diagnostics on the next loop
 
-
-/******************************
- *      STEP DETECTION        *
- *****************************/
-
-
-////////////////////////////////////////////////////////////////////////////////
-// ALGORITHM BEHAVIOUR
-////////////////////////////////////////////////////////////////////////////////
-
-// Tweak these values to calibrate the step detector.
-
-
-float treshold          = 0.19;     // how small/big vibrations are counted
-
-uint8_t stairsLimit     = 5;        // if shakiness rises above this --> STAIRS
-uint8_t idleLimit       = 3;        // if shakiness drops below this --> IDLE
-
-uint8_t maxShakiness    = 7;        // the greatest possible shakiness
-uint8_t minShakiness    = 0;        // the lowest possible shakiness
-
-float shakinessRise     = 0.7;      // how fast shakiness rises
-float shakinessDrop     = 0.5;      // how fast shakiness drops back
-
-////////////////////////////////////////////////////////////////////////////////
-
-float shakiness = 0;
-
-uint32_t sampleCount = 0;
-
-// moving average samples for each axis
-float ma_samples_x[MA_N];
-float ma_samples_y[MA_N];
-float ma_samples_z[MA_N];
-
-// moving average values for each axis
-float movingAvg_x;
-float movingAvg_y;
-float movingAvg_z;
+int16_t imuSamples[IMU_FIFO_MAX][6];        // MPU samples since the previous read (raw)
+uint8_t imuCount = 0;                       // how many, 0 if the FIFO overflowed
+uint32_t pressure = 0;                      // the latest BMP280 sample (Pa * 256), 0 if not read
+int16_t climateTemp = 0;                    // the latest HDC1000 sample (0.01 C)
+uint16_t climateHumidity = 0;               // and humidity (0.01 %RH)
 
 
 
@@ -161,12 +160,61 @@ static PIN_Config cMpuPin[] = {
     PIN_TERMINATE
 };
 
+// MPU interrupt, wakes up from standby on motion
+static PIN_Handle hMpuInt;
+static PIN_State sMpuInt;
+static PIN_Config cMpuInt[] = {
+    Board_MPU_INT | PIN_INPUT_EN | PIN_PULLDOWN | PIN_HYSTERESIS | PIN_IRQ_POSEDGE,
+    PIN_TERMINATE
+};
+static Semaphore_Handle hMotionSem;
+static volatile uint32_t motionTicks;       // when the MPU interrupt came
+static uint8_t waking = 0;                  // back from standby, not read at full rate yet
+
+// BMP280: a sample every ~140 ms, the IIR filter takes the noise down to
+// ~10 cm (libs/vertical.h)
+static const bmp280_config baroConfig = {
+    BMP280_OSRS_X4,         // pressure
+    BMP280_OSRS_X1,         // temperature
+    BMP280_FILTER_4,
+    BMP280_STANDBY_125_MS,
+    0                       // 64 bit compensation
+};
+
 // MPU9250 uses its own I2C interface
 static const I2CCC26XX_I2CPinCfg i2cMPUCfg = {
     .pinSDA = Board_I2C0_SDA1,
     .pinSCL = Board_I2C0_SCL1
 };
 
+// The acquisition schedule (libs/acquire.h), bits of ACQ_run()
+enum {
+    SENSOR_MPU,
+    SENSOR_BARO,
+    SENSOR_CLIMATE,
+    SENSOR_LIGHT,
+    SENSORS
+};
+
+#define LOOP_MS (MAIN_TASK_DELAY / 1000)
+
+uint8_t readSensors(I2C_Handle *i2cMPU);
+uint8_t readPressure(I2C_Handle *i2c);
+uint8_t readClimate(I2C_Handle *i2c);
+uint8_t readLight(I2C_Handle *i2c);
+
+// The MPU fills its FIFO and the BMP280 converts on its own: both are read
+// when due. The barometer a loop after the MPU, so that they seldom share a
+// loop. The HDC1000 is triggered and read on a later loop. The OPT3001
+// converts on its own too, it is polled with the barometer on the same bus
+// (AMB_PERIOD a multiple of BARO_RATE loops).
+static const AcqSensor sensors[SENSORS] = {
+    { "mpu",  ACQ_BUS_MPU,     SAMPLE_RATE * LOOP_MS, 0, 0,       NULL, readSensors },
+    { "baro", ACQ_BUS_SENSORS, BARO_RATE * LOOP_MS,   0, LOOP_MS, NULL, readPressure },
+    { "hdc",  ACQ_BUS_SENSORS, HDC_PERIOD, HDC1000_CONVERSION_MS, 3 * LOOP_MS, hdc1000_start, readClimate },
+    { "opt",  ACQ_BUS_SENSORS, AMB_PERIOD,            0, LOOP_MS, NULL, readLight }
+};
+
 
 
 /*******************************
@@ -174,174 +222,358 @@ static const I2CCC26XX_I2CPinCfg i2cMPUCfg = {
  ******************************/
 
 
-void array_pop(float *arr, float *el, uint16_t len);
-float array_sum(float *arr);
-
-uint8_t tresholdExceeded(float ax, float ay, float az);
-void readSensors(I2C_Handle *i2c, I2C_Handle *i2cMPU, I2C_Params *i2cParams, I2C_Params *i2cMPUParams, float *results);
-void detectStep(float *rawData);
 void resetAutoSleep();
+void dumpClimate();
 
 void sendInspireMsg();
+char *newMsgSlot();
+void logEvent(LogType type, const void *data, uint8_t len);
+void restoreLog();
+uint8_t loadSnapshot();
+void saveSnapshot();
+void recalibrate(I2C_Handle *i2cMPU, I2C_Params *i2cMPUParams);
+void setTier(Tier tier, I2C_Handle *i2cMPU, I2C_Params *i2cMPUParams);
+void standBy(I2C_Handle *i2cMPU, I2C_Params *i2cMPUParams);
+Void mpuIntFxn(PIN_Handle handle, PIN_Id pinId);
+void startTrace();
 void readBattery(uint8_t *batteryLevel);
 void shutDown();
 
 
 /**
- * Shifts every element in given array to left and adds @el to the end of
- * the array. The first element is popped out.
+ * Read sensors, on the MPU's bus: the samples the MPU has collected to its
+ * FIFO since the previous read, IMU_RATE per second, to imuSamples
+ * (ax, ay, az, gx, gy, gz raw, oldest first) and imuCount. In the low tier
+ * (libs/tiers.h) the latest accelerometer sample only, the gyro reads zero.
  * 
- * NOTE: @arr and @el are type of float!
+ * @return  1, imuCount is 0 if the FIFO overflowed
+ */
+uint8_t readSensors(I2C_Handle *i2cMPU) {
+    
+    PROF_BEGIN(PROF_READ_SENSORS);
+    if (TIER_state()->tier == TIER_FULL) {
+        imuCount = mpu9250_get_fifo(i2cMPU, imuSamples, IMU_FIFO_MAX);
+    } else {
+        mpu9250_get_accel(i2cMPU, imuSamples[0]);
+        imuCount = 1;
+    }
+    PROF_END(PROF_READ_SENSORS);
+    
+    return 1;
+}
+
+/**
+ * Read the barometer to pressure, on the sensors' bus.
  * 
- * @arr     The array we are popping
- * @el      Element to be added to the end of @arr
- * @len     Length of @arr
+ * @return  1 if it could be read
  */
-void array_pop(float *arr, float *el, uint16_t len) {
+uint8_t readPressure(I2C_Handle *i2c) {
+    int32_t temp;
     
-    // shift every element one element forward
-    uint16_t i;
-    for(i=0; i < len-1; i++) {
-	    arr[i] = arr[i+1];
-	}
-	
-	// add new element to the end of the array
-	arr[len-1] = *el;
+    PROF_BEGIN(PROF_READ_BARO);
+    pressure = 0;
+    bmp280_get_data_fixed(i2c, &pressure, &temp);
+    PROF_END(PROF_READ_BARO);
+    
+    return pressure != 0;
 }
 
+/**
+ * Read the temperature and humidity the HDC1000 has converted.
+ * 
+ * @return  1 if it could be read
+ */
+uint8_t readClimate(I2C_Handle *i2c) {
+    return hdc1000_get_data_fixed(i2c, &climateTemp, &climateHumidity);
+}
 
 /**
- * Sum all elements in given array and return the sum.
+ * Poll the ambient light. It is read only when it has left the window of
+ * the OPT3001 (libs/ambient.h), or for the first time, and the window is
+ * moved around it.
  * 
- * @arr     Array containing the elements we want to be summed.
- * @return  (Float) sum of the elements.
+ * @return  1 if it could be polled
+ */
+uint8_t readLight(I2C_Handle *i2c) {
+    uint16_t status;
+    uint32_t lux;
+    
+    if (!opt3001_get_status(i2c, &status)) {
+        return 0;
+    }
+    
+    if (AMB_state()->valid ? !(status & (OPT3001_FLAG_HIGH | OPT3001_FLAG_LOW))
+            : !(status & OPT3001_DATA_READY)) {
+        return 1;
+    }
+    
+    if (!opt3001_get_data_fixed(i2c, &lux)) {
+        return 0;
+    }
+    AMB_sample(lux);
+    
+    return opt3001_set_window(i2c, AMB_state()->low, AMB_state()->high);
+}
+
+/**
+ * Print the latest temperature and humidity.
  */
-float array_sum(float *arr) {
-	float sum = 0;
-	unsigned int i;
+void dumpClimate() {
+    char line[DIAG_LINE_LEN];
+    
+    sprintf(line, "CLIMATE %s%u.%02u C %u.%02u %%RH", climateTemp < 0 ? "-" : "",
+        abs(climateTemp) / 100, abs(climateTemp) % 100, climateHumidity / 100, climateHumidity % 100);
+    DIAG_print(line);
+}
 
-	for(i=0; i < MA_N; i++) {
-		sum += arr[i];
-	}
 
-	return sum;
+/**
+ * Reset sleep counter.
+ */
+void resetAutoSleep() {
+    if (autoSleep) {
+        sleepCounter = AUTO_SLEEP_TIME;
+    }
 }
 
+/**
+ * Send an inspiring message to other devices on the range.
+ */
+void sendInspireMsg() {
+    
+    char msg[16] = "I'm so fit!";
+    
+    // send a message to SERVER via 6LoWPAN
+    Send6LoWPAN(IEEE80154_BROADCAST, msg, strlen(msg));
+    
+}
 
 /**
- * Part of stepDetection.
- * 
- * Returns 1 if treshold is exceeded on any axis.
+ * Make room for a new message and return where to put it. When the list is
+ * full, the oldest message is dropped.
  */
-uint8_t tresholdExceeded(float ax, float ay, float az) {
+char *newMsgSlot() {
     
-    return ((fabs(movingAvg_x - ax) > treshold || fabs(movingAvg_y - ay) > treshold || fabs(movingAvg_z - az) > treshold));
+    if (msgCount == MSGS_MAX_COUNT) {
+        memmove(msgs[0], msgs[1], (MSGS_MAX_COUNT - 1) * MAX_TEXT_LEN);
+        --msgCount;
+    }
+    
+    memset(msgs[msgCount], 0, MAX_TEXT_LEN);
+    return msgs[msgCount++];
+}
 
+
+/* Activity log */
+
+/**
+ * Append an event to the activity log.
+ */
+void logEvent(LogType type, const void *data, uint8_t len) {
+    
+    if (!logOpen) {
+        return;
+    }
+    
+    // every sector gets the score, so it can be restored from the newest one
+    if (FLOG_append(type, data, len) == FLOG_NEW_SECTOR) {
+        
+        if (type != LOG_SCORE) {
+            FLOG_append(LOG_SCORE, &score, sizeof(score));
+        }
+        
+#if TRACE_MODE == TRACE_LOG
+        // and a trace can be read from any sector
+        TRACE_meta();
+#endif
+    }
 }
 
+/**
+ * Restore the score and the latest messages from the activity log.
+ */
+void restoreLog() {
+    FlogCursor cursor;
+    FlogRecord record;
+    
+    FLOG_first(&cursor, LOG_RESTORE_SECTORS);
+    
+    while (FLOG_next(&cursor, &record)) {
+        switch (record.type) {
+            
+            case LOG_SCORE:
+                memcpy(&score, record.data, sizeof(score));
+                break;
+                
+            case LOG_ACTIVITY:
+                memcpy(&score, &record.data[offsetof(LogActivity, score)], sizeof(score));
+                break;
+                
+            case LOG_MSG:
+                memcpy(newMsgSlot(), record.data, MAX_TEXT_LEN);
+                break;
+        }
+    }
+}
+
+
+/* Boot snapshot */
 
 /**
- * Read sensors.
+ * Restore the state saved at shutdown. Only done when waking up from
+ * shutdown, after a reset the log is newer than the snapshot.
+ * 
+ * @return  1 if the state was restored
  */
-void readSensors(I2C_Handle *i2c, I2C_Handle *i2cMPU, I2C_Params *i2cParams, I2C_Params *i2cMPUParams, float *results) {
+uint8_t loadSnapshot() {
+    Snapshot snapshot;
+    
+    if (SysCtrlResetSourceGet() != RSTSRC_WAKEUP_FROM_SHUTDOWN) {
+        return 0;
+    }
+    
+    if (!SNAP_load(SNAP_STATE, &snapshot, sizeof(snapshot), SNAPSHOT_VERSION)) {
+        return 0;
+    }
     
-    // Ask data from MPU...
+    score = snapshot.score;
+    autoSleep = snapshot.autoSleep;
+    msgCount = snapshot.msgCount;
+    memcpy(msgs, snapshot.msgs, sizeof(msgs));
+    
+    if (autoSleep) {
+        sleepCounter = AUTO_SLEEP_TIME;
+    }
+    
+    return 1;
+}
+
+/**
+ * Save the state for the next boot.
+ */
+void saveSnapshot() {
+    Snapshot snapshot;
+    
+    snapshot.score = score;
+    snapshot.autoSleep = autoSleep;
+    snapshot.msgCount = msgCount;
+    memcpy(snapshot.msgs, msgs, sizeof(msgs));
+    
+    if (!SNAP_save(SNAP_STATE, &snapshot, sizeof(snapshot), SNAPSHOT_VERSION)) {
+        System_printf("Snapshot not saved\n");
+        System_flush();
+    }
+}
+
+
+/**
+ * Apply a corrected calibration to the MPU and save it.
+ */
+void recalibrate(I2C_Handle *i2cMPU, I2C_Params *i2cMPUParams) {
+    const mpu9250_calibration *cal = CAL_get();
     
     *i2cMPU = I2C_open(Board_I2C, i2cMPUParams);
     if (*i2cMPU == NULL) {
         System_abort("Error Initializing I2CMPU\n");
     }
+    ENERGY_on(EN_I2C);
     
-    // Accelometer/gyro: ax, ay, az, gx, gy, gz
-    mpu9250_get_data(&i2cMPU,
-        &results[0],
-        &results[1],
-        &results[2],
-        &results[3],
-        &results[4],
-        &results[5]
-    );
+    mpu9250_set_bias(cal->gyro_bias, cal->accel_bias);
     
     I2C_close(*i2cMPU);
+    ENERGY_off(EN_I2C);
+    
+    ATT_setBias(cal->accel_bias);
+    
+#if TRACE_MODE != TRACE_OFF
+    startTrace();   // the replay needs the new bias
+#endif
+    
+    if (logOpen) {
+        CAL_save();
+    }
+    
+    System_printf("MPU9250: Drift corrected\n");
+    System_flush();
 }
 
-
 /**
- * Detect steps from accelometer data.
- * 
- * @rawData     Array containing the raw accelometer data from sensor
+ * Switch the MPU to a sampling tier. Coming back to full rate, the attitude
+ * and the step band features start over: the gyro was off and the
+ * orientation may have changed.
  */
-void detectStep(float *rawData) {
-    float ax = rawData[0];
-    float ay = rawData[1];
-    float az = rawData[2];
-    
-    // increase sampleCount - how many data pieces we have got in total
-    ++sampleCount;
-    
-    // add new sample to moving average samples, oldest one pops out!
-    array_pop(ma_samples_x, &ax, MA_N);
-    array_pop(ma_samples_y, &ay, MA_N);
-    array_pop(ma_samples_z, &az, MA_N);
-    
-    // if we have gained enough data so the sample list is full
-    if (sampleCount >= MA_N-1) {
-        
-        // TODO: update all of these at once!!
-        // calculate the moving average for each axis individually
-        movingAvg_x = array_sum(ma_samples_x) / MA_N;
-        movingAvg_y = array_sum(ma_samples_y) / MA_N;
-        movingAvg_z = array_sum(ma_samples_z) / MA_N;
-        
-        // Adjust shakiness
-        if(tresholdExceeded(ax, ay, az) && shakiness <= maxShakiness - shakinessRise) {
-            
-            shakiness += shakinessRise;
-            resetAutoSleep();
-            
-            
-        } else {
-            
-            // lower shakiness
-            if(shakiness >= minShakiness + shakinessDrop) {
-                
-                shakiness -= shakinessDrop;
-                
-            }
-        }
+void setTier(Tier tier, I2C_Handle *i2cMPU, I2C_Params *i2cMPUParams) {
+    
+    *i2cMPU = I2C_open(Board_I2C, i2cMPUParams);
+    if (*i2cMPU == NULL) {
+        System_abort("Error Initializing I2CMPU\n");
     }
+    ENERGY_on(EN_I2C);
     
-    /* Handle result */
+    if (tier == TIER_FULL) {
+        mpu9250_full_rate(i2cMPU);
+    } else {
+        mpu9250_low_power(i2cMPU, TIER_LOW_ODR);
+    }
     
-    if (shakiness >= stairsLimit) {
-	    activity = ACT_STAIRS;
-    } else if(shakiness < idleLimit) {
-	    activity = ACT_IDLE;
-	}
+    I2C_close(*i2cMPU);
+    ENERGY_off(EN_I2C);
+    
+    if (tier == TIER_FULL) {
+        ENERGY_off(EN_MPU_LP);
+        ENERGY_on(EN_MPU);
+        ATT_reset();
+        SPEC_reset();
+    } else {
+        ENERGY_off(EN_MPU);
+        ENERGY_on(EN_MPU_LP);
+    }
     
+    ACQ_setPeriod(SENSOR_MPU, (tier == TIER_FULL ? SAMPLE_RATE : TIER_LOW_READ) * LOOP_MS,
+        Clock_getTicks() / (1000 / Clock_tickPeriod));
 }
 
+
+/* IMU trace */
+
+#if TRACE_MODE != TRACE_OFF
+
 /**
- * Reset sleep counter.
+ * Send a trace record where TRACE_MODE says.
  */
-void resetAutoSleep() {
-    if (autoSleep) {
-        sleepCounter = AUTO_SLEEP_TIME;
-    }
+void traceSink(uint8_t type, const void *data, uint8_t len) {
+    
+#if TRACE_MODE == TRACE_LOG
+    logEvent((LogType)type, data, len);
+#else
+    uint8_t frame[2 + TRACE_MAX_LEN];
+    
+    // the same {type, length, data} as in a trace file
+    frame[0] = type;
+    frame[1] = len;
+    memcpy(&frame[2], data, len);
+    
+    Send6LoWPAN(IEEE80154_SERVER_ADDR, frame, 2 + len);
+#endif
 }
 
 /**
- * Send an inspiring message to other devices on the range.
+ * Start recording the MPU samples with the current scales and bias.
  */
-void sendInspireMsg() {
-    
-    char msg[16] = "I'm so fit!";
+void startTrace() {
+    TraceMeta meta;
+    mpu9250_calibration cal;
     
-    // send a message to SERVER via 6LoWPAN
-    Send6LoWPAN(IEEE80154_BROADCAST, msg, strlen(msg));
+    mpu9250_get_scale(&meta.aRes, &meta.gRes);
+    mpu9250_get_calibration(&cal);
+    memcpy(meta.accelBias, cal.accel_bias, sizeof(meta.accelBias));
+    meta.interval = 1000 / IMU_RATE;
     
+    TRACE_start(&meta, traceSink);
 }
 
+#endif
+
 
 /* Utility Functions */
 
@@ -359,6 +591,91 @@ void readBattery(uint8_t *batteryLevel) {
 }
 
 
+/**
+ * Stand by until the device is moved. The MPU watches for motion in its
+ * low power cycle and the radio core is off, so the CPU can stay in
+ * standby: the MPU interrupt is the only way out, besides the RTC every
+ * STANDBY_TICK seconds to keep the load and energy counters from wrapping.
+ * The buttons are ignored and the LCD is blanked (no VCOM toggling) until
+ * then. The wake latency is measured at the first read at full rate.
+ */
+void standBy(I2C_Handle *i2cMPU, I2C_Params *i2cMPUParams) {
+    static EnergyStats before;
+    uint32_t start;
+    
+    System_printf("Standby: waiting for motion\n");
+    System_flush();
+    
+    // save the state and write out the activity log, in case the battery
+    // runs out before anything happens
+    if (logOpen) {
+        saveSnapshot();
+        FLOG_sync();
+    }
+    
+    LOAD_update();
+    ENERGY_update();
+    before = *ENERGY_stats();
+    start = Clock_getTicks();
+    
+    // a press would not be seen on a blank screen, don't act on it
+    PIN_setInterrupt(hButton1, Board_BUTTON0 | PIN_IRQ_DIS);
+    PIN_setInterrupt(hButton2, Board_BUTTON1 | PIN_IRQ_DIS);
+    GUI_sleepDisplay();
+    
+    Sleep6LoWPAN();
+    
+    *i2cMPU = I2C_open(Board_I2C, i2cMPUParams);
+    if (*i2cMPU == NULL) {
+        System_abort("Error Initializing I2CMPU\n");
+    }
+    ENERGY_on(EN_I2C);
+    
+    mpu9250_wake_on_motion(i2cMPU, STANDBY_WAKE_MG, STANDBY_ODR);
+    
+    I2C_close(*i2cMPU);
+    ENERGY_off(EN_I2C);
+    ENERGY_off(EN_MPU);
+    ENERGY_on(EN_MPU_LP);
+    
+    // a pulse left over from the last time doesn't count
+    Semaphore_pend(hMotionSem, BIOS_NO_WAIT);
+    hMpuInt = PIN_open(&sMpuInt, cMpuInt);
+    if (hMpuInt == NULL) {
+        System_abort("MPU interrupt pin open failed!");
+    }
+    PIN_registerIntCb(hMpuInt, &mpuIntFxn);
+    
+    while (!Semaphore_pend(hMotionSem, STANDBY_TICK * (1000000 / Clock_tickPeriod))) {
+        LOAD_update();
+        ENERGY_update();
+    }
+    PIN_close(hMpuInt);
+    
+    // full rate (the low tier is skipped, something is going on) and the
+    // radio back on
+    setTier(TIER_FULL, i2cMPU, i2cMPUParams);
+    TIER_update(1, Clock_getTicks() / (1000 / Clock_tickPeriod));
+    Wake6LoWPAN();
+    
+    // the sensors were not read in between, that is not late
+    ACQ_resync(Clock_getTicks() / (1000 / Clock_tickPeriod));
+    
+    GUI_wakeDisplay();
+    PIN_setInterrupt(hButton1, Board_BUTTON0 | PIN_IRQ_NEGEDGE);
+    PIN_setInterrupt(hButton2, Board_BUTTON1 | PIN_IRQ_NEGEDGE);
+    
+    LOAD_update();
+    ENERGY_update();
+    System_printf("Standby: %lu s, %lu uA estimated\n",
+        (unsigned long)((Clock_getTicks() - start) / (1000000 / Clock_tickPeriod)),
+        (unsigned long)ENERGY_meanSince(&before));
+    System_flush();
+    
+    waking = 1;
+    resetAutoSleep();
+}
+
 /**
  * Shut down the device.
  */
@@ -367,10 +684,22 @@ void shutDown() {
     System_printf("Shutting down...\n");
     System_flush();
     
+#if TRACE_MODE != TRACE_OFF
+    TRACE_stop();
+#endif
+    
+    // save the state and write out the activity log
+    if (logOpen) {
+        saveSnapshot();
+        FLOG_close();
+    }
+    
     GUI_closeDisplay();
     
     // Power off MPU
     PIN_setOutputValue(hMpuPin,Board_MPU_POWER, Board_MPU_POWER_OFF);
+    ENERGY_off(EN_MPU);
+    ENERGY_off(EN_MPU_LP);
     
     Task_sleep(100000 / Clock_tickPeriod);
 
@@ -391,6 +720,15 @@ void shutDown() {
  ******************************/
 
  
+/**
+ * Callback of the MPU interrupt: moved while in standby.
+ */
+Void mpuIntFxn(PIN_Handle handle, PIN_Id pinId) {
+    
+    motionTicks = Clock_getTicks();
+    Semaphore_post(hMotionSem);
+}
+
 /**
  * Callback function for BUTTON 1
  * 
@@ -427,17 +765,37 @@ Void button1Fxn(PIN_Handle handle, PIN_Id pinId) {
             break;
             
         case VW_STATS:
+            
+            // Button 2 held down: the hidden diagnostics view
+            if (!PIN_getInputValue(Board_BUTTON1)) {
+                LOAD_setCounting(1);
+                GUI_changeView(&view, VW_DIAG, &state);
+                break;
+            }
         
             // Return to main menu
             GUI_changeView(&view, VW_MENU, &state);
             break;
             
+        case VW_DIAG:
+            
+            // Let the CPU sleep again, back to statistics
+            LOAD_setCounting(0);
+            GUI_changeView(&view, VW_STATS, &state);
+            break;
+            
         case VW_SETTINGS:
         
             // Return to main menu
             GUI_changeView(&view, VW_MENU, &state);
             break;
             
+        case VW_GAME:
+        
+            // Return to main menu
+            GUI_changeView(&view, VW_MENU, &state);
+            break;
+            
         case VW_CONFM_SHUTDOWN:
             
             // Return from confirmation view to main view
@@ -495,6 +853,13 @@ Void button2Fxn(PIN_Handle handle, PIN_Id pinId) {
                     
                 case 3:
                 
+                    // Start a new game
+                    GAME_reset(Clock_getTicks() * Clock_tickPeriod);
+                    GUI_changeView(&view, VW_GAME, &state);
+                    break;
+                    
+                case 4:
+                
                     // Go to settings view
                     GUI_changeView(&view, VW_SETTINGS, &state);
                     break;
@@ -503,6 +868,25 @@ Void button2Fxn(PIN_Handle handle, PIN_Id pinId) {
             
             break;
             
+        case VW_STATS:
+        
+            // switch chart resolution
+            GUI_cycleStatsRes();
+            state = ST_UPDATE_SCR;
+            break;
+            
+        case VW_GAME:
+        
+            // jump (or play again)
+            GAME_press();
+            break;
+            
+        case VW_DIAG:
+            
+            // dump the diagnostics (in the main task)
+            diagDump = 1;
+            break;
+            
         case VW_SETTINGS:
         
             // change settings
@@ -520,8 +904,9 @@ Void button2Fxn(PIN_Handle handle, PIN_Id pinId) {
             
         case VW_CONFM_SHUTDOWN:
             
-            // Turn off the device
-            shutDown();
+            // Turn off the device (in the main task, the log can't be
+            // written from here)
+            powerOff = 1;
             break;
     }
 }
@@ -544,6 +929,28 @@ Void mainTask(UArg arg0, UArg arg1) {
     GUI_initDisplay();
     
     
+    /* Activity log and boot snapshot */
+    
+    // whether the MPU has a stored calibration
+    uint8_t fastBoot = 0;
+    
+    logOpen = FLOG_open();
+    if (logOpen) {
+        
+        // the snapshot is quicker to read than the log
+        if (!loadSnapshot()) {
+            restoreLog();
+        }
+        
+        fastBoot = CAL_load();
+        
+        logEvent(LOG_BOOT, NULL, 0);
+    } else {
+        System_printf("Activity log not available\n");
+        System_flush();
+    }
+    
+    
     /* Sensors */
     
     I2C_Handle      i2c;
@@ -560,9 +967,13 @@ Void mainTask(UArg arg0, UArg arg1) {
     i2cMPUParams.bitRate = I2C_400kHz;
     i2cMPUParams.custom = (uintptr_t)&i2cMPUCfg;
 	
-	// this always holds the lastest raw data samples
+	// this always holds the lastest data sample, scaled
 	float realTimeData[6];
 	
+	// and this the acceleration of the samples in the earth frame
+	float linearAccel[3];
+	uint8_t i;
+	
 	
 	/* Init general I2C */
 	
@@ -571,10 +982,19 @@ Void mainTask(UArg arg0, UArg arg1) {
         System_abort("Error Initializing I2C\n");
     }
     
+    ENERGY_on(EN_I2C);
+    
     // setup pressure sensor
-    // bmp280_setup(&i2c);
+    bmp280_setup(&i2c, &baroConfig);
+    
+    // temperature and humidity in one conversion
+    hdc1000_setup(&i2c);
+    
+    // ambient light, flags when it changes
+    opt3001_setup(&i2c);
     
     I2C_close(i2c);
+    ENERGY_off(EN_I2C);
     
     
     /* Init I2C for MPU */
@@ -583,25 +1003,66 @@ Void mainTask(UArg arg0, UArg arg1) {
     if (i2cMPU == NULL) {
         System_abort("Error Initializing I2CMPU\n");
     }
+    ENERGY_on(EN_I2C);
     
     // power on for MPU
     PIN_setOutputValue(hMpuPin, Board_MPU_POWER, Board_MPU_POWER_ON);
+    ENERGY_on(EN_MPU);
 
     // WAIT 100MS FOR THE SENSOR TO POWER UP
 	Task_sleep(100000 / Clock_tickPeriod);
     System_printf("MPU9250: Power ON\n");
     System_flush();
     
-    System_printf("MPU9250: Setup and calibration...\n");
-	System_flush();
-
-	mpu9250_setup(&i2cMPU);
-
-	System_printf("MPU9250: Setup and calibration OK\n");
-	System_flush();
+    if (fastBoot) {
+        
+        // calibrated earlier, drift is corrected while running
+        mpu9250_setup_fast(&i2cMPU, CAL_get());
+        
+        System_printf("MPU9250: Setup OK (stored calibration)\n");
+        System_flush();
+        
+    } else {
+        
+        System_printf("MPU9250: Setup and calibration...\n");
+        System_flush();
+        
+        mpu9250_setup(&i2cMPU);
+        
+        mpu9250_calibration cal;
+        mpu9250_get_calibration(&cal);
+        cal.timestamp = Clock_getTicks() / (1000000 / Clock_tickPeriod);
+        CAL_set(&cal);
+        
+        if (logOpen) {
+            CAL_save();
+        }
+        
+        System_printf("MPU9250: Setup and calibration OK\n");
+        System_flush();
+    }
+    
+    // from now on, every sample is kept until read
+    mpu9250_fifo_start(&i2cMPU);
 	
 	I2C_close(i2cMPU);
+    ENERGY_off(EN_I2C);
+    
+    float aRes, gRes;
+    mpu9250_get_scale(&aRes, &gRes);
+    ATT_init(IMU_RATE, aRes, gRes, CAL_get()->accel_bias);
+    STEP_init(IMU_RATE);
+    SPEC_init(IMU_RATE);
+    CLS_init(&CLS_model);
+    TIER_init(aRes, Clock_getTicks() / (1000 / Clock_tickPeriod));
+    AMB_init();
+    
+    I2C_Params *busParams[ACQ_BUSES] = { &i2cParams, &i2cMPUParams };
+    ACQ_init(sensors, SENSORS, busParams, Clock_getTicks() / (1000 / Clock_tickPeriod));
 	
+#if TRACE_MODE != TRACE_OFF
+    startTrace();
+#endif
 	
     
     /*****************
@@ -611,28 +1072,148 @@ Void mainTask(UArg arg0, UArg arg1) {
     // main loop's 'program counter'
     uint32_t loop = 0;
     
+    // what the accelerometer alone says
+    Activity shaking;
+    
+    // something going on, keeps the MPU at full rate
+    uint8_t busy;
+    
+    // a new window of features, their vector and what the classifier says
+    uint8_t window;
+    int16_t features[CLS_FEATURES];
+    Activity classified;
+    
+    // sensors read on this loop (libs/acquire.h)
+    uint16_t acquired;
+    
+    // a frame is due (or a redraw the buttons asked for), and whether it
+    // was dark when the light last changed
+    uint8_t frameDue;
+    uint8_t dark = 0;
+    
+    // floors up the barometer has counted, the history has got them all
+    uint16_t floorsUp = 0;
+    
+    // steps of the latest MPU read, and the points they made
+    uint8_t steps;
+    uint16_t points = 0;
+    
+    // last activity written to the log
+    Activity loggedActivity = ACT_IDLE;
+    LogActivity logActivity;
+    
+    // for measuring the boot time
+    uint8_t sampled = 0;
+    
+    // when the next loop starts, the sensors are due on a steady clock
+    uint32_t nextLoop = Clock_getTicks();
+    int32_t wait;
+    
     while(1) {
         
         // These things we do every time...
         
-        // read sensors
-        if (loop % SAMPLE_RATE == 0) {
-            state = ST_READ_SENSORS;
+        // refresh screen, not in the dark (libs/ambient.h); what the
+        // buttons changed is drawn anyway, even if a read comes first
+        frameDue = (loop % FRAME_RATE == 0 && !AMB_state()->dark) || GUI_redrawPending();
+        
+        // out of the pocket, show what happened in it at once
+        if (AMB_state()->dark != dark) {
+            dark = AMB_state()->dark;
+            frameDue |= !dark;
         }
         
-        // refresh screen
-        if (loop % FRAME_RATE == 0) {
+        if (frameDue) {
             state = ST_UPDATE_SCR;
         }
         
+        // read the sensors that are due, before a frame: the FIFO has room
+        // for only a couple of MPU reads (the frame is drawn on the next
+        // loop). The MPU less often in the low tier.
+        acquired = ACQ_run(Clock_getTicks() / (1000 / Clock_tickPeriod));
+        
+        if (acquired & (1 << SENSOR_MPU)) {
+            state = ST_READ_SENSORS;
+        }
+        
+        if (acquired & (1 << SENSOR_BARO)) {
+            VERT_sample(pressure, DET_shakiness() >= DET_params()->idleLimit);
+            
+            if (VERT_state()->floorsUp != floorsUp) {
+                HIST_addFloors(VERT_state()->floorsUp - floorsUp);
+                floorsUp = VERT_state()->floorsUp;
+            }
+            
+#if TRACE_MODE != TRACE_OFF
+            TRACE_pressure(pressure, Clock_getTicks() / (1000 / Clock_tickPeriod));
+#endif
+        }
+        
         // read battery level
         if (loop % 15) {
             readBattery(&batteryLevel);
         }
         
-        // Update scores (BETA) about once per second
-        if (activity == ACT_STAIRS && loop % 20 == 0) {
-            score += 1;
+        // score the steps climbed, to the log about once per second
+        if (points > 0 && loop % HIST_TICK_RATE == 0) {
+            score += points;
+            HIST_addScore(points);
+            logEvent(LOG_SCORE, &score, sizeof(score));
+            points = 0;
+        }
+        
+        // log activity changes, write the log out when a climb ends
+        if (activity != loggedActivity) {
+            loggedActivity = activity;
+            
+            logActivity.uptime = Clock_getTicks() / (1000000 / Clock_tickPeriod);
+            logActivity.score = score;
+            logActivity.activity = activity;
+            logEvent(LOG_ACTIVITY, &logActivity, sizeof(logActivity));
+            
+            if (activity == ACT_IDLE && logOpen) {
+                FLOG_sync();
+            }
+        }
+        
+        // record activity history
+        if (loop % HIST_TICK_RATE == 0) {
+            HIST_tick(activity);
+        }
+        
+        // CPU load window and the energy used in it
+        if (loop % LOAD_UPDATE_RATE == 0) {
+            LOAD_update();
+            ENERGY_update();
+        }
+        
+        // energy report to the server
+        if (loop > 0 && loop % (ENERGY_REPORT_PERIOD * (1000000 / MAIN_TASK_DELAY)) == 0) {
+            ENERGY_dump();
+        }
+        
+#if PROFILING
+        if (loop > 0 && loop % (PROF_DUMP_PERIOD * (1000000 / MAIN_TASK_DELAY)) == 0) {
+            diagDump = 1;
+        }
+#endif
+        
+        if (diagDump) {
+            diagDump = 0;
+            LOAD_dump();
+            ENERGY_dump();
+            VERT_dump();
+            ATT_dump();
+            STEP_dump();
+            SPEC_dump();
+            CLS_dump();
+            TIER_dump();
+            ACQ_dump();
+            AMB_dump();
+            dumpClimate();
+#if PROFILING
+            PROF_dump();
+#endif
         }
         
         // if in 'messages' view, mark all messages as read
@@ -641,10 +1222,20 @@ Void mainTask(UArg arg0, UArg arg1) {
         }
         
         // if it's time to go to sleep, make it happen
-        if (autoSleep && sleepCounter <= 0) {
+        if ((autoSleep && sleepCounter <= 0) || powerOff) {
             state = ST_SLEEP;
         }
         
+        // the game draws its own frames, as often as the display keeps up
+        if (view == VW_GAME) {
+            GAME_frame(Clock_getTicks() * Clock_tickPeriod);
+        }
+        
+        // animations, no one sees them in the dark
+        if (!AMB_state()->dark) {
+            GUI_tick(view);
+        }
+        
         // This draws everything that needs to be updated on every loop
         // GUI_drawDynamics(&view, shakiness); (REMOVED)
         
@@ -655,14 +1246,116 @@ Void mainTask(UArg arg0, UArg arg1) {
                 
             case ST_READ_SENSORS:
             
-                // Read sensor data
-                readSensors(&i2cParams, &i2c, &i2cMPU, &i2cMPUParams, &realTimeData);
+                // in the low tier only see if the device is moved or carried
+                // up or down; the rest waits for full rate
+                if (TIER_state()->tier == TIER_LOW) {
+                    mpu9250_scale(imuSamples[0], realTimeData);
+                    busy = TIER_motion(imuSamples[0]);
+                    if (busy) {
+                        resetAutoSleep();
+                    }
+                    busy |= abs(VERT_state()->speed) >= VERT_START_SPEED;
+                    
+                    if (TIER_update(busy, Clock_getTicks() / (1000 / Clock_tickPeriod)) == TIER_FULL) {
+                        setTier(TIER_FULL, &i2cMPU, &i2cMPUParams);
+                    }
+                    state = frameDue ? ST_UPDATE_SCR : ST_IDLE;
+                    break;
+                }
+                
+                // every sample turns the attitude, may be a step and goes
+                // to the step band features
+                steps = 0;
+                window = 0;
+                for (i = 0; i < imuCount; i++) {
+                    PROF_BEGIN(PROF_ATTITUDE);
+                    ATT_sample(imuSamples[i]);
+                    PROF_END(PROF_ATTITUDE);
+                    
+                    PROF_BEGIN(PROF_STEPS);
+                    steps += STEP_sample(ATT_vertical());
+                    PROF_END(PROF_STEPS);
+                    
+                    PROF_BEGIN(PROF_SPECTRUM);
+                    window |= SPEC_sample(ATT_vertical());
+                    PROF_END(PROF_SPECTRUM);
+                    
+#if TRACE_MODE != TRACE_OFF
+                    TRACE_sample(imuSamples[i], Clock_getTicks() / (1000 / Clock_tickPeriod)
+                        - (imuCount - 1 - i) * (1000 / IMU_RATE));
+#endif
+                }
+                
+                if (imuCount == 0) {
+                    state = frameDue ? ST_UPDATE_SCR : ST_IDLE;
+                    break;
+                }
+                mpu9250_scale(imuSamples[imuCount - 1], realTimeData);
+                
+                if (waking) {
+                    waking = 0;
+                    System_printf("Standby: full rate %u ms after the motion\n",
+                        (Clock_getTicks() - motionTicks) / (1000 / Clock_tickPeriod));
+                    System_flush();
+                }
+                
+                if (!sampled) {
+                    sampled = 1;
+                    System_printf("Boot: first sample at %u ms (%s boot)\n",
+                        Clock_getTicks() / (1000 / Clock_tickPeriod), fastBoot ? "fast" : "full");
+                    System_flush();
+                }
+                
+                // correct the calibration if it has drifted while lying still
+                if (CAL_sample(realTimeData, mpu9250_get_temperature(),
+                        Clock_getTicks() / (1000000 / Clock_tickPeriod))) {
+                    recalibrate(&i2cMPU, &i2cMPUParams);
+                }
                 
-                // Detect steps from 'real-time' data
-                detectStep(&realTimeData);
+                // Detect steps from the acceleration of the samples
+                ATT_linear(linearAccel);
+                PROF_BEGIN(PROF_DETECT);
+                shaking = DET_sample(linearAccel);
+                PROF_END(PROF_DETECT);
                 
-                if (shakiness >= stairsLimit) {
+                // the classifier decides on every window of features, if it
+                // is sure enough; without the barometer, all shaking is
+                // stairs
+                if (window) {
+                    CLS_gather(features);
+                    PROF_BEGIN(PROF_CLASSIFY);
+                    classified = CLS_classify(features);
+                    PROF_END(PROF_CLASSIFY);
+                    
+                    if (VERT_state()->valid && CLS_result()->confidence[classified] >= CLS_MIN_CONFIDENCE) {
+                        activity = classified;
+                    }
+                }
+                if (!VERT_state()->valid) {
+                    activity = shaking;
+                }
+                
+                // a point for each step up (or down) the stairs, two when
+                // climbing briskly
+                if (activity == ACT_STAIRS) {
+                    points += steps * (STEP_state()->cadence >= STEP_BRISK_CADENCE ? 2 : 1);
+                }
+                
+                if (DET_moved()) {
+                    resetAutoSleep();
+                }
+                
+                // drop to the low tier when nothing has gone on for a while
+                busy = DET_shakiness() >= DET_params()->idleLimit || activity != ACT_IDLE
+                    || abs(VERT_state()->speed) >= VERT_START_SPEED;
+                if (TIER_update(busy, Clock_getTicks() / (1000 / Clock_tickPeriod)) == TIER_LOW) {
+                    setTier(TIER_LOW, &i2cMPU, &i2cMPUParams);
+                }
+                
+                if (DET_shakiness() >= DET_params()->stairsLimit) {
             	    state = ST_SEND_MSG;    // send an inspirational message
+            	} else if (frameDue) {
+            	    state = ST_UPDATE_SCR;  // the frame that was due
             	} else {
             	    state = ST_IDLE;
             	}
@@ -685,15 +1378,22 @@ Void mainTask(UArg arg0, UArg arg1) {
             case ST_UPDATE_SCR:
             
                 // Update screen
+                PROF_BEGIN(PROF_UPDATE_SCREEN);
                 GUI_updateScreen(&activity, &view, batteryLevel, score, msgs, msgCount, &newMsg);
+                PROF_END(PROF_UPDATE_SCREEN);
                 
                 state = ST_IDLE;
                 break;
                 
             case ST_SLEEP:
                 
-                // Go to sleep
-                shutDown();
+                // Go to sleep: off when asked, else until moved
+                if (powerOff) {
+                    shutDown();
+                }
+                standBy(&i2cMPU, &i2cMPUParams);
+                state = ST_IDLE;
+                break;
                 
         }
         
@@ -708,8 +1408,16 @@ Void mainTask(UArg arg0, UArg arg1) {
             --sleepCounter;
         }
         
-        // give time for other tasks...
-        Task_sleep((UInt)arg0);
+        // give time for other tasks, until the next loop. After a long
+        // one (standby, a flash erase) start over from now rather than
+        // catch up.
+        nextLoop += (UInt)arg0;
+        wait = (int32_t)(nextLoop - Clock_getTicks());
+        if (wait <= 0 || wait > (int32_t)(UInt)arg0) {
+            nextLoop = Clock_getTicks() + (UInt)arg0;
+            wait = (UInt)arg0;
+        }
+        Task_sleep(wait);
         ++loop;
     }
     
@@ -731,24 +1439,22 @@ Void commTask(UArg arg0, UArg arg1) {
 		System_abort("Wireless receive mode failed");
 	}
 
-    char receivedMsg[MAX_TEXT_LEN];
+    char *msg;
 
     while (1) {
         
-        // No System_printf() here, apparently... It makes the whole thing stagger.
+        // sleep until Radio_IRQ() has something for us
+    	WaitRXFlag(BIOS_WAIT_FOREVER);
         
     	// if there are messages waiting
-        if (GetRXFlag()) {
-
-            // clear buffer from old stuff
-            memset(msgs[msgCount], 0, 8);
-            
-            // read buffer to variable payload
-            Receive6LoWPAN(&senderAddr, msgs[msgCount], MAX_TEXT_LEN);
-            
-            if (msgCount < MSGS_MAX_COUNT) {
-                ++msgCount;
-            }
+        while (GetRXFlag()) {
+
+            // read buffer to a free slot
+            msg = newMsgSlot();
+            PROF_BEGIN(PROF_RECEIVE);
+            Receive6LoWPAN(&senderAddr, msg, MAX_TEXT_LEN);
+            PROF_END(PROF_RECEIVE);
+            logEvent(LOG_MSG, msg, MAX_TEXT_LEN);
             
             // set the 'unread messages' flag on
             newMsg = 1;
@@ -775,7 +1481,14 @@ int main(void) {
     // Initialize board
     Board_initGeneral();
     Board_initI2C();
+    Board_initSPI();
     Init6LoWPAN();
+    DIAG_init();
+    LOAD_init();
+    ENERGY_init();
+#if PROFILING
+    PROF_init();
+#endif
     
     
     /********************
@@ -816,6 +1529,16 @@ int main(void) {
     if (hMpuPin == NULL) {
     	System_abort("MPU pin open failed!");
     }
+    ENERGY_on(EN_MPU);      // the pin starts high
+    
+    // MPU interrupt, opened for standby
+    Semaphore_Params motionSemParams;
+    Semaphore_Params_init(&motionSemParams);
+    motionSemParams.mode = Semaphore_Mode_BINARY;
+    hMotionSem = Semaphore_create(0, &motionSemParams, NULL);
+    if (hMotionSem == NULL) {
+        System_abort("Motion semaphore create failed!");
+    }
     
     
     /******************
@@ -834,6 +1557,7 @@ int main(void) {
     if (hMainTask == NULL) {
     	System_abort("Error creating mainTask\n");
     }
+    LOAD_addTask(hMainTask, "main");
     
     // Init Communication Task
     
@@ -846,6 +1570,7 @@ int main(void) {
     if (hCommTask == NULL) {
         System_abort("Error creating commTask\n");
     }
+    LOAD_addTask(hCommTask, "comm");
     
     
     /************
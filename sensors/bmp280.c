@@ -27,6 +27,8 @@ int16_t  dig_P8;
 int16_t  dig_P9;
 int32_t	 t_fine = 0;
 
+static uint8_t fast_pres = 0;  // 32 bit pressure compensation
+
 // i2c
 I2C_Transaction i2cTransaction;
 char txBuffer[4];
@@ -59,23 +61,21 @@ void bmp280_set_trimming(char *v) {
 	dig_P9 = (v[23] << 8) | v[22];
 }
 
-double bmp280_convert_temp(uint32_t adc_T) {
+// the datasheet's integer formulas; temperature first, it sets t_fine
+int32_t bmp280_compensate_temp(int32_t adc_T) {
 
-	double ret = 0.0;
 	int32_t var1, var2;
 
 	var1 = ((((adc_T>>3) - ((int32_t)dig_T1 <<1))) * ((int32_t)dig_T2)) >> 11;
 	var2 = (((((adc_T>>4) - ((int32_t)dig_T1)) * ((adc_T>>4) - ((int32_t)dig_T1))) >> 12) * ((int32_t)dig_T3)) >> 14;
 	t_fine = var1 + var2;
 
-	ret = (double)((t_fine * 5 + 128) >> 8);
-	ret /= 100.0;
-	return ret;
+	return (t_fine * 5 + 128) >> 8;
 }
 
-double bmp280_convert_pres(uint32_t adc_P) {
+// 64 bit: Q24.8 Pa, 0.004 Pa resolution
+uint32_t bmp280_compensate_pres(int32_t adc_P) {
 
-	double ret = 0.0;
 	int64_t var1, var2, p;
 
 	var1 = ((int64_t)t_fine) - 128000;
@@ -85,23 +85,61 @@ double bmp280_convert_pres(uint32_t adc_P) {
 	var1 = ((var1 * var1 * (int64_t)dig_P3)>>8) + ((var1 * (int64_t)dig_P2)<<12);
 	var1 = (((((int64_t)1)<<47)+var1))*((int64_t)dig_P1)>>33;
 	if (var1 == 0) {
-	    return 0.0;  // avoid exception caused by division by zero
+	    return 0;  // avoid exception caused by division by zero
 	}
 	p = 1048576 - adc_P;
 	p = (((p<<31) - var2)*3125) / var1;
 	var1 = (((int64_t)dig_P9) * (p>>13) * (p>>13)) >> 25;
 	var2 = (((int64_t)dig_P8) * p) >> 19;
 
-	ret = ((p + var1 + var2) >> 8) + (((int64_t)dig_P7)<<4);
-	ret /= 256.0;
-	return ret;
+	return (uint32_t)(((p + var1 + var2) >> 8) + (((int64_t)dig_P7)<<4));
+}
+
+// 32 bit: 1 Pa resolution, no 64 bit multiplications or division
+uint32_t bmp280_compensate_pres32(int32_t adc_P) {
+
+	int32_t var1, var2;
+	uint32_t p;
+
+	var1 = (((int32_t)t_fine)>>1) - (int32_t)64000;
+	var2 = (((var1>>2) * (var1>>2)) >> 11 ) * ((int32_t)dig_P6);
+	var2 = var2 + ((var1*((int32_t)dig_P5))<<1);
+	var2 = (var2>>2)+(((int32_t)dig_P4)<<16);
+	var1 = (((dig_P3 * (((var1>>2) * (var1>>2)) >> 13 )) >> 3) + ((((int32_t)dig_P2) * var1)>>1))>>18;
+	var1 = ((((32768+var1))*((int32_t)dig_P1))>>15);
+	if (var1 == 0) {
+	    return 0;  // avoid exception caused by division by zero
+	}
+	p = (((uint32_t)(((int32_t)1048576)-adc_P)-(var2>>12)))*3125;
+	if (p < 0x80000000) {
+		p = (p << 1) / ((uint32_t)var1);
+	} else {
+		p = (p / (uint32_t)var1) * 2;
+	}
+	var1 = (((int32_t)dig_P9) * ((int32_t)(((p>>3) * (p>>3))>>13)))>>12;
+	var2 = (((int32_t)(p>>2)) * ((int32_t)dig_P8))>>13;
+
+	return (uint32_t)((int32_t)p + ((var1 + var2 + dig_P7) >> 4));
 }
 
-void bmp280_setup(I2C_Handle *i2c) {
+double bmp280_convert_temp(uint32_t adc_T) {
+
+	// signed, or a negative dig_T3 term is shifted as a huge unsigned value
+	return bmp280_compensate_temp((int32_t)adc_T) / 100.0;
+}
+
+double bmp280_convert_pres(uint32_t adc_P) {
+
+	return bmp280_compensate_pres((int32_t)adc_P) / 256.0;
+}
+
+void bmp280_setup(I2C_Handle *i2c, const bmp280_config *config) {
+
+    fast_pres = config->fast;
 
     i2cTransaction.slaveAddress = Board_BMP280_ADDR;
     txBuffer[0] = BMP280_REG_CONFIG;
-    txBuffer[1] = 0x40;
+    txBuffer[1] = (config->standby << 5) | (config->filter << 2);
     i2cTransaction.writeBuf = txBuffer;
     i2cTransaction.writeCount = 2;
     i2cTransaction.readBuf = NULL;
@@ -115,9 +153,10 @@ void bmp280_setup(I2C_Handle *i2c) {
     }
     System_flush();
 
+    // normal mode
     i2cTransaction.slaveAddress = Board_BMP280_ADDR;
     txBuffer[0] = BMP280_REG_CTRL_MEAS;
-    txBuffer[1] = 0x2F;
+    txBuffer[1] = (config->osrs_t << 5) | (config->osrs_p << 2) | 0x03;
     i2cTransaction.writeBuf = txBuffer;
     i2cTransaction.writeCount = 2;
     i2cTransaction.readBuf = NULL;
@@ -149,24 +188,12 @@ void bmp280_setup(I2C_Handle *i2c) {
     bmp280_set_trimming(rxBuffer);
 }
 
-void bmp280_get_data(I2C_Handle *i2c, double *pres, double *temp) {
+// raw pressure and temperature, 0 if not read or nothing measured yet
+static uint8_t bmp280_get_raw(I2C_Handle *i2c, int32_t *presRaw, int32_t *tempRaw) {
 
 	uint8_t txBuffer[1];
 	uint8_t rxBuffer[6];
-	
-	uint32_t presRaw;
-	uint32_t tempRaw;
-	
-	char output[35];
-
-	/* JTKJ: FILL OUT THIS I2C DATA STRUCTURE TO ASK DATA
-	txBuffer[0] = ...
-    i2cTransaction.slaveAddress = ...
-    i2cTransaction.writeBuf = ...
-    i2cTransaction.writeCount = ...
-    i2cTransaction.readBuf = ...
-    i2cTransaction.readCount = ...
-	*/
+
 	txBuffer[0] = BMP280_REG_PRESS_MSB;
     i2cTransaction.slaveAddress = Board_BMP280_ADDR;
     i2cTransaction.writeBuf = txBuffer;
@@ -174,28 +201,44 @@ void bmp280_get_data(I2C_Handle *i2c, double *pres, double *temp) {
     i2cTransaction.readBuf = rxBuffer;
     i2cTransaction.readCount = 6;
 
-    if (I2C_transfer(*i2c, &i2cTransaction)) {
-
-        // JTKJ
-		// 1) GET THE AIR PRESSURE AND TEMPERATURE VALUES FROM rxBuffer BY USING BIT WISE OPERATIONS (AS IN THE EXERCISES)
-		// 2) USE FUNCTION bmp280_convert_temp() TO CONVERT RAW TEMPERATURE VALUE. THIS ALSO STARTS TEMPERATURE COMPENSATION, WHICH IS NEEDED BY PRESSURE CONVERSION
-		// 3) USE FUNCTION bmp280_convert_pres() TO CONVERT RAW PRESSURE VALUE TO PASCALS
-		
-		// Luetaan 6 tavua (6 * 8 bittiä):
-		presRaw = combine_bytes(rxBuffer[0], rxBuffer[1], rxBuffer[2]);
-		tempRaw = combine_bytes(rxBuffer[3], rxBuffer[4], rxBuffer[5]);
-		
-		*pres = bmp280_convert_pres(presRaw) * 0.01;
-		*temp = bmp280_convert_temp(tempRaw);
-		
-		// print some data to console
-		// sprintf(output, "Temp: %f F, Pres: %f hPa\n", *temp, *pres);
-		// System_printf(output);
-		// System_flush();
-
-    } else {
+    if (!I2C_transfer(*i2c, &i2cTransaction)) {
 
         System_printf("BMP280: Data read failed!\n");
 		System_flush();
+		return 0;
     }
+
+	// Luetaan 6 tavua (6 * 8 bittiä):
+	*presRaw = combine_bytes(rxBuffer[0], rxBuffer[1], rxBuffer[2]);
+	*tempRaw = combine_bytes(rxBuffer[3], rxBuffer[4], rxBuffer[5]);
+
+	// reset value, nothing measured yet
+	return (*presRaw != 0x80000);
+}
+
+// pressure in hPa, temperature in C
+void bmp280_get_data(I2C_Handle *i2c, double *pres, double *temp) {
+
+	int32_t presRaw;
+	int32_t tempRaw;
+
+	if (bmp280_get_raw(i2c, &presRaw, &tempRaw)) {
+
+		// temperature first, the pressure compensation needs its t_fine
+		*temp = bmp280_convert_temp(tempRaw);
+		*pres = bmp280_convert_pres(presRaw) * 0.01;
+	}
+}
+
+// pressure in Pa * 256, temperature in 0.01 C
+void bmp280_get_data_fixed(I2C_Handle *i2c, uint32_t *pres, int32_t *temp) {
+
+	int32_t presRaw;
+	int32_t tempRaw;
+
+	if (bmp280_get_raw(i2c, &presRaw, &tempRaw)) {
+
+		*temp = bmp280_compensate_temp(tempRaw);
+		*pres = fast_pres ? bmp280_compensate_pres32(presRaw) << 8 : bmp280_compensate_pres(presRaw);
+	}
 }
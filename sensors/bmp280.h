@@ -10,6 +10,7 @@
 #ifndef BMP280_H_
 #define BMP280_H_
 
+#include <inttypes.h>
 #include <ti/drivers/I2C.h>
 
 #define BMP280_REG_CTRL_MEAS	0xF4
@@ -30,7 +31,49 @@
 #define BMP280_REG_P9			0x9E
 */
 
-void bmp280_setup(I2C_Handle *i2c);
+// oversampling (osrs_p, osrs_t)
+#define BMP280_OSRS_SKIP		0
+#define BMP280_OSRS_X1			1
+#define BMP280_OSRS_X2			2
+#define BMP280_OSRS_X4			3
+#define BMP280_OSRS_X8			4
+#define BMP280_OSRS_X16			5
+
+// IIR filter coefficient
+#define BMP280_FILTER_OFF		0
+#define BMP280_FILTER_2			1
+#define BMP280_FILTER_4			2
+#define BMP280_FILTER_8			3
+#define BMP280_FILTER_16		4
+
+// standby time between measurements (normal mode)
+#define BMP280_STANDBY_0_5_MS	0
+#define BMP280_STANDBY_62_5_MS	1
+#define BMP280_STANDBY_125_MS	2
+#define BMP280_STANDBY_250_MS	3
+#define BMP280_STANDBY_500_MS	4
+#define BMP280_STANDBY_1000_MS	5
+#define BMP280_STANDBY_2000_MS	6
+#define BMP280_STANDBY_4000_MS	7
+
+typedef struct {
+	uint8_t osrs_p;         // BMP280_OSRS_*
+	uint8_t osrs_t;
+	uint8_t filter;         // BMP280_FILTER_*
+	uint8_t standby;        // BMP280_STANDBY_*
+	uint8_t fast;           // 32 bit pressure compensation: quicker, 1 Pa resolution
+} bmp280_config;
+
+void bmp280_setup(I2C_Handle *i2c, const bmp280_config *config);
 void bmp280_get_data(I2C_Handle *i2c, double *pres, double *temp);
+void bmp280_get_data_fixed(I2C_Handle *i2c, uint32_t *pres, int32_t *temp);
+
+// compensation of the raw values, bmp280_compensate_temp() first
+void bmp280_set_trimming(char *v);
+int32_t bmp280_compensate_temp(int32_t adc_T);      // 0.01 C
+uint32_t bmp280_compensate_pres(int32_t adc_P);     // Pa * 256, 64 bit
+uint32_t bmp280_compensate_pres32(int32_t adc_P);   // Pa, 32 bit
+double bmp280_convert_temp(uint32_t adc_T);         // C
+double bmp280_convert_pres(uint32_t adc_P);         // Pa
 
 #endif /* BMP280_H_ */
@@ -8,7 +8,6 @@
  */
 
 #include <xdc/runtime/System.h>
-#include <ti/sysbios/knl/Task.h>
 
 #include "Board.h"
 #include "hdc1000.h"
@@ -38,9 +37,10 @@ void hdc1000_setup(I2C_Handle *i2c) {
 
 }
 
-void hdc1000_get_data(I2C_Handle *i2c, double *temp, double *hum) {
+// start a conversion: temperature, then humidity (sequential mode),
+// ready after HDC1000_CONVERSION_MS
+uint8_t hdc1000_start(I2C_Handle *i2c) {
 
-	/* Start temperature measurement */
 	i2cTransaction.slaveAddress = Board_HDC1000_ADDR;
 	txBuffer[0] = HDC1000_REG_TEMP;
 	i2cTransaction.writeBuf = txBuffer;
@@ -50,66 +50,43 @@ void hdc1000_get_data(I2C_Handle *i2c, double *temp, double *hum) {
 
 	if (!I2C_transfer(*i2c, &i2cTransaction)) {
 
-		System_printf("HDC1000: Trigger temp meas failed!\n");
+		System_printf("HDC1000: Trigger meas failed!\n");
 		System_flush();
+		return 0;
 	}
 
-	Task_sleep(10000);
-
-	/* FILL OUT THIS I2C DATA STRUCTURE TO ASK TEMPERATURE DATA
-    i2cTransaction.slaveAddress = ...
-    i2cTransaction.writeBuf = ...
-    i2cTransaction.writeCount = ...
-    i2cTransaction.readBuf = ...
-    i2cTransaction.readCount = ...
-	*/
-
-	if (I2C_transfer(*i2c, &i2cTransaction)) {
-
-		// JTKJ: HERE YOU GET THE DATA VALUE FROM RXBUFFER
-		// ACCORDING TO DATASHEET
-
-	} else {
+	return 1;
+}
 
-		System_printf("HDC1000: Temp data read failed!\n");
-		System_flush();
-	}
+// both results of the conversion, in one read without a pointer write:
+// temperature in 0.01 C, humidity in 0.01 %RH. The HDC1000 doesn't
+// acknowledge the read before the conversion is done.
+uint8_t hdc1000_get_data_fixed(I2C_Handle *i2c, int16_t *temp, uint16_t *hum) {
 
-	Task_sleep(10000);
+	uint8_t rxBuffer[4];
+	uint16_t tempRaw;
+	uint16_t humRaw;
 
-	/* Start humidity measurement */
 	i2cTransaction.slaveAddress = Board_HDC1000_ADDR;
-	txBuffer[0] = HDC1000_REG_HUM;
-	i2cTransaction.writeBuf = txBuffer;
-	i2cTransaction.writeCount = 1;
-	i2cTransaction.readBuf = NULL;
-	i2cTransaction.readCount = 0;
+	i2cTransaction.writeBuf = NULL;
+	i2cTransaction.writeCount = 0;
+	i2cTransaction.readBuf = rxBuffer;
+	i2cTransaction.readCount = 4;
 
 	if (!I2C_transfer(*i2c, &i2cTransaction)) {
 
-		System_printf("HDC1000: Trigger hum meas failed!\n");
+		System_printf("HDC1000: Data read failed!\n");
 		System_flush();
+		return 0;
 	}
 
-	Task_sleep(10000);
-
-	/* JTKJ: FILL OUT THIS DATA STRUCTURE TO ASK HUMIDITY DATA
-	txBuffer[0] = ...
-    i2cTransaction.slaveAddress = ...
-    i2cTransaction.writeBuf = ...
-    i2cTransaction.writeCount = ...
-    i2cTransaction.readBuf = ...
-    i2cTransaction.readCount = ...
-	*/
+	tempRaw = (rxBuffer[0] << 8) | rxBuffer[1];
+	humRaw = (rxBuffer[2] << 8) | rxBuffer[3];
 
-	if (I2C_transfer(*i2c, &i2cTransaction)) {
+	// T = raw / 2^16 * 165 C - 40 C, RH = raw / 2^16 * 100 %, s.14
+	*temp = (int16_t)(((uint32_t)tempRaw * 16500) >> 16) - 4000;
+	*hum = ((uint32_t)humRaw * 10000) >> 16;
 
-		// JTKJ: HERE YOU GET THE HUMIDITY VALUE FROM RXBUFFER AS BYTES
-
-	} else {
-
-		System_printf("HDC1000: Hum data read failed!\n");
-		System_flush();
-	}
+	return 1;
 }
 
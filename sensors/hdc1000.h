@@ -16,7 +16,12 @@
 #define HDC1000_REG_HUM			0x1
 #define HDC1000_REG_CONFIG		0x2
 
+#define HDC1000_CONVERSION_MS	15		// ms, both at 14 bit: 6.35 + 6.5 ms, s.5
+
 void hdc1000_setup(I2C_Handle *i2c);
-void hdc1000_get_data(I2C_Handle *i2c, double *temp, double *hum);
+
+// non-blocking: start, then read HDC1000_CONVERSION_MS later
+uint8_t hdc1000_start(I2C_Handle *i2c);
+uint8_t hdc1000_get_data_fixed(I2C_Handle *i2c, int16_t *temp, uint16_t *hum);	// 0.01 C, 0.01 %RH
 
 #endif /* HDC1000_H_ */
@@ -11,6 +11,7 @@
 
 #include <inttypes.h>
 #include <math.h>
+#include <string.h>
 
 #include <xdc/runtime/System.h>
 #include <ti/sysbios/knl/Task.h>
@@ -33,12 +34,17 @@
 #define GYRO_CONFIG      0x1B
 #define ACCEL_CONFIG     0x1C
 #define ACCEL_CONFIG2    0x1D
+#define LP_ACCEL_ODR     0x1E
+#define WOM_THR          0x1F
 #define FIFO_EN          0x23
 #define I2C_MST_CTRL     0x24
 #define INT_PIN_CFG      0x37
 #define INT_ENABLE       0x38
+#define INT_STATUS       0x3A
 #define ACCEL_XOUT_H     0x3B
+#define TEMP_OUT_H       0x41
 #define GYRO_XOUT_H      0x43
+#define MOT_DETECT_CTRL  0x69
 #define USER_CTRL        0x6A  // Bit 7 enable DMP, bit 3 reset DMP
 #define PWR_MGMT_1       0x6B // Device defaults to the SLEEP mode
 #define PWR_MGMT_2       0x6C
@@ -74,6 +80,8 @@ enum Gscale {
 
 // Prototypes
 void initMPU9250();
+void configMPU9250();
+void writeGyroOffsets(const float *bias);
 void accelgyrocalMPU9250(float *dest1, float *dest2);
 void MPU9250SelfTest(float * destination);
 
@@ -83,6 +91,9 @@ uint8_t Ascale = AFS_8G;
 float aRes, gRes;      // scale resolutions per LSB for the sensors
 float gyroBias[3] = {0, 0, 0}, accelBias[3] = {0, 0, 0};      // Bias corrections for gyro and accelerometer
 float SelfTest[6];
+float temperature;     // C, from the latest read
+int16_t rawSample[6];  // ax, ay, az, gx, gy, gz from the latest read
+uint8_t fifoData[12 * 10]; // FIFO_R_W reads, 10 samples at a time
 
 I2C_Handle i2c;
 
@@ -195,10 +206,102 @@ void mpu9250_setup(I2C_Handle *i2c_orig) {
 	initMPU9250();
 	delay(100);
 
+	// temperature of the calibration, the biases drift with it
+	uint8_t rawData[2];
+	readByte(TEMP_OUT_H, 2, rawData);
+	temperature = (float)(int16_t)((rawData[0] << 8) | rawData[1]) / 333.87 + 21.0;
+
 	System_printf("MPU9250: Setup OK\n");
 	System_flush();
 }
 
+// Setup with an earlier calibration: no self test, no calibration and only
+// the gyro start-up time to wait. The sensor must have been powered up.
+void mpu9250_setup_fast(I2C_Handle *i2c_orig, const mpu9250_calibration *cal) {
+
+	uint8_t ii;
+
+	i2c = *i2c_orig;
+
+	getAres();
+	getGres();
+
+	for (ii = 0; ii < 6; ii++) {
+		SelfTest[ii] = cal->self_test[ii];
+	}
+	temperature = cal->temperature;
+
+	writeByte(PWR_MGMT_1, 0x01);  // PLL clock, out of sleep
+	writeByte(PWR_MGMT_2, 0x00);  // all sensors on
+
+	mpu9250_set_bias(cal->gyro_bias, cal->accel_bias);
+	configMPU9250();
+
+	delay(35); // gyro start-up time (datasheet)
+}
+
+// Results of the last calibration (timestamp not set)
+void mpu9250_get_calibration(mpu9250_calibration *cal) {
+
+	uint8_t ii;
+
+	for (ii = 0; ii < 3; ii++) {
+		cal->gyro_bias[ii] = gyroBias[ii];
+		cal->accel_bias[ii] = accelBias[ii];
+	}
+	for (ii = 0; ii < 6; ii++) {
+		cal->self_test[ii] = SelfTest[ii];
+	}
+	cal->temperature = temperature;
+	cal->timestamp = 0;
+}
+
+// Change the biases, e.g. after drift. Gyro bias goes to the hardware offset
+// registers, so the I2C must be open.
+void mpu9250_set_bias(const float *gyro_bias, const float *accel_bias) {
+
+	uint8_t ii;
+
+	for (ii = 0; ii < 3; ii++) {
+		gyroBias[ii] = gyro_bias[ii];
+		accelBias[ii] = accel_bias[ii];
+	}
+
+	writeGyroOffsets(gyroBias);
+}
+
+// Temperature (C) from the latest mpu9250_get_data()
+float mpu9250_get_temperature() {
+
+	return temperature;
+}
+
+// Unscaled ax, ay, az, gx, gy, gz from the latest mpu9250_get_data()
+void mpu9250_get_raw(int16_t *raw) {
+
+	memcpy(raw, rawSample, sizeof(rawSample));
+}
+
+// Scales of the raw values: g per LSB and dps per LSB
+void mpu9250_get_scale(float *a_res, float *g_res) {
+
+	*a_res = aRes;
+	*g_res = gRes;
+}
+
+// Push gyro biases (dps) to the hardware offset registers
+void writeGyroOffsets(const float *bias) {
+
+	int32_t offset;
+	uint8_t ii;
+
+	for (ii = 0; ii < 3; ii++) {
+		offset = -lroundf(bias[ii] * 131.0f) / 4; // 32.9 LSB per deg/s, biases are additive
+		writeByte(XG_OFFSET_H + 2*ii, (offset >> 8) & 0xFF);
+		writeByte(XG_OFFSET_L + 2*ii, offset & 0xFF);
+	}
+}
+
 void initMPU9250() {
 
 	// wake up device
@@ -209,6 +312,13 @@ void initMPU9250() {
 	writeByte(PWR_MGMT_1, 0x01);  // Auto select clock source to be PLL gyroscope reference if ready else
 	delay(200);
 
+	configMPU9250();
+	delay(100);
+}
+
+// Sample rate, filters, full scales and interrupts
+void configMPU9250() {
+
 	// Configure Gyro and Thermometer
 	// Disable FSYNC and set thermometer and gyro bandwidth to 41 and 42 Hz, respectively;
 	// minimum delay time for this setting is 5.9 ms, which means sensor fusion update rates cannot
@@ -257,7 +367,6 @@ void initMPU9250() {
 	//   writeByte( INT_PIN_CFG, 0x22);
 	writeByte( INT_PIN_CFG, 0x12);  // INT is 50 microsecond pulse and any read to clear
 	writeByte( INT_ENABLE, 0x01);  // Enable data ready (bit 0) interrupt
-	delay(100);
 }
 
 
@@ -512,6 +621,15 @@ void mpu9250_get_data(I2C_Handle *i2c, float *ax, float *ay, float *az, float *g
 	data[5] = (rawData[10] << 8) | rawData[11];
 	data[6] = (rawData[12] << 8) | rawData[13];
 
+	temperature = (float)data[3] / 333.87 + 21.0;
+
+	rawSample[0] = data[0];
+	rawSample[1] = data[1];
+	rawSample[2] = data[2];
+	rawSample[3] = data[4];
+	rawSample[4] = data[5];
+	rawSample[5] = data[6];
+
 	/* Now we'll calculate the accleration value into actual G's */
 	*ax = (float)data[0]*aRes - accelBias[0];
 	*ay = (float)data[1]*aRes - accelBias[1];
@@ -524,3 +642,148 @@ void mpu9250_get_data(I2C_Handle *i2c, float *ax, float *ay, float *az, float *g
 	*gz = (float)data[6]*gRes;
 }
 
+// Start collecting accel and gyro samples (12 bytes, at the sample rate) to
+// the FIFO, so that none are lost between the reads
+void mpu9250_fifo_start(I2C_Handle *i2c_orig) {
+
+	i2c = *i2c_orig;
+
+	writeByte(FIFO_EN, 0x00);
+	writeByte(USER_CTRL, 0x44);  // enable and reset the FIFO
+	writeByte(FIFO_EN, 0x78);    // accel xyz, gyro xyz
+}
+
+// Read at most @max samples (ax, ay, az, gx, gy, gz, unscaled) from the FIFO,
+// oldest first. Updates the temperature and the latest raw sample. After an
+// overflow the samples are not aligned any more: the FIFO is reset and
+// nothing is returned.
+uint8_t mpu9250_get_fifo(I2C_Handle *i2c_orig, int16_t (*raw)[6], uint8_t max) {
+
+	uint8_t rawData[2];
+	uint8_t status;
+	uint16_t count;
+	uint8_t chunk, n, ii, jj;
+
+	i2c = *i2c_orig;
+
+	// first, any read clears the status
+	readByte(INT_STATUS, 1, &status);
+	if (status & 0x10) {
+		writeByte(USER_CTRL, 0x44);
+		System_printf("MPU9250: FIFO overflow\n");
+		System_flush();
+		return 0;
+	}
+
+	readByte(TEMP_OUT_H, 2, rawData);
+	temperature = (float)(int16_t)((rawData[0] << 8) | rawData[1]) / 333.87 + 21.0;
+
+	readByte(FIFO_COUNTH, 2, rawData);
+	count = (((uint16_t)rawData[0] << 8) | rawData[1]) / 12;
+	if (count > max) {
+		count = max;
+	}
+
+	for (n = 0; n < count; n += chunk) {
+		chunk = count - n;
+		if (chunk > sizeof(fifoData) / 12) {
+			chunk = sizeof(fifoData) / 12;
+		}
+		readByte(FIFO_R_W, chunk * 12, fifoData);
+
+		for (ii = 0; ii < chunk; ii++) {
+			for (jj = 0; jj < 6; jj++) {
+				raw[n + ii][jj] = (int16_t)((fifoData[12*ii + 2*jj] << 8) | fifoData[12*ii + 2*jj + 1]);
+			}
+		}
+	}
+
+	if (count > 0) {
+		memcpy(rawSample, raw[count - 1], sizeof(rawSample));
+	}
+
+	return count;
+}
+
+// Low power accelerometer only mode: the gyro in standby, the FIFO stopped
+// and the accelerometer waking up at @odr (LP_ACCEL_ODR code, 0.24 Hz << odr)
+// to take a sample. Read them with mpu9250_get_accel().
+void mpu9250_low_power(I2C_Handle *i2c_orig, uint8_t odr) {
+
+	i2c = *i2c_orig;
+
+	writeByte(FIFO_EN, 0x00);
+	writeByte(USER_CTRL, 0x00);
+	writeByte(PWR_MGMT_2, 0x07);     // gyro xyz in standby
+	writeByte(ACCEL_CONFIG2, 0x09);  // accel_fchoice_b = 1, A_DLPF_CFG = 1, as the cycle mode wants
+	writeByte(LP_ACCEL_ODR, odr & 0x0F);
+	writeByte(PWR_MGMT_1, 0x21);     // CYCLE, PLL clock
+}
+
+// Back from the low power mode: accel and gyro at the sample rate, the FIFO
+// restarted once the gyro has started up
+void mpu9250_full_rate(I2C_Handle *i2c_orig) {
+
+	i2c = *i2c_orig;
+
+	writeByte(PWR_MGMT_1, 0x01);
+	writeByte(PWR_MGMT_2, 0x00);
+	writeByte(ACCEL_CONFIG2, 0x03);  // 1 kHz, 41 Hz bandwidth like configMPU9250()
+	writeByte(MOT_DETECT_CTRL, 0x00);
+	writeByte(INT_ENABLE, 0x01);     // data ready, like configMPU9250()
+	delay(35);                       // gyro start-up time
+
+	mpu9250_fifo_start(i2c_orig);
+}
+
+// Wake on motion: the low power accelerometer cycle at @odr, and an
+// interrupt (a pulse on INT) when any axis changes more than @mg from the
+// previous sample. The threshold is in 4 mg steps, up to 1020 mg.
+// mpu9250_full_rate() turns it off.
+void mpu9250_wake_on_motion(I2C_Handle *i2c_orig, uint16_t mg, uint8_t odr) {
+
+	uint8_t status;
+
+	i2c = *i2c_orig;
+
+	writeByte(FIFO_EN, 0x00);
+	writeByte(USER_CTRL, 0x00);
+	writeByte(PWR_MGMT_1, 0x01);     // out of the cycle mode while configuring
+	writeByte(PWR_MGMT_2, 0x07);     // gyro xyz in standby
+	writeByte(ACCEL_CONFIG2, 0x09);  // accel_fchoice_b = 1, A_DLPF_CFG = 1
+	writeByte(INT_ENABLE, 0x40);     // wake on motion only
+	writeByte(MOT_DETECT_CTRL, 0xC0); // ACCEL_INTEL_EN, compare with the previous sample
+	writeByte(WOM_THR, mg >= 1020 ? 0xFF : mg / 4);
+	writeByte(LP_ACCEL_ODR, odr & 0x0F);
+	readByte(INT_STATUS, 1, &status); // nothing pending
+	writeByte(PWR_MGMT_1, 0x21);     // CYCLE
+}
+
+// Read the latest accelerometer sample (ax, ay, az, unscaled), in the low
+// power mode. The gyro of the latest raw sample reads zero.
+void mpu9250_get_accel(I2C_Handle *i2c_orig, int16_t *raw) {
+
+	uint8_t rawData[6];
+	uint8_t ii;
+
+	i2c = *i2c_orig;
+
+	readByte(ACCEL_XOUT_H, 6, rawData);
+
+	for (ii = 0; ii < 3; ii++) {
+		raw[ii] = (int16_t)((rawData[2*ii] << 8) | rawData[2*ii + 1]);
+		rawSample[ii] = raw[ii];
+		rawSample[ii + 3] = 0;
+	}
+}
+
+// Scale a raw sample like mpu9250_get_data(): g with the bias removed, dps
+void mpu9250_scale(const int16_t *raw, float *values) {
+
+	uint8_t ii;
+
+	for (ii = 0; ii < 3; ii++) {
+		values[ii] = (float)raw[ii]*aRes - accelBias[ii];
+		values[ii + 3] = (float)raw[ii + 3]*gRes;
+	}
+}
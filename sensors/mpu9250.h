@@ -12,9 +12,32 @@
 #ifndef MPU9250_H_
 #define MPU9250_H_
 
+#include <inttypes.h>
 #include <ti/drivers/I2C.h>
 
+// Results of the self test and calibration
+typedef struct {
+	float gyro_bias[3];     // dps
+	float accel_bias[3];    // g
+	float self_test[6];     // accel xyz, gyro xyz: % deviation from factory trim
+	float temperature;      // C, when calibrated
+	uint32_t timestamp;     // set by the user
+} mpu9250_calibration;
+
 void mpu9250_setup(I2C_Handle *i2c);
+void mpu9250_setup_fast(I2C_Handle *i2c, const mpu9250_calibration *cal);
+void mpu9250_get_calibration(mpu9250_calibration *cal);
+void mpu9250_set_bias(const float *gyro_bias, const float *accel_bias);
+float mpu9250_get_temperature();
+void mpu9250_get_raw(int16_t *raw);
+void mpu9250_get_scale(float *a_res, float *g_res);
 void mpu9250_get_data(I2C_Handle *i2c, float *ax, float *ay, float *az, float *gx, float *gy, float *gz);
+void mpu9250_fifo_start(I2C_Handle *i2c);
+uint8_t mpu9250_get_fifo(I2C_Handle *i2c, int16_t (*raw)[6], uint8_t max);
+void mpu9250_low_power(I2C_Handle *i2c, uint8_t odr);
+void mpu9250_full_rate(I2C_Handle *i2c);
+void mpu9250_wake_on_motion(I2C_Handle *i2c, uint16_t mg, uint8_t odr);
+void mpu9250_get_accel(I2C_Handle *i2c, int16_t *raw);
+void mpu9250_scale(const int16_t *raw, float *values);
 
 #endif /* MPU9250_H_ */
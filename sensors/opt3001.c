@@ -8,7 +8,6 @@
  */
 
 #include <string.h>
-#include <math.h>
 
 #include <xdc/runtime/System.h>
 
@@ -23,8 +22,8 @@ void opt3001_setup(I2C_Handle *i2c) {
 
     i2cTransaction.slaveAddress = Board_OPT3001_ADDR;
     txBuffer[0] = OPT3001_REG_CONFIG;
-    txBuffer[1] = 0xCE; // continuous mode s.22
-    txBuffer[2] = 0x02;
+    txBuffer[1] = 0xC6; // continuous mode, 100 ms, automatic range s.22
+    txBuffer[2] = 0x11; // latched window, 2 faults: the flags tell of a change
     i2cTransaction.writeBuf = txBuffer;
     i2cTransaction.writeCount = 3;
     i2cTransaction.readBuf = NULL;
@@ -40,11 +39,12 @@ void opt3001_setup(I2C_Handle *i2c) {
 
 }
 
-double opt3001_get_data(I2C_Handle *i2c) {
+// read the configuration register: OPT3001_DATA_READY and the latched
+// window flags OPT3001_FLAG_HIGH and _LOW, which the read clears
+uint8_t opt3001_get_status(I2C_Handle *i2c, uint16_t *status) {
 
-	uint16_t e=0;
+	uint8_t rxBuffer[2];
 
-	/* Read sensor state */
 	i2cTransaction.slaveAddress = Board_OPT3001_ADDR;
 	txBuffer[0] = OPT3001_REG_CONFIG;
 	i2cTransaction.writeBuf = txBuffer;
@@ -52,41 +52,84 @@ double opt3001_get_data(I2C_Handle *i2c) {
 	i2cTransaction.readBuf = rxBuffer;
 	i2cTransaction.readCount = 2;
 
-	if (I2C_transfer(*i2c, &i2cTransaction)) {
+	if (!I2C_transfer(*i2c, &i2cTransaction)) {
 
-		e = (rxBuffer[0] << 8) | rxBuffer[1];
+		System_printf("OPT3001: Config read failed!\n");
+		System_flush();
+		return 0;
+	}
 
-	} else {
+	*status = (rxBuffer[0] << 8) | rxBuffer[1];
+	return 1;
+}
 
-		e = 0;
+// the latest result in 0.01 lux: 4 bit exponent, 12 bit mantissa, s.20
+uint8_t opt3001_get_data_fixed(I2C_Handle *i2c, uint32_t *lux) {
 
-		System_printf("OPT3001: Config read failed!\n");
+	uint8_t rxBuffer[2];
+
+	i2cTransaction.slaveAddress = Board_OPT3001_ADDR;
+	txBuffer[0] = OPT3001_REG_RESULT;
+	i2cTransaction.writeBuf = txBuffer;
+	i2cTransaction.writeCount = 1;
+	i2cTransaction.readBuf = rxBuffer;
+	i2cTransaction.readCount = 2;
+
+	if (!I2C_transfer(*i2c, &i2cTransaction)) {
+
+		System_printf("OPT3001: Data read failed!\n");
 		System_flush();
+		return 0;
 	}
 
-	/* Data available? */
-	if (e & OPT3001_DATA_READY) {
+	*lux = (uint32_t)(((rxBuffer[0] & 0x0F) << 8) | rxBuffer[1]) << (rxBuffer[0] >> 4);
+	return 1;
+}
+
+// 0.01 lux to the result format, the finest exponent that fits
+static uint16_t opt3001_encode(uint32_t lux) {
 
-		/* JTKJ FILL OUT THIS I2C DATA STRUCTURE TO GET LUX DATA
-		txBuffer[0] = ...
-	    i2cTransaction.slaveAddress = ...
-	    i2cTransaction.writeBuf = ...
-	    i2cTransaction.writeCount = ...
-	    i2cTransaction.readBuf = ...
-	    i2cTransaction.readCount = ...
-		*/
+	uint8_t e = 0;
+
+	while (e < 11 && (lux >> e) > 0x0FFF) {
+		e++;
+	}
+	if ((lux >> e) > 0x0FFF) {
+		lux = 0x0FFF << e;
+	}
+
+	return (e << 12) | (lux >> e);
+}
 
-		if (I2C_transfer(*i2c, &i2cTransaction)) {
+// the window of the comparator, in 0.01 lux: a result outside it for the
+// fault count sets a flag
+uint8_t opt3001_set_window(I2C_Handle *i2c, uint32_t low, uint32_t high) {
 
-			// JTKJ: HERE YOU GET THE DATA VALUE FROM RXBUFFER AS BYTES
+	uint16_t limit[2];
+	uint8_t i;
 
-		} else {
+	limit[0] = opt3001_encode(low);
+	limit[1] = opt3001_encode(high);
 
-			System_printf("OPT3001: Data read failed!\n");
+	i2cTransaction.slaveAddress = Board_OPT3001_ADDR;
+	i2cTransaction.writeBuf = txBuffer;
+	i2cTransaction.writeCount = 3;
+	i2cTransaction.readBuf = NULL;
+	i2cTransaction.readCount = 0;
+
+	for (i = 0; i < 2; i++) {
+		txBuffer[0] = OPT3001_REG_LOW_LIMIT + i;
+		txBuffer[1] = limit[i] >> 8;
+		txBuffer[2] = limit[i] & 0xFF;
+
+		if (!I2C_transfer(*i2c, &i2cTransaction)) {
+
+			System_printf("OPT3001: Limit write failed!\n");
 			System_flush();
+			return 0;
 		}
 	}
 
-	// FIX THIS
-	return -10000;
+	return 1;
 }
+
@@ -14,9 +14,15 @@
 
 #define OPT3001_REG_RESULT		0x0
 #define OPT3001_REG_CONFIG		0x1
+#define OPT3001_REG_LOW_LIMIT	0x2
+#define OPT3001_REG_HIGH_LIMIT	0x3
 #define OPT3001_DATA_READY		0x80
+#define OPT3001_FLAG_HIGH		0x40
+#define OPT3001_FLAG_LOW		0x20
 
 void opt3001_setup(I2C_Handle *i2c);
-double opt3001_get_data(I2C_Handle *i2c);
+uint8_t opt3001_get_status(I2C_Handle *i2c, uint16_t *status);
+uint8_t opt3001_get_data_fixed(I2C_Handle *i2c, uint32_t *lux);					// 0.01 lux
+uint8_t opt3001_set_window(I2C_Handle *i2c, uint32_t low, uint32_t high);		// 0.01 lux
 
 #endif /* OPT3001_H_ */
@@ -0,0 +1,165 @@
+#!/usr/bin/env python3
+"""
+Generate bitmaps/anim.c: animation frame tables for libs/anim.c.
+
+Source images are read from bitmaps/gui.c (1BPP_COMP_RLE4 or 1BPP_UNCOMP).
+Intermediate frames are made here, and for each frame only the XOR of it
+and the previous frame is stored, cropped to the rectangle that changes.
+The firmware applies these with LCD_blit(..., LCD_BLIT_XOR), so a frame
+costs only the display lines it really changes.
+
+Run from the repository root after changing the images or the table below:
+
+    python3 tools/mkanim.py
+"""
+
+import re
+import sys
+
+SOURCE = 'bitmaps/gui.c'
+OUTPUT = 'bitmaps/anim.c'
+
+# name, first image, last image, frame count, ticks per frame, loop mode
+ANIMATIONS = [
+    ('anim_stand_to_stairs', 'img_standing', 'img_stairs_up', 8, 1, 'ANIM_ONCE'),
+]
+
+# height of the dithered edge of the wipe (rows)
+DITHER_ROWS = 2
+
+# bytes per line on the Sharp LCD: address + 12 data + dummy
+LCD_LINE_SIZE = 14
+
+
+def load_image(source, name):
+    """Decode a tImage from the C source into rows of 0/1 (1 = ink)."""
+    fmt = re.search(r'const tImage %s = \{\s*(\w+),\s*(\d+),\s*(\d+)' % name, source)
+    data = re.search(r'static const unsigned char %s_data\[\] = \{(.*?)\};' % name, source, re.S)
+    if not fmt or not data:
+        sys.exit('%s: image %s not found' % (SOURCE, name))
+
+    kind, w, h = fmt.group(1), int(fmt.group(2)), int(fmt.group(3))
+    data = [int(b, 16) for b in re.findall(r'0x[0-9a-fA-F]+', data.group(1))]
+    pixels = []
+
+    if kind == 'IMAGE_FMT_1BPP_COMP_RLE4':
+        # byte = (run length - 1) << 4 | palette index, runs continue over rows
+        for b in data:
+            pixels += [b & 0x0F] * ((b >> 4) + 1)
+        pixels = (pixels + [0] * (w * h))[:w * h]
+        return [pixels[y * w:(y + 1) * w] for y in range(h)]
+
+    if kind == 'IMAGE_FMT_1BPP_UNCOMP':
+        stride = (w + 7) // 8
+        return [[(data[y * stride + x // 8] >> (7 - x % 8)) & 1 for x in range(w)] for y in range(h)]
+
+    sys.exit('%s: unsupported format %s' % (name, kind))
+
+
+def wipe_up(first, last, count):
+    """Frames where the last image rises from the bottom over the first one."""
+    h, w = len(first), len(first[0])
+    frames = []
+
+    for k in range(count):
+        edge = h - round(k * (h + DITHER_ROWS) / (count - 1))
+        frame = []
+        for y in range(h):
+            if y >= edge + DITHER_ROWS:
+                frame.append(list(last[y]))
+            elif y >= edge:
+                frame.append([last[y][x] if (x + y) % 2 == 0 else first[y][x] for x in range(w)])
+            else:
+                frame.append(list(first[y]))
+        frames.append(frame)
+
+    return frames
+
+
+def xor_rect(a, b):
+    """Bounding rectangle and packed XOR rows of two frames (None if equal)."""
+    h, w = len(a), len(a[0])
+    diff = [[a[y][x] ^ b[y][x] for x in range(w)] for y in range(h)]
+    rows = [y for y in range(h) if any(diff[y])]
+    cols = [x for x in range(w) if any(diff[y][x] for y in range(h))]
+    if not rows:
+        return None
+
+    x0, x1, y0, y1 = cols[0], cols[-1], rows[0], rows[-1]
+    packed = []
+    for y in range(y0, y1 + 1):
+        bits = diff[y][x0:x1 + 1]
+        bits += [0] * (-len(bits) % 8)
+        packed += [int(''.join(map(str, bits[i:i + 8])), 2) for i in range(0, len(bits), 8)]
+
+    return (x0, y0, x1 - x0 + 1, y1 - y0 + 1, packed, len(rows))
+
+
+def emit(out, name, first, last, count, ticks, loop, images):
+    frames = wipe_up(images[first], images[last], count)
+    deltas = []
+
+    # frames[0] is reached only by looping back from the last frame
+    deltas.append(xor_rect(frames[-1], frames[0]) if loop == 'ANIM_LOOP' else None)
+    for k in range(1, count):
+        deltas.append(xor_rect(frames[k - 1], frames[k]))
+
+    sent = sum(d[5] for d in deltas[1:] if d)
+    swap = sum(1 for y in range(len(frames[0])) if frames[0][y] != frames[-1][y])
+
+    out.append('/* %s: %s -> %s, %d frames */' % (name.upper(), first, last, count))
+    out.append('// lines sent over the whole animation: %d (%d B), a plain image swap: %d (%d B)'
+               % (sent, sent * LCD_LINE_SIZE, swap, swap * LCD_LINE_SIZE))
+
+    for k, d in enumerate(deltas):
+        if not d:
+            continue
+        out.append('static const uint8_t %s_xor%d[] = {' % (name, k))
+        for i in range(0, len(d[4]), 16):
+            out.append('    ' + ', '.join('0x%02x' % b for b in d[4][i:i + 16]) + ',')
+        out.append('};')
+    out.append('')
+
+    out.append('static const AnimFrame %s_frames[] = {' % name)
+    for k, d in enumerate(deltas):
+        if d:
+            out.append('    { %d, %d, %d, %d, %d, %s_xor%d },' % (ticks, d[0], d[1], d[2], d[3], name, k))
+        else:
+            out.append('    { %d, 0, 0, 0, 0, NULL },' % ticks)
+    out.append('};')
+    out.append('')
+
+    out.append('const Animation %s = {' % name)
+    out.append('    &%s,' % first)
+    out.append('    &%s,' % last)
+    out.append('    %d,' % count)
+    out.append('    %s_frames,' % name)
+    out.append('    %s' % loop)
+    out.append('};')
+    out.append('')
+
+
+def main():
+    source = open(SOURCE).read()
+    images = {}
+    for anim in ANIMATIONS:
+        for img in anim[1:3]:
+            images[img] = load_image(source, img)
+        if len(images[anim[1]]) != len(images[anim[2]]) or len(images[anim[1]][0]) != len(images[anim[2]][0]):
+            sys.exit('%s: images must be the same size' % anim[0])
+
+    banner = source[:source.index('*/') + 2].replace('\r\n', '\n')
+    out = [banner, '',
+           '// GENERATED by tools/mkanim.py from %s, do not edit.' % SOURCE, '',
+           '#include <stddef.h>', '',
+           '#include "bitmaps/anim.h"', '#include "bitmaps/gui.h"', '', '']
+
+    for anim in ANIMATIONS:
+        emit(out, *anim, images=images)
+
+    open(OUTPUT, 'w', newline='\n').write('\n'.join(out))
+    print('wrote %s' % OUTPUT)
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,282 @@
+#!/usr/bin/env python3
+"""
+Generate libs/model.c: the activity classifier model for libs/classifier.c.
+
+Trains on feature vectors of traces (host/replay -c) and the segments the
+traces were made of (what host/mktrace prints, or the same "<seconds> s
+<name>" lines written by hand for a recorded trace). Each window of
+features gets the activity of its segment; windows over the start of a
+segment are left out, they have a bit of both. The classes are weighted
+equally, so the rare elevator rides count as much as lying still.
+
+The model is a decision tree (the default), or with --linear a softmax
+regression whose class scores are quantised to log2 odds, both in integers
+like the firmware evaluates them.
+
+From host/, after building the tools (make model does all this):
+
+    build/mktrace -m 240 -s 2 build/train.trace > build/train.segments
+    build/replay -c build/train.trace > build/train.csv
+    python3 ../tools/train.py build/train.segments build/train.csv
+"""
+
+import argparse
+import math
+import os
+import re
+import sys
+
+ROOT = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+HEADER = os.path.join(ROOT, 'upstair.h')
+BANNER = os.path.join(ROOT, 'libs/classifier.h')
+OUTPUT = os.path.join(ROOT, 'libs/model.c')
+
+# segment names, as the activity they are
+ACTIVITIES = {'idle': 0, 'walk': 0, 'bump': 0, 'stairs': 1, 'elevator': 2}
+CLASSES = ['IDLE', 'STAIRS', 'ELEVATOR']
+
+# the feature vector, in ClsFeature order
+FEATURES = ['CLS_AMPLITUDE', 'CLS_BAND', 'CLS_REGULARITY', 'CLS_CADENCE', 'CLS_CLIMB']
+
+# the linear model's class scores have this many fraction bits (CLS_LOG_FRAC)
+LOG_FRAC = 4
+
+
+def define(header, name):
+    m = re.search(r'#define %s (\d+)' % name, header)
+    if not m:
+        sys.exit('%s: %s not found' % (HEADER, name))
+    return int(m.group(1))
+
+
+def load(segment_path, csv_path, window):
+    """Labelled feature vectors of one trace."""
+    segments = []
+    for line in open(segment_path):
+        m = re.match(r'\s*([\d.]+) s\s+(\w+)\s*$', line)
+        if m and m.group(2) in ACTIVITIES:
+            segments.append((float(m.group(1)), ACTIVITIES[m.group(2)]))
+    if not segments:
+        sys.exit('%s: no segments' % segment_path)
+
+    samples = []
+    k = 0
+    for line in open(csv_path):
+        values = line.strip().split(',')
+        if len(values) != 1 + len(FEATURES):
+            continue
+        time = float(values[0])
+        while k + 1 < len(segments) and segments[k + 1][0] <= time:
+            k += 1
+        if time - window >= segments[k][0]:
+            samples.append(([int(v) for v in values[1:]], segments[k][1]))
+
+    return samples
+
+
+def class_weights(samples):
+    counts = [sum(1 for _, c in samples if c == k) for k in range(len(CLASSES))]
+    return [len(samples) / (len(CLASSES) * n) if n else 0 for n in counts], counts
+
+
+def gini(weights):
+    total = sum(weights)
+    return 1 - sum((w / total) ** 2 for w in weights) if total else 0
+
+
+def grow(samples, weights, depth, min_leaf, nodes, leaves):
+    """Add the subtree of @samples to @nodes, @return the index of its root."""
+    totals = [0.0] * len(CLASSES)
+    for _, c in samples:
+        totals[c] += weights[c]
+
+    best = None
+    if depth > 0 and gini(totals) > 0:
+        for f in range(len(FEATURES)):
+            ordered = sorted(samples, key=lambda s: s[0][f])
+            below = [0.0] * len(CLASSES)
+            for i in range(len(ordered) - 1):
+                below[ordered[i][1]] += weights[ordered[i][1]]
+                value, following = ordered[i][0][f], ordered[i + 1][0][f]
+                if value == following or i + 1 < min_leaf or len(ordered) - i - 1 < min_leaf:
+                    continue
+                above = [t - b for t, b in zip(totals, below)]
+                cost = sum(below) * gini(below) + sum(above) * gini(above)
+                if best is None or cost < best[0]:
+                    best = (cost, f, value)
+
+    if best is None or best[0] >= sum(totals) * gini(totals) - 1e-9:
+        confidence = [round(100 * t / sum(totals)) for t in totals]
+        nodes.append([-1, len(leaves), 0, 0])
+        leaves.append((confidence, len(samples)))
+        return len(nodes) - 1
+
+    _, f, threshold = best
+    index = len(nodes)
+    nodes.append([f, 0, 0, threshold])
+    nodes[index][1] = grow([s for s in samples if s[0][f] <= threshold], weights, depth - 1, min_leaf, nodes, leaves)
+    nodes[index][2] = grow([s for s in samples if s[0][f] > threshold], weights, depth - 1, min_leaf, nodes, leaves)
+
+    # both sides say the same: one leaf will do
+    below, above = nodes[nodes[index][1]], nodes[nodes[index][2]]
+    if below[0] == -1 and above[0] == -1:
+        a, b = leaves[below[1]], leaves[above[1]]
+        if a[0].index(max(a[0])) == b[0].index(max(b[0])):
+            n = a[1] + b[1]
+            confidence = [round((x * a[1] + y * b[1]) / n) for x, y in zip(a[0], b[0])]
+            del nodes[index:]
+            del leaves[below[1]:]
+            nodes.append([-1, len(leaves), 0, 0])
+            leaves.append((confidence, n))
+
+    return index
+
+
+def tree_classify(nodes, leaves, x):
+    node = nodes[0]
+    while node[0] != -1:
+        node = nodes[node[1] if x[node[0]] <= node[3] else node[2]]
+    confidence = leaves[node[1]][0]
+    return confidence.index(max(confidence))
+
+
+def train_linear(samples, weights, iterations, rate):
+    """Softmax regression on standardised features, @return log2 odds per raw unit."""
+    n = len(FEATURES)
+    mean = [sum(s[0][i] for s in samples) / len(samples) for i in range(n)]
+    sd = [math.sqrt(sum((s[0][i] - mean[i]) ** 2 for s in samples) / len(samples)) or 1 for i in range(n)]
+    data = [([(s[0][i] - mean[i]) / sd[i] for i in range(n)], s[1]) for s in samples]
+    w = [[0.0] * n for _ in CLASSES]
+    b = [0.0] * len(CLASSES)
+    total = sum(weights[c] for _, c in data)
+
+    for _ in range(iterations):
+        gw = [[0.0] * n for _ in CLASSES]
+        gb = [0.0] * len(CLASSES)
+        for x, c in data:
+            z = [b[k] + sum(w[k][i] * x[i] for i in range(n)) for k in range(len(CLASSES))]
+            top = max(z)
+            e = [math.exp(v - top) for v in z]
+            s = sum(e)
+            for k in range(len(CLASSES)):
+                g = weights[c] * (e[k] / s - (k == c))
+                gb[k] += g
+                for i in range(n):
+                    gw[k][i] += g * x[i]
+        for k in range(len(CLASSES)):
+            b[k] -= rate * gb[k] / total
+            for i in range(n):
+                w[k][i] -= rate * (gw[k][i] / total + 1e-3 * w[k][i])
+
+    # back to raw features, natural log to log2
+    slope = [[w[k][i] / sd[i] / math.log(2) for i in range(n)] for k in range(len(CLASSES))]
+    bias = [(b[k] - sum(w[k][i] * mean[i] / sd[i] for i in range(n))) / math.log(2) for k in range(len(CLASSES))]
+    return slope, bias
+
+
+def quantise(slope, bias):
+    """Integer weights and bias, with the largest shift that can't overflow."""
+    for shift in range(24, -1, -1):
+        scale = (1 << LOG_FRAC) * (1 << shift)
+        weights = [[round(v * scale) for v in row] for row in slope]
+        offsets = [round(v * scale) for v in bias]
+        if all(abs(v) <= 32767 for row in weights for v in row) \
+                and all(sum(abs(v) for v in row) * 32767 + abs(o) < 2 ** 31 for row, o in zip(weights, offsets)):
+            return weights, offsets, shift
+    sys.exit('linear model: weights too large')
+
+
+def linear_classify(weights, offsets, shift, x):
+    scores = [(o + sum(w * v for w, v in zip(row, x))) >> shift for row, o in zip(weights, offsets)]
+    return scores.index(max(scores))
+
+
+def report(samples, classify):
+    right = [0] * len(CLASSES)
+    counts = [0] * len(CLASSES)
+    for x, c in samples:
+        counts[c] += 1
+        right[c] += classify(x) == c
+    for k, name in enumerate(CLASSES):
+        if counts[k]:
+            print('  %-8s %5.1f %% right of %d windows' % (name, 100.0 * right[k] / counts[k], counts[k]))
+    return 100.0 * sum(right) / len(samples)
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Train the activity classifier (libs/model.c).')
+    parser.add_argument('-o', '--output', default=OUTPUT)
+    parser.add_argument('--linear', action='store_true', help='softmax regression instead of a tree')
+    parser.add_argument('--depth', type=int, default=5, help='of the tree')
+    parser.add_argument('--min-leaf', type=int, default=10, help='windows in a leaf of the tree')
+    parser.add_argument('--iterations', type=int, default=300, help='of the linear model')
+    parser.add_argument('files', nargs='+', help='segments and feature CSV of each trace, in pairs')
+    args = parser.parse_args()
+
+    if len(args.files) % 2:
+        sys.exit('give the segments and the feature CSV of each trace')
+
+    header = open(HEADER).read()
+    window = define(header, 'SPEC_WINDOW') * define(header, 'SPEC_DECIMATION') / define(header, 'IMU_RATE')
+
+    samples = []
+    for k in range(0, len(args.files), 2):
+        samples += load(args.files[k], args.files[k + 1], window)
+    weights, counts = class_weights(samples)
+    print('%d windows: %s' % (len(samples), ', '.join('%s %d' % (n, c) for n, c in zip(CLASSES, counts))))
+
+    sources = ', '.join(args.files)
+    source = open(BANNER).read()
+    banner = source[:source.index('*/') + 2]
+    out = [banner, '',
+           '// GENERATED by tools/train.py from %s, do not edit.' % sources]
+
+    if args.linear:
+        slope, bias = train_linear(samples, weights, args.iterations, 0.5)
+        qw, qb, shift = quantise(slope, bias)
+        accuracy = report(samples, lambda x: linear_classify(qw, qb, shift, x))
+        name = 'linear, %d windows' % len(samples)
+        out += ['// linear, %.1f %% of %d training windows right' % (accuracy, len(samples)), '',
+                '#include <stddef.h>', '', '#include "libs/classifier.h"', '', '',
+                '// log2 odds << (%d + shift) per unit of %s' % (LOG_FRAC, ', '.join(FEATURES)),
+                'static const int16_t weights[CLS_CLASSES][CLS_FEATURES] = {']
+        for k, row in enumerate(qw):
+            out.append('    { %s },    // %s' % (', '.join('%6d' % v for v in row), CLASSES[k]))
+        out += ['};', '',
+                'static const int32_t bias[CLS_CLASSES] = { %s };' % ', '.join(str(v) for v in qb), '',
+                'const ClsModel CLS_model = {',
+                '    "%s",' % name,
+                '    NULL,', '    NULL,', '    weights,', '    bias,', '    %d' % shift, '};', '']
+    else:
+        nodes, leaves = [], []
+        grow(samples, weights, args.depth, args.min_leaf, nodes, leaves)
+        accuracy = report(samples, lambda x: tree_classify(nodes, leaves, x))
+        name = 'tree, %d windows' % len(samples)
+        out += ['// decision tree of %d nodes, %.1f %% of %d training windows right'
+                % (len(nodes), accuracy, len(samples)), '',
+                '#include <stddef.h>', '', '#include "libs/classifier.h"', '', '',
+                '// feature, below, above, threshold; a leaf has its confidences at below',
+                'static const ClsNode nodes[] = {']
+        for k, (f, below, above, threshold) in enumerate(nodes):
+            if f == -1:
+                entry = '    { CLS_LEAF, %d, 0, 0 },' % below
+            else:
+                entry = '    { %s, %d, %d, %d },' % (FEATURES[f], below, above, threshold)
+            out.append('%s// %d' % (entry.ljust(44), k))
+        out += ['};', '',
+                '// %, IDLE, STAIRS, ELEVATOR',
+                'static const uint8_t leaves[][CLS_CLASSES] = {']
+        for confidence, n in leaves:
+            out.append('    { %3d, %3d, %3d },    // %d windows' % (confidence[0], confidence[1], confidence[2], n))
+        out += ['};', '',
+                'const ClsModel CLS_model = {',
+                '    "%s",' % name,
+                '    nodes,', '    leaves,', '    NULL,', '    NULL,', '    0', '};', '']
+
+    print('%.1f %% right' % accuracy)
+    open(args.output, 'w', newline='\n').write('\n'.join(out))
+    print('wrote %s' % args.output)
+
+
+if __name__ == '__main__':
+    main()
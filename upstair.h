@@ -33,19 +33,121 @@
 #define MAIN_TASK_DELAY 50000           // 1000000/50000 = ~20 times/sec
 #define SAMPLE_RATE 2                   // 20/2 = 10 times/sec
 #define FRAME_RATE 3                    // 20/3 = 6.7 times/sec
+#define HIST_TICK_RATE 20               // 20/20 = once per sec (history is kept in seconds)
+#define LOAD_UPDATE_RATE 20             // 20/20 = once per sec (CPU load windows)
 
 #define AUTO_SLEEP_TIME 1800            // idle time before goung to sleep (in loops)
 
+/* Standby (auto sleep), until the MPU9250 sees motion */
+#define STANDBY_WAKE_MG 96              // mg between two samples, in 4 mg steps
+#define STANDBY_ODR 4                   // LP_ACCEL_ODR code, 3.9 Hz: motion is seen within 256 ms
+#define STANDBY_TICK 600                // seconds, the RTC wakes up for the bookkeeping
+
 /* Views */
-#define MAIN_MENU_LEN 4
+#define MAIN_MENU_LEN 5
 
 /* Messages */
 #define MSGS_MAX_COUNT 6
 #define MAX_TEXT_LEN 16                 // how many characters fits to one line
 
+/* Activity log */
+#define LOG_RESTORE_SECTORS 2           // how far back the log is read at boot
+
+/* Boot snapshot */
+#define SNAPSHOT_VERSION 2              // change when Snapshot changes
+
+/* Snapshot stores (libs/snapshot.h) */
+#define SNAP_STATE 0                    // Snapshot
+#define SNAP_CALIBRATION 1              // MPU9250 calibration (libs/calib.h)
+
 /* Step detection */
 #define MA_N 8                          // how many samples for moving average algorithm
 
+/* Attitude (libs/attitude.h) */
+#define IMU_RATE 200                    // Hz, MPU9250 sample rate (SMPLRT_DIV)
+#define IMU_FIFO_MAX 42                 // samples that fit in the 512 byte FIFO
+#define ATT_KP 0.5f                     // 1/s, how fast the accelerometer corrects the gyro
+#define ATT_GATE 25                     // %, trust the accelerometer within 1 g +- this
+
+/* Step counting (libs/steps.h) */
+#define STEP_BAND_HZ 2                  // band-pass centre, the step rate of walking and climbing
+#define STEP_MIN_PEAK 60                // mg, smaller bounces are not steps
+#define STEP_REFRACTORY 250             // ms, at most 4 steps a second
+#define STEP_TIMEOUT 2000               // ms without a step ends a run of steps
+#define STEP_CONFIRM 4                  // steps in a row before they are counted
+#define STEP_CADENCE_STEPS 8            // steps in the cadence
+#define STEP_BRISK_CADENCE 110          // steps/min, stairs climbed faster than this score double
+
+/* Step band features (libs/spectrum.h) */
+#define SPEC_DECIMATION 10              // MPU samples averaged, 200/10 = 20 Hz
+#define SPEC_WINDOW 64                  // averaged samples (3.2 s), new features every half
+#define SPEC_SEARCH_LOW 50              // 0.01 Hz, where the dominant frequency is looked for
+#define SPEC_SEARCH_HIGH 400            // 0.01 Hz
+#define SPEC_BAND_LOW 150               // 0.01 Hz, the step band of climbing
+#define SPEC_BAND_HIGH 250              // 0.01 Hz
+#define SPEC_STILL 10                   // mg RMS, below this there is no dominant frequency
+
+/* Activity classifier (libs/classifier.h), the model is in libs/model.c */
+#define CLS_MIN_CONFIDENCE 60           // %, a less certain class does not change the activity
+
+/* Sampling tiers (libs/tiers.h) */
+#define TIER_LOW_ODR 4                  // LP_ACCEL_ODR code while idle, 0.24 Hz << 4 = 3.9 Hz
+#define TIER_LOW_READ 4                 // 20/4 = 5 times/sec, an accelerometer sample while idle
+#define TIER_WAKE_MG 50                 // mg, a change on any axis between samples is motion
+#define TIER_HOLDOFF 10                 // seconds not busy before dropping to the low tier
+
+/* Sensor acquisition (libs/acquire.h) */
+#define ACQ_SENSORS_MAX 6               // sensors in the schedule, at most 16
+#define HDC_PERIOD 10000                // ms, temperature and humidity (HDC1000)
+
+/* Ambient light (libs/ambient.h) */
+#define AMB_PERIOD 400                  // ms, the OPT3001 window flags are polled
+#define AMB_HYSTERESIS 25               // %, a smaller change of the light is not read
+#define AMB_MIN_CHANGE 2                // lux, nor one smaller than this
+#define AMB_DARK_LUX 5                  // lux, below this the screen is not redrawn (in a pocket)...
+#define AMB_LIGHT_LUX 15                // lux, ...until above this
+
+/* Vertical motion (libs/vertical.h) */
+#define BARO_RATE 4                     // 20/4 = 5 times/sec, on the loops without an MPU read
+#define VERT_WINDOW 10                  // samples in the vertical speed (2 s)
+#define VERT_START_SPEED 15             // cm/s, going up or down above this...
+#define VERT_STOP_SPEED 8               // ...until below this
+#define VERT_ELEVATOR_SPEED 80          // cm/s, faster than anyone climbs stairs
+#define VERT_CONFIRM 10                 // samples to tell stairs from elevator
+#define VERT_FLOOR_HEIGHT 300           // cm
+#define VERT_SETTLE_TIME 10             // seconds level before a trip is over
+
+/* IMU trace recording (libs/trace.h): TRACE_OFF, TRACE_LOG or TRACE_RADIO.
+ * A trace has every MPU and BMP280 sample, it fills the activity log in about
+ * 2.5 minutes. */
+#define TRACE_MODE TRACE_OFF
+
+/* Hot path profiling (libs/prof.h): 1 to measure, 0 compiles it out */
+#ifndef PROFILING
+#define PROFILING 0
+#endif
+#ifndef PROF_DUMP_PERIOD
+#define PROF_DUMP_PERIOD 60             // seconds between dumps of the table
+#endif
+
+/* CPU load (libs/load.h) */
+#define LOAD_HISTORY 10                 // windows in the rolling average
+#define LOAD_CALIB_TIME 100             // ms of idle loop counted for the baseline
+
+/* Energy model (libs/energy.h): typical currents of each subsystem (uA) */
+#define CUR_CPU_ACTIVE 2930             // CC2650 at 48 MHz, 61 uA/MHz
+#define CUR_CPU_STANDBY 1               // RTC running, RAM retained
+#define CUR_RADIO_RX 5900
+#define CUR_RADIO_TX 6100               // 0 dBm
+#define CUR_RADIO_IDLE 550              // radio core up, not receiving
+#define CUR_MPU 3700                    // MPU9250, accelerometer and gyro on
+#define CUR_MPU_LP 10                   // MPU9250, low power accelerometer at ~4 Hz
+#define CUR_LCD 250                     // LCD flush: SPI, DMA and the display
+#define CUR_I2C 400                     // bus open: the peripheral and pull-ups
+#define CUR_FLASH 3000                  // MX25R8035F programming or erasing
+#define BATTERY_CAPACITY 240            // mAh, CR2032
+#define ENERGY_REPORT_PERIOD 3600       // seconds between reports to the server
+
 extern uint8_t autoSleep;
 
 
@@ -53,6 +155,34 @@ extern uint8_t autoSleep;
 typedef enum { ACT_IDLE, ACT_STAIRS, ACT_ELEVATOR } Activity;
 
 
+/* Record types of the activity log (libs/flashlog.h) */
+typedef enum {
+    LOG_BOOT = 1,       // no data
+    LOG_ACTIVITY,       // LogActivity
+    LOG_SCORE,          // uint16_t, total score
+    LOG_MSG,            // char[MAX_TEXT_LEN], received message
+    LOG_TRACE_META,     // TraceMeta (libs/trace.h)
+    LOG_TRACE,          // IMU samples (libs/trace.h)
+    LOG_TRACE_PRESSURE  // a BMP280 sample (libs/trace.h)
+} LogType;
+
+/* Activity changed */
+typedef struct {
+    uint32_t uptime;    // seconds since boot
+    uint16_t score;
+    uint8_t activity;
+} LogActivity;
+
+
+/* State saved at shutdown and restored at boot (libs/snapshot.h) */
+typedef struct {
+    uint16_t score;
+    uint8_t autoSleep;
+    uint8_t msgCount;
+    char msgs[MSGS_MAX_COUNT][MAX_TEXT_LEN];
+} Snapshot;
+
+
 /* States of the finite state machine */
 typedef enum {
     ST_IDLE,            // do nothing specific
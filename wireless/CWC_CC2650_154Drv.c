@@ -66,6 +66,7 @@ static volatile rfc_CMD_IEEE_ABORT_BG_t rfc_CMD_IEEE_ABORT_BG;//stop background
 
 //internal status structure
 static volatile CWC_CC2650_154_Status_Struct_t my_CC2650_Status;
+static CWC_CC2650_154_StateCallbackfuncPtr_t State_Callback = NULL;//told about every state change (NOTE: may be called from an interrupt!)
 
 //Some specific configs for IEEE 802.15.4 mode
 static uint32_t ieee_overrides[] = {//NOTE: by some reason cannot be const
@@ -279,8 +280,33 @@ static dataQueue_t rx_data_queue = { 0 };
 
 //MACROS
 
+//CODE: LOCAL FUNCTIONS
+
+//all changes of myState go through here
+__STATIC_INLINE void
+CWC_CC2650_154_SetState(CWC_CC2650_154_State_t State){
+	my_CC2650_Status.myState=State;
+	if(State_Callback!=NULL)State_Callback(State);
+}
+
 //CODE: PUBLIC FUNCTIONS
 
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//FunctionName:		CWC_CC2650_154_SetStateCallback
+///Description:		Sets a function to be called on every change of the radio state (e.g. for energy accounting)
+//Version & Data:	0.01 2018.11.20
+//Author(s):		Miika Sikala
+//Inputs: 			CWC_CC2650_154_StateCallbackfuncPtr_t Callback - the function, NULL to remove
+//Outputs:			none
+//Dependences:		none
+//Notes:			the function is called with the current state at once, and later also from the radio IRQ
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+void
+CWC_CC2650_154_SetStateCallback(CWC_CC2650_154_StateCallbackfuncPtr_t Callback){
+	State_Callback=Callback;
+	if(State_Callback!=NULL)State_Callback(my_CC2650_Status.myState);
+}
+
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 //FunctionName:		CWC_CC2650_154_Init
 ///Description:		Initializes the radio and puts it to idle mode
@@ -303,7 +329,7 @@ CWC_CC2650_154_Init(CWC_CC2650_154_Init_struct_t *ptr_Init_Data){//initialize th
 	}
 
 	{//fill in the internal structure(s)
-		my_CC2650_Status.myState=CWC_CC2650_154_STATE_UNINIT;//just in case
+		CWC_CC2650_154_SetState(CWC_CC2650_154_STATE_UNINIT);//just in case
 		my_CC2650_Status.myBackgroundState=CWC_CC2650_154_Background_UNINIT;//just in case
 		my_CC2650_Status.Event_Callback=ptr_Init_Data->Event_Callback;
 		my_CC2650_Status.myChannel=ptr_Init_Data->Channel;
@@ -391,7 +417,7 @@ CWC_CC2650_154_Init(CWC_CC2650_154_Init_struct_t *ptr_Init_Data){//initialize th
     }
 
     {//update state variables
-		my_CC2650_Status.myState=CWC_CC2650_154_STATE_IDLE;
+		CWC_CC2650_154_SetState(CWC_CC2650_154_STATE_IDLE);
 		my_CC2650_Status.myBackgroundState=CWC_CC2650_154_Background_IDLE;
     }
     return 1;
@@ -440,7 +466,7 @@ CWC_CC2650_154_SendDataPacket_Forced(uint16_t DestAddr, uint8_t *ptr_Payload, ui
 				rfc_CMD_IEEE_TX.payloadLen = u8_length+IEEE_802_15_4_FRAME_OVERHEAD;
 				result= RFCDoorbellSendTo((unsigned long)&rfc_CMD_IEEE_TX);
 				if(result==1){
-					my_CC2650_Status.myState=CWC_CC2650_154_STATE_TX;
+					CWC_CC2650_154_SetState(CWC_CC2650_154_STATE_TX);
 					return 1;
 				}
 				else return 0;
@@ -473,7 +499,7 @@ CWC_CC2650_154_ReceiveStart(void){
 			//CWC_CC2650_154_EnableRadioIRQs();//just in case - enable the IRQs
 			result=RFCDoorbellSendTo((unsigned long)&rfc_CMD_IEEE_RX);
 			if(result==1){
-				my_CC2650_Status.myState=CWC_CC2650_154_STATE_RX;
+				CWC_CC2650_154_SetState(CWC_CC2650_154_STATE_RX);
 				my_CC2650_Status.myBackgroundState=CWC_CC2650_154_Background_RX;
 				return 1;
 			}
@@ -485,6 +511,41 @@ CWC_CC2650_154_ReceiveStart(void){
 	}
 }
 
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//FunctionName:		CWC_CC2650_154_PowerDown
+///Description:		Stops receiving and powers the radio core down
+//Version & Data:	0.01 2018.12.04
+//Author(s):		Miika Sikala
+//Inputs: 			none
+//Outputs:			1 - all is ok (i.e., the radio is off), 0 - fail (a packet is being sent)
+//Dependences:		none
+//Notes:			CWC_CC2650_154_Init() powers the radio up again
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+uint8_t
+CWC_CC2650_154_PowerDown(void){
+	volatile int result = 0;
+	//check the status
+	switch(my_CC2650_Status.myState){
+		case CWC_CC2650_154_STATE_RX:
+			rfc_CMD_IEEE_ABORT_BG.commandNo=CMD_IEEE_ABORT_BG;//immediate command, stops the background RX
+			result=RFCDoorbellSendTo((unsigned long)&rfc_CMD_IEEE_ABORT_BG);
+			if(result!=0x01)return 0;//something goes wrong
+			//no break - the core is idle now
+		case CWC_CC2650_154_STATE_IDLE:
+		{
+			CWC_CC2650_154_DisableRadioIRQs();
+			RFCClockDisable();
+			PRCMPowerDomainOff(PRCM_DOMAIN_RFCORE);
+			my_CC2650_Status.myBackgroundState=CWC_CC2650_154_Background_UNINIT;
+			CWC_CC2650_154_SetState(CWC_CC2650_154_STATE_OFF);
+			return 1;
+		}
+		default:
+			//cannot handle
+			return 0;
+	}
+}
+
 
 //INTERRUPTS
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -526,8 +587,8 @@ RFCCPE1IntHandler(UArg arg0){
 	if(u32_IRQ&RFC_DBELL_RFCPEIFG_TX_DONE){
 		CWC_CC2650_154_Events_t CurrentEvent=CWC_CC2650_154_EVENT_TXD_OK;
 		my_CC2650_Status.Event_Callback(CurrentEvent);//call callback
-		if(my_CC2650_Status.myBackgroundState==CWC_CC2650_154_Background_RX)my_CC2650_Status.myState=CWC_CC2650_154_STATE_RX;
-		else my_CC2650_Status.myState=CWC_CC2650_154_STATE_IDLE;
+		if(my_CC2650_Status.myBackgroundState==CWC_CC2650_154_Background_RX)CWC_CC2650_154_SetState(CWC_CC2650_154_STATE_RX);
+		else CWC_CC2650_154_SetState(CWC_CC2650_154_STATE_IDLE);
 		HWREG(RFC_DBELL_NONBUF_BASE + RFC_DBELL_O_RFCPEIFG) = ~(RFC_DBELL_RFCPEIFG_TX_DONE);//see NOTE on page 1476 of swcu117d
 	}
 	else if(u32_IRQ&RFC_DBELL_RFCPEIFG_RX_OK){
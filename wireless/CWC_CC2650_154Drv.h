@@ -13,13 +13,14 @@
 
 //INCLUDES
 #include <xdc/std.h> // Teemu
+#include <stddef.h>
 #include <inc/hw_types.h>
 #include <driverlib/rf_data_entry.h>
 #include <driverlib/interrupt.h>
 
 //CONSTANTS
 #define IEEE_802_15_4_FRAME_OVERHEAD			9//FCS - automatically added
-#define CC2650_RX_ENTRY_HEADER_OVERHEAD_BYTES	8//size of header for an entry see Table 23-10 on page 1584 of SWCU117E
+#define CC2650_RX_ENTRY_HEADER_OVERHEAD_BYTES	offsetof(rfc_dataEntryGeneral_t, data)//size of header for an entry (8) see Table 23-10 on page 1584 of SWCU117E
 //NOTE: the following defs are based on the RX command parameters and needs to be changed if RX command is modified
 #define CC2650_RX_ENTRY_ELEMENTLENGTH_BYTES 	1
 #define CC2650_RX_ENTRY_PHYHEADER_BYTES 		1
@@ -81,6 +82,7 @@ typedef enum{//events
 }CWC_CC2650_154_Events_t;
 
 typedef void (*CWC_CC2650_154_CallbackfuncPtr_t)(CWC_CC2650_154_Events_t);//callback function (NOTE: called from an interrupt!)
+typedef void (*CWC_CC2650_154_StateCallbackfuncPtr_t)(CWC_CC2650_154_State_t);//state change callback (NOTE: may be called from an interrupt!)
 
 typedef struct{//init structure
    uint8_t Channel;
@@ -122,6 +124,8 @@ extern volatile uint8_t *rx_read_entry;
 uint8_t CWC_CC2650_154_Init(CWC_CC2650_154_Init_struct_t *ptr_Init_Data);//initialize the radio
 uint8_t CWC_CC2650_154_SendDataPacket_Forced(uint16_t DestAddr, uint8_t *ptr_Payload, uint8_t u8_length);//sent a radio packet in forced mode (i.e. without CCA)
 uint8_t CWC_CC2650_154_ReceiveStart(void);//start receive mode
+uint8_t CWC_CC2650_154_PowerDown(void);//stop receiving and power the radio core down, CWC_CC2650_154_Init() to power up
+void CWC_CC2650_154_SetStateCallback(CWC_CC2650_154_StateCallbackfuncPtr_t Callback);//be told about radio state changes
 
 //Enable radio IRQs. Should work from each possible state.
 __STATIC_INLINE void
@@ -16,6 +16,7 @@
 #include <xdc/runtime/System.h>
 #include <driverlib/pwr_ctrl.h>
 #include <ti/sysbios/hal/Hwi.h>
+#include <ti/sysbios/knl/Semaphore.h>
 
 #include "wireless/comm_lib.h"
 #include "wireless/CWC_CC2650_154Drv.h"
@@ -36,6 +37,8 @@ Hwi_Handle cpe0Handle;
 Hwi_Params cpe1Params;
 Hwi_Handle cpe1Handle;
 
+static Semaphore_Handle hRXSem;		//posted by Radio_IRQ on every received frame
+
 char debug_str[20];
 
 uint8_t GetTXFlag(void) {
@@ -46,6 +49,14 @@ uint8_t GetRXFlag(void) {
 	return u8_RXd_Flag;
 }
 
+//blocks until a frame has been received or timeout (in Clock ticks) passes, returns the RX flag
+uint8_t WaitRXFlag(uint32_t timeout) {
+	if(!u8_RXd_Flag) {
+		Semaphore_pend(hRXSem, timeout);
+	}
+	return u8_RXd_Flag;
+}
+
 uint16_t GetAddr6LoWPAN(void) {
 
 	return IEEE80154_MY_ADDR;
@@ -55,25 +66,38 @@ int8_t GetRSSI(void) {
     return rssi;
 }
 
-void Init6LoWPAN(void) {
-
-	 // Enable power domains
-	PRCMPowerDomainOn(PRCM_DOMAIN_PERIPH);
-	while (PRCMPowerDomainStatus(PRCM_DOMAIN_PERIPH) != PRCM_DOMAIN_POWER_ON) { //NOTE: potential infinite loop
-	}
+//populate the radio's init structure and init the radio (also after Sleep6LoWPAN())
+static void RadioInit(void) {
 
-	//populate radio's init structure
 	CWC_CC2650_154_Init_struct_t str_Radio_Init;
 	str_Radio_Init.Channel=IEEE80154_CHANNEL;
 	str_Radio_Init.Event_Callback=&Radio_IRQ;
 	str_Radio_Init.myPANID=IEEE80154_PANID;
 	str_Radio_Init.myAddress=IEEE80154_MY_ADDR;
 
-	//init the radio
 	int32_t result=CWC_CC2650_154_Init(&str_Radio_Init);
 	if(result!=1) {
 		System_abort("Error in Radio\n");
 	}
+}
+
+void Init6LoWPAN(void) {
+
+	Semaphore_Params semParams;
+	Semaphore_Params_init(&semParams);
+	semParams.mode = Semaphore_Mode_BINARY;
+	hRXSem = Semaphore_create(0, &semParams, NULL);
+	if (hRXSem == NULL) {
+		System_abort("RX semaphore create failed!");
+	}
+
+	 // Enable power domains
+	PRCMPowerDomainOn(PRCM_DOMAIN_PERIPH);
+	while (PRCMPowerDomainStatus(PRCM_DOMAIN_PERIPH) != PRCM_DOMAIN_POWER_ON) { //NOTE: potential infinite loop
+	}
+
+	//init the radio
+	RadioInit();
 
     // INT_RFC_CPE_0
     Hwi_Params_init(&cpe0Params);
@@ -95,6 +119,22 @@ int8_t StartReceive6LoWPAN(void) {
 	return CWC_CC2650_154_ReceiveStart();
 }
 
+//radio core off, nothing is received until Wake6LoWPAN()
+void Sleep6LoWPAN(void) {
+
+	if(!CWC_CC2650_154_PowerDown()) {
+		System_printf("Radio busy, not powered down\n");
+		System_flush();
+	}
+}
+
+//power the radio core up and back to receive mode
+int8_t Wake6LoWPAN(void) {
+
+	RadioInit();
+	return CWC_CC2650_154_ReceiveStart();
+}
+
 void Send6LoWPAN(uint16_t DestAddr, uint8_t *ptr_Payload, uint8_t u8_length) {
 
 	volatile uint32_t u32_cnt = 0;
@@ -143,7 +183,7 @@ int8_t Receive6LoWPAN(uint16_t *senderAddr, char *payload, uint8_t maxLen) {
 	*senderAddr = CC2650_RXQueueStruct.ptr_MACdata->str_Header.SrcAddr;
 
 	// RRSI
-	rssi = CC2650_RXQueueStruct.ptr_RSSI;
+	rssi = *(int8_t *)CC2650_RXQueueStruct.ptr_RSSI;
 
 	// no overflow
 	if(i16_MACPDU_length >= maxLen) {
@@ -194,6 +234,7 @@ void Radio_IRQ(CWC_CC2650_154_Events_t Event) {
 				}
 				rx_read_entry=entry;
 				u8_RXd_Flag=1;
+				Semaphore_post(hRXSem);
 			}
 			break;
 		case CWC_CC2650_154_EVENT_RXD_NOK:
@@ -209,6 +250,7 @@ void Radio_IRQ(CWC_CC2650_154_Events_t Event) {
 				}
 				rx_read_entry=entry;
 				u8_RXd_Flag=1;
+				Semaphore_post(hRXSem);
 			}
 			break;
 		default:
@@ -21,12 +21,15 @@
 
 void Init6LoWPAN(void);
 int8_t StartReceive6LoWPAN(void);
+void Sleep6LoWPAN(void);
+int8_t Wake6LoWPAN(void);
 void Send6LoWPAN(uint16_t DestAddr, uint8_t *ptr_Payload, uint8_t u8_length);
 int8_t Receive6LoWPAN(uint16_t *senderAddr, char *payload, uint8_t maxLen);
 
 uint16_t GetAddr6LoWPAN(void);
 uint8_t GetTXFlag(void);
 uint8_t GetRXFlag(void);
+uint8_t WaitRXFlag(uint32_t timeout);
 int8_t GetRSSI(void);
 void Radio_IRQ(CWC_CC2650_154_Events_t Event);
 extern void RFCCPE0IntHandler(UArg arg0);